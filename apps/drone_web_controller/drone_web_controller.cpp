@@ -4,9 +4,6 @@
 #include <sstream>
 #include <signal.h>
 #include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
 #include <cstring>
 #include <chrono>
 #include <thread>
@@ -14,8 +11,11 @@
 #include <cstdlib>
 #include <cstdio>
 #include <filesystem>
+#include <cmath>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 #include <sl/Camera.hpp>
+#include "jpeg_encoder.h"
 
 namespace fs = std::filesystem;
 
@@ -31,14 +31,16 @@ DroneWebController::DroneWebController() {
 DroneWebController::~DroneWebController() {
     handleShutdown();
     
-    // Now that handleShutdown() completed, join web server thread if it exists
-    // (Safe to do here since we're not IN the web server thread - it already exited after setting flag)
-    if (web_server_thread_ && web_server_thread_->joinable()) {
-        std::cout << "[WEB_CONTROLLER] Waiting for web server thread to finish..." << std::endl;
-        web_server_thread_->join();
-        web_server_thread_.reset();
-        std::cout << "[WEB_CONTROLLER] ✓ Web server thread joined" << std::endl;
+    // Now that handleShutdown() completed, join the web server threads if they exist
+    // (Safe to do here since we're not IN a web server thread - reactor already asked to stop)
+    if (http_server_) {
+        std::cout << "[WEB_CONTROLLER] Waiting for web server threads to finish..." << std::endl;
+        http_server_->stop();
+        http_server_.reset();
+        std::cout << "[WEB_CONTROLLER] ✓ Web server threads joined" << std::endl;
     }
+    mjpeg_broadcaster_.reset();
+    event_broadcaster_.reset();
 }
 
 bool DroneWebController::initialize() {
@@ -86,6 +88,12 @@ bool DroneWebController::initialize() {
             lcd_->displayMessage("ERROR", "No USB Storage");
             return false;
         }
+        recording_index_ = std::make_unique<RecordingIndex>(storage_->getMountPath());
+        storage_flusher_ = std::make_unique<StorageFlusher>();
+        storage_flusher_->start(storage_->getMountPath());
+        time_predictor_ = std::make_unique<RecordingTimePredictor>(storage_->getMountPath());
+        time_predictor_->update(recordingModeKey(), 0.0, false);
+        startStorageBenchmark(false);   // Background; a stick seen before is served from the cache
         
         // Initialize battery monitor (I2C bus 7, address 0x40)
         std::cout << "[WEB_CONTROLLER] Initializing battery monitor..." << std::endl;
@@ -112,6 +120,7 @@ bool DroneWebController::initialize() {
         // NOW start system monitor thread (after boot sequence complete)
         // From this point on, systemMonitorLoop will manage LCD updates
         system_monitor_thread_ = std::make_unique<std::thread>(&DroneWebController::systemMonitorLoop, this);
+        stop_worker_thread_ = std::make_unique<std::thread>(&DroneWebController::stopWorkerLoop, this);
         
         std::cout << "[WEB_CONTROLLER] Initialization complete" << std::endl;
         std::cout << "[WEB_CONTROLLER] Camera: " << svo_recorder_->getModeName(camera_resolution_) << std::endl;
@@ -128,6 +137,36 @@ bool DroneWebController::startRecording() {
         return false;
     }
     
+    // Never benchmark while recording; refuse loads the stick measurably cannot sustain
+    stopStorageBenchmark();
+    StorageLoad load = estimateStorageLoad();
+    StorageFit fit = assessStorage(load);
+    if (fit == StorageFit::INSUFFICIENT || fit == StorageFit::MARGINAL) {
+        double capacity;
+        {
+            std::lock_guard<std::mutex> lock(benchmark_mutex_);
+            capacity = storage_bench_.seq_write_mb_per_sec;
+        }
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(0) << "USB stick "
+                << (fit == StorageFit::INSUFFICIENT ? "too slow" : "near its limit") << ": needs ~"
+                << load.mb_per_sec << " MB/s";
+        if (load.files_per_sec > 0.0) {
+            message << " + " << load.files_per_sec << " files/s";
+        }
+        message << ", measured " << capacity << " MB/s";
+        std::cout << "[WEB_CONTROLLER] " << message.str() << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(status_mutex_);
+            status_message_ = message.str();
+        }
+        if (fit == StorageFit::INSUFFICIENT) {
+            updateLCD("USB too slow", "Choose lower mode");
+            publishStatus();
+            return false;
+        }
+    }
+    
     std::cout << std::endl << "[WEB_CONTROLLER] Starting recording..." << std::endl;
     std::cout << "[WEB_CONTROLLER] Mode: ";
     switch (recording_mode_) {
@@ -163,11 +202,16 @@ bool DroneWebController::startRecording() {
         
         // Reinitialize camera if depth mode changed
         if (needs_reinit) {
+            // Claim the camera before it is closed (control requests are serialised, the claim is for the status/preview threads)
+            bool expected = false;
+            if (!camera_initializing_.compare_exchange_strong(expected, true)) {
+                std::cerr << "[WEB_CONTROLLER] Cannot start recording - camera reinitializing" << std::endl;
+                return false;
+            }
             updateLCD("Reinitializing", "Camera...");  // Consolidated message
             
             // Close and destroy the old recorder
-            svo_recorder_->close();
-            svo_recorder_.reset();
+            closeSvoRecorder();
             
             // CRITICAL: Give ZED SDK time to release USB resources
             // ZED 2i needs minimum 3 seconds to fully release hardware
@@ -177,18 +221,18 @@ bool DroneWebController::startRecording() {
             // Don't update LCD during init - keep "Reinitializing Camera..." visible
             
             // Create new recorder
-            svo_recorder_ = std::make_unique<ZEDRecorder>();
+            auto recorder = std::make_unique<ZEDRecorder>();
             
             // Enable depth BEFORE init
             sl::DEPTH_MODE zed_depth_mode = convertDepthMode(depth_mode_);
-            svo_recorder_->enableDepthComputation(true, zed_depth_mode);
+            recorder->enableDepthComputation(true, zed_depth_mode);
             
             // Try initialization with retry (corrupted frames can happen on first attempt)
             bool init_success = false;
             for (int attempt = 1; attempt <= 3; attempt++) {
                 std::cout << "[WEB_CONTROLLER] Camera init attempt " << attempt << "/3..." << std::endl;
                 
-                if (svo_recorder_->init(camera_resolution_)) {  // Use saved resolution!
+                if (recorder->init(camera_resolution_)) {  // Use saved resolution!
                     init_success = true;
                     std::cout << "[WEB_CONTROLLER] Camera initialized successfully" << std::endl;
                     break;
@@ -200,6 +244,9 @@ bool DroneWebController::startRecording() {
                 }
             }
             
+            adoptSvoRecorder(std::move(recorder));
+            camera_initializing_ = false;
+            
             if (!init_success) {
                 std::cerr << "[WEB_CONTROLLER] Failed to reinitialize camera with depth after 3 attempts" << std::endl;
                 updateLCD("Init Error", "Camera failed");
@@ -233,13 +280,18 @@ bool DroneWebController::startRecording() {
             std::cout << "[WEB_CONTROLLER] Depth data directory: " << depth_data_dir << std::endl;
             
             // Initialize DepthDataWriter
-            depth_data_writer_ = std::make_unique<DepthDataWriter>();
-            if (!depth_data_writer_->init(depth_data_dir, depth_recording_fps_.load())) {
+            auto writer = std::make_unique<DepthDataWriter>();
+            if (!writer->init(depth_data_dir, depth_recording_fps_.load())) {
                 std::cout << "[WEB_CONTROLLER] Failed to initialize DepthDataWriter" << std::endl;
                 updateLCD("Recording Error", "Depth Init Fail");
-                depth_data_writer_.reset();
                 return false;
             }
+            writer->setCodec(depth_codec_.load());
+            writer->setDownsample(depth_scale_.load(), depth_pooling_.load());
+            {
+                std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+                depth_data_writer_ = std::move(writer);
+            }
             std::cout << "[WEB_CONTROLLER] DepthDataWriter initialized (target: " 
                       << depth_recording_fps_.load() << " FPS)" << std::endl;
         }
@@ -269,8 +321,22 @@ bool DroneWebController::startRecording() {
         
         // Start DepthDataWriter after SVO recording is running (SVO2_DEPTH_INFO mode)
         if (recording_mode_ == RecordingModeType::SVO2_DEPTH_INFO && depth_data_writer_) {
-            depth_data_writer_->start(*svo_recorder_->getCamera());
-            std::cout << "[WEB_CONTROLLER] DepthDataWriter started successfully" << std::endl;
+            if (depth_data_writer_->start(*svo_recorder_->getCaptureHub())) {
+                std::cout << "[WEB_CONTROLLER] DepthDataWriter started successfully" << std::endl;
+            } else {
+                // SVO2 keeps recording; depth is an add-on
+                std::cout << "[WEB_CONTROLLER] ⚠️ DepthDataWriter failed to start - recording SVO2 only" << std::endl;
+                std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+                depth_data_writer_.reset();
+            }
+        }
+        
+        if (storage_flusher_) {
+            storage_flusher_->track(svo_recorder_->getVideoPath());
+            storage_flusher_->track(sensor_path);
+            if (depth_data_writer_) {
+                storage_flusher_->track(depth_data_writer_->getStreamPath());
+            }
         }
         
         current_recording_path_ = video_path;
@@ -284,22 +350,29 @@ bool DroneWebController::startRecording() {
         
         // Initialize raw recorder if not already done
         if (!raw_recorder_) {
-            raw_recorder_ = std::make_unique<RawFrameRecorder>();
-            if (!raw_recorder_->init(RecordingMode::HD720_30FPS, depth_mode_)) {
+            auto recorder = std::make_unique<RawFrameRecorder>();
+            bool ok = recorder->init(RecordingMode::HD720_30FPS, depth_mode_);
+            adoptRawRecorder(std::move(recorder));
+            if (!ok) {
                 std::cout << "[WEB_CONTROLLER] Failed to initialize raw recorder" << std::endl;
                 updateLCD("Recording Error", "Init Failed");
                 return false;
             }
         }
         
-        // Create directory structure for raw frames
-        if (!storage_->createRawRecordingStructure()) {
+        // Container recordings only need the flight directory (frames.dfc + sensor_data.slog)
+        bool dir_ok = (raw_recorder_->getStorageFormat() == RawStorageFormat::CONTAINER)
+                          ? storage_->createRecordingDir()
+                          : storage_->createRawRecordingStructure();
+        if (!dir_ok) {
             std::cout << "[WEB_CONTROLLER] Failed to create raw recording structure" << std::endl;
             updateLCD("Recording Error", "Dir Failed");
             return false;
         }
         
         std::string base_dir = storage_->getRecordingDir();
+        raw_recorder_->setDepthCodec(depth_codec_.load());
+        raw_recorder_->setDepthDownsample(depth_scale_.load(), depth_pooling_.load());
         
         if (!raw_recorder_->startRecording(base_dir)) {
             std::cout << "[WEB_CONTROLLER] Failed to start raw frame recording" << std::endl;
@@ -307,6 +380,13 @@ bool DroneWebController::startRecording() {
             return false;
         }
         
+        if (storage_flusher_) {
+            if (!raw_recorder_->getContainerPath().empty()) {
+                storage_flusher_->track(raw_recorder_->getContainerPath());
+            }
+            storage_flusher_->track(raw_recorder_->getSensorPath());
+        }
+        
         current_recording_path_ = base_dir;
         std::cout << "[WEB_CONTROLLER] RAW Recording started: " << base_dir << std::endl;
         std::cout << "[WEB_CONTROLLER] Depth mode: " 
@@ -315,8 +395,12 @@ bool DroneWebController::startRecording() {
     
     recording_active_ = true;
     recording_stop_complete_ = false;  // Recording started - stop not yet complete
+    if (recording_index_) {
+        recording_index_->setActive(fs::path(storage_->getRecordingDir()).filename().string());
+    }
     current_state_ = RecorderState::RECORDING;
     recording_start_time_ = std::chrono::steady_clock::now();
+    publishStatus();
     
     // Start depth visualization thread if in SVO2 + Depth Viz mode
     if (recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
@@ -334,6 +418,8 @@ bool DroneWebController::startRecording() {
 }
 
 bool DroneWebController::stopRecording() {
+    // Concurrent callers (stop worker, battery shutdown, handleShutdown) wait here and then see !recording_active_
+    std::lock_guard<std::mutex> stop_lock(stop_mutex_);
     if (!recording_active_) {
         return false;
     }
@@ -341,7 +427,14 @@ bool DroneWebController::stopRecording() {
     std::cout << std::endl << "[WEB_CONTROLLER] Stopping recording..." << std::endl;
     updateLCD("Stopping", "Recording...");
     
+    auto stop_start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+    StopTiming timing;
+    
     current_state_ = RecorderState::STOPPING;
+    publishStatus();
     
     // Stop appropriate recorder based on mode
     if (recording_mode_ == RecordingModeType::SVO2 ||
@@ -349,12 +442,16 @@ bool DroneWebController::stopRecording() {
         recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
         
         // Stop depth data writer if running (SVO2_DEPTH_INFO mode)
-        if (depth_data_writer_) {
+        std::unique_ptr<DepthDataWriter> depth_writer;
+        {
+            std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+            depth_writer = std::move(depth_data_writer_);
+        }
+        if (depth_writer) {
             std::cout << "[WEB_CONTROLLER] Stopping DepthDataWriter..." << std::endl;
-            depth_data_writer_->stop();
-            int frame_count = depth_data_writer_->getFrameCount();
+            depth_writer->stop();
+            int frame_count = depth_writer->getFrameCount();
             std::cout << "[WEB_CONTROLLER] DepthDataWriter stopped. Total frames: " << frame_count << std::endl;
-            depth_data_writer_.reset();
         }
         
         // Stop depth visualization thread if running (SVO2_DEPTH_IMAGES mode)
@@ -367,15 +464,23 @@ bool DroneWebController::stopRecording() {
             }
             std::cout << "[WEB_CONTROLLER] Depth visualization thread stopped" << std::endl;
         }
+        timing.writers_ms = elapsed_ms(stop_start);
         
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
         if (svo_recorder_) {
+            auto recorder_start = std::chrono::steady_clock::now();
             svo_recorder_->stopRecording();
+            timing.recorder_ms = elapsed_ms(recorder_start);
+            timing.svo = svo_recorder_->getLastStopTiming();
             // Disable depth computation for next recording
             svo_recorder_->enableDepthComputation(false);
         }
     } else {
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
         if (raw_recorder_) {
+            auto recorder_start = std::chrono::steady_clock::now();
             raw_recorder_->stopRecording();
+            timing.recorder_ms = elapsed_ms(recorder_start);
         }
     }
     
@@ -383,38 +488,92 @@ bool DroneWebController::stopRecording() {
     recording_active_ = false;
     
     // Wait for recording monitor thread to finish (after setting flags)
+    auto monitor_start = std::chrono::steady_clock::now();
     if (recording_monitor_thread_ && recording_monitor_thread_->joinable()) {
         recording_monitor_thread_->join();
         recording_monitor_thread_.reset();  // Clean up thread pointer
     }
+    timing.monitor_ms = elapsed_ms(monitor_start);
+    
+    // Everything the recording left on the stick (depth files included) - not the eMMC rootfs
+    if (storage_flusher_) {
+        auto sync_start = std::chrono::steady_clock::now();
+        storage_flusher_->syncMount();
+        storage_flusher_->untrackAll();
+        timing.syncfs_ms = elapsed_ms(sync_start);
+    }
     
     // Show "Recording Stopped" message
     updateLCD("Recording", "Stopped");
     
-    // IMPORTANT: Keep STOPPING state visible for GUI (give GUI time to poll and display it)
-    // Without this delay, state transitions RECORDING → STOPPING → IDLE too fast for GUI to see
-    // User expects to see "Stopping..." state during cleanup, especially after timer expires
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    
-    // Set state to IDLE only after a delay (let "Stopped" message stay visible)
-    // Use a timer that systemMonitorLoop can check
+    // systemMonitorLoop keeps "Stopped" on the LCD for a while after this time
     recording_stopped_time_ = std::chrono::steady_clock::now();
     
     // CRITICAL: Transition state to IDLE *before* setting completion flag
     // This ensures shutdown waits for complete state transition, not just partial cleanup
     current_state_ = RecorderState::IDLE;
+    publishStatus();
+    timing.total_ms = elapsed_ms(stop_start);
+    last_stop_timing_.store(timing);
     std::cout << "[WEB_CONTROLLER] State transitioned to IDLE" << std::endl;
+    if (recording_index_) {
+        recording_index_->setActive("");  // Rescan once more with the final file sizes
+    }
     
     // CRITICAL: Signal that recording stop is FULLY complete (including state transition)
     // This flag allows shutdown routine to wait for complete cleanup without timing guesses
     // Best practice: Use completion flags instead of arbitrary delays
     recording_stop_complete_ = true;
     
-    std::cout << "[WEB_CONTROLLER] Recording stopped" << std::endl;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(0)
+         << "[WEB_CONTROLLER] Recording stopped in " << timing.total_ms << "ms (writers " << timing.writers_ms
+         << "ms, recorder " << timing.recorder_ms << "ms, monitor " << timing.monitor_ms
+         << "ms, syncfs " << timing.syncfs_ms << "ms)";
+    std::cout << line.str() << std::endl;
     
     return true;
 }
 
+bool DroneWebController::requestStopRecording() {
+    if (!recording_active_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stop_request_mutex_);
+        stop_requested_ = true;     // Repeated requests while a stop is pending collapse into one
+    }
+    stop_request_cv_.notify_one();
+    return true;
+}
+
+void DroneWebController::stopWorkerLoop() {
+    std::unique_lock<std::mutex> lock(stop_request_mutex_);
+    while (true) {
+        stop_request_cv_.wait(lock, [this]() { return stop_requested_ || stop_worker_exit_; });
+        if (stop_worker_exit_) {
+            break;      // handleShutdown() stops a remaining recording itself
+        }
+        lock.unlock();
+        stopRecording();
+        lock.lock();
+        stop_requested_ = false;
+    }
+}
+
+void DroneWebController::stopStopWorker() {
+    {
+        std::lock_guard<std::mutex> lock(stop_request_mutex_);
+        stop_worker_exit_ = true;
+    }
+    stop_request_cv_.notify_one();
+    // A stop already in progress completes first (join waits for it)
+    if (stop_worker_thread_ && stop_worker_thread_->joinable()) {
+        stop_worker_thread_->join();
+    }
+    stop_worker_thread_.reset();
+}
+
 bool DroneWebController::shutdownSystem() {
     // DEPRECATED: Use shutdown_requested_ flag instead
     // This function only sets the flag - actual shutdown handled by main loop
@@ -424,7 +583,62 @@ bool DroneWebController::shutdownSystem() {
     return true;
 }
 
+namespace {
+
+template <size_t N>
+void copyField(char (&field)[N], const std::string& value) {
+    size_t length = std::min(value.size(), N - 1);
+    std::memcpy(field, value.data(), length);
+    field[length] = '\0';
+}
+
+}  // namespace
+
 RecordingStatus DroneWebController::getStatus() const {
+    const StatusSnapshot snapshot = status_snapshot_.load();
+    RecordingStatus status;
+    status.state = snapshot.state;
+    status.recording_mode = snapshot.recording_mode;
+    status.recording_time_remaining = snapshot.recording_time_remaining;
+    status.recording_duration_total = snapshot.recording_duration_total;
+    status.bytes_written = snapshot.bytes_written;
+    status.mb_per_second = snapshot.mb_per_second;
+    status.recording_seconds_left = snapshot.recording_seconds_left;
+    status.frame_count = snapshot.frame_count;
+    status.current_fps = snapshot.current_fps;
+    status.depth_fps = snapshot.depth_fps;
+    status.camera_initializing = snapshot.camera_initializing;
+    status.depth_mode = snapshot.depth_mode;
+    status.current_file_path = snapshot.current_file_path;
+    status.status_message = snapshot.status_message;
+    status.error_message = snapshot.error_message;
+    return status;
+}
+
+void DroneWebController::publishStatus() {
+    // Called from several threads; without the lock a slow sampler could store its older state last
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    const RecordingStatus status = sampleStatus();
+    StatusSnapshot snapshot;
+    snapshot.state = status.state;
+    snapshot.recording_mode = status.recording_mode;
+    snapshot.recording_time_remaining = status.recording_time_remaining;
+    snapshot.recording_duration_total = status.recording_duration_total;
+    snapshot.bytes_written = status.bytes_written;
+    snapshot.mb_per_second = status.mb_per_second;
+    snapshot.recording_seconds_left = status.recording_seconds_left;
+    snapshot.frame_count = status.frame_count;
+    snapshot.current_fps = status.current_fps;
+    snapshot.depth_fps = status.depth_fps;
+    snapshot.camera_initializing = status.camera_initializing;
+    copyField(snapshot.depth_mode, status.depth_mode);
+    copyField(snapshot.current_file_path, status.current_file_path);
+    copyField(snapshot.status_message, status.status_message);
+    copyField(snapshot.error_message, status.error_message);
+    status_snapshot_.store(snapshot);
+}
+
+RecordingStatus DroneWebController::sampleStatus() const {
     RecordingStatus status;
     status.state = current_state_;
     status.current_file_path = current_recording_path_;
@@ -442,10 +656,9 @@ RecordingStatus DroneWebController::getStatus() const {
     }
     
     // Set depth mode name
-    if (recording_mode_ == RecordingModeType::RAW_FRAMES && raw_recorder_) {
-        status.depth_mode = raw_recorder_->getDepthModeName(depth_mode_);
-    } else if (recording_mode_ == RecordingModeType::SVO2_DEPTH_INFO ||
-               recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
+    if (recording_mode_ == RecordingModeType::RAW_FRAMES ||
+        recording_mode_ == RecordingModeType::SVO2_DEPTH_INFO ||
+        recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
         status.depth_mode = getDepthModeName(depth_mode_);
     } else {
         status.depth_mode = "N/A";
@@ -457,7 +670,8 @@ RecordingStatus DroneWebController::getStatus() const {
         status.recording_time_remaining = recording_duration_seconds_ - elapsed;
         status.recording_duration_total = recording_duration_seconds_;
         
-        // Get stats based on recording mode
+        // Get stats based on recording mode (a reinit cannot run while recording; the lock covers shutdown)
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
         if (recording_mode_ == RecordingModeType::SVO2 ||
             recording_mode_ == RecordingModeType::SVO2_DEPTH_INFO ||
             recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
@@ -469,10 +683,10 @@ RecordingStatus DroneWebController::getStatus() const {
                     status.depth_fps = svo_recorder_->getDepthComputationFPS();
                 }
                 
-                if (elapsed > 0) {
+                // Current write rate from the recorder's size sampler (average until the first samples exist)
+                status.mb_per_second = svo_recorder_->getWriteRateMBps();
+                if (status.mb_per_second <= 0.0 && elapsed > 0) {
                     status.mb_per_second = (status.bytes_written / 1024.0 / 1024.0) / elapsed;
-                } else {
-                    status.mb_per_second = 0.0;
                 }
             } else {
                 status.bytes_written = 0;
@@ -502,9 +716,62 @@ RecordingStatus DroneWebController::getStatus() const {
         status.mb_per_second = 0.0;
     }
     
+    // Learned rate of this mode once it has recorded, the estimate before that
+    status.recording_seconds_left = time_predictor_
+        ? time_predictor_->predictSeconds(recordingModeKey(), estimateStorageLoad().mb_per_sec)
+        : -1;
+    
     return status;
 }
 
+void DroneWebController::releasePreview() {
+    // Bug #5 Fix: preview consumers drop the hub before it is destroyed with its recorder
+    std::lock_guard<std::mutex> lock(preview_mutex_);
+    preview_subscription_.reset();      // The hub closes it
+    if (mjpeg_broadcaster_) {
+        mjpeg_broadcaster_->releaseSubscription();  // Returns once the broadcaster no longer holds the hub
+    }
+}
+
+void DroneWebController::closeSvoRecorder() {
+    std::unique_ptr<ZEDRecorder> recorder;
+    {
+        std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+        recorder = std::move(svo_recorder_);
+    }
+    // Detached: the hub provider and snapshots can no longer reach it
+    if (recorder) {
+        releasePreview();
+        recorder->close();
+    }
+}
+
+void DroneWebController::closeRawRecorder() {
+    std::unique_ptr<RawFrameRecorder> recorder;
+    {
+        std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+        recorder = std::move(raw_recorder_);
+        raw_camera_mode_ = RecordingMode::HD720_30FPS;  // What startRecording() creates
+        raw_storage_format_ = RawStorageFormat::CONTAINER;
+    }
+    if (recorder) {
+        releasePreview();
+        recorder->close();
+    }
+}
+
+void DroneWebController::adoptSvoRecorder(std::unique_ptr<ZEDRecorder> recorder) {
+    std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+    svo_recorder_ = std::move(recorder);
+}
+
+void DroneWebController::adoptRawRecorder(std::unique_ptr<RawFrameRecorder> recorder) {
+    std::unique_lock<std::shared_mutex> lock(recorder_mutex_);
+    raw_camera_mode_ = recorder->getCurrentMode();
+    raw_storage_format_ = recorder->getStorageFormat();
+    raw_recorder_ = std::move(recorder);
+}
+
 void DroneWebController::setRecordingMode(RecordingModeType mode) {
     if (recording_active_) {
         std::cerr << "[WEB_CONTROLLER] Cannot change recording mode while recording" << std::endl;
@@ -515,16 +782,6 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
         return;
     }
     
-    // NEW: Block concurrent mode changes during camera reinitialization
-    if (camera_initializing_) {
-        std::cerr << "[WEB_CONTROLLER] Cannot change recording mode - camera reinitializing" << std::endl;
-        {
-            std::lock_guard<std::mutex> lock(status_mutex_);
-            status_message_ = "Please wait - camera reinitializing...";
-        }
-        return;
-    }
-    
     RecordingModeType old_mode = recording_mode_;
     
     // Check if mode actually changed
@@ -533,6 +790,19 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
         return;
     }
     
+    // Claim the camera before anything is closed; a concurrent reinit keeps it
+    bool expected = false;
+    if (!camera_initializing_.compare_exchange_strong(expected, true)) {
+        std::cerr << "[WEB_CONTROLLER] Cannot change recording mode - camera reinitializing" << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(status_mutex_);
+            status_message_ = "Please wait - camera reinitializing...";
+        }
+        return;
+    }
+    current_state_ = RecorderState::REINITIALIZING;  // Set state for GUI visibility
+    publishStatus();
+    
     recording_mode_ = mode;
     
     std::cout << "[WEB_CONTROLLER] Recording mode change: ";
@@ -565,60 +835,40 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
     
     bool needs_reinit = false;
     
-    // Bug #5 Fix: Invalidate frame cache before any camera reinitialization
-    auto invalidate_cache = [this]() {
-        std::lock_guard<std::mutex> lock(frame_cache_mutex_);
-        frame_cache_valid_ = false;
-        std::cout << "[WEB_CONTROLLER] Frame cache invalidated for mode change" << std::endl;
-    };
-    
     // If switching TO RAW mode from SVO mode
     if (mode == RecordingModeType::RAW_FRAMES && svo_recorder_) {
         std::cout << "[WEB_CONTROLLER] Switching from SVO to RAW mode - reinitializing..." << std::endl;
-        invalidate_cache();  // Bug #5: Clear cache before reinit
-        svo_recorder_->close();
-        svo_recorder_.reset();
+        closeSvoRecorder();
         needs_reinit = true;
     }
     // If switching TO SVO mode from RAW mode
     else if (mode != RecordingModeType::RAW_FRAMES && old_mode == RecordingModeType::RAW_FRAMES && raw_recorder_) {
         std::cout << "[WEB_CONTROLLER] Switching from RAW to SVO mode - reinitializing..." << std::endl;
-        invalidate_cache();  // Bug #5: Clear cache before reinit
-        raw_recorder_->close();
-        raw_recorder_.reset();
+        closeRawRecorder();
         needs_reinit = true;
     }
     // If switching TO SVO2 only from depth modes (need to disable depth)
     else if (mode == RecordingModeType::SVO2 && (old_mode == RecordingModeType::SVO2_DEPTH_INFO || old_mode == RecordingModeType::SVO2_DEPTH_IMAGES)) {
         std::cout << "[WEB_CONTROLLER] Switching from SVO2+Depth to SVO2 only - reinitializing without depth..." << std::endl;
-        invalidate_cache();  // Bug #5: Clear cache before reinit
-        if (svo_recorder_) {
-            svo_recorder_->close();
-            svo_recorder_.reset();
-        }
+        closeSvoRecorder();
         needs_reinit = true;
     }
     // If switching between SVO depth modes
     else if (old_mode != mode && (mode == RecordingModeType::SVO2_DEPTH_INFO || mode == RecordingModeType::SVO2_DEPTH_IMAGES)) {
         std::cout << "[WEB_CONTROLLER] Switching SVO depth mode - reinitializing..." << std::endl;
-        invalidate_cache();  // Bug #5: Clear cache before reinit
-        if (svo_recorder_) {
-            svo_recorder_->close();
-            svo_recorder_.reset();
-        }
+        closeSvoRecorder();
         needs_reinit = true;
     }
     
     // Reinitialize with SAVED camera_resolution_ (preserve FPS settings!)
     if (needs_reinit) {
-        camera_initializing_ = true;
-        current_state_ = RecorderState::REINITIALIZING;  // Set state for GUI visibility
-        
         std::this_thread::sleep_for(std::chrono::milliseconds(500));  // Brief pause for hardware
         
         if (mode == RecordingModeType::RAW_FRAMES) {
-            raw_recorder_ = std::make_unique<RawFrameRecorder>();
-            if (!raw_recorder_->init(camera_resolution_, depth_mode_)) {
+            auto recorder = std::make_unique<RawFrameRecorder>();
+            bool ok = recorder->init(camera_resolution_, depth_mode_);
+            adoptRawRecorder(std::move(recorder));
+            if (!ok) {
                 std::cerr << "[WEB_CONTROLLER] Failed to initialize RAW recorder" << std::endl;
                 updateLCD("Init Error", "RAW Failed");
             } else {
@@ -626,13 +876,13 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
                 updateLCD("RAW Mode", "Ready");
             }
         } else {
-            svo_recorder_ = std::make_unique<ZEDRecorder>();
+            auto recorder = std::make_unique<ZEDRecorder>();
             
             // Enable depth computation ONLY if depth recording is needed
             // For SVO2 only: depth_mode_ should be NONE (set automatically above)
             if (mode == RecordingModeType::SVO2_DEPTH_INFO || mode == RecordingModeType::SVO2_DEPTH_IMAGES) {
                 sl::DEPTH_MODE zed_depth_mode = convertDepthMode(depth_mode_);
-                svo_recorder_->enableDepthComputation(true, zed_depth_mode);
+                recorder->enableDepthComputation(true, zed_depth_mode);
                 std::cout << "[WEB_CONTROLLER] Depth computation ENABLED with mode: " 
                           << getDepthModeName(depth_mode_) << std::endl;
             } else {
@@ -640,7 +890,9 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
                 std::cout << "[WEB_CONTROLLER] Depth computation DISABLED (SVO2 only, compute later on PC)" << std::endl;
             }
             
-            if (!svo_recorder_->init(camera_resolution_)) {
+            bool ok = recorder->init(camera_resolution_);
+            adoptSvoRecorder(std::move(recorder));
+            if (!ok) {
                 std::cerr << "[WEB_CONTROLLER] Failed to initialize SVO recorder" << std::endl;
                 updateLCD("Init Error", "SVO Failed");
             } else {
@@ -651,10 +903,11 @@ void DroneWebController::setRecordingMode(RecordingModeType mode) {
         
         // Show success message longer for visibility
         std::this_thread::sleep_for(std::chrono::seconds(2));
-        
-        camera_initializing_ = false;
-        current_state_ = RecorderState::IDLE;  // Return to IDLE after reinit
     }
+    
+    camera_initializing_ = false;
+    current_state_ = RecorderState::IDLE;  // Return to IDLE after reinit
+    publishStatus();
 }
 
 void DroneWebController::setCameraResolution(RecordingMode mode) {
@@ -665,8 +918,15 @@ void DroneWebController::setCameraResolution(RecordingMode mode) {
         return;
     }
     
-    // NEW: Block concurrent resolution changes during camera reinitialization
-    if (camera_initializing_) {
+    // Check if resolution actually changed
+    if (camera_resolution_ == mode) {
+        std::cout << "[WEB_CONTROLLER] Camera resolution unchanged, skipping reinit" << std::endl;
+        return;
+    }
+    
+    // Claim the camera before anything is closed; a concurrent reinit keeps it
+    bool expected = false;
+    if (!camera_initializing_.compare_exchange_strong(expected, true)) {
         std::cerr << "[WEB_CONTROLLER] Cannot change resolution - camera reinitializing" << std::endl;
         {
             std::lock_guard<std::mutex> lock(status_mutex_);
@@ -675,20 +935,14 @@ void DroneWebController::setCameraResolution(RecordingMode mode) {
         return;
     }
     
-    // Check if resolution actually changed
-    if (camera_resolution_ == mode) {
-        std::cout << "[WEB_CONTROLLER] Camera resolution unchanged, skipping reinit" << std::endl;
-        return;
-    }
-    
     // Save current exposure setting before reinit
     int current_exposure = getCameraExposure();
     
     // Store new resolution setting
     camera_resolution_ = mode;
     
-    camera_initializing_ = true;
     current_state_ = RecorderState::REINITIALIZING;  // Set state for GUI visibility
+    publishStatus();
     {
         std::lock_guard<std::mutex> lock(status_mutex_);
         status_message_ = "Reinitializing camera with new resolution...";
@@ -699,49 +953,48 @@ void DroneWebController::setCameraResolution(RecordingMode mode) {
     std::cout << "[WEB_CONTROLLER] Changing camera resolution/FPS to: " 
               << svo_recorder_->getModeName(mode) << std::endl;
     
-    // Bug #5 Fix: Invalidate frame cache before camera reinitialization
-    {
-        std::lock_guard<std::mutex> lock(frame_cache_mutex_);
-        frame_cache_valid_ = false;
-        std::cout << "[WEB_CONTROLLER] Frame cache invalidated for camera reinit" << std::endl;
-    }
-    
-    // Close and reinitialize camera
-    if (svo_recorder_) {
-        svo_recorder_->close();
-        svo_recorder_.reset();
-    }
-    if (raw_recorder_) {
-        raw_recorder_->close();
-        raw_recorder_.reset();
-    }
+    // Close and reinitialize camera (the preview subscriptions are released first)
+    closeSvoRecorder();
+    closeRawRecorder();
     
     // Reinitialize with new mode
     if (recording_mode_ == RecordingModeType::RAW_FRAMES) {
-        raw_recorder_ = std::make_unique<RawFrameRecorder>();
-        if (!raw_recorder_->init(mode, depth_mode_)) {
+        auto recorder = std::make_unique<RawFrameRecorder>();
+        bool ok = recorder->init(mode, depth_mode_);
+        adoptRawRecorder(std::move(recorder));
+        if (!ok) {
             std::cerr << "[WEB_CONTROLLER] Failed to reinitialize RAW recorder" << std::endl;
-            std::lock_guard<std::mutex> lock(status_mutex_);
-            status_message_ = "Camera initialization failed!";
+            {
+                std::lock_guard<std::mutex> lock(status_mutex_);
+                status_message_ = "Camera initialization failed!";
+            }
             camera_initializing_ = false;
+            current_state_ = RecorderState::IDLE;
+            publishStatus();
             updateLCD("Init Error", "Camera failed");
             return;
         }
     } else {
-        svo_recorder_ = std::make_unique<ZEDRecorder>();
+        auto recorder = std::make_unique<ZEDRecorder>();
         
         // Re-enable depth computation if needed (for both DEPTH_INFO and DEPTH_IMAGES modes)
         if (recording_mode_ == RecordingModeType::SVO2_DEPTH_INFO ||
             recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
             sl::DEPTH_MODE zed_depth_mode = convertDepthMode(depth_mode_);
-            svo_recorder_->enableDepthComputation(true, zed_depth_mode);
+            recorder->enableDepthComputation(true, zed_depth_mode);
         }
         
-        if (!svo_recorder_->init(mode)) {
+        bool ok = recorder->init(mode);
+        adoptSvoRecorder(std::move(recorder));
+        if (!ok) {
             std::cerr << "[WEB_CONTROLLER] Failed to reinitialize SVO recorder" << std::endl;
-            std::lock_guard<std::mutex> lock(status_mutex_);
-            status_message_ = "Camera initialization failed!";
+            {
+                std::lock_guard<std::mutex> lock(status_mutex_);
+                status_message_ = "Camera initialization failed!";
+            }
             camera_initializing_ = false;
+            current_state_ = RecorderState::IDLE;
+            publishStatus();
             updateLCD("Init Error", "Camera failed");
             return;
         }
@@ -749,6 +1002,7 @@ void DroneWebController::setCameraResolution(RecordingMode mode) {
     
     camera_initializing_ = false;
     current_state_ = RecorderState::IDLE;  // Return to IDLE after reinit
+    publishStatus();
     {
         std::lock_guard<std::mutex> lock(status_mutex_);
         status_message_ = "Camera reinitialized successfully";
@@ -767,8 +1021,10 @@ void DroneWebController::setCameraResolution(RecordingMode mode) {
 void DroneWebController::setCameraExposure(int exposure) {
     if (svo_recorder_ && svo_recorder_->setCameraExposure(exposure)) {
         std::cout << "[WEB_CONTROLLER] Exposure set to: " << exposure << std::endl;
+        camera_exposure_cached_ = exposure;
     } else if (raw_recorder_ && raw_recorder_->setCameraExposure(exposure)) {
         std::cout << "[WEB_CONTROLLER] Exposure set to: " << exposure << std::endl;
+        camera_exposure_cached_ = exposure;
     } else {
         std::cerr << "[WEB_CONTROLLER] Failed to set exposure" << std::endl;
     }
@@ -780,6 +1036,7 @@ RecordingMode DroneWebController::getCameraResolution() {
 }
 
 int DroneWebController::getCameraExposure() {
+    std::shared_lock<std::shared_mutex> lock(recorder_mutex_);     // Also sampled by the status push thread
     if (svo_recorder_) {
         return svo_recorder_->getCameraExposure();
     } else if (raw_recorder_) {
@@ -791,14 +1048,17 @@ int DroneWebController::getCameraExposure() {
 void DroneWebController::setCameraGain(int gain) {
     if (svo_recorder_ && svo_recorder_->setCameraGain(gain)) {
         std::cout << "[WEB_CONTROLLER] Gain set to: " << gain << std::endl;
+        camera_gain_cached_ = gain;
     } else if (raw_recorder_ && raw_recorder_->setCameraGain(gain)) {
         std::cout << "[WEB_CONTROLLER] Gain set to: " << gain << std::endl;
+        camera_gain_cached_ = gain;
     } else {
         std::cerr << "[WEB_CONTROLLER] Failed to set gain" << std::endl;
     }
 }
 
 int DroneWebController::getCameraGain() {
+    std::shared_lock<std::shared_mutex> lock(recorder_mutex_);     // Also sampled by the status push thread
     if (svo_recorder_) {
         return svo_recorder_->getCameraGain();
     } else if (raw_recorder_) {
@@ -830,21 +1090,31 @@ void DroneWebController::setDepthMode(DepthMode depth_mode) {
         return;
     }
     
+    // Need to reinitialize camera for both RAW and SVO2+Depth modes
+    const bool needs_reinit = recording_mode_ == RecordingModeType::RAW_FRAMES ||
+                              recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES;
+    
+    // Claim the camera before anything is closed; a concurrent reinit keeps it
+    bool expected = false;
+    if (needs_reinit && !camera_initializing_.compare_exchange_strong(expected, true)) {
+        std::cerr << "[WEB_CONTROLLER] Cannot change depth mode - camera reinitializing" << std::endl;
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        status_message_ = "Please wait - camera reinitializing...";
+        return;
+    }
+    
     std::cout << "[WEB_CONTROLLER] Changing depth mode from " 
-              << (int)depth_mode_ << " to " << (int)depth_mode << std::endl;
+              << (int)depth_mode_.load() << " to " << (int)depth_mode << std::endl;
     
     depth_mode_ = depth_mode;
     
-    // Need to reinitialize camera for both RAW and SVO2+Depth modes
-    if (recording_mode_ == RecordingModeType::RAW_FRAMES || 
-        recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
-        
-        camera_initializing_ = true;
-        
+    if (needs_reinit) {
+        current_state_ = RecorderState::REINITIALIZING;  // Set state for GUI visibility
         {
             std::lock_guard<std::mutex> lock(status_mutex_);
             status_message_ = "Reinitializing camera with new depth mode...";
         }
+        publishStatus();
         
         updateLCD("Camera Init", "Please wait...");
         
@@ -852,21 +1122,24 @@ void DroneWebController::setDepthMode(DepthMode depth_mode) {
             std::cout << "[WEB_CONTROLLER] Reinitializing RAW recorder with new depth mode..." << std::endl;
             
             // Close and reinitialize raw recorder
-            if (raw_recorder_) {
-                raw_recorder_->close();
-                raw_recorder_.reset();
-            }
+            closeRawRecorder();
             
             // CRITICAL: Wait for camera hardware to fully release
             std::cout << "[WEB_CONTROLLER] Waiting 3s for camera hardware to release..." << std::endl;
             std::this_thread::sleep_for(std::chrono::seconds(3));
             
-            raw_recorder_ = std::make_unique<RawFrameRecorder>();
-            if (!raw_recorder_->init(RecordingMode::HD720_30FPS, depth_mode)) {
+            auto recorder = std::make_unique<RawFrameRecorder>();
+            bool ok = recorder->init(RecordingMode::HD720_30FPS, depth_mode);
+            adoptRawRecorder(std::move(recorder));
+            if (!ok) {
                 std::cerr << "[WEB_CONTROLLER] Failed to reinitialize raw recorder" << std::endl;
-                std::lock_guard<std::mutex> lock(status_mutex_);
-                status_message_ = "Camera initialization failed!";
+                {
+                    std::lock_guard<std::mutex> lock(status_mutex_);
+                    status_message_ = "Camera initialization failed!";
+                }
                 camera_initializing_ = false;
+                current_state_ = RecorderState::IDLE;
+                publishStatus();
                 updateLCD("Init Error", "Camera failed");
                 return;
             }
@@ -875,16 +1148,13 @@ void DroneWebController::setDepthMode(DepthMode depth_mode) {
             std::cout << "[WEB_CONTROLLER] Reinitializing SVO2 recorder with new depth mode..." << std::endl;
             
             // Close and reinitialize svo recorder
-            if (svo_recorder_) {
-                svo_recorder_->close();
-                svo_recorder_.reset();
-            }
+            closeSvoRecorder();
             
             // CRITICAL: Wait for camera hardware to fully release
             std::cout << "[WEB_CONTROLLER] Waiting 3s for camera hardware to release..." << std::endl;
             std::this_thread::sleep_for(std::chrono::seconds(3));
             
-            svo_recorder_ = std::make_unique<ZEDRecorder>();
+            auto recorder = std::make_unique<ZEDRecorder>();
             
             // Enable depth computation BEFORE init() so camera opens with correct depth mode
             if (recording_mode_ == RecordingModeType::SVO2_DEPTH_IMAGES) {
@@ -901,14 +1171,20 @@ void DroneWebController::setDepthMode(DepthMode depth_mode) {
                 }
                 
                 std::cout << "[WEB_CONTROLLER] Enabling depth computation with mode: " << (int)zed_depth_mode << std::endl;
-                svo_recorder_->enableDepthComputation(true, zed_depth_mode);
+                recorder->enableDepthComputation(true, zed_depth_mode);
             }
             
-            if (!svo_recorder_->init(RecordingMode::HD720_30FPS)) {
+            bool ok = recorder->init(RecordingMode::HD720_30FPS);
+            adoptSvoRecorder(std::move(recorder));
+            if (!ok) {
                 std::cerr << "[WEB_CONTROLLER] Failed to reinitialize SVO2 recorder" << std::endl;
-                std::lock_guard<std::mutex> lock(status_mutex_);
-                status_message_ = "Camera initialization failed!";
+                {
+                    std::lock_guard<std::mutex> lock(status_mutex_);
+                    status_message_ = "Camera initialization failed!";
+                }
                 camera_initializing_ = false;
+                current_state_ = RecorderState::IDLE;
+                publishStatus();
                 updateLCD("Init Error", "Camera failed");
                 return;
             }
@@ -920,6 +1196,8 @@ void DroneWebController::setDepthMode(DepthMode depth_mode) {
         }
         
         camera_initializing_ = false;
+        current_state_ = RecorderState::IDLE;  // Return to IDLE after reinit
+        publishStatus();
         updateLCD("Camera Ready", getDepthModeShortName(depth_mode));
         std::cout << "[WEB_CONTROLLER] Camera reinitialized successfully" << std::endl;
     }
@@ -1017,8 +1295,49 @@ void DroneWebController::startWebServer(int port) {
     std::cout << "[WEB_CONTROLLER] Starting web server on port " << port << std::endl;
     updateLCD("Starting Web", "Server...");
     
+    // Preview frames come from the active recorder's CaptureHub - never from a grab on the web side
+    mjpeg_broadcaster_ = std::make_unique<MjpegBroadcaster>();
+    mjpeg_broadcaster_->start([this]() -> CaptureHub* {
+        if (shutdown_requested_ || camera_initializing_) {
+            return nullptr;
+        }
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
+        if (svo_recorder_) {
+            return svo_recorder_->getCaptureHub();
+        }
+        if (raw_recorder_) {
+            return raw_recorder_->getCaptureHub();
+        }
+        return nullptr;
+    });
+    
+    event_broadcaster_ = std::make_unique<EventBroadcaster>();
+    
+    if (main_page_.empty()) {
+        main_page_ = StaticAsset("text/html; charset=utf-8", generateMainPage());
+        std::cout << "[WEB_CONTROLLER] UI page cached: " << main_page_.size() << " bytes, "
+                  << main_page_.gzipSize() << " gzip, ETag " << main_page_.etag() << std::endl;
+    }
+    
+    HttpServer::Config config;
+    config.port = port;
+    config.file_rate_limit = 8ULL * 1024 * 1024;  // Downloads leave WiFi headroom for the UI and preview
+    http_server_ = std::make_unique<HttpServer>(config);
+    registerWebRoutes(*http_server_);
+    
+    if (!http_server_->start()) {
+        std::cout << "[WEB_CONTROLLER] Web server failed to start on port " << port << std::endl;
+        http_server_.reset();
+        mjpeg_broadcaster_.reset();
+        event_broadcaster_.reset();
+        updateLCD("Web Server", "Start Failed");
+        return;
+    }
     web_server_running_ = true;
-    web_server_thread_ = std::make_unique<std::thread>(&DroneWebController::webServerLoop, this, port);
+    
+    // Status/battery snapshots for /api/status, /api/battery and /api/events
+    status_push_running_ = true;
+    status_push_thread_ = std::make_unique<std::thread>(&DroneWebController::statusPushLoop, this);
     
     updateLCD("Web Server", "http://192.168.4.1");
     std::cout << "[WEB_CONTROLLER] Web server started at http://192.168.4.1:" << port << std::endl;
@@ -1032,8 +1351,15 @@ void DroneWebController::stopWebServer() {
     std::cout << "[WEB_CONTROLLER] Stopping web server..." << std::endl;
     web_server_running_ = false;
     
-    if (web_server_thread_ && web_server_thread_->joinable()) {
-        web_server_thread_->join();
+    // Broadcasters first: close the preview/event streams while the server can still end them
+    stopStatusPush();
+    if (mjpeg_broadcaster_) {
+        mjpeg_broadcaster_->stop();
+        mjpeg_broadcaster_.reset();
+    }
+    if (http_server_) {
+        http_server_->stop();
+        http_server_.reset();
     }
     
     updateLCD("Web Server", "Stopped");
@@ -1105,18 +1431,34 @@ void DroneWebController::recordingMonitorLoop() {
         
         // Check if recording duration reached
         if (elapsed >= recording_duration_seconds_) {
-            std::cout << std::endl << "[WEB_CONTROLLER] Recording duration reached, setting timer_expired flag..." << std::endl;
+            std::cout << std::endl << "[WEB_CONTROLLER] Recording duration reached, requesting stop..." << std::endl;
             
-            // Set flag to trigger stopRecording() from main thread (prevents deadlock)
-            timer_expired_ = true;
-            
-            // Exit loop - main thread will call stopRecording() when it sees timer_expired_
+            // The stop worker joins this thread - only request, never stop from here
+            requestStopRecording();
             break;
         }
         
+        // Learn this mode's rate; stop while the SVO2 can still be finalised (ENOSPC leaves it unreadable)
+        if (time_predictor_) {
+            const std::string mode_key = recordingModeKey();
+            const double estimate = estimateStorageLoad().mb_per_sec;
+            time_predictor_->update(mode_key, getStatus().mb_per_second, true);
+            if (time_predictor_->shouldStop(mode_key, estimate)) {
+                std::cout << std::endl << "[WEB_CONTROLLER] USB stick almost full ("
+                          << time_predictor_->getFreeBytes() / (1024 * 1024) << " MB free), requesting stop..." << std::endl;
+                {
+                    std::lock_guard<std::mutex> lock(status_mutex_);
+                    status_message_ = "USB full - recording stopped early";
+                }
+                updateLCD("USB Full!", "Stopping Rec...");
+                requestStopRecording();
+                break;
+            }
+        }
+        
         // Update LCD every 3 seconds
         // Line 1: Static - shows progress "Rec: n/240s"
-        // Line 2: Rotates every update between mode and settings
+        // Line 2: Rotates every update between mode, settings and recording time left on the stick
         auto lcd_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_lcd_update_).count();
         if (lcd_elapsed >= 3) {
             std::ostringstream line1, line2;
@@ -1142,7 +1484,7 @@ void DroneWebController::recordingMonitorLoop() {
                         line2 << "RAW"; 
                         break;
                 }
-            } else {
+            } else if (lcd_display_cycle_ == 1) {
                 // Page 2: Resolution@FPS shutter (max 16 chars)
                 // Examples: "720@60 1/120" or "720@60 Auto"
                 int fps;
@@ -1156,91 +1498,111 @@ void DroneWebController::recordingMonitorLoop() {
                     case RecordingMode::VGA_100FPS: res = "VGA"; fps = 100; break;
                 }
                 
-                int exposure = getCameraExposure();
+                int exposure = camera_exposure_cached_.load();  // No SDK call from the LCD path
                 std::string shutter = exposureToShutterSpeed(exposure, fps);
                 line2 << res << "@" << fps << " " << shutter;
+            } else {
+                // Page 3: Recording time left on the USB stick, e.g. "USB left: 1h23m"
+                int left = getStatus().recording_seconds_left;
+                if (left < 0) {
+                    line2 << "USB left: ?";
+                } else if (left >= 3600) {
+                    line2 << "USB left: " << left / 3600 << "h" << std::setfill('0') << std::setw(2) << (left % 3600) / 60 << "m";
+                } else {
+                    line2 << "USB left: " << left / 60 << "m" << std::setfill('0') << std::setw(2) << left % 60 << "s";
+                }
             }
             
             updateLCD(line1.str(), line2.str());
             
-            // Toggle between page 0 and 1 every 3 seconds
-            lcd_display_cycle_ = (lcd_display_cycle_ + 1) % 2;
+            // Rotate pages 0 -> 1 -> 2 every 3 seconds
+            lcd_display_cycle_ = (lcd_display_cycle_ + 1) % 3;
             last_lcd_update_ = now;
         }
         
         updateRecordingStatus();
+        publishStatus();
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 }
 
-void DroneWebController::webServerLoop(int port) {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd == 0) {
-        std::cout << "[WEB_CONTROLLER] Socket creation failed" << std::endl;
-        return;
-    }
-    
-    // Store for clean shutdown
-    server_fd_ = server_fd;
-    
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
-    
-    struct sockaddr_in address;
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(port);
-    
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        std::cout << "[WEB_CONTROLLER] Bind failed" << std::endl;
-        close(server_fd);
-        return;
-    }
-    
-    if (listen(server_fd, 3) < 0) {
-        std::cout << "[WEB_CONTROLLER] Listen failed" << std::endl;
-        close(server_fd);
-        return;
+void DroneWebController::registerWebRoutes(HttpServer& server) {
+    using Dispatch = HttpServer::Dispatch;
+    
+    // INLINE: cheap status JSON / static page, answered on the reactor thread (sub-ms)
+    server.addRoute("GET", "/", Dispatch::INLINE, [this](const HttpRequest& request) {
+        return main_page_.serve(request);   // 304 on a matching ETag, gzip body shared without copying
+    });
+    server.addRoute("GET", "/api/status", Dispatch::INLINE, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generateStatusAPI());
+    });
+    server.addRoute("GET", "/api/battery", Dispatch::INLINE, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generateBatteryAPI());
+    });
+    server.addRoute("GET", "/api/perf", Dispatch::INLINE, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generatePerfAPI());
+    });
+    // SSE status push: attaches a stream and sends the current snapshot as its first event
+    server.addRoute("GET", "/api/events", Dispatch::INLINE, [this](const HttpRequest&) {
+        std::shared_ptr<const std::string> status = std::atomic_load(&status_json_);
+        if (shutdown_requested_ || !event_broadcaster_ || !status) {
+            return HttpResponse::make(503, "text/plain", "Events not available");
+        }
+        return event_broadcaster_->openStream("status", *status);
+    });
+    // MJPEG preview: only attaches a stream, frames are pushed by the broadcaster thread
+    server.addRoute("GET", "/stream.mjpg", Dispatch::INLINE, [this](const HttpRequest& request) {
+        if (shutdown_requested_ || camera_initializing_ || !mjpeg_broadcaster_) {
+            return HttpResponse::make(503, "text/plain", "Preview not available");
+        }
+        return mjpeg_broadcaster_->openStream(request);
+    });
+    
+    // POOL: JPEG encode and camera/recorder control can take 10ms..seconds
+    server.addRoute("GET", "/api/snapshot", Dispatch::POOL, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generateSnapshotJPEG());
+    });
+    // Recording browser/download: directory scans and file opens touch the USB stick
+    server.addRoute("GET", "/api/storage", Dispatch::INLINE, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generateStorageAPI());     // Cached result + arithmetic only
+    });
+    server.addRoute("GET", "/api/recordings", Dispatch::POOL, [this](const HttpRequest&) {
+        return HttpResponse::fromRaw(generateRecordingsAPI());
+    });
+    server.addPrefixRoute("GET", "/api/recordings/", Dispatch::POOL, [this](const HttpRequest& request) {
+        return handleRecordingRequest(request);
+    });
+    static const char* const control_paths[] = {
+        "/api/start_recording", "/api/stop_recording", "/api/set_recording_mode",
+        "/api/set_depth_mode", "/api/set_depth_recording_fps", "/api/set_depth_codec",
+        "/api/set_depth_resolution",
+        "/api/set_camera_resolution", "/api/set_camera_exposure", "/api/set_camera_gain",
+        "/api/storage_benchmark", "/api/shutdown"
+    };
+    for (const char* path : control_paths) {
+        server.addRoute("POST", path, Dispatch::POOL, [this](const HttpRequest& request) {
+            // Two pool threads: without this a mode change could close the camera under start_recording
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            if (shutdown_requested_) {
+                return HttpResponse::make(503, "text/plain", "Shutting down");
+            }
+            return HttpResponse::fromRaw(handleControlRequest(request));
+        });
     }
     
-    std::cout << "[WEB_CONTROLLER] Web server listening on port " << port << std::endl;
+    server.setFallback([](const HttpRequest&) {
+        return HttpResponse::make(404, "text/html", "<h1>404 Not Found</h1>");
+    });
     
-    while (web_server_running_) {
-        // CRITICAL: Check if recording timer expired FIRST (before blocking select)
-        // This ensures immediate response when timer expires, not up to 1 second delay
-        if (timer_expired_ && recording_active_) {
-            std::cout << "[WEB_CONTROLLER] Timer expired detected, spawning stop thread..." << std::endl;
-            timer_expired_ = false;  // Reset flag
-            
-            // CRITICAL: Call stopRecording() in separate thread to avoid blocking web server!
-            // If we call stopRecording() here (web server thread), it blocks for 3-6 seconds
-            // during file closure, preventing GUI from polling status and seeing STOPPING state.
-            // Solution: Spawn detached thread that calls stopRecording(), allowing web server
-            // to continue handling /api/status requests while cleanup happens in background.
-            std::thread([this]() {
-                stopRecording();
-            }).detach();
+    // Reactor tick (250ms): gate downloads on the recorder state
+    server.setTickHandler([this]() {
+        // Downloads compete with the recorder for USB bandwidth: hold them while recording
+        if (http_server_) {
+            RecorderState state = current_state_.load();
+            http_server_->setFileTransfersPaused(state == RecorderState::RECORDING ||
+                                                 state == RecorderState::STOPPING);
         }
-        
-        fd_set read_fds;
-        struct timeval timeout;
-        FD_ZERO(&read_fds);
-        FD_SET(server_fd, &read_fds);
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-        
-        int activity = select(server_fd + 1, &read_fds, NULL, NULL, &timeout);
-        if (activity <= 0) continue;
-        
-        int client_socket = accept(server_fd, NULL, NULL);
-        if (client_socket < 0) continue;
-        
-        handleClientRequest(client_socket);
-        close(client_socket);
-    }
-    
-    close(server_fd);
-    std::cout << "[WEB_CONTROLLER] Web server loop ended" << std::endl;
+    });
 }
 
 void DroneWebController::systemMonitorLoop() {
@@ -1357,6 +1719,24 @@ void DroneWebController::systemMonitorLoop() {
             }
         }
         
+        // A benchmark that startRecording cancelled runs again once the recorder is idle
+        // (after the "Stopped" period, so it does not compete with the final syncfs)
+        if (benchmark_cancelled_ && !recording_active_ && !shutdown_requested_ && !system_shutdown_requested_ &&
+            current_state_ == RecorderState::IDLE &&
+            std::chrono::steady_clock::now() - recording_stopped_time_ >= std::chrono::seconds(3)) {
+            // A control request in progress (e.g. start_recording) wins; try again on the next pass
+            std::unique_lock<std::mutex> control_lock(control_mutex_, std::try_to_lock);
+            if (control_lock.owns_lock() && !recording_active_) {
+                std::cout << "[WEB_CONTROLLER] Restarting cancelled storage benchmark" << std::endl;
+                startStorageBenchmark(benchmark_force_);
+            }
+        }
+        
+        // Free space for the time-left prediction (throttled to 1 Hz; recordingMonitorLoop samples while recording)
+        if (time_predictor_ && !recording_active_) {
+            time_predictor_->update(recordingModeKey(), 0.0, false);
+        }
+        
         std::this_thread::sleep_for(std::chrono::milliseconds(500));  // Check battery every 500ms (5s until shutdown with 10 confirmations)
     }
     
@@ -1443,39 +1823,32 @@ void DroneWebController::updateRecordingStatus() {
     // Currently just a placeholder
 }
 
-void DroneWebController::handleClientRequest(int client_socket) {
-    char buffer[1024] = {0};
-    read(client_socket, buffer, 1024);
-    
-    std::string request(buffer);
+std::string DroneWebController::handleControlRequest(const HttpRequest& http_request) {
+    const std::string& path = http_request.path;
+    const std::string& request = http_request.body;  // Form-encoded parameters
     std::string response;
     
-    // Parse HTTP request
-    if (request.find("GET / ") != std::string::npos) {
-        response = generateMainPage();
-    } else if (request.find("GET /api/snapshot") != std::string::npos) {
-        response = generateSnapshotJPEG();
-    } else if (request.find("GET /api/status") != std::string::npos) {
-        response = generateStatusAPI();
-    } else if (request.find("GET /api/battery") != std::string::npos) {
-        response = generateBatteryAPI();
-    } else if (request.find("POST /api/start_recording") != std::string::npos) {
+    if (path == "/api/start_recording") {
         bool success = startRecording();
         response = generateAPIResponse(success ? "Recording started" : "Failed to start recording");
-    } else if (request.find("POST /api/stop_recording") != std::string::npos) {
-        // CRITICAL: Spawn separate thread for stopRecording() to avoid blocking web server
-        // stopRecording() blocks for 3-6 seconds during file closure/sync, preventing
-        // GUI from receiving status updates. By running in detached thread, web server
-        // continues handling /api/status requests, allowing GUI to see STOPPING state.
-        if (recording_active_) {
-            std::thread([this]() {
-                stopRecording();
-            }).detach();
+    } else if (path == "/api/stop_recording") {
+        // The stop worker finalizes the files; this handler thread returns immediately
+        // and the STOPPING -> IDLE transition reaches the GUI through /api/events
+        if (requestStopRecording()) {
             response = generateAPIResponse("Recording stop initiated");
         } else {
             response = generateAPIResponse("No active recording to stop");
         }
-    } else if (request.find("POST /api/set_recording_mode") != std::string::npos) {
+    } else if (path == "/api/storage_benchmark") {
+        if (recording_active_) {
+            response = generateAPIResponse("Cannot benchmark storage while recording");
+        } else if (benchmark_running_) {
+            response = generateAPIResponse("Storage benchmark already running");
+        } else {
+            startStorageBenchmark(true);
+            response = generateAPIResponse("Storage benchmark started");
+        }
+    } else if (path == "/api/set_recording_mode") {
         // Parse mode from request body
         size_t mode_pos = request.find("mode=");
         if (mode_pos != std::string::npos) {
@@ -1498,7 +1871,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
         } else {
             response = generateAPIResponse("Missing mode parameter");
         }
-    } else if (request.find("POST /api/set_depth_mode") != std::string::npos) {
+    } else if (path == "/api/set_depth_mode") {
         // Parse depth mode from request body
         size_t mode_pos = request.find("depth=");
         if (mode_pos != std::string::npos) {
@@ -1521,8 +1894,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
                 depth_mode = DepthMode::NONE;
             } else {
                 response = generateAPIResponse("Invalid depth mode");
-                send(client_socket, response.c_str(), response.length(), 0);
-                return;
+                return response;
             }
             
             setDepthMode(depth_mode);
@@ -1530,7 +1902,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
         } else {
             response = generateAPIResponse("Missing depth parameter");
         }
-    } else if (request.find("POST /api/set_depth_recording_fps") != std::string::npos) {
+    } else if (path == "/api/set_depth_recording_fps") {
         // Parse FPS from request body
         size_t fps_pos = request.find("fps=");
         if (fps_pos != std::string::npos) {
@@ -1550,7 +1922,57 @@ void DroneWebController::handleClientRequest(int client_socket) {
         } else {
             response = generateAPIResponse("Missing fps parameter");
         }
-    } else if (request.find("POST /api/set_camera_resolution") != std::string::npos) {
+    } else if (path == "/api/set_depth_codec") {
+        // Parse codec from request body (float32 | mm16 | mm16_zlib)
+        size_t codec_pos = request.find("codec=");
+        if (codec_pos != std::string::npos) {
+            std::string codec_str = request.substr(codec_pos + 6);
+            codec_str = codec_str.substr(0, codec_str.find_first_of("&\r\n "));
+            DepthCodec codec;
+            if (isRecording()) {
+                response = generateAPIResponse("Cannot change depth codec while recording");
+            } else if (depth_codec::parseCodec(codec_str, codec)) {
+                depth_codec_ = codec;
+                std::cout << "[WEB_CONTROLLER] Depth codec set to: " << codec_str << std::endl;
+                response = generateAPIResponse("Depth codec set to " + codec_str);
+            } else {
+                response = generateAPIResponse("Invalid depth codec");
+            }
+        } else {
+            response = generateAPIResponse("Missing codec parameter");
+        }
+    } else if (path == "/api/set_depth_resolution") {
+        // Parse stored depth resolution from request body (scale=full|half|quarter[&pooling=min|median|mean])
+        size_t scale_pos = request.find("scale=");
+        if (scale_pos != std::string::npos) {
+            std::string scale_str = request.substr(scale_pos + 6);
+            scale_str = scale_str.substr(0, scale_str.find_first_of("&\r\n "));
+            DepthPooling pooling = depth_pooling_.load();
+            size_t pooling_pos = request.find("pooling=");
+            std::string pooling_str;
+            if (pooling_pos != std::string::npos) {
+                pooling_str = request.substr(pooling_pos + 8);
+                pooling_str = pooling_str.substr(0, pooling_str.find_first_of("&\r\n "));
+            }
+            int scale;
+            if (isRecording()) {
+                response = generateAPIResponse("Cannot change depth resolution while recording");
+            } else if (!depth_downsample::parseScale(scale_str, scale)) {
+                response = generateAPIResponse("Invalid depth scale");
+            } else if (!pooling_str.empty() && !depth_downsample::parsePooling(pooling_str, pooling)) {
+                response = generateAPIResponse("Invalid depth pooling");
+            } else {
+                depth_scale_ = scale;
+                depth_pooling_ = pooling;
+                std::string name = std::string(depth_downsample::scaleName(scale)) + " (" +
+                                   depth_downsample::poolingName(pooling) + ")";
+                std::cout << "[WEB_CONTROLLER] Depth resolution set to: " << name << std::endl;
+                response = generateAPIResponse("Depth resolution set to " + name);
+            }
+        } else {
+            response = generateAPIResponse("Missing scale parameter");
+        }
+    } else if (path == "/api/set_camera_resolution") {
         // Parse resolution/FPS mode from request body
         size_t mode_pos = request.find("mode=");
         if (mode_pos != std::string::npos) {
@@ -1571,8 +1993,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
                 mode = RecordingMode::VGA_100FPS;
             } else {
                 response = generateAPIResponse("Invalid resolution/FPS mode");
-                send(client_socket, response.c_str(), response.length(), 0);
-                return;
+                return response;
             }
             
             setCameraResolution(mode);
@@ -1580,7 +2001,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
         } else {
             response = generateAPIResponse("Missing mode parameter");
         }
-    } else if (request.find("POST /api/set_camera_exposure") != std::string::npos) {
+    } else if (path == "/api/set_camera_exposure") {
         // Parse exposure from request body
         size_t exp_pos = request.find("exposure=");
         if (exp_pos != std::string::npos) {
@@ -1600,7 +2021,7 @@ void DroneWebController::handleClientRequest(int client_socket) {
             response = generateAPIResponse("Missing exposure parameter");
         }
         
-    } else if (request.find("POST /api/set_camera_gain") != std::string::npos) {
+    } else if (path == "/api/set_camera_gain") {
         // Parse gain from request body
         size_t gain_pos = request.find("gain=");
         if (gain_pos != std::string::npos) {
@@ -1619,35 +2040,31 @@ void DroneWebController::handleClientRequest(int client_socket) {
         } else {
             response = generateAPIResponse("Missing exposure parameter");
         }
-    } else if (request.find("POST /api/shutdown") != std::string::npos) {
-        response = generateAPIResponse("Shutdown initiated");
-        send(client_socket, response.c_str(), response.length(), 0);
-        
+    } else if (path == "/api/shutdown") {
         // CRITICAL: Don't call shutdownSystem() from web server thread (causes deadlock)
         // Set SYSTEM shutdown flag - this will power off the Jetson
         std::cout << std::endl << "[WEB_CONTROLLER] System shutdown requested via GUI" << std::endl;
         
-        // Display final message on LCD (stays visible after power off)
-        updateLCD("User Shutdown", "Please Wait...");
-        std::this_thread::sleep_for(std::chrono::seconds(1));  // Ensure LCD write completes
-        
-        system_shutdown_requested_ = true;  // Power off system
-        shutdown_requested_ = true;          // Also stop application
-        return;
+        // Flags are set from a detached thread so the response is sent before main() tears down the server
+        std::thread([this]() {
+            // Display final message on LCD (stays visible after power off)
+            updateLCD("User Shutdown", "Please Wait...");
+            std::this_thread::sleep_for(std::chrono::seconds(1));  // Ensure LCD write completes
+            
+            system_shutdown_requested_ = true;  // Power off system
+            shutdown_requested_ = true;          // Also stop application
+        }).detach();
+        response = generateAPIResponse("Shutdown initiated");
     } else {
         response = "HTTP/1.1 404 Not Found\r\n\r\n<h1>404 Not Found</h1>";
     }
     
-    send(client_socket, response.c_str(), response.length(), 0);
+    return response;
 }
 
 std::string DroneWebController::generateMainPage() {
-    return "HTTP/1.1 200 OK\r\n"
-           "Content-Type: text/html; charset=utf-8\r\n"
-           "Cache-Control: no-cache, no-store, must-revalidate\r\n"
-           "Pragma: no-cache\r\n"
-           "Expires: 0\r\n\r\n"
-           "<!DOCTYPE html><html><head><title>Drone Controller</title>"
+    // Static page: built once into main_page_ (gzip + ETag) when the web server starts
+    return "<!DOCTYPE html><html><head><title>Drone Controller</title>"
            "<meta name='viewport' content='width=device-width, initial-scale=1'>"
            "<meta charset='utf-8'>"
            "<style>body{font-family:Arial;text-align:center;margin:15px;background:#f0f0f0}"
@@ -1712,7 +2129,7 @@ std::string DroneWebController::generateMainPage() {
            ".system-info strong{color:#495057}"
            "</style>"
            "<script>"
-           "let currentRecMode='svo2',currentDepthMode='NEURAL_LITE',livestreamActive=false,livestreamInterval=null,fullscreenInterval=null,livestreamFPS=2,currentCameraFPS=60,lastFrameTime=Date.now(),frameCount=0,actualLivestreamFPS=0;"
+           "let currentRecMode='svo2',currentDepthMode='NEURAL_LITE',livestreamActive=false,livestreamFPS=2,currentCameraFPS=60,lastStatus=null;"
            "const exposureToShutterSpeed=(exposure,fps)=>{"
            "if(exposure<=0)return 'Auto';"
            "let shutter=Math.round((fps*100)/exposure);"
@@ -1728,19 +2145,48 @@ std::string DroneWebController::generateMainPage() {
            "}).filter(item=>item.e>=5&&item.e<=100);"
            "};"
            "let shutterSpeeds=[{s:0,e:-1}];"  // Auto mode, will be populated on init
+           "function loadRecordings(){"
+           "fetch('/api/recordings').then(r=>r.json()).then(data=>{"
+           "let list=document.getElementById('recordingsList');"
+           "document.getElementById('downloadsPaused').style.display=data.downloads_paused?'block':'none';"
+           "if(!data.recordings||!data.recordings.length){list.textContent='No recordings on USB';return;}"
+           "list.innerHTML=data.recordings.map(rec=>'<details ontoggle=\"loadRecordingFiles(this,\\''+rec.id+'\\')\"><summary>'+rec.id+' - '+(rec.bytes/1048576).toFixed(1)+' MB, '+rec.duration_s+'s'+(rec.active?' (recording)':'')+'</summary><div></div></details>').join('');"
+           "}).catch(()=>{});"
+           "}"
+           "function loadRecordingFiles(el,id){"
+           "if(!el.open||el.dataset.loaded)return;"
+           "fetch('/api/recordings/'+id+'/').then(r=>r.json()).then(data=>{"
+           "el.dataset.loaded=1;"
+           "el.lastChild.innerHTML=data.files.map(f=>'<a href=\"/api/recordings/'+id+'/'+f.path+'\">'+f.path+'</a> ('+(f.bytes/1048576).toFixed(1)+' MB)').join('<br>');"
+           "}).catch(()=>{});"
+           "}"
+           "function loadStorage(){"
+           "fetch('/api/storage').then(r=>r.json()).then(data=>{"
+           "let el=document.getElementById('storageBench');"
+           "if(data.running){el.textContent='running...';setTimeout(loadStorage,2000);return;}"
+           "if(!data.valid){el.textContent='not measured';return;}"
+           "el.textContent=data.seq_write_mbps.toFixed(1)+' MB/s, '+data.small_files_per_sec.toFixed(0)+' files/s, fsync '+data.fsync_p50_ms.toFixed(1)+' ms - current mode needs ~'+data.required_mbps.toFixed(0)+' MB/s ('+data.fit+')';"
+           "}).catch(()=>{});"
+           "}"
+           "function runStorageBenchmark(){"
+           "fetch('/api/storage_benchmark',{method:'POST'}).then(r=>r.json()).then(data=>{"
+           "document.getElementById('storageBench').textContent=data.message;"
+           "setTimeout(loadStorage,1000);"
+           "}).catch(()=>{});"
+           "}"
            "function switchTab(tabName){"
            "document.querySelectorAll('.tab').forEach(t=>t.classList.remove('active'));"
            "document.querySelectorAll('.tab-content').forEach(c=>c.classList.remove('active'));"
            "document.querySelector('.tab[data-tab=\"'+tabName+'\"]').classList.add('active');"
            "document.getElementById(tabName+'-tab').classList.add('active');"
+           "if(tabName==='system'){loadRecordings();loadStorage();}"
            "if(tabName==='livestream'&&livestreamActive){"
            "startLivestream();"
            "}else if(tabName!=='livestream'){"
            "stopLivestream();"
            "}"
            "}"
-           "function updateStatus(){"
-           "fetch('/api/status').then(r=>r.json()).then(data=>{"
+           "function applyStatus(data){"
            "let stateText=data.state===0?'IDLE':data.state===1?'RECORDING':data.state===2?'STOPPING':data.state===3?'REINITIALIZING':'ERROR';"
            "document.getElementById('status').textContent=stateText;"
            "let isRecording=data.state===1;"
@@ -1793,6 +2239,12 @@ std::string DroneWebController::generateMainPage() {
            "document.getElementById('modeRadioDepthImages').disabled=isRecording||isInitializing;"
            "document.getElementById('modeRadioRaw').disabled=isRecording||isInitializing;"
            "document.getElementById('depthFpsSlider').disabled=isRecording||isInitializing;"
+           "document.getElementById('depthCodecSelect').disabled=isRecording||isInitializing;"
+           "if(data.depth_codec)document.getElementById('depthCodecSelect').value=data.depth_codec;"
+           "document.getElementById('depthScaleSelect').disabled=isRecording||isInitializing;"
+           "document.getElementById('depthPoolingSelect').disabled=isRecording||isInitializing;"
+           "if(data.depth_scale)document.getElementById('depthScaleSelect').value=data.depth_scale;"
+           "if(data.depth_pooling)document.getElementById('depthPoolingSelect').value=data.depth_pooling;"
            "if(isInitializing){"
            "document.getElementById('statusDiv').className='status initializing';"
            "document.getElementById('status').textContent='INITIALIZING...';"
@@ -1816,6 +2268,9 @@ std::string DroneWebController::generateMainPage() {
            "document.getElementById('stopBtn').disabled=!isRecording;"
            "document.getElementById('livestreamToggle').disabled=isInitializing;"
            "document.getElementById('livestreamFPSSelect').disabled=isInitializing;"
+           "if(livestreamActive&&data.preview_fps!==undefined){"
+           "document.getElementById('actualFPS').textContent=data.preview_fps.toFixed(1)+' FPS';"
+           "}"
            "document.getElementById('depthModeGroup').style.display=showDepth?'block':'none';"
            "document.getElementById('depthFpsGroup').style.display=showDepthFps?'block':'none';"
            "if(currentRecMode==='svo2_depth_info'){"
@@ -1825,8 +2280,14 @@ std::string DroneWebController::generateMainPage() {
            "}else if(currentRecMode==='svo2'){"
            "document.getElementById('modeInfo').textContent='SVO2: Single compressed file at 30 FPS';"
            "}else if(currentRecMode==='raw'){"
-           "document.getElementById('modeInfo').textContent='RAW: Separate left/right/depth images';"
+           "document.getElementById('modeInfo').textContent='RAW: Left/right JPEG + depth in one frames.dfc container';"
            "}"
+           "let sw=document.getElementById('storageWarning');"
+           "let slow=data.storage_fit==='insufficient';"
+           "sw.style.display=(slow||data.storage_fit==='marginal')&&!isRecording?'block':'none';"
+           "sw.textContent=(slow?'⛔ USB stick too slow for this mode':'⚠️ USB stick near its limit for this mode')+' (needs ~'+data.storage_required_mbps.toFixed(0)+' MB/s)';"
+           "let left=data.recording_seconds_left;"
+           "document.getElementById('usbLeft').textContent=left<0?'':'💾 USB space for ~'+(left>=3600?Math.floor(left/3600)+'h '+Math.floor(left%3600/60)+'m':Math.floor(left/60)+'m '+(left%60)+'s')+' in this mode';"
            "if(isRecording){"
            "let elapsed=data.recording_duration_total-data.recording_time_remaining;"
            "let percent=Math.round((elapsed/data.recording_duration_total)*100);"
@@ -1838,7 +2299,9 @@ std::string DroneWebController::generateMainPage() {
            "document.getElementById('remaining').textContent=data.recording_time_remaining+'s';"
            "document.getElementById('percent').textContent=percent+'%';"
            "document.getElementById('filesize').textContent=fileSize+' GB';"
-           "document.getElementById('speed').textContent=speed+' MB/s';"
+           "let speedEl=document.getElementById('speed');"
+           "speedEl.textContent=speed+' MB/s'+(data.flush_warning?' ⚠ '+data.flush_backlog_s.toFixed(1)+'s unflushed':'');"
+           "speedEl.style.color=data.flush_warning?'#e74c3c':'';"
            "if(currentRecMode==='raw'){"
            "document.getElementById('filename').textContent='Frames: '+data.frame_count+' | FPS: '+data.current_fps.toFixed(1);"
            "}else if(currentRecMode==='svo2_depth_test'||currentRecMode==='svo2_depth_images'){"
@@ -1849,11 +2312,12 @@ std::string DroneWebController::generateMainPage() {
            "}else{"
            "document.getElementById('progress').style.display='none';"
            "}"
-           "}).catch(()=>{"
+           "}"
+           "function showConnectionError(){"
            "document.getElementById('statusDiv').className='status error';"
            "document.getElementById('status').textContent='CONNECTION ERROR';"
-           "});"
-           "fetch('/api/battery').then(r=>r.json()).then(bat=>{"
+           "}"
+           "function applyBattery(bat){"
            "if(bat.error){return;}"
            "let pct=bat.battery_percentage||0;"
            "let indicator=document.getElementById('batteryIndicator');"
@@ -1877,7 +2341,18 @@ std::string DroneWebController::generateMainPage() {
            "else if(bat.is_healthy){statusText='✓ OK';}"
            "document.getElementById('batStatus').textContent=statusText;"
            "}"
-           "}).catch(()=>{});"
+           "}"
+           "function updateStatus(){"
+           "fetch('/api/status').then(r=>r.json()).then(data=>{lastStatus=data;applyStatus(data);}).catch(showConnectionError);"
+           "fetch('/api/battery').then(r=>r.json()).then(applyBattery).catch(()=>{});"
+           "}"
+           "function startStatusEvents(){"
+           "if(!window.EventSource){setInterval(updateStatus,1000);return;}"
+           "let events=new EventSource('/api/events');"
+           "events.addEventListener('status',e=>{lastStatus=JSON.parse(e.data);applyStatus(lastStatus);});"
+           "events.addEventListener('delta',e=>{if(!lastStatus)return;Object.assign(lastStatus,JSON.parse(e.data));applyStatus(lastStatus);});"
+           "events.addEventListener('battery',e=>applyBattery(JSON.parse(e.data)));"
+           "events.onerror=()=>{showConnectionError();};"
            "}"
            "function setRecordingMode(mode){"
            "if(currentRecMode===mode)return;"
@@ -1907,6 +2382,19 @@ std::string DroneWebController::generateMainPage() {
            "setTimeout(updateStatus,500);"
            "});"
            "}"
+           "function setDepthCodec(){"
+           "let codec=document.getElementById('depthCodecSelect').value;"
+           "fetch('/api/set_depth_codec',{method:'POST',body:'codec='+codec}).then(r=>r.json()).then(data=>{"
+           "console.log(data.message);"
+           "});"
+           "}"
+           "function setDepthResolution(){"
+           "let scale=document.getElementById('depthScaleSelect').value;"
+           "let pooling=document.getElementById('depthPoolingSelect').value;"
+           "fetch('/api/set_depth_resolution',{method:'POST',body:'scale='+scale+'&pooling='+pooling}).then(r=>r.json()).then(data=>{"
+           "console.log(data.message);"
+           "});"
+           "}"
            "function setDepthRecordingFPS(fps){"
            "document.getElementById('depthFpsValue').textContent=fps;"
            "fetch('/api/set_depth_recording_fps',{method:'POST',body:'fps='+fps}).then(r=>r.json()).then(data=>{"
@@ -1961,53 +2449,31 @@ std::string DroneWebController::generateMainPage() {
            "if(livestreamActive){startLivestream();}else{stopLivestream();}"
            "}"
            "function startLivestream(){"
-           "if(livestreamInterval)return;"
-           "document.getElementById('livestreamImage').style.display='block';"
-           "frameCount=0;"
-           "lastFrameTime=Date.now();"
-           "actualLivestreamFPS=0;"
-           "document.getElementById('actualFPS').textContent='-';"
-           "let intervalMs=Math.round(1000/livestreamFPS);"
            "let img=document.getElementById('livestreamImage');"
-           "img.onload=function(){"
-           "frameCount++;"
-           "let now=Date.now();"
-           "if(now-lastFrameTime>=1000){"
-           "actualLivestreamFPS=frameCount;"
-           "document.getElementById('actualFPS').textContent=actualLivestreamFPS+' FPS';"
-           "frameCount=0;"
-           "lastFrameTime=now;"
-           "}"
-           "};"
-           "livestreamInterval=setInterval(()=>{"
-           "img.src='/api/snapshot?t='+Date.now();"
-           "},intervalMs);"
-           "console.log('Livestream started at '+livestreamFPS+' FPS ('+intervalMs+'ms interval)');"
+           "if(img.src.indexOf('/stream.mjpg')>=0)return;"
+           "img.style.display='block';"
+           "document.getElementById('actualFPS').textContent='-';"
+           "img.src='/stream.mjpg?fps='+livestreamFPS+'&t='+Date.now();"
+           "console.log('Livestream started at '+livestreamFPS+' FPS (MJPEG)');"
            "}"
            "function stopLivestream(){"
-           "if(livestreamInterval){clearInterval(livestreamInterval);livestreamInterval=null;}"
-           "document.getElementById('livestreamImage').style.display='none';"
+           "let img=document.getElementById('livestreamImage');"
+           "img.removeAttribute('src');"
+           "img.style.display='none';"
            "document.getElementById('actualFPS').textContent='-';"
            "console.log('Livestream stopped');"
            "}"
            "function enterFullscreen(){"
-           "if(fullscreenInterval){clearInterval(fullscreenInterval);fullscreenInterval=null;}"
            "document.getElementById('fullscreenOverlay').classList.add('active');"
-           "document.getElementById('fullscreenImage').src='/api/snapshot?t='+Date.now();"
-           "let intervalMs=Math.round(1000/livestreamFPS);"
-           "fullscreenInterval=setInterval(()=>{"
-           "if(document.getElementById('fullscreenOverlay').classList.contains('active')){"
-           "document.getElementById('fullscreenImage').src='/api/snapshot?t='+Date.now();"
-           "}"
-           "},intervalMs);"
-           "console.log('Fullscreen started at '+livestreamFPS+' FPS');"
+           "document.getElementById('fullscreenImage').src='/stream.mjpg?fps='+livestreamFPS+'&t='+Date.now();"
+           "console.log('Fullscreen started at '+livestreamFPS+' FPS (MJPEG)');"
            "document.getElementById('fullscreenOverlay').onclick=function(e){"
            "if(e.target.id==='fullscreenOverlay'){exitFullscreen();}"
            "};"
            "}"
            "function exitFullscreen(){"
            "console.log('Closing fullscreen...');"
-           "if(fullscreenInterval){clearInterval(fullscreenInterval);fullscreenInterval=null;}"
+           "document.getElementById('fullscreenImage').removeAttribute('src');"
            "document.getElementById('fullscreenOverlay').classList.remove('active');"
            "document.getElementById('fullscreenOverlay').onclick=null;"
            "console.log('Fullscreen closed');"
@@ -2062,9 +2528,9 @@ std::string DroneWebController::generateMainPage() {
            "livestreamActive=false;"
            "console.log('Livestream initialized: OFF, 2 FPS default');"
            "setupFullscreenButton();"
-           "setInterval(updateStatus,1000);"
            "setInterval(updateNetworkStats,2000);"
            "updateStatus();"
+           "startStatusEvents();"
            "updateNetworkStats();"
            "console.log('UI setup complete');"
            "});"
@@ -2089,6 +2555,8 @@ std::string DroneWebController::generateMainPage() {
            "<label><input type='radio' id='modeRadioRaw' name='recMode' value='raw' onclick='setRecordingMode(\"raw\")'> RAW (Images+Depth)</label>"
            "</div>"
            "<div class='mode-info' id='modeInfo'>SVO2: Single compressed file at 30 FPS</div>"
+           "<div class='mode-info' id='storageWarning' style='display:none;color:#e74c3c'></div>"
+           "<div class='mode-info' id='usbLeft'></div>"
            "<div class='select-group' id='depthModeGroup' style='display:none'>"
            "<label>Depth Computation Mode:</label>"
            "<select id='depthModeSelect' onchange='setDepthMode()'>"
@@ -2101,6 +2569,23 @@ std::string DroneWebController::generateMainPage() {
            "<option value='none'>None (Images Only)</option>"
            "</select>"
            "<div class='mode-info'>⚠️ Changing depth mode reinitializes the camera</div>"
+           "<label>Depth File Codec:</label>"
+           "<select id='depthCodecSelect' onchange='setDepthCodec()'>"
+           "<option value='float32' selected>Float32 (exact, 3.7MB/frame)</option>"
+           "<option value='mm16'>16-bit mm (half size)</option>"
+           "<option value='mm16_zlib'>16-bit mm + compression (smallest)</option>"
+           "</select>"
+           "<label>Depth Resolution:</label>"
+           "<select id='depthScaleSelect' onchange='setDepthResolution()'>"
+           "<option value='full' selected>Full (camera resolution)</option>"
+           "<option value='half'>Half (1/4 of the data)</option>"
+           "<option value='quarter'>Quarter (1/16 of the data)</option>"
+           "</select>"
+           "<select id='depthPoolingSelect' onchange='setDepthResolution()'>"
+           "<option value='min' selected>Nearest (min) - obstacles</option>"
+           "<option value='median'>Median</option>"
+           "<option value='mean'>Mean - smooth terrain</option>"
+           "</select>"
            "</div>"
            "<div class='select-group' id='depthFpsGroup' style='display:none'>"
            "<label>Depth Recording FPS: <span id='depthFpsValue'>10</span> (0 = test mode)</label>"
@@ -2195,8 +2680,18 @@ std::string DroneWebController::generateMainPage() {
            "<div class='system-info'>"
            "<strong>USB Label:</strong> DRONE_DATA<br>"
            "<strong>Mount:</strong> /media/angelo/DRONE_DATA/<br>"
-           "<strong>Filesystem:</strong> NTFS/exFAT (recommended)"
+           "<strong>Filesystem:</strong> NTFS/exFAT (recommended)<br>"
+           "<strong>Benchmark:</strong> <span id='storageBench'>-</span>"
+           "</div>"
+           "<button onclick='runStorageBenchmark()'>⏱️ Re-run benchmark</button>"
+           "<div class='mode-info'>Measured once per USB stick; modes above its write rate are refused</div>"
            "</div>"
+           "<div class='config-section'>"
+           "<h3>📁 Recordings</h3>"
+           "<button onclick='loadRecordings()'>🔄 Refresh</button>"
+           "<div id='downloadsPaused' class='mode-info' style='display:none'>⏸️ Downloads paused while recording</div>"
+           "<div id='recordingsList' class='system-info' style='text-align:left'>-</div>"
+           "<div class='mode-info'>Downloads resume where they stopped (HTTP Range)</div>"
            "</div>"
            "<div class='config-section'>"
            "<h3>🖥️ System Control</h3>"
@@ -2261,9 +2756,169 @@ int getCameraFPSFromMode(RecordingMode mode) {
     }
 }
 
-std::string DroneWebController::generateStatusAPI() {
+void cameraSizeFromMode(RecordingMode mode, int& width, int& height) {
+    switch(mode) {
+        case RecordingMode::HD1080_30FPS: width = 1920; height = 1080; break;
+        case RecordingMode::HD2K_15FPS: width = 2208; height = 1242; break;
+        case RecordingMode::VGA_100FPS: width = 672; height = 376; break;
+        default: width = 1280; height = 720; break;     // HD720 modes
+    }
+}
+
+DroneWebController::StorageLoad DroneWebController::estimateStorageLoad() const {
+    // Per-pixel sizes from field recordings: LOSSLESS SVO2 ~13 MB/s for HD720@30 (side-by-side stereo)
+    constexpr double SVO2_BYTES_PER_PIXEL = 0.235;
+    constexpr double JPEG_BYTES_PER_PIXEL = 0.3;
+    const double MB = 1024.0 * 1024.0;
+    
+    double depth_bytes_per_pixel;
+    switch (depth_codec_.load()) {
+        case DepthCodec::UINT16_MM: depth_bytes_per_pixel = 2.0; break;
+        case DepthCodec::UINT16_MM_DELTA_ZLIB: depth_bytes_per_pixel = 0.8; break;
+        default: depth_bytes_per_pixel = 4.0; break;
+    }
+    const int depth_scale = depth_scale_.load();
+    depth_bytes_per_pixel /= depth_scale * depth_scale;    // Per camera pixel
+    
+    // RAW recorder runs HD720@30 (see startRecording) unless it was created with another mode
+    RecordingMode mode = camera_resolution_;
+    if (recording_mode_ == RecordingModeType::RAW_FRAMES) {
+        mode = raw_camera_mode_;
+    }
+    int width, height;
+    cameraSizeFromMode(mode, width, height);
+    const double pixels = static_cast<double>(width) * height;
+    const double fps = getCameraFPSFromMode(mode);
+    const double depth_fps = depth_recording_fps_.load();
+    
+    StorageLoad load;
+    switch (recording_mode_) {
+        case RecordingModeType::SVO2:
+            load.mb_per_sec = pixels * 2 * fps * SVO2_BYTES_PER_PIXEL / MB;
+            break;
+        case RecordingModeType::SVO2_DEPTH_INFO:
+            load.mb_per_sec = (pixels * 2 * fps * SVO2_BYTES_PER_PIXEL + pixels * depth_fps * depth_bytes_per_pixel) / MB;
+            break;      // Depth goes into one depth.dsf stream
+        case RecordingModeType::SVO2_DEPTH_IMAGES:
+            load.mb_per_sec = (pixels * 2 * fps * SVO2_BYTES_PER_PIXEL + pixels * depth_fps * JPEG_BYTES_PER_PIXEL) / MB;
+            load.files_per_sec = depth_fps;
+            break;
+        case RecordingModeType::RAW_FRAMES: {
+            bool with_depth = depth_mode_ != DepthMode::NONE;
+            load.mb_per_sec = fps * (pixels * 2 * JPEG_BYTES_PER_PIXEL + (with_depth ? pixels * depth_bytes_per_pixel : 0.0)) / MB;
+            bool directories = raw_storage_format_ == RawStorageFormat::DIRECTORIES;
+            load.files_per_sec = directories ? fps * (with_depth ? 3 : 2) : 0.0;
+            break;
+        }
+    }
+    return load;
+}
+
+std::string DroneWebController::recordingModeKey() const {
+    // Same camera mode choice as estimateStorageLoad()
+    RecordingMode mode = camera_resolution_;
+    if (recording_mode_ == RecordingModeType::RAW_FRAMES) {
+        mode = raw_camera_mode_;
+    }
+    int width, height;
+    cameraSizeFromMode(mode, width, height);
+    
+    std::ostringstream key;
+    key << static_cast<int>(recording_mode_.load()) << ":" << width << "x" << height << "@" << getCameraFPSFromMode(mode);
+    if (recording_mode_ != RecordingModeType::SVO2) {
+        // Depth output dominates the rate of the depth modes
+        key << ":" << static_cast<int>(depth_mode_.load()) << ":" << depth_recording_fps_.load()
+            << ":" << depth_codec::codecName(depth_codec_.load()) << ":1/" << depth_scale_.load();
+    }
+    return key.str();
+}
+
+StorageFit DroneWebController::assessStorage(const StorageLoad& load) const {
+    std::lock_guard<std::mutex> lock(benchmark_mutex_);
+    return storage_benchmark_.assess(storage_bench_, load.mb_per_sec, load.files_per_sec);
+}
+
+void DroneWebController::startStorageBenchmark(bool force) {
+    std::lock_guard<std::mutex> thread_lock(benchmark_thread_mutex_);
+    if (!storage_ || recording_active_ || benchmark_running_.exchange(true)) {
+        return;
+    }
+    if (benchmark_thread_ && benchmark_thread_->joinable()) {
+        benchmark_thread_->join();      // Previous run already finished
+    }
+    benchmark_force_ = force;
+    benchmark_cancelled_ = false;
+    std::string mount_path = storage_->getMountPath();
+    benchmark_thread_ = std::make_unique<std::thread>([this, mount_path, force]() {
+        StorageBenchmarkResult result = storage_benchmark_.run(mount_path, force);
+        if (result.valid) {
+            std::lock_guard<std::mutex> lock(benchmark_mutex_);
+            storage_bench_ = result;
+            benchmark_cancelled_ = false;   // Finished before the cancel reached it
+        }
+        benchmark_running_ = false;
+    });
+}
+
+void DroneWebController::stopStorageBenchmark() {
+    std::lock_guard<std::mutex> thread_lock(benchmark_thread_mutex_);
+    if (benchmark_running_) {
+        std::cout << "[WEB_CONTROLLER] Cancelling storage benchmark..." << std::endl;
+        benchmark_cancelled_ = true;
+        storage_benchmark_.cancel();
+    }
+    if (benchmark_thread_ && benchmark_thread_->joinable()) {
+        benchmark_thread_->join();      // Returns after the current block write
+    }
+    benchmark_thread_.reset();
+}
+
+namespace {
+
+std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string jsonFixed(double value, int precision) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    return buffer;
+}
+
+std::string jsonObject(const std::vector<std::pair<std::string, std::string>>& fields) {
+    std::string json = "{";
+    for (const auto& field : fields) {
+        if (json.size() > 1) {
+            json += ',';
+        }
+        json += "\"" + field.first + "\":" + field.second;
+    }
+    return json + "}";
+}
+
+// Status push cadence: deltas at most every PUSH_INTERVAL, a full state event every KEYFRAME_INTERVAL
+constexpr auto STATUS_PUSH_INTERVAL = std::chrono::milliseconds(250);
+constexpr auto CAMERA_SETTINGS_INTERVAL = std::chrono::milliseconds(1000);
+constexpr auto STATUS_KEYFRAME_INTERVAL = std::chrono::seconds(10);
+
+}  // namespace
+
+DroneWebController::StatusFields DroneWebController::collectStatusFields() const {
     RecordingStatus status = getStatus();
-    std::ostringstream json;
+    MjpegStats preview = mjpeg_broadcaster_ ? mjpeg_broadcaster_->getStats() : MjpegStats();
+    FlushStats flush = storage_flusher_ ? storage_flusher_->getStats() : FlushStats();
+    StorageLoad storage_load = estimateStorageLoad();
     
     // Recording mode string
     std::string mode_str;
@@ -2274,38 +2929,54 @@ std::string DroneWebController::generateStatusAPI() {
         case RecordingModeType::RAW_FRAMES: mode_str = "raw"; break;
     }
     
-    json << "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n"
-         << "{\"state\":" << static_cast<int>(status.state) << ","
-         << "\"recording_time_remaining\":" << status.recording_time_remaining << ","
-         << "\"recording_duration_total\":" << status.recording_duration_total << ","
-         << "\"bytes_written\":" << status.bytes_written << ","
-         << "\"mb_per_second\":" << std::fixed << std::setprecision(2) << status.mb_per_second << ","
-         << "\"current_file_path\":\"" << status.current_file_path << "\","
-         << "\"recording_mode\":\"" << mode_str << "\","
-         << "\"depth_mode\":\"" << status.depth_mode << "\","
-         << "\"frame_count\":" << status.frame_count << ","
-         << "\"current_fps\":" << std::fixed << std::setprecision(1) << status.current_fps << ","
-         << "\"depth_fps\":" << std::fixed << std::setprecision(1) << status.depth_fps << ","
-         << "\"camera_fps\":" << getCameraFPSFromMode(camera_resolution_) << ","
-         << "\"camera_initializing\":" << (status.camera_initializing ? "true" : "false") << ","
-         << "\"camera_exposure\":" << getCameraExposure() << ","
-         << "\"camera_gain\":" << getCameraGain() << ","
-         << "\"status_message\":\"" << status.status_message << "\","
-         << "\"error_message\":\"" << status.error_message << "\"}";
-    return json.str();
+    return {
+        {"state", std::to_string(static_cast<int>(status.state))},
+        {"recording_time_remaining", std::to_string(status.recording_time_remaining)},
+        {"recording_duration_total", std::to_string(status.recording_duration_total)},
+        {"bytes_written", std::to_string(status.bytes_written)},
+        {"mb_per_second", jsonFixed(status.mb_per_second, 2)},
+        {"current_file_path", jsonString(status.current_file_path)},
+        {"recording_mode", jsonString(mode_str)},
+        {"depth_mode", jsonString(status.depth_mode)},
+        {"frame_count", std::to_string(status.frame_count)},
+        {"current_fps", jsonFixed(status.current_fps, 1)},
+        {"depth_fps", jsonFixed(status.depth_fps, 1)},
+        {"depth_codec", jsonString(depth_codec::codecName(depth_codec_.load()))},
+        {"depth_scale", jsonString(depth_downsample::scaleName(depth_scale_.load()))},
+        {"depth_pooling", jsonString(depth_downsample::poolingName(depth_pooling_.load()))},
+        {"camera_fps", std::to_string(getCameraFPSFromMode(camera_resolution_))},
+        {"camera_initializing", status.camera_initializing ? "true" : "false"},
+        {"camera_exposure", std::to_string(camera_exposure_cached_.load())},
+        {"camera_gain", std::to_string(camera_gain_cached_.load())},
+        {"preview_clients", std::to_string(preview.clients)},
+        {"preview_fps", jsonFixed(preview.encode_fps, 1)},
+        {"last_stop_ms", jsonFixed(last_stop_timing_.load().total_ms, 0)},
+        {"flush_backlog_s", jsonFixed(flush.backlog_s, 1)},
+        {"flush_warning", flush.backlog_warning ? "true" : "false"},
+        {"storage_fit", jsonString(storageFitName(assessStorage(storage_load)))},
+        {"storage_required_mbps", jsonFixed(storage_load.mb_per_sec, 1)},
+        {"recording_seconds_left", std::to_string(status.recording_seconds_left)},
+        {"storage_free_bytes", std::to_string(time_predictor_ ? time_predictor_->getFreeBytes() : 0)},
+        {"status_message", jsonString(status.status_message)},
+        {"error_message", jsonString(status.error_message)},
+    };
 }
 
-std::string DroneWebController::generateBatteryAPI() {
+std::string DroneWebController::generateStatusAPI() {
+    // Published by statusPushLoop(); built here only before the first snapshot exists
+    std::shared_ptr<const std::string> json = std::atomic_load(&status_json_);
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n\r\n" +
+           (json ? *json : jsonObject(collectStatusFields()));
+}
+
+std::string DroneWebController::buildBatteryJSON() const {
     if (!battery_monitor_) {
-        return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: application/json\r\n\r\n"
-               "{\"error\":\"Battery monitor not available\"}";
+        return "";
     }
     
     BatteryStatus battery = getBatteryStatus();
     std::ostringstream json;
-    
-    json << "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n"
-         << "{\"voltage\":" << std::fixed << std::setprecision(3) << battery.voltage << ","
+    json << "{\"voltage\":" << std::fixed << std::setprecision(3) << battery.voltage << ","
          << "\"cell_voltage\":" << std::fixed << std::setprecision(3) << battery.cell_voltage << ","
          << "\"current\":" << std::fixed << std::setprecision(3) << battery.current << ","
          << "\"power\":" << std::fixed << std::setprecision(2) << battery.power << ","
@@ -2319,10 +2990,304 @@ std::string DroneWebController::generateBatteryAPI() {
          << "\"hardware_error\":" << (battery.hardware_error ? "true" : "false") << ","
          << "\"sample_count\":" << battery.sample_count << ","
          << "\"uptime_seconds\":" << std::fixed << std::setprecision(1) << battery.uptime_seconds << "}";
+    return json.str();
+}
+
+std::string DroneWebController::generateBatteryAPI() {
+    std::shared_ptr<const std::string> cached = std::atomic_load(&battery_json_);
+    std::string json = cached ? *cached : buildBatteryJSON();
+    if (json.empty()) {
+        return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: application/json\r\n\r\n"
+               "{\"error\":\"Battery monitor not available\"}";
+    }
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n\r\n" + json;
+}
+
+void DroneWebController::statusPushLoop() {
+    std::cout << "[WEB_CONTROLLER] Status push thread started" << std::endl;
+    StatusFields last_fields;
+    std::string last_battery;
+    auto last_camera_refresh = std::chrono::steady_clock::time_point();
+    auto last_keyframe = std::chrono::steady_clock::now();
+    auto last_battery_refresh = std::chrono::steady_clock::time_point();
+    auto last_event = std::chrono::steady_clock::now();
+    
+    while (status_push_running_) {
+        auto now = std::chrono::steady_clock::now();
+        
+        // Camera settings go into the ZED SDK - sample them here, never on a request
+        if (now - last_camera_refresh >= CAMERA_SETTINGS_INTERVAL) {
+            last_camera_refresh = now;
+            if (!camera_initializing_ && current_state_ != RecorderState::REINITIALIZING && !shutdown_requested_) {
+                camera_exposure_cached_ = getCameraExposure();
+                camera_gain_cached_ = getCameraGain();
+            }
+        }
+        
+        publishStatus();
+        StatusFields fields = collectStatusFields();
+        auto status_json = std::make_shared<const std::string>(jsonObject(fields));
+        std::atomic_store(&status_json_, status_json);
+        
+        bool have_clients = event_broadcaster_ && event_broadcaster_->getClientCount() > 0;
+        if (have_clients) {
+            if (now - last_keyframe >= STATUS_KEYFRAME_INTERVAL || last_fields.size() != fields.size()) {
+                // Full state lets clients that dropped a delta resynchronise
+                event_broadcaster_->publish("status", *status_json);
+                last_keyframe = now;
+                last_event = now;
+            } else {
+                StatusFields delta;
+                for (size_t i = 0; i < fields.size(); i++) {
+                    if (fields[i].second != last_fields[i].second) {
+                        delta.push_back(fields[i]);
+                    }
+                }
+                if (!delta.empty()) {
+                    event_broadcaster_->publish("delta", jsonObject(delta));
+                    last_event = now;
+                }
+            }
+        }
+        last_fields = std::move(fields);
+        
+        if (now - last_battery_refresh >= std::chrono::seconds(1)) {
+            last_battery_refresh = now;
+            std::string battery = buildBatteryJSON();
+            if (battery != last_battery) {
+                std::atomic_store(&battery_json_, std::make_shared<const std::string>(battery));
+                if (have_clients && !battery.empty()) {
+                    event_broadcaster_->publish("battery", battery);
+                    last_event = now;
+                }
+                last_battery = std::move(battery);
+            }
+        }
+        
+        if (have_clients && now - last_event >= std::chrono::seconds(15)) {
+            event_broadcaster_->heartbeat();
+            last_event = now;
+        }
+        
+        std::this_thread::sleep_for(STATUS_PUSH_INTERVAL);
+    }
+    
+    std::cout << "[WEB_CONTROLLER] Status push thread stopped" << std::endl;
+}
+
+void DroneWebController::stopStatusPush() {
+    status_push_running_ = false;
+    if (status_push_thread_ && status_push_thread_->joinable()) {
+        status_push_thread_->join();
+    }
+    status_push_thread_.reset();
+    if (event_broadcaster_) {
+        event_broadcaster_->closeAll();
+    }
+}
+
+std::string DroneWebController::generatePerfAPI() {
+    // Same recorder selection as getStatus(); histograms cover the current/last recording
+    LatencyReport report;
+    std::string pipeline = "none";
+    DepthWriterStats depth;     // Zeros when no depth writer is active
+    if (!camera_initializing_) {
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
+        if (recording_mode_ == RecordingModeType::RAW_FRAMES && raw_recorder_) {
+            pipeline = "raw";
+            report = raw_recorder_->getLatencyReport();
+        } else if (recording_mode_ != RecordingModeType::RAW_FRAMES && svo_recorder_) {
+            pipeline = "svo2";
+            report = svo_recorder_->getLatencyReport();
+        }
+        if (depth_data_writer_) {
+            LatencyReport depth_report = depth_data_writer_->getLatencyReport();
+            report.insert(report.end(), depth_report.begin(), depth_report.end());
+            depth = depth_data_writer_->getStats();
+        }
+    }
+    if (http_server_) {
+        LatencyReport http_report = http_server_->getLatencyReport();
+        report.insert(report.end(), http_report.begin(), http_report.end());
+    }
+    if (mjpeg_broadcaster_) {
+        LatencyReport mjpeg_report = mjpeg_broadcaster_->getLatencyReport();
+        report.insert(report.end(), mjpeg_report.begin(), mjpeg_report.end());
+    }
+    
+    std::ostringstream json;
+    json << "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n\r\n"
+         << "{\"pipeline\":\"" << pipeline << "\","
+         << "\"recording\":" << (current_state_ == RecorderState::RECORDING ? "true" : "false") << ","
+         << "\"stages\":{";
+    json << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (const auto& stage : report) {
+        const LatencySummary& s = stage.second;
+        if (s.count == 0) {
+            continue;  // Stage not used by this configuration (e.g. depth off)
+        }
+        json << (first ? "" : ",") << "\"" << stage.first << "\":{"
+             << "\"count\":" << s.count << ","
+             << "\"mean_ms\":" << s.mean_ms << ","
+             << "\"p50_ms\":" << s.p50_ms << ","
+             << "\"p95_ms\":" << s.p95_ms << ","
+             << "\"p99_ms\":" << s.p99_ms << ","
+             << "\"max_ms\":" << s.max_ms << "}";
+        first = false;
+    }
+    json << "},";
+    
+    // Where the last STOPPING -> IDLE went (0 until the first stop)
+    StopTiming stop = last_stop_timing_.load();
+    json << "\"last_stop\":{"
+         << "\"total_ms\":" << stop.total_ms << ","
+         << "\"writers_ms\":" << stop.writers_ms << ","
+         << "\"recorder_ms\":" << stop.recorder_ms << ","
+         << "\"monitor_ms\":" << stop.monitor_ms << ","
+         << "\"syncfs_ms\":" << stop.syncfs_ms << ","
+         << "\"svo_loop_exit_ms\":" << stop.svo.loop_exit_ms << ","
+         << "\"svo_finalize_ms\":" << stop.svo.finalize_ms << ","
+         << "\"svo_sensor_close_ms\":" << stop.svo.sensor_close_ms << ","
+         << "\"svo_fsync_ms\":" << stop.svo.fsync_ms << ","
+         << "\"svo_bytes\":" << stop.svo.bytes << "}";
+    
+    // Write-behind state of the recording files on the stick
+    FlushStats flush = storage_flusher_ ? storage_flusher_->getStats() : FlushStats();
+    json << ",\"flush\":{"
+         << "\"tracked_files\":" << flush.tracked_files << ","
+         << "\"pending_bytes\":" << flush.pending_bytes << ","
+         << "\"system_dirty_bytes\":" << flush.system_dirty_bytes << ","
+         << "\"writeback_mb_per_sec\":" << flush.writeback_mb_per_sec << ","
+         << "\"backlog_s\":" << flush.backlog_s << ","
+         << "\"backlog_warning\":" << (flush.backlog_warning ? "true" : "false") << ","
+         << "\"last_syncfs_ms\":" << flush.last_syncfs_ms << "}";
+    
+    // Depth capture -> write pipeline (SVO2_DEPTH_INFO; zeros when no depth writer is active)
+    json << ",\"depth_writer\":{"
+         << "\"frames_captured\":" << depth.frames_captured << ","
+         << "\"frames_written\":" << depth.frames_written << ","
+         << "\"dropped_backpressure\":" << depth.frames_dropped_backpressure << ","
+         << "\"dropped_hub\":" << depth.frames_dropped_hub << ","
+         << "\"write_errors\":" << depth.write_errors << ","
+         << "\"queue_depth\":" << depth.queue_depth << ","
+         << "\"queue_high_water\":" << depth.queue_high_water << "}}";
+    return json.str();
+}
+
+std::string DroneWebController::generateStorageAPI() {
+    StorageBenchmarkResult bench;
+    {
+        std::lock_guard<std::mutex> lock(benchmark_mutex_);
+        bench = storage_bench_;
+    }
+    StorageLoad load = estimateStorageLoad();
     
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(1)
+         << "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n\r\n"
+         << "{\"running\":" << (benchmark_running_ ? "true" : "false") << ","
+         << "\"cancelled\":" << (benchmark_cancelled_ ? "true" : "false") << ","
+         << "\"valid\":" << (bench.valid ? "true" : "false") << ","
+         << "\"uuid\":" << jsonString(bench.uuid) << ","
+         << "\"seq_write_mbps\":" << bench.seq_write_mb_per_sec << ","
+         << "\"small_files_per_sec\":" << bench.small_files_per_sec << ","
+         << "\"fsync_p50_ms\":" << bench.fsync_p50_ms << ","
+         << "\"fsync_max_ms\":" << bench.fsync_max_ms << ","
+         << "\"direct_io\":" << (bench.direct_io ? "true" : "false") << ","
+         << "\"measured_at\":" << bench.measured_at << ","
+         << "\"from_cache\":" << (bench.from_cache ? "true" : "false") << ","
+         << "\"required_mbps\":" << load.mb_per_sec << ","
+         << "\"required_files_per_sec\":" << load.files_per_sec << ","
+         << "\"fit\":" << jsonString(storageFitName(assessStorage(load))) << "}";
     return json.str();
 }
 
+std::string DroneWebController::generateRecordingsAPI() {
+    if (!recording_index_) {
+        return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: application/json\r\n\r\n"
+               "{\"error\":\"USB storage not available\"}";
+    }
+    recording_index_->refresh();
+    
+    std::string json = "{\"root\":" + jsonString(recording_index_->getRoot()) + "," +
+                       "\"downloads_paused\":" +
+                       (http_server_ && http_server_->areFileTransfersPaused() ? "true" : "false") + "," +
+                       "\"recordings\":[";
+    bool first = true;
+    for (const RecordingInfo& info : recording_index_->list()) {
+        json += (first ? "" : ",") + jsonObject({
+            {"id", jsonString(info.id)},
+            {"bytes", std::to_string(info.bytes)},
+            {"file_count", std::to_string(info.file_count)},
+            {"start_time", std::to_string(info.start_time)},
+            {"duration_s", jsonFixed(info.duration_s, 0)},
+            {"active", info.active ? "true" : "false"},
+        });
+        first = false;
+    }
+    json += "]}";
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n\r\n" + json;
+}
+
+HttpResponse DroneWebController::handleRecordingRequest(const HttpRequest& request) {
+    if (!recording_index_) {
+        return HttpResponse::make(503, "text/plain", "USB storage not available");
+    }
+    // /api/recordings/<id>/            -> file list
+    // /api/recordings/<id>/<file path> -> download (Range supported)
+    static const std::string prefix = "/api/recordings/";
+    std::string rest = request.path.substr(prefix.size());
+    size_t slash = rest.find('/');
+    std::string id = rest.substr(0, slash);
+    std::string file = (slash == std::string::npos) ? "" : rest.substr(slash + 1);
+    
+    recording_index_->refresh();
+    if (file.empty()) {
+        RecordingInfo info;
+        if (!recording_index_->find(id, info)) {
+            return HttpResponse::make(404, "application/json", "{\"error\":\"Unknown recording\"}");
+        }
+        std::string json = "{\"id\":" + jsonString(info.id) + ",\"files\":[";
+        for (size_t i = 0; i < info.files.size(); i++) {
+            json += (i ? "," : "") + jsonObject({
+                {"path", jsonString(info.files[i].path)},
+                {"bytes", std::to_string(info.files[i].bytes)},
+            });
+        }
+        json += "]}";
+        HttpResponse response = HttpResponse::make(200, "application/json", json);
+        response.setHeader("Cache-Control", "no-cache");
+        return response;
+    }
+    
+    std::string path = recording_index_->resolve(id, file);
+    if (path.empty()) {
+        return HttpResponse::make(404, "text/plain", "Not Found");
+    }
+    
+    std::string extension = fs::path(file).extension().string();
+    std::string content_type = "application/octet-stream";  // .svo/.svo2/.depth/.dfc/.slog
+    if (extension == ".csv") {
+        content_type = "text/csv";
+    } else if (extension == ".txt" || extension == ".log") {
+        content_type = "text/plain";
+    } else if (extension == ".json") {
+        content_type = "application/json";
+    } else if (extension == ".jpg" || extension == ".jpeg") {
+        content_type = "image/jpeg";
+    } else if (extension == ".png") {
+        content_type = "image/png";
+    }
+    
+    HttpResponse response = HttpResponse::makeFile(request, path, content_type);
+    if (response.file) {
+        std::string name = fs::path(file).filename().string();
+        response.setHeader("Content-Disposition", "attachment; filename=\"" + id + "_" + name + "\"");
+    }
+    return response;
+}
+
 BatteryStatus DroneWebController::getBatteryStatus() const {
     if (battery_monitor_) {
         return battery_monitor_->getStatus();
@@ -2355,102 +3320,72 @@ std::string DroneWebController::generateSnapshotJPEG() {
         return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n\r\nCamera reinitializing";
     }
     
+    // The recorder cannot be swapped until the subscription exists (closed by the hub when it goes away)
+    std::shared_lock<std::shared_mutex> recorder_lock(recorder_mutex_);
+    
     // Check if camera is available
     if (!svo_recorder_ && !raw_recorder_) {
         std::cerr << "[WEB_CONTROLLER] No camera available for snapshot" << std::endl;
         return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n\r\nCamera not initialized";
     }
     
-    sl::Camera* camera = nullptr;
+    CaptureHub* hub = nullptr;
     if (svo_recorder_) {
-        camera = svo_recorder_->getCamera();
+        hub = svo_recorder_->getCaptureHub();
     } else if (raw_recorder_) {
-        camera = raw_recorder_->getCamera();
+        hub = raw_recorder_->getCaptureHub();
     }
     
-    if (!camera || !camera->isOpened()) {
+    if (!hub) {
         std::cerr << "[WEB_CONTROLLER] Camera not opened for snapshot" << std::endl;
         return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n\r\nCamera not open";
     }
     
-    // Double-check shutdown flag before camera grab (race condition protection)
+    // Double-check shutdown flag before touching the hub (race condition protection)
     if (shutdown_requested_) {
         std::cout << "[WEB_CONTROLLER] Snapshot aborted - shutdown detected" << std::endl;
         return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n\r\nServer shutting down";
     }
     
-    // Bug #5 Fix: Smart frame caching to prevent blocking at high FPS
-    // Check if cached frame is fresh enough (< 50ms old)
-    auto now = std::chrono::steady_clock::now();
-    bool use_cached_frame = false;
-    
+    // Bug #5 Fix: Never grab on the web thread. The hub publishes every frame the
+    // recorder grabs (or grabs itself while idle) into a single-slot mailbox, so a
+    // snapshot costs at most one frame period and never competes with recording.
+    std::shared_ptr<FrameSubscription> subscription;
     {
-        std::lock_guard<std::mutex> lock(frame_cache_mutex_);
-        if (frame_cache_valid_) {
-            auto frame_age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - cached_frame_time_).count();
-            
-            // At 60 FPS, frames arrive every ~16.7ms
-            // At 100 FPS, frames arrive every 10ms
-            // Cache is valid if < 50ms old (accommodates 2-3 frames at high FPS)
-            if (frame_age_ms < 50) {
-                use_cached_frame = true;
-                std::cout << "[WEB_CONTROLLER] Using cached frame (age: " << frame_age_ms << "ms) - prevents blocking" << std::endl;
-            }
+        std::lock_guard<std::mutex> lock(preview_mutex_);
+        if (!preview_subscription_ || preview_subscription_->isClosed()) {
+            SubscriberConfig config;
+            config.name = "preview";
+            config.image = true;
+            config.mailbox = MailboxType::LATEST;
+            preview_subscription_ = hub->subscribe(config);
         }
+        subscription = preview_subscription_;
     }
+    recorder_lock.unlock();
     
-    sl::Mat frame_to_encode;
+    CapturedFramePtr frame;
+    if (!subscription->waitFrame(frame, std::chrono::milliseconds(200))) {
+        // No newer frame in time (e.g. low FPS) - reuse the last one
+        frame = subscription->latest();
+    }
+    if (!frame || !frame->image) {
+        return "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n\r\nNo frame available yet";
+    }
+    if (frame->corrupted) {
+        // CORRUPTED_FRAME is common with dark images or covered lens - serve it anyway (ZED Explorer does the same)
+        std::cout << "[WEB_CONTROLLER] Warning: Frame may be corrupted (dark image or covered lens), continuing anyway..." << std::endl;
+    }
     
-    if (!use_cached_frame) {
-        // Need fresh frame - grab from camera
-        // NOTE: This can block for up to 1 frame period (16.7ms @ 60fps, 10ms @ 100fps)
-        sl::ERROR_CODE err = camera->grab();
-        if (err != sl::ERROR_CODE::SUCCESS) {
-            // CORRUPTED_FRAME is common with dark images or covered lens - treat as warning, not error
-            if (err == sl::ERROR_CODE::CORRUPTED_FRAME) {
-                std::cout << "[WEB_CONTROLLER] Warning: Frame may be corrupted (dark image or covered lens), continuing anyway..." << std::endl;
-                // Continue to retrieve image - it will be dark/corrupted but better than no image
-            } else {
-                std::cerr << "[WEB_CONTROLLER] Failed to grab frame: " << toString(err) << std::endl;
-                return "HTTP/1.1 500 Internal Server Error\r\nContent-Type: text/plain\r\n\r\nFailed to grab frame";
-            }
-        }
-        
-        // Retrieve left image (even if frame was corrupted - ZED Explorer does the same)
-        sl::Mat zed_image;
-        err = camera->retrieveImage(zed_image, sl::VIEW::LEFT);
-        if (err != sl::ERROR_CODE::SUCCESS) {
-            std::cerr << "[WEB_CONTROLLER] Failed to retrieve image: " << toString(err) << std::endl;
-            return "HTTP/1.1 500 Internal Server Error\r\nContent-Type: text/plain\r\n\r\nFailed to retrieve image";
-        }
-        
-        // Update cache with fresh frame
-        {
-            std::lock_guard<std::mutex> lock(frame_cache_mutex_);
-            // ZED SDK clone() requires destination Mat parameter
-            zed_image.clone(cached_livestream_frame_);  // Deep copy for thread safety
-            cached_frame_time_ = now;
-            frame_cache_valid_ = true;
-        }
-        
-        frame_to_encode = zed_image;
-    } else {
-        // Use cached frame
-        std::lock_guard<std::mutex> lock(frame_cache_mutex_);
-        // ZED SDK clone() requires destination Mat parameter
-        cached_livestream_frame_.clone(frame_to_encode);  // Clone for thread safety
-    }
-    
-    // Convert ZED Mat to OpenCV Mat
-    cv::Mat cv_image(frame_to_encode.getHeight(), frame_to_encode.getWidth(), CV_8UC4, frame_to_encode.getPtr<sl::uchar1>(sl::MEM::CPU));
-    cv::Mat cv_image_rgb;
-    cv::cvtColor(cv_image, cv_image_rgb, cv::COLOR_BGRA2BGR);
-    
-    // Encode to JPEG (quality 85 for good balance)
-    std::vector<uchar> jpeg_buffer;
-    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, 85};
-    if (!cv::imencode(".jpg", cv_image_rgb, jpeg_buffer, params)) {
-        std::cerr << "[WEB_CONTROLLER] Failed to encode JPEG" << std::endl;
+    const sl::Mat& frame_to_encode = *frame->image;
+    
+    // Encode the BGRA frame directly (quality 85 for good balance) - no cvtColor copy
+    thread_local JpegEncoder snapshot_encoder(85);
+    if (!snapshot_encoder.encodeBGRA(frame_to_encode.getPtr<sl::uchar1>(sl::MEM::CPU),
+                                     static_cast<int>(frame_to_encode.getWidth()),
+                                     static_cast<int>(frame_to_encode.getHeight()),
+                                     frame_to_encode.getStepBytes(sl::MEM::CPU))) {
+        std::cerr << "[WEB_CONTROLLER] Failed to encode JPEG: " << snapshot_encoder.getLastError() << std::endl;
         return "HTTP/1.1 500 Internal Server Error\r\nContent-Type: text/plain\r\n\r\nFailed to encode JPEG";
     }
     
@@ -2458,7 +3393,7 @@ std::string DroneWebController::generateSnapshotJPEG() {
     std::ostringstream response;
     response << "HTTP/1.1 200 OK\r\n"
              << "Content-Type: image/jpeg\r\n"
-             << "Content-Length: " << jpeg_buffer.size() << "\r\n"
+             << "Content-Length: " << snapshot_encoder.size() << "\r\n"
              << "Cache-Control: no-cache, no-store, must-revalidate\r\n"
              << "Pragma: no-cache\r\n"
              << "Expires: 0\r\n"
@@ -2466,7 +3401,7 @@ std::string DroneWebController::generateSnapshotJPEG() {
     
     // Append binary JPEG data
     std::string response_str = response.str();
-    response_str.append(reinterpret_cast<const char*>(jpeg_buffer.data()), jpeg_buffer.size());
+    response_str.append(reinterpret_cast<const char*>(snapshot_encoder.data()), snapshot_encoder.size());
     
     return response_str;
 }
@@ -2490,19 +3425,28 @@ void DroneWebController::handleShutdown() {
     // This prevents race conditions with camera closure
     web_server_running_ = false;
     
-    // Close server socket to unblock accept() and force server thread to exit
-    int fd = server_fd_.load();
-    if (fd >= 0) {
+    // Wake the reactor: it closes the listen socket and all client connections
+    if (http_server_) {
         std::cout << "[WEB_CONTROLLER] Closing web server socket..." << std::endl;
-        shutdown(fd, SHUT_RDWR);  // Shutdown both directions
-        close(fd);
-        server_fd_ = -1;
+        http_server_->requestStop();
+    }
+    
+    // Preview and status threads must not touch the recorders once they start closing
+    stopStatusPush();
+    if (mjpeg_broadcaster_) {
+        mjpeg_broadcaster_->stop();
     }
     
-    // CRITICAL: DON'T join web server thread here - might be called FROM web server thread!
-    // Thread will exit naturally when it detects web_server_running_ == false and socket closed
+    // CRITICAL: DON'T join web server threads here - might be called FROM a handler thread!
     // Main thread cleanup (destructor) will handle final join after this function returns
-    std::cout << "[WEB_CONTROLLER] ✓ Web server shutdown signal sent (thread will exit naturally)" << std::endl;
+    std::cout << "[WEB_CONTROLLER] ✓ Web server shutdown signal sent (threads will exit naturally)" << std::endl;
+    
+    // A control request already running (e.g. a camera reinit) finishes first; later ones see shutdown_requested_
+    std::lock_guard<std::mutex> control_lock(control_mutex_);
+    
+    // Let a stop requested from the GUI/timer finish before deciding what is left to do
+    stopStopWorker();
+    stopStorageBenchmark();
     
     // STEP 3: Stop any active recording with FULL cleanup (critical for data integrity)
     // NOTE: If recording was already stopped by main.cpp before system shutdown, this is a no-op
@@ -2539,25 +3483,30 @@ void DroneWebController::handleShutdown() {
                       << (max_wait * 100) << "ms - proceeding anyway" << std::endl;
         }
         
-        // Additional filesystem sync to ensure USB buffers are flushed
-        std::cout << "[WEB_CONTROLLER] Performing filesystem sync..." << std::endl;
-        sync();  // Force kernel to flush all filesystem buffers
-        std::cout << "[WEB_CONTROLLER] ✓ Filesystem sync complete" << std::endl;
+        // stopRecording() already ran syncfs() on the stick; flush once more only if it did not complete
+        if (!recording_stop_complete_ && storage_flusher_) {
+            std::cout << "[WEB_CONTROLLER] Flushing USB storage..." << std::endl;
+            storage_flusher_->syncMount();
+        }
         
     } else {
         std::cout << "[WEB_CONTROLLER] No active recording to stop (already stopped or never started)" << std::endl;
     }
     
+    if (storage_flusher_) {
+        storage_flusher_->stop();
+    }
+    
     // STEP 4: Close ZED cameras (safe now - no snapshot requests can arrive)
     std::cout << "[ZED] Closing camera explicitly..." << std::endl;
     if (svo_recorder_) {
         std::cout << "[ZED] Closing ZED camera..." << std::endl;
-        svo_recorder_->close();
+        closeSvoRecorder();
         std::cout << "[ZED] ✓ SVO recorder closed" << std::endl;
     }
     if (raw_recorder_) {
         std::cout << "[ZED] Closing RAW recorder..." << std::endl;
-        raw_recorder_->close();
+        closeRawRecorder();
         std::cout << "[ZED] ✓ RAW recorder closed" << std::endl;
     }
     
@@ -2593,64 +3542,89 @@ void DroneWebController::depthVisualizationLoop() {
     int target_fps = depth_recording_fps_.load();
     std::cout << "[DEPTH_VIZ] Depth visualization thread started (target " << target_fps << " FPS)" << std::endl;
     
-    sl::Mat depth_map;
+    CaptureHub* hub = nullptr;
+    {
+        // The recorder stays until stopRecording() has joined this thread
+        std::shared_lock<std::shared_mutex> lock(recorder_mutex_);
+        hub = svo_recorder_ ? svo_recorder_->getCaptureHub() : nullptr;
+    }
+    if (!hub) {
+        std::cerr << "[DEPTH_VIZ] No capture hub available" << std::endl;
+        return;
+    }
+    
+    // Depth of every n-th recording frame - file names carry the exact SVO2 frame number
+    SubscriberConfig config;
+    config.name = "depth_viz";
+    config.depth = true;
+    config.recording_only = true;
+    config.mailbox = MailboxType::LATEST;
+    std::shared_ptr<FrameSubscription> subscription = hub->subscribe(config);
+    
+    int source_fps = hub->getSourceFPS();
     int frame_count = 0;
     auto start_time = std::chrono::steady_clock::now();
     
     std::string depth_dir = storage_->getRecordingDir() + "/depth_viz";
     
+    CapturedFramePtr frame;
     while (depth_viz_running_ && recording_active_) {
         // Get current target FPS (in case it changed during recording)
         target_fps = depth_recording_fps_.load();
+        int divisor = (target_fps > 0 && source_fps > target_fps)
+                          ? static_cast<int>(std::lround(static_cast<double>(source_fps) / target_fps)) : 1;
+        subscription->setRateDivisor(divisor);
         
-        // Get latest depth map from recorder
-        if (svo_recorder_ && svo_recorder_->getLatestDepthMap(depth_map)) {
-            
-            // Only save if FPS > 0 (FPS=0 is test mode: compute but don't save)
-            if (target_fps > 0) {
-                // Get current frame number from SVO2 recorder for synchronized naming
-                int current_frame = svo_recorder_->getCurrentFrameNumber();
-                
-                // Convert ZED depth map to OpenCV format
-                cv::Mat depth_ocv(depth_map.getHeight(), depth_map.getWidth(), CV_32FC1, depth_map.getPtr<sl::float1>(sl::MEM::CPU));
-                
-                // Normalize depth to 0-255 (0-10 meters range)
-                cv::Mat depth_normalized;
-                depth_ocv.convertTo(depth_normalized, CV_8UC1, 255.0 / 10.0);  // 10m max range
-                
-                // Apply colormap (JET colormap: blue=close, red=far)
-                cv::Mat depth_colored;
-                cv::applyColorMap(depth_normalized, depth_colored, cv::COLORMAP_JET);
-                
-                // Save with zero-padded frame number (4 digits: 0001, 0002, ... 0005, ...)
-                // This matches the SVO2 frame numbering for synchronized extraction
-                char filename_buffer[256];
-                snprintf(filename_buffer, sizeof(filename_buffer), "%s/depth_%04d.jpg", 
-                         depth_dir.c_str(), current_frame);
-                std::string filename(filename_buffer);
-                
-                cv::imwrite(filename, depth_colored, {cv::IMWRITE_JPEG_QUALITY, 90});
-                
-                frame_count++;
-                
-                // Log progress every 30 frames
-                if (frame_count % 30 == 0) {
-                    auto now = std::chrono::steady_clock::now();
-                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
-                    float fps = (elapsed > 0) ? (float)frame_count / elapsed : 0;
-                    std::cout << "[DEPTH_VIZ] Saved " << frame_count << " depth images (" 
-                              << fps << " FPS, last frame: " << current_frame << ")" << std::endl;
-                }
+        if (!subscription->waitFrame(frame, std::chrono::milliseconds(200))) {
+            if (subscription->isClosed()) {
+                break;
             }
+            continue;
         }
         
-        // Dynamic sleep based on target FPS
-        // FPS=0: Sleep 1 second (test mode, no saving)
-        // FPS>0: Sleep according to target frame interval
-        int sleep_ms = (target_fps > 0) ? (1000 / target_fps) : 1000;
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        // Only save if FPS > 0 (FPS=0 is test mode: compute but don't save)
+        if (target_fps > 0 && frame->depth) {
+            const sl::Mat& depth_map = *frame->depth;
+            int current_frame = static_cast<int>(frame->frame_number);
+            
+            // Convert ZED depth map to OpenCV format
+            cv::Mat depth_ocv(depth_map.getHeight(), depth_map.getWidth(), CV_32FC1,
+                              depth_map.getPtr<sl::float1>(sl::MEM::CPU), depth_map.getStepBytes(sl::MEM::CPU));
+            
+            // Normalize depth to 0-255 (0-10 meters range)
+            cv::Mat depth_normalized;
+            depth_ocv.convertTo(depth_normalized, CV_8UC1, 255.0 / 10.0);  // 10m max range
+            
+            // Apply colormap (JET colormap: blue=close, red=far)
+            cv::Mat depth_colored;
+            cv::applyColorMap(depth_normalized, depth_colored, cv::COLORMAP_JET);
+            
+            // Save with zero-padded frame number (4 digits: 0001, 0002, ... 0005, ...)
+            // This matches the SVO2 frame numbering for synchronized extraction
+            char filename_buffer[256];
+            snprintf(filename_buffer, sizeof(filename_buffer), "%s/depth_%04d.jpg", 
+                     depth_dir.c_str(), current_frame);
+            std::string filename(filename_buffer);
+            
+            cv::imwrite(filename, depth_colored, {cv::IMWRITE_JPEG_QUALITY, 90});
+            
+            frame_count++;
+            
+            // Log progress every 30 frames
+            if (frame_count % 30 == 0) {
+                auto now = std::chrono::steady_clock::now();
+                auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+                float fps = (elapsed > 0) ? (float)frame_count / elapsed : 0;
+                std::cout << "[DEPTH_VIZ] Saved " << frame_count << " depth images (" 
+                          << fps << " FPS, last frame: " << current_frame << ")" << std::endl;
+            }
+        }
+        frame.reset();  // Return the depth buffer to the hub pool
     }
     
+    if (!subscription->isClosed()) {
+        hub->unsubscribe(subscription);
+    }
     std::cout << "[DEPTH_VIZ] Depth visualization thread stopped. Total frames saved: " << frame_count << std::endl;
 }
 
@@ -4,13 +4,26 @@
 #include <atomic>
 #include <memory>
 #include <functional>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include "zed_recorder.h"
 #include "raw_frame_recorder.h"
 #include "depth_data_writer.h"
 #include "storage.h"
+#include "recording_index.h"
+#include "storage_flusher.h"
+#include "storage_benchmark.h"
+#include "recording_time_predictor.h"
 #include "lcd_handler.h"
 #include "safe_hotspot_manager.h"
 #include "battery_monitor.h"
+#include "http_server.h"
+#include "seqlock.h"
+#include "mjpeg_broadcaster.h"
+#include "event_broadcaster.h"
+#include "static_asset.h"
 
 enum class RecorderState {
     IDLE,
@@ -33,6 +46,7 @@ struct RecordingStatus {
     int recording_duration_total;
     long bytes_written;
     double mb_per_second;
+    int recording_seconds_left;  // Free space / bitrate of the selected mode (-1 = unknown)
     std::string current_file_path;
     std::string error_message;
     
@@ -55,7 +69,8 @@ public:
     
     // Control methods
     bool startRecording();
-    bool stopRecording();
+    bool stopRecording();           // Blocks until the recording is finalized and the state is IDLE
+    bool requestStopRecording();    // Hands the stop to the stop worker and returns immediately
     bool shutdownSystem();
     
     // Recording mode configuration
@@ -74,7 +89,7 @@ public:
     std::string exposureToShutterSpeed(int exposure, int fps);  // Convert exposure to "1/X" notation
     
     // Status methods
-    RecordingStatus getStatus() const;
+    RecordingStatus getStatus() const;   // Last published snapshot: no locks, no recorder/SDK calls
     bool isRecording() const { return current_state_ == RecorderState::RECORDING; }
     bool isRecordingStopComplete() const { return recording_stop_complete_; }
     bool isShutdownRequested() const { return shutdown_requested_.load(); }
@@ -95,9 +110,6 @@ public:
     void startWebServer(int port = 8080);
     void stopWebServer();
     
-    // HTTP request handling
-    void handleClientRequest(int client_socket);
-    
     // LCD display updates
     void updateLCD(const std::string& line1, const std::string& line2 = "");
     
@@ -110,27 +122,52 @@ private:
     std::unique_ptr<ZEDRecorder> svo_recorder_;
     std::unique_ptr<RawFrameRecorder> raw_recorder_;
     std::unique_ptr<DepthDataWriter> depth_data_writer_;  // For SVO2_DEPTH_INFO mode
+    // The three pointers above change only under an exclusive lock (control requests; the stop path for
+    // depth_data_writer_). Status, preview, snapshot, perf and stop threads use them under a shared lock.
+    mutable std::shared_mutex recorder_mutex_;
     std::unique_ptr<StorageHandler> storage_;
+    std::unique_ptr<RecordingIndex> recording_index_;      // Flight directories on the USB stick (/api/recordings)
+    std::unique_ptr<StorageFlusher> storage_flusher_;      // Write-behind while recording, syncfs() of the stick at stop
+    
+    // USB qualification: measured once per filesystem UUID, gates startRecording()
+    StorageBenchmark storage_benchmark_;
+    std::unique_ptr<std::thread> benchmark_thread_;
+    std::atomic<bool> benchmark_running_{false};
+    std::atomic<bool> benchmark_force_{false};              // force flag of the current/last run
+    std::atomic<bool> benchmark_cancelled_{false};          // Cancelled without a result: systemMonitorLoop retries when idle
+    std::mutex benchmark_thread_mutex_;                     // benchmark_thread_ start/cancel/join
+    mutable std::mutex benchmark_mutex_;
+    StorageBenchmarkResult storage_bench_;                  // Guarded by benchmark_mutex_
+    std::unique_ptr<RecordingTimePredictor> time_predictor_;  // Recording time left on the stick, early stop before ENOSPC
     std::unique_ptr<LCDHandler> lcd_;
     std::unique_ptr<BatteryMonitor> battery_monitor_;
     
     // Network management - SAFE implementation (complies with NETWORK_SAFETY_POLICY.md)
     std::unique_ptr<SafeHotspotManager> hotspot_manager_;
     
-    // Recording mode configuration
-    RecordingModeType recording_mode_{RecordingModeType::SVO2};
-    DepthMode depth_mode_{DepthMode::NEURAL_PLUS};  // Default to best quality depth (auto-switched to NONE for SVO2 only)
-    RecordingMode camera_resolution_{RecordingMode::HD720_60FPS};  // Default camera resolution/FPS
+    // Recording mode configuration (written by control requests, read by the status/monitor threads)
+    std::atomic<RecordingModeType> recording_mode_{RecordingModeType::SVO2};
+    std::atomic<DepthMode> depth_mode_{DepthMode::NEURAL_PLUS};  // Default to best quality depth (auto-switched to NONE for SVO2 only)
+    std::atomic<RecordingMode> camera_resolution_{RecordingMode::HD720_60FPS};  // Default camera resolution/FPS
+    // Of the live RAW recorder, cached on every swap so the status path never calls into a recorder
+    std::atomic<RecordingMode> raw_camera_mode_{RecordingMode::HD720_30FPS};
+    std::atomic<RawStorageFormat> raw_storage_format_{RawStorageFormat::CONTAINER};
     std::atomic<int> depth_recording_fps_{10};  // FPS for depth visualization saving (0 = disabled)
+    std::atomic<DepthCodec> depth_codec_{DepthCodec::FLOAT32};  // Depth file codec (SVO2_DEPTH_INFO + RAW_FRAMES)
+    std::atomic<int> depth_scale_{1};  // Stored depth resolution divisor 1/2/4 (SVO2_DEPTH_INFO + RAW_FRAMES)
+    std::atomic<DepthPooling> depth_pooling_{DepthPooling::MIN};  // Block reduction when depth_scale_ > 1
     
     // State management
     std::atomic<RecorderState> current_state_{RecorderState::IDLE};
     std::atomic<bool> recording_active_{false};
     std::atomic<bool> recording_stop_complete_{true};  // Flag: stopRecording() fully completed (true when idle)
-    std::atomic<bool> timer_expired_{false};  // Flag: recording timer reached duration
     std::atomic<bool> hotspot_active_{false};
     std::atomic<bool> web_server_running_{false};
-    std::atomic<bool> camera_initializing_{false};
+    std::atomic<bool> camera_initializing_{false};  // Claimed with compare_exchange by the reinit paths
+    
+    // Control requests (start/stop, mode/depth/resolution changes, ...) run one at a time:
+    // the handler pool has several threads and these handlers reinitialise the camera
+    std::mutex control_mutex_;
     
     // Status message for UI feedback
     std::string status_message_;
@@ -146,29 +183,85 @@ private:
     int lcd_display_cycle_{0};  // Alternates between different recording info displays
     std::chrono::steady_clock::time_point last_lcd_update_;
     
-    // Bug #5 Fix: Frame caching for non-blocking livestream at high FPS
-    sl::Mat cached_livestream_frame_;                           // Last grabbed frame
-    std::chrono::steady_clock::time_point cached_frame_time_;   // Timestamp of cached frame
-    std::mutex frame_cache_mutex_;                              // Protect cache access
-    bool frame_cache_valid_{false};                             // Cache contains valid data
+    // Livestream preview: latest frame from the recorder's CaptureHub (no grab on the web thread)
+    std::shared_ptr<FrameSubscription> preview_subscription_;   // Re-created after camera reinit
+    std::mutex preview_mutex_;                                  // Protect subscription swap
     
     // Background tasks
     std::unique_ptr<std::thread> recording_monitor_thread_;
-    std::unique_ptr<std::thread> web_server_thread_;
     std::unique_ptr<std::thread> system_monitor_thread_;
     std::unique_ptr<std::thread> depth_viz_thread_;
     std::atomic<bool> depth_viz_running_{false};
     
-    // Web server
-    std::atomic<int> server_fd_{-1};  // Server socket file descriptor for clean shutdown
+    // Web server (epoll reactor + handler pool, see http_server.h)
+    std::unique_ptr<HttpServer> http_server_;
+    std::unique_ptr<MjpegBroadcaster> mjpeg_broadcaster_;      // GET /stream.mjpg (encode once, push to all clients)
+    std::unique_ptr<EventBroadcaster> event_broadcaster_;      // GET /api/events (SSE status push)
+    StaticAsset main_page_;                                     // GET / (built once: gzip + ETag)
+    
+    // Status push: one thread samples status/battery/camera settings and publishes
+    // immutable JSON snapshots; request handlers only load a pointer (std::atomic_load)
+    std::unique_ptr<std::thread> status_push_thread_;
+    std::atomic<bool> status_push_running_{false};
+    std::shared_ptr<const std::string> status_json_;           // Body of /api/status
+    std::shared_ptr<const std::string> battery_json_;          // Body of /api/battery (empty: no monitor)
+    std::atomic<int> camera_exposure_cached_{-1};              // Refreshed off the request path (SDK call)
+    std::atomic<int> camera_gain_cached_{-1};
+    
+    // RecordingStatus in trivially copyable form for the seqlock (strings truncated)
+    struct StatusSnapshot {
+        RecorderState state{RecorderState::IDLE};
+        RecordingModeType recording_mode{RecordingModeType::SVO2};
+        int recording_time_remaining{0};
+        int recording_duration_total{0};
+        long bytes_written{0};
+        double mb_per_second{0.0};
+        int recording_seconds_left{-1};
+        long frame_count{0};
+        float current_fps{0.0f};
+        float depth_fps{0.0f};
+        bool camera_initializing{false};
+        char depth_mode[32]{};
+        char current_file_path[160]{};
+        char status_message[160]{};
+        char error_message[96]{};
+    };
+    // Written by publishStatus() (status push thread, recording monitor, state changes), read by getStatus()
+    Seqlock<StatusSnapshot> status_snapshot_;
+    std::mutex publish_mutex_;          // Sample + store as one step: an older sample never replaces a newer one
 
+    // Stop pipeline: requestStopRecording() wakes stop_worker_thread_, which runs stopRecording()
+    struct StopTiming {
+        double writers_ms{0.0};         // DepthDataWriter + depth visualisation joined
+        double recorder_ms{0.0};        // ZEDRecorder / RawFrameRecorder stopRecording()
+        double monitor_ms{0.0};         // Recording monitor joined
+        double syncfs_ms{0.0};          // syncfs() of the USB mount (StorageFlusher)
+        double total_ms{0.0};           // STOPPING -> IDLE
+        RecordingStopTiming svo;        // Breakdown of recorder_ms (SVO2 modes only)
+    };
+    std::unique_ptr<std::thread> stop_worker_thread_;
+    std::mutex stop_mutex_;                         // Serialises stopRecording() callers
+    std::mutex stop_request_mutex_;
+    std::condition_variable stop_request_cv_;
+    bool stop_requested_{false};                    // Guarded by stop_request_mutex_
+    bool stop_worker_exit_{false};                  // Guarded by stop_request_mutex_
+    Seqlock<StopTiming> last_stop_timing_;          // Published at the end of every stop
+    
     // Critical battery debounce counter (require multiple consecutive critical reads)
     int critical_battery_counter_{0};
     const int critical_battery_threshold_{10};
     
     // Private methods
+    // Recorder swaps (control requests): pointer changes under the exclusive recorder_mutex_,
+    // close() and init() outside it so status/preview threads never wait for the camera
+    void releasePreview();
+    void closeSvoRecorder();
+    void closeRawRecorder();
+    void adoptSvoRecorder(std::unique_ptr<ZEDRecorder> recorder);
+    void adoptRawRecorder(std::unique_ptr<RawFrameRecorder> recorder);
     void recordingMonitorLoop();
-    void webServerLoop(int port);
+    void stopWorkerLoop();
+    void stopStopWorker();
     void systemMonitorLoop();
     void depthVisualizationLoop();  // New: Depth visualization thread
     bool setupWiFiHotspot();
@@ -176,14 +269,36 @@ private:
     bool verifyHotspotActive();     // Verify NetworkManager hotspot is running
     void displayWiFiStatus();       // Display WiFi connection info
     void updateRecordingStatus();
+    void statusPushLoop();
+    void publishStatus();                // Sample recorder/state and publish one consistent snapshot
+    RecordingStatus sampleStatus() const;
+    void stopStatusPush();
+    using StatusFields = std::vector<std::pair<std::string, std::string>>;  // JSON key -> serialised value
+    StatusFields collectStatusFields() const;
+    std::string buildBatteryJSON() const;
+    struct StorageLoad {
+        double mb_per_sec{0.0};
+        double files_per_sec{0.0};      // One-file-per-frame layouts only
+    };
+    StorageLoad estimateStorageLoad() const;     // Expected write load of the selected mode/resolution
+    StorageFit assessStorage(const StorageLoad& load) const;
+    std::string recordingModeKey() const;        // Predictor key: recording mode + resolution
+    void startStorageBenchmark(bool force);      // Runs on benchmark_thread_ (cached result unless force)
+    void stopStorageBenchmark();                 // Cancel a running benchmark and join
     std::string getDepthModeShortName(DepthMode mode) const;
     std::string getDepthModeName(DepthMode mode) const;
     sl::DEPTH_MODE convertDepthMode(DepthMode mode) const;
     
     // Web server helper methods
-    std::string generateMainPage();
+    void registerWebRoutes(HttpServer& server);
+    std::string handleControlRequest(const HttpRequest& request);  // POST /api/* (runs on a handler thread)
+    std::string generateMainPage();      // UI HTML, cached in main_page_
     std::string generateStatusAPI();
     std::string generateBatteryAPI();
+    std::string generatePerfAPI();       // Per-stage latency percentiles of the active pipeline
+    std::string generateStorageAPI();                               // GET /api/storage
+    std::string generateRecordingsAPI();                            // GET /api/recordings
+    HttpResponse handleRecordingRequest(const HttpRequest& request); // GET /api/recordings/<id>/[<file>]
     std::string generateSnapshotJPEG();  // JPEG snapshot from ZED camera
     std::string generateAPIResponse(const std::string& message);
     
@@ -62,9 +62,7 @@ int main() {
             std::cout << "[MAIN] ⚠ Warning: Recording stop timeout after 10s" << std::endl;
         }
         
-        // Final filesystem sync
-        sync();
-        std::cout << "[MAIN] ✓ Filesystem synced" << std::endl;
+        // No global sync(): stopRecording() already ran syncfs() on the USB stick
     }
     
     std::cout << "[MAIN] Performing cleanup..." << std::endl;
@@ -55,7 +55,7 @@ bool testRecordingMode(RecordingMode mode, LCDHandler& lcd, StorageHandler& stor
     }
     
     std::string video_path = test_dir + "/video.svo2";
-    std::string sensor_path = test_dir + "/sensors.csv";
+    std::string sensor_path = test_dir + "/sensors.slog";
     
     if (!recorder.startRecording(video_path, sensor_path)) {
         std::cerr << "Failed to start recording for mode: " << recorder.getModeName(mode) << std::endl;
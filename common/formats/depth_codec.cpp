@@ -0,0 +1,343 @@
+#include "depth_codec.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+inline uint16_t toMillimetres(float depth) {
+    if (std::isnan(depth)) {
+        return depth_codec::MM_NAN;
+    }
+    if (std::isinf(depth)) {
+        return depth > 0.0f ? depth_codec::MM_POS_INF : depth_codec::MM_NEG_INF;
+    }
+    float mm = depth * 1000.0f + 0.5f;
+    if (mm < 1.0f) {
+        return 1;
+    }
+    if (mm > static_cast<float>(depth_codec::MM_MAX)) {
+        return depth_codec::MM_MAX;
+    }
+    return static_cast<uint16_t>(mm);
+}
+
+inline float fromMillimetres(uint16_t mm) {
+    switch (mm) {
+        case depth_codec::MM_NAN: return std::numeric_limits<float>::quiet_NaN();
+        case depth_codec::MM_NEG_INF: return -std::numeric_limits<float>::infinity();
+        case depth_codec::MM_POS_INF: return std::numeric_limits<float>::infinity();
+        default: return mm * 0.001f;
+    }
+}
+
+// Gradient predictor (left + up - upleft); first row of a strip uses the left neighbour only,
+// so strips decode independently. Arithmetic is modulo 2^16, i.e. exactly invertible.
+inline uint16_t predict(const uint16_t* row, const uint16_t* up, int x) {
+    if (x == 0) {
+        return up ? up[0] : 0;
+    }
+    if (!up) {
+        return row[x - 1];
+    }
+    return static_cast<uint16_t>(row[x - 1] + up[x] - up[x - 1]);
+}
+
+inline uint16_t zigzag(uint16_t diff) {
+    // Shift the unsigned value: s << 1 is undefined for negative s before C++20
+    int16_t s = static_cast<int16_t>(diff);
+    return static_cast<uint16_t>((diff << 1) ^ (s >> 15));
+}
+
+inline uint16_t unzigzag(uint16_t z) {
+    return static_cast<uint16_t>((z >> 1) ^ -(z & 1));
+}
+
+void stripRows(int height, int strip_count, int strip, int& first, int& last) {
+    int rows_per_strip = (height + strip_count - 1) / strip_count;
+    first = std::min(height, strip * rows_per_strip);
+    last = std::min(height, first + rows_per_strip);
+}
+
+}  // namespace
+
+namespace depth_codec {
+
+const char* codecName(DepthCodec codec) {
+    switch (codec) {
+        case DepthCodec::FLOAT32: return "float32";
+        case DepthCodec::UINT16_MM: return "mm16";
+        case DepthCodec::UINT16_MM_DELTA_ZLIB: return "mm16_zlib";
+        default: return "unknown";
+    }
+}
+
+bool parseCodec(const std::string& name, DepthCodec& codec) {
+    if (name == "float32") {
+        codec = DepthCodec::FLOAT32;
+    } else if (name == "mm16") {
+        codec = DepthCodec::UINT16_MM;
+    } else if (name == "mm16_zlib") {
+        codec = DepthCodec::UINT16_MM_DELTA_ZLIB;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool isBlob(const uint8_t* data, size_t size) {
+    uint32_t magic = 0;
+    if (size < sizeof(DepthBlobHeader)) {
+        return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == BLOB_MAGIC;
+}
+
+}  // namespace depth_codec
+
+DepthEncoder::DepthEncoder(int strip_count, int zlib_level)
+    : strip_count_(std::max(1, strip_count)) {
+    std::memset(&zstream_, 0, sizeof(zstream_));
+    zstream_ready_ = (deflateInit(&zstream_, zlib_level) == Z_OK);
+}
+
+DepthEncoder::~DepthEncoder() {
+    if (zstream_ready_) {
+        deflateEnd(&zstream_);
+    }
+}
+
+bool DepthEncoder::compressStrip(const uint16_t* residuals, size_t count, std::vector<uint8_t>& out,
+                                 size_t offset, size_t& written) {
+    // Byte planes: the high bytes of small residuals are mostly zero and compress to almost nothing
+    planes_.resize(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        planes_[i] = static_cast<uint8_t>(residuals[i] >> 8);
+        planes_[count + i] = static_cast<uint8_t>(residuals[i] & 0xFF);
+    }
+
+    size_t bound = deflateBound(&zstream_, static_cast<uLong>(planes_.size()));
+    if (out.size() < offset + bound) {
+        out.resize(offset + bound);
+    }
+
+    deflateReset(&zstream_);
+    zstream_.next_in = planes_.data();
+    zstream_.avail_in = static_cast<uInt>(planes_.size());
+    zstream_.next_out = out.data() + offset;
+    zstream_.avail_out = static_cast<uInt>(bound);
+
+    if (deflate(&zstream_, Z_FINISH) != Z_STREAM_END) {
+        last_error_ = "deflate failed";
+        return false;
+    }
+    written = bound - zstream_.avail_out;
+    return true;
+}
+
+bool DepthEncoder::encode(const float* depth, int width, int height, size_t stride_bytes,
+                          DepthCodec codec, int frame_number) {
+    auto start = std::chrono::steady_clock::now();
+    last_error_.clear();
+
+    if (!depth || width <= 0 || height <= 0) {
+        last_error_ = "invalid depth map";
+        return false;
+    }
+    if (stride_bytes == 0) {
+        stride_bytes = static_cast<size_t>(width) * sizeof(float);
+    }
+
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(depth);
+
+    depth_codec::DepthBlobHeader header{};
+    header.magic = depth_codec::BLOB_MAGIC;
+    header.codec = static_cast<uint32_t>(codec);
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.frame_number = frame_number;
+    header.strip_count = 0;
+
+    size_t offset = sizeof(header);
+
+    if (codec == DepthCodec::FLOAT32) {
+        output_.resize(std::max(output_.size(), offset + pixels * sizeof(float)));
+        for (int y = 0; y < height; y++) {
+            std::memcpy(output_.data() + offset, base + y * stride_bytes, width * sizeof(float));
+            offset += width * sizeof(float);
+        }
+    } else {
+        // Quantize to uint16 millimetres (drops the sl::Mat row padding)
+        quantized_.resize(pixels);
+        for (int y = 0; y < height; y++) {
+            const float* row = reinterpret_cast<const float*>(base + y * stride_bytes);
+            uint16_t* out = quantized_.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                out[x] = toMillimetres(row[x]);
+            }
+        }
+
+        if (codec == DepthCodec::UINT16_MM) {
+            output_.resize(std::max(output_.size(), offset + pixels * sizeof(uint16_t)));
+            std::memcpy(output_.data() + offset, quantized_.data(), pixels * sizeof(uint16_t));
+            offset += pixels * sizeof(uint16_t);
+        } else if (codec == DepthCodec::UINT16_MM_DELTA_ZLIB) {
+            if (!zstream_ready_) {
+                last_error_ = "zlib not initialized";
+                return false;
+            }
+
+            int strips = std::min(strip_count_, height);
+            header.strip_count = static_cast<uint32_t>(strips);
+            size_t sizes_offset = offset;
+            offset += strips * sizeof(uint32_t);
+            if (output_.size() < offset) {
+                output_.resize(offset);
+            }
+
+            for (int strip = 0; strip < strips; strip++) {
+                int first = 0;
+                int last = 0;
+                stripRows(height, strips, strip, first, last);
+
+                size_t count = static_cast<size_t>(last - first) * width;
+                residuals_.resize(count);
+                uint16_t* res = residuals_.data();
+                for (int y = first; y < last; y++) {
+                    const uint16_t* row = quantized_.data() + static_cast<size_t>(y) * width;
+                    const uint16_t* up = (y > first) ? row - width : nullptr;
+                    for (int x = 0; x < width; x++) {
+                        *res++ = zigzag(static_cast<uint16_t>(row[x] - predict(row, up, x)));
+                    }
+                }
+
+                size_t written = 0;
+                if (!compressStrip(residuals_.data(), count, output_, offset, written)) {
+                    return false;
+                }
+                uint32_t strip_size = static_cast<uint32_t>(written);
+                std::memcpy(output_.data() + sizes_offset + strip * sizeof(uint32_t), &strip_size, sizeof(strip_size));
+                offset += written;
+            }
+        } else {
+            last_error_ = "unknown depth codec";
+            return false;
+        }
+    }
+
+    std::memcpy(output_.data(), &header, sizeof(header));
+    output_size_ = offset;
+
+    stats_.frames++;
+    stats_.raw_bytes += pixels * sizeof(float);
+    stats_.encoded_bytes += output_size_;
+    stats_.encode_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool decodeDepthBlob(const uint8_t* data, size_t size, DepthImage& out, std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (!depth_codec::isBlob(data, size)) {
+        return fail("not a depth_codec blob");
+    }
+
+    depth_codec::DepthBlobHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.width == 0 || header.height == 0 || header.width > 65535 || header.height > 65535) {
+        return fail("invalid dimensions");
+    }
+
+    const size_t pixels = static_cast<size_t>(header.width) * header.height;
+    const uint8_t* payload = data + sizeof(header);
+    const size_t payload_size = size - sizeof(header);
+
+    out.width = static_cast<int>(header.width);
+    out.height = static_cast<int>(header.height);
+    out.frame_number = header.frame_number;
+    out.codec = static_cast<DepthCodec>(header.codec);
+    out.data.resize(pixels);
+
+    switch (out.codec) {
+        case DepthCodec::FLOAT32:
+            if (payload_size < pixels * sizeof(float)) {
+                return fail("truncated float32 payload");
+            }
+            std::memcpy(out.data.data(), payload, pixels * sizeof(float));
+            return true;
+
+        case DepthCodec::UINT16_MM: {
+            if (payload_size < pixels * sizeof(uint16_t)) {
+                return fail("truncated mm16 payload");
+            }
+            for (size_t i = 0; i < pixels; i++) {
+                uint16_t mm;
+                std::memcpy(&mm, payload + i * sizeof(uint16_t), sizeof(mm));
+                out.data[i] = fromMillimetres(mm);
+            }
+            return true;
+        }
+
+        case DepthCodec::UINT16_MM_DELTA_ZLIB: {
+            const int width = out.width;
+            const int strips = static_cast<int>(header.strip_count);
+            if (strips <= 0 || strips > out.height || payload_size < strips * sizeof(uint32_t)) {
+                return fail("invalid strip table");
+            }
+
+            std::vector<uint32_t> strip_sizes(strips);
+            std::memcpy(strip_sizes.data(), payload, strips * sizeof(uint32_t));
+            size_t offset = strips * sizeof(uint32_t);
+
+            std::vector<uint8_t> planes;
+            std::vector<uint16_t> rows;
+            for (int strip = 0; strip < strips; strip++) {
+                int first = 0;
+                int last = 0;
+                stripRows(out.height, strips, strip, first, last);
+                size_t count = static_cast<size_t>(last - first) * width;
+
+                if (offset + strip_sizes[strip] > payload_size) {
+                    return fail("truncated strip " + std::to_string(strip));
+                }
+                planes.resize(count * 2);
+                uLongf plane_size = static_cast<uLongf>(planes.size());
+                if (uncompress(planes.data(), &plane_size, payload + offset, strip_sizes[strip]) != Z_OK ||
+                    plane_size != planes.size()) {
+                    return fail("corrupt strip " + std::to_string(strip));
+                }
+                offset += strip_sizes[strip];
+
+                // Undo byte planes + prediction
+                rows.resize(count);
+                for (int y = first; y < last; y++) {
+                    uint16_t* row = rows.data() + static_cast<size_t>(y - first) * width;
+                    const uint16_t* up = (y > first) ? row - width : nullptr;
+                    for (int x = 0; x < width; x++) {
+                        size_t i = static_cast<size_t>(y - first) * width + x;
+                        uint16_t z = static_cast<uint16_t>((planes[i] << 8) | planes[count + i]);
+                        row[x] = static_cast<uint16_t>(unzigzag(z) + predict(row, up, x));
+                    }
+                }
+
+                float* dst = out.data.data() + static_cast<size_t>(first) * width;
+                for (size_t i = 0; i < count; i++) {
+                    dst[i] = fromMillimetres(rows[i]);
+                }
+            }
+            return true;
+        }
+
+        default:
+            return fail("unknown depth codec " + std::to_string(header.codec));
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <zlib.h>
+
+/**
+ * @brief Depth map codecs for DepthDataWriter (depth.dsf records, legacy .depth), RAW_FRAMES (.dat / frames.dfc)
+ *
+ * FLOAT32             - float32 metres, bit-exact (3.7MB per HD720 frame)
+ * UINT16_MM           - millimetres in uint16 with sentinels for NaN/+inf/-inf (half size)
+ * UINT16_MM_DELTA_ZLIB - UINT16_MM + gradient prediction + zlib, lossless w.r.t. UINT16_MM
+ *
+ * UINT16_MM keeps 1mm resolution from 0.001m to 65.533m; finite values outside
+ * that range are clamped. ZED's NaN (no measurement), +inf (too far) and
+ * -inf (too close) survive the round trip.
+ *
+ * Encoded blobs are self-describing (DepthBlobHeader) so readers do not need to
+ * know the codec up front. The DELTA_ZLIB payload is split into independent
+ * row strips, each compressed on its own (decodable in parallel).
+ */
+enum class DepthCodec : uint32_t {
+    FLOAT32 = 0,
+    UINT16_MM = 1,
+    UINT16_MM_DELTA_ZLIB = 2
+};
+
+namespace depth_codec {
+
+constexpr uint32_t BLOB_MAGIC = 0x31435044;     // "DPC1"
+
+// UINT16_MM sentinels
+constexpr uint16_t MM_NAN = 0;                  // No measurement (occlusion, low confidence)
+constexpr uint16_t MM_NEG_INF = 0xFFFE;         // Too close
+constexpr uint16_t MM_POS_INF = 0xFFFF;         // Too far
+constexpr uint16_t MM_MAX = 0xFFFD;             // Largest real value (65.533m)
+
+#pragma pack(push, 1)
+struct DepthBlobHeader {
+    uint32_t magic;             // BLOB_MAGIC
+    uint32_t codec;             // DepthCodec
+    uint32_t width;
+    uint32_t height;
+    int32_t frame_number;       // -1 if unknown (e.g. inside frames.dfc, which has its own)
+    uint32_t strip_count;       // DELTA_ZLIB: number of uint32 strip sizes following the header
+};
+#pragma pack(pop)
+
+static_assert(sizeof(DepthBlobHeader) == 24, "DepthBlobHeader layout");
+
+// "float32", "mm16", "mm16_zlib"
+const char* codecName(DepthCodec codec);
+bool parseCodec(const std::string& name, DepthCodec& codec);
+
+// True if the buffer starts with a DepthBlobHeader (legacy .depth/.dat files do not)
+bool isBlob(const uint8_t* data, size_t size);
+
+}  // namespace depth_codec
+
+/**
+ * @brief Decoded depth map (float32 metres, row-major, no padding)
+ */
+struct DepthImage {
+    int width = 0;
+    int height = 0;
+    int frame_number = -1;
+    DepthCodec codec = DepthCodec::FLOAT32;
+    std::vector<float> data;
+};
+
+/**
+ * @brief Accumulated encoder throughput
+ */
+struct DepthCodecStats {
+    uint64_t frames = 0;
+    uint64_t raw_bytes = 0;         // float32 input size
+    uint64_t encoded_bytes = 0;
+    double encode_ms = 0.0;
+
+    double ratio() const { return encoded_bytes > 0 ? static_cast<double>(raw_bytes) / encoded_bytes : 0.0; }
+    double mbPerSec() const { return encode_ms > 0.0 ? raw_bytes / (1024.0 * 1024.0) / (encode_ms / 1000.0) : 0.0; }
+};
+
+/**
+ * @brief Depth encoder with persistent scratch buffers and zlib state
+ *
+ * Not thread-safe: use one encoder per worker thread (e.g. thread_local).
+ */
+class DepthEncoder {
+public:
+    explicit DepthEncoder(int strip_count = 4, int zlib_level = Z_BEST_SPEED);
+    ~DepthEncoder();
+
+    DepthEncoder(const DepthEncoder&) = delete;
+    DepthEncoder& operator=(const DepthEncoder&) = delete;
+
+    /**
+     * @brief Encode one depth map into a DepthBlobHeader + payload blob
+     * @param depth First value of the first row (float32 metres)
+     * @param stride_bytes Distance between rows (sl::Mat::getStepBytes())
+     * @return true on success; result in data()/size()
+     */
+    bool encode(const float* depth, int width, int height, size_t stride_bytes,
+                DepthCodec codec, int frame_number = -1);
+
+    const uint8_t* data() const { return output_.data(); }
+    size_t size() const { return output_size_; }
+
+    // Totals over all encode() calls of this encoder
+    const DepthCodecStats& getStats() const { return stats_; }
+    void resetStats() { stats_ = DepthCodecStats(); }
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    bool compressStrip(const uint16_t* residuals, size_t count, std::vector<uint8_t>& out, size_t offset,
+                       size_t& written);
+
+    int strip_count_;
+    z_stream zstream_;
+    bool zstream_ready_{false};
+
+    std::vector<uint16_t> quantized_;   // uint16 mm of the whole frame
+    std::vector<uint16_t> residuals_;   // Zigzag prediction residuals of one strip
+    std::vector<uint8_t> planes_;       // High-byte plane + low-byte plane of one strip
+    std::vector<uint8_t> output_;       // Grows to the largest frame seen, never shrinks
+    size_t output_size_{0};
+
+    DepthCodecStats stats_;
+    std::string last_error_;
+};
+
+/**
+ * @brief Decode a depth_codec blob (any codec) to float32 metres
+ */
+bool decodeDepthBlob(const uint8_t* data, size_t size, DepthImage& out, std::string* error = nullptr);
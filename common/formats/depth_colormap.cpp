@@ -0,0 +1,177 @@
+#include "depth_colormap.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct Rgb {
+    float r, g, b;
+};
+
+inline float clamp01(float v) {
+    return std::min(1.0f, std::max(0.0f, v));
+}
+
+Rgb jet(float x) {
+    return {clamp01(1.5f - std::fabs(4.0f * x - 3.0f)),
+            clamp01(1.5f - std::fabs(4.0f * x - 2.0f)),
+            clamp01(1.5f - std::fabs(4.0f * x - 1.0f))};
+}
+
+// Polynomial fit of Turbo (Mikhailov, Google AI 2019), max error < 1/255
+Rgb turbo(float x) {
+    float r = 0.13572138f + x * (4.61539260f + x * (-42.66032258f + x * (132.13108234f + x * (-152.94239396f + x * 59.28637943f))));
+    float g = 0.09140261f + x * (2.19418839f + x * (4.84296658f + x * (-14.18503333f + x * (4.27729857f + x * 2.82956604f))));
+    float b = 0.10667330f + x * (12.64194608f + x * (-60.58204836f + x * (110.36276771f + x * (-89.90310912f + x * 27.34824973f))));
+    return {clamp01(r), clamp01(g), clamp01(b)};
+}
+
+inline uint8_t toByte(float v) {
+    return static_cast<uint8_t>(v * 255.0f + 0.5f);
+}
+
+// LUT index per pixel: [0, max_index] for near < depth <= far, invalid_index otherwise.
+// The comparisons are false for NaN, so NaN and +/-inf need no separate test.
+void computeIndices(const float* depth, int width, float near_m, float far_m, float scale,
+                    uint32_t max_index, uint32_t invalid_index, uint32_t* out) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t v_near = vdupq_n_f32(near_m);
+    const float32x4_t v_far = vdupq_n_f32(far_m);
+    const float32x4_t v_scale = vdupq_n_f32(scale);
+    const uint32x4_t v_max = vdupq_n_u32(max_index);
+    const uint32x4_t v_invalid = vdupq_n_u32(invalid_index);
+    for (; x + 4 <= width; x += 4) {
+        float32x4_t d = vld1q_f32(depth + x);
+        uint32x4_t valid = vandq_u32(vcgtq_f32(d, v_near), vcleq_f32(d, v_far));
+        uint32x4_t index = vminq_u32(vcvtq_u32_f32(vmulq_f32(vsubq_f32(d, v_near), v_scale)), v_max);
+        vst1q_u32(out + x, vbslq_u32(valid, index, v_invalid));
+    }
+#elif defined(__SSE2__)
+    const __m128 v_near = _mm_set1_ps(near_m);
+    const __m128 v_far = _mm_set1_ps(far_m);
+    const __m128 v_scale = _mm_set1_ps(scale);
+    const __m128 v_max = _mm_set1_ps(static_cast<float>(max_index));
+    const __m128i v_invalid = _mm_set1_epi32(static_cast<int>(invalid_index));
+    for (; x + 4 <= width; x += 4) {
+        __m128 d = _mm_loadu_ps(depth + x);
+        __m128i valid = _mm_castps_si128(_mm_and_ps(_mm_cmpgt_ps(d, v_near), _mm_cmple_ps(d, v_far)));
+        __m128i index = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(d, v_near), v_scale), v_max));
+        __m128i result = _mm_or_si128(_mm_and_si128(valid, index), _mm_andnot_si128(valid, v_invalid));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), result);
+    }
+#endif
+    for (; x < width; x++) {
+        float d = depth[x];
+        if (d > near_m && d <= far_m) {
+            out[x] = std::min(static_cast<uint32_t>((d - near_m) * scale), max_index);
+        } else {
+            out[x] = invalid_index;
+        }
+    }
+}
+
+}  // namespace
+
+namespace depth_colormap {
+
+const char* colormapName(ColormapType type) {
+    switch (type) {
+        case ColormapType::JET: return "jet";
+        case ColormapType::TURBO: return "turbo";
+    }
+    return "unknown";
+}
+
+bool parseColormap(const std::string& name, ColormapType& type) {
+    if (name == "jet") {
+        type = ColormapType::JET;
+    } else if (name == "turbo") {
+        type = ColormapType::TURBO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace depth_colormap
+
+DepthColormap::DepthColormap() : DepthColormap(Config()) {
+}
+
+DepthColormap::DepthColormap(const Config& config) : config_(config) {
+    config_.lut_size = std::min(65536, std::max(2, config_.lut_size));
+    if (!(config_.far_m > config_.near_m)) {
+        config_.far_m = config_.near_m + 0.001f;
+    }
+    const int steps = config_.lut_size - 1;
+    scale_ = steps / (config_.far_m - config_.near_m);
+
+    lut_.assign(static_cast<size_t>(config_.lut_size + 1) * 4, 0);     // Invalid entry stays black
+    for (int i = 0; i < config_.lut_size; i++) {
+        float x = static_cast<float>(i) / steps;
+        Rgb c = (config_.type == ColormapType::TURBO) ? turbo(x) : jet(x);
+        uint8_t* entry = &lut_[static_cast<size_t>(i) * 4];
+        entry[0] = toByte(c.b);
+        entry[1] = toByte(c.g);
+        entry[2] = toByte(c.r);
+    }
+}
+
+void DepthColormap::applyRows(const float* depth, int width, size_t stride_bytes,
+                              uint8_t* bgr, size_t bgr_stride_bytes, int first_row, int last_row) const {
+    const uint32_t max_index = static_cast<uint32_t>(config_.lut_size - 1);
+    const uint32_t invalid_index = static_cast<uint32_t>(config_.lut_size);
+    const uint8_t* lut = lut_.data();
+    std::vector<uint32_t> indices(width);
+
+    for (int y = first_row; y < last_row; y++) {
+        const float* row = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(depth) + y * stride_bytes);
+        uint8_t* out = bgr + y * bgr_stride_bytes;
+        computeIndices(row, width, config_.near_m, config_.far_m, scale_, max_index, invalid_index, indices.data());
+        for (int x = 0; x < width; x++) {
+            const uint8_t* c = lut + indices[x] * 4;
+            out[0] = c[0];
+            out[1] = c[1];
+            out[2] = c[2];
+            out += 3;
+        }
+    }
+}
+
+void DepthColormap::apply(const float* depth, int width, int height, size_t stride_bytes,
+                          uint8_t* bgr, size_t bgr_stride_bytes, int threads) const {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    threads = std::max(1, std::min(threads, height));
+    if (threads == 1) {
+        applyRows(depth, width, stride_bytes, bgr, bgr_stride_bytes, 0, height);
+        return;
+    }
+
+    // Contiguous row bands; the calling thread takes the last one
+    const int rows_per_band = (height + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    int first = 0;
+    for (int t = 0; t < threads - 1 && first < height; t++) {
+        int last = std::min(height, first + rows_per_band);
+        workers.emplace_back(&DepthColormap::applyRows, this, depth, width, stride_bytes,
+                             bgr, bgr_stride_bytes, first, last);
+        first = last;
+    }
+    if (first < height) {
+        applyRows(depth, width, stride_bytes, bgr, bgr_stride_bytes, first, height);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Colour palettes for depth visualisation
+ *
+ * JET   - MATLAB/OpenCV jet (blue = near, red = far)
+ * TURBO - Google's perceptually smoother jet replacement
+ */
+enum class ColormapType {
+    JET,
+    TURBO
+};
+
+namespace depth_colormap {
+
+// "jet", "turbo"
+const char* colormapName(ColormapType type);
+bool parseColormap(const std::string& name, ColormapType& type);
+
+}  // namespace depth_colormap
+
+/**
+ * @brief float32 depth (metres) -> BGR24 through a precomputed LUT
+ *
+ * Values in (near_m, far_m] map linearly onto the LUT; NaN, +/-inf and values
+ * outside the range are painted black. The index computation runs 4 pixels at
+ * a time (NEON on the Jetson, SSE2 on x86, scalar elsewhere), the colour fetch
+ * is a plain table lookup. Rows can be split across threads.
+ *
+ * Immutable after construction, so one instance can be shared by all threads.
+ */
+class DepthColormap {
+public:
+    struct Config {
+        ColormapType type = ColormapType::JET;
+        float near_m = 0.0f;            // Exclusive: depth <= near_m is invalid (as ZED's 0)
+        float far_m = 10.0f;            // Inclusive
+        int lut_size = 256;             // Colour steps between near_m and far_m (256 = 8-bit applyColorMap)
+    };
+
+    DepthColormap();
+    explicit DepthColormap(const Config& config);
+
+    /**
+     * @brief Colourise one depth map
+     * @param stride_bytes Distance between depth rows (width * 4 for packed data)
+     * @param bgr_stride_bytes Distance between output rows (cv::Mat::step)
+     * @param threads Row bands processed in parallel (1 = calling thread only)
+     */
+    void apply(const float* depth, int width, int height, size_t stride_bytes,
+               uint8_t* bgr, size_t bgr_stride_bytes, int threads = 1) const;
+
+    const Config& getConfig() const { return config_; }
+
+private:
+    void applyRows(const float* depth, int width, size_t stride_bytes,
+                   uint8_t* bgr, size_t bgr_stride_bytes, int first_row, int last_row) const;
+
+    Config config_;
+    float scale_;                       // LUT steps per metre
+    std::vector<uint8_t> lut_;          // (lut_size + 1) BGRx entries, the last one is the invalid colour
+};
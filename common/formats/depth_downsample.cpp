@@ -0,0 +1,274 @@
+#include "depth_downsample.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+inline bool isValid(float d) {
+    return d > 0.0f && d < INF;     // False for NaN and +/-inf
+}
+
+inline const float* rowAt(const uint8_t* base, size_t stride_bytes, int row) {
+    return reinterpret_cast<const float*>(base + row * stride_bytes);
+}
+
+// column[x] = min(column[x], row[x]) over valid samples (invalid -> +inf)
+void foldRowMin(const float* row, int width, float* column) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t v_zero = vdupq_n_f32(0.0f);
+    const float32x4_t v_inf = vdupq_n_f32(INF);
+    for (; x + 4 <= width; x += 4) {
+        float32x4_t d = vld1q_f32(row + x);
+        uint32x4_t valid = vandq_u32(vcgtq_f32(d, v_zero), vcltq_f32(d, v_inf));
+        vst1q_f32(column + x, vminq_f32(vld1q_f32(column + x), vbslq_f32(valid, d, v_inf)));
+    }
+#elif defined(__SSE2__)
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_inf = _mm_set1_ps(INF);
+    for (; x + 4 <= width; x += 4) {
+        __m128 d = _mm_loadu_ps(row + x);
+        __m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, v_zero), _mm_cmplt_ps(d, v_inf));
+        __m128 value = _mm_or_ps(_mm_and_ps(valid, d), _mm_andnot_ps(valid, v_inf));
+        _mm_storeu_ps(column + x, _mm_min_ps(_mm_loadu_ps(column + x), value));
+    }
+#endif
+    for (; x < width; x++) {
+        if (isValid(row[x]) && row[x] < column[x]) {
+            column[x] = row[x];
+        }
+    }
+}
+
+// sum[x] += row[x], count[x] += 1 over valid samples
+void foldRowSum(const float* row, int width, float* sum, float* count) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t v_zero = vdupq_n_f32(0.0f);
+    const float32x4_t v_inf = vdupq_n_f32(INF);
+    const uint32x4_t v_one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+    for (; x + 4 <= width; x += 4) {
+        float32x4_t d = vld1q_f32(row + x);
+        uint32x4_t valid = vandq_u32(vcgtq_f32(d, v_zero), vcltq_f32(d, v_inf));
+        vst1q_f32(sum + x, vaddq_f32(vld1q_f32(sum + x), vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(d)))));
+        vst1q_f32(count + x, vaddq_f32(vld1q_f32(count + x), vreinterpretq_f32_u32(vandq_u32(valid, v_one))));
+    }
+#elif defined(__SSE2__)
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_inf = _mm_set1_ps(INF);
+    const __m128 v_one = _mm_set1_ps(1.0f);
+    for (; x + 4 <= width; x += 4) {
+        __m128 d = _mm_loadu_ps(row + x);
+        __m128 valid = _mm_and_ps(_mm_cmpgt_ps(d, v_zero), _mm_cmplt_ps(d, v_inf));
+        _mm_storeu_ps(sum + x, _mm_add_ps(_mm_loadu_ps(sum + x), _mm_and_ps(valid, d)));
+        _mm_storeu_ps(count + x, _mm_add_ps(_mm_loadu_ps(count + x), _mm_and_ps(valid, v_one)));
+    }
+#endif
+    for (; x < width; x++) {
+        if (isValid(row[x])) {
+            sum[x] += row[x];
+            count[x] += 1.0f;
+        }
+    }
+}
+
+// values[i] = op(values[2i], values[2i + 1]) for i < width / 2, in place
+template <bool Min>
+void foldPairs(float* values, int width) {
+    const int half = width / 2;
+    int i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= half; i += 4) {
+        float32x4x2_t pairs = vuzpq_f32(vld1q_f32(values + 2 * i), vld1q_f32(values + 2 * i + 4));
+        vst1q_f32(values + i, Min ? vminq_f32(pairs.val[0], pairs.val[1]) : vaddq_f32(pairs.val[0], pairs.val[1]));
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= half; i += 4) {
+        __m128 a = _mm_loadu_ps(values + 2 * i);
+        __m128 b = _mm_loadu_ps(values + 2 * i + 4);
+        __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(values + i, Min ? _mm_min_ps(even, odd) : _mm_add_ps(even, odd));
+    }
+#endif
+    for (; i < half; i++) {
+        float a = values[2 * i];
+        float b = values[2 * i + 1];
+        values[i] = Min ? std::min(a, b) : a + b;
+    }
+}
+
+}  // namespace
+
+namespace depth_downsample {
+
+const char* poolingName(DepthPooling pooling) {
+    switch (pooling) {
+        case DepthPooling::MIN: return "min";
+        case DepthPooling::MEDIAN: return "median";
+        case DepthPooling::MEAN: return "mean";
+    }
+    return "unknown";
+}
+
+bool parsePooling(const std::string& name, DepthPooling& pooling) {
+    if (name == "min") {
+        pooling = DepthPooling::MIN;
+    } else if (name == "median") {
+        pooling = DepthPooling::MEDIAN;
+    } else if (name == "mean") {
+        pooling = DepthPooling::MEAN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* scaleName(int scale) {
+    switch (scale) {
+        case 1: return "full";
+        case 2: return "half";
+        case 4: return "quarter";
+    }
+    return "unknown";
+}
+
+bool parseScale(const std::string& name, int& scale) {
+    if (name == "full" || name == "1") {
+        scale = 1;
+    } else if (name == "half" || name == "2") {
+        scale = 2;
+    } else if (name == "quarter" || name == "4") {
+        scale = 4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace depth_downsample
+
+DepthDownsampler::DepthDownsampler() : DepthDownsampler(Config()) {
+}
+
+DepthDownsampler::DepthDownsampler(const Config& config) : config_(config) {
+    if (!depth_downsample::isValidScale(config_.scale)) {
+        config_.scale = 1;
+    }
+}
+
+void DepthDownsampler::apply(const float* depth, int width, int height, size_t stride_bytes, float* out) {
+    const int scale = config_.scale;
+    const int out_width = outputWidth(width);
+    const int out_height = outputHeight(height);
+    if (out_width <= 0 || out_height <= 0) {
+        return;
+    }
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(depth);
+
+    if (scale == 1) {
+        for (int y = 0; y < height; y++) {
+            std::memcpy(out + static_cast<size_t>(y) * width, rowAt(base, stride_bytes, y), width * sizeof(float));
+        }
+        return;
+    }
+
+    for (int y = 0; y < out_height; y++) {
+        const uint8_t* block = base + static_cast<size_t>(y) * scale * stride_bytes;
+        float* out_row = out + static_cast<size_t>(y) * out_width;
+        if (config_.pooling == DepthPooling::MEDIAN) {
+            poolRowMedian(block, out_width, stride_bytes, out_row);
+        } else {
+            poolRowMinMean(block, out_width, stride_bytes, out_row);
+        }
+    }
+}
+
+void DepthDownsampler::poolRowMinMean(const uint8_t* block, int out_width, size_t stride_bytes, float* out) {
+    const int scale = config_.scale;
+    const int in_width = out_width * scale;
+
+    if (config_.pooling == DepthPooling::MIN) {
+        column_min_.assign(in_width, INF);
+        for (int r = 0; r < scale; r++) {
+            foldRowMin(rowAt(block, stride_bytes, r), in_width, column_min_.data());
+        }
+        for (int width = in_width; width > out_width; width /= 2) {
+            foldPairs<true>(column_min_.data(), width);
+        }
+        for (int x = 0; x < out_width; x++) {
+            float value = column_min_[x];
+            out[x] = value < INF ? value : emptyBlockValue(block, x, stride_bytes);
+        }
+        return;
+    }
+
+    column_sum_.assign(in_width, 0.0f);
+    column_count_.assign(in_width, 0.0f);
+    for (int r = 0; r < scale; r++) {
+        foldRowSum(rowAt(block, stride_bytes, r), in_width, column_sum_.data(), column_count_.data());
+    }
+    for (int width = in_width; width > out_width; width /= 2) {
+        foldPairs<false>(column_sum_.data(), width);
+        foldPairs<false>(column_count_.data(), width);
+    }
+    for (int x = 0; x < out_width; x++) {
+        float count = column_count_[x];
+        out[x] = count > 0.0f ? column_sum_[x] / count : emptyBlockValue(block, x, stride_bytes);
+    }
+}
+
+void DepthDownsampler::poolRowMedian(const uint8_t* block, int out_width, size_t stride_bytes, float* out) {
+    const int scale = config_.scale;
+    float values[16];
+    for (int x = 0; x < out_width; x++) {
+        int count = 0;
+        for (int r = 0; r < scale; r++) {
+            const float* row = rowAt(block, stride_bytes, r) + x * scale;
+            for (int c = 0; c < scale; c++) {
+                if (isValid(row[c])) {
+                    values[count++] = row[c];
+                }
+            }
+        }
+        if (count == 0) {
+            out[x] = emptyBlockValue(block, x, stride_bytes);
+            continue;
+        }
+        // Insertion sort beats nth_element at <= 16 values
+        for (int i = 1; i < count; i++) {
+            float value = values[i];
+            int j = i;
+            for (; j > 0 && values[j - 1] > value; j--) {
+                values[j] = values[j - 1];
+            }
+            values[j] = value;
+        }
+        out[x] = values[(count - 1) / 2];
+    }
+}
+
+float DepthDownsampler::emptyBlockValue(const uint8_t* block, int x, size_t stride_bytes) const {
+    const int scale = config_.scale;
+    bool too_far = false;
+    for (int r = 0; r < scale; r++) {
+        const float* row = rowAt(block, stride_bytes, r) + x * scale;
+        for (int c = 0; c < scale; c++) {
+            if (row[c] == -INF) {
+                return -INF;        // Too close wins: something is in front of the camera
+            }
+            too_far |= (row[c] == INF);
+        }
+    }
+    return too_far ? INF : std::numeric_limits<float>::quiet_NaN();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief How a scale x scale block of depth values becomes one output value
+ *
+ * MIN    - nearest valid depth (conservative for obstacle statistics)
+ * MEDIAN - lower median of the valid depths (always a measured value, no mixing across edges)
+ * MEAN   - average of the valid depths (smoothest, blends foreground and background at edges)
+ */
+enum class DepthPooling : uint32_t {
+    MIN = 0,
+    MEDIAN = 1,
+    MEAN = 2
+};
+
+namespace depth_downsample {
+
+// "min", "median", "mean"
+const char* poolingName(DepthPooling pooling);
+bool parsePooling(const std::string& name, DepthPooling& pooling);
+
+// "full", "half", "quarter" <-> 1, 2, 4
+const char* scaleName(int scale);
+bool parseScale(const std::string& name, int& scale);
+
+// 1, 2 or 4
+inline bool isValidScale(int scale) { return scale == 1 || scale == 2 || scale == 4; }
+
+// Output width/height; trailing rows/columns that do not fill a block are dropped
+inline int outputSize(int size, int scale) { return scale > 0 ? size / scale : size; }
+
+}  // namespace depth_downsample
+
+/**
+ * @brief NaN-aware block pooling of float32 depth maps (1/2 or 1/4 resolution)
+ *
+ * Valid samples are 0 < depth < +inf; ZED's NaN (no measurement), -inf (too
+ * close) and +inf (too far) are skipped. A block without any valid sample
+ * becomes -inf if it contains a -inf, else +inf if it contains a +inf, else
+ * NaN, so the codecs' sentinels survive downsampling.
+ *
+ * MIN and MEAN reduce 4 columns at a time (NEON on the Jetson, SSE2 on x86,
+ * scalar elsewhere): rows of a block are folded column-wise, then adjacent
+ * columns pairwise. MEDIAN sorts each block (at most 16 values). Scale 1 is a
+ * plain copy that drops row padding.
+ *
+ * Not thread-safe (scratch rows): use one instance per thread.
+ */
+class DepthDownsampler {
+public:
+    struct Config {
+        int scale = 1;                      // 1 (full), 2 (half) or 4 (quarter) - others fall back to 1
+        DepthPooling pooling = DepthPooling::MIN;
+    };
+
+    DepthDownsampler();
+    explicit DepthDownsampler(const Config& config);
+
+    /**
+     * @brief Downsample one depth map
+     * @param stride_bytes Distance between input rows (sl::Mat::getStepBytes())
+     * @param out outputSize(width) * outputSize(height) floats, row-major, no padding
+     */
+    void apply(const float* depth, int width, int height, size_t stride_bytes, float* out);
+
+    int outputWidth(int width) const { return depth_downsample::outputSize(width, config_.scale); }
+    int outputHeight(int height) const { return depth_downsample::outputSize(height, config_.scale); }
+
+    const Config& getConfig() const { return config_; }
+
+private:
+    void poolRowMinMean(const uint8_t* block, int out_width, size_t stride_bytes, float* out);
+    void poolRowMedian(const uint8_t* block, int out_width, size_t stride_bytes, float* out);
+    float emptyBlockValue(const uint8_t* block, int x, size_t stride_bytes) const;
+
+    Config config_;
+    std::vector<float> column_min_;     // MIN: per input column, later per output pixel
+    std::vector<float> column_sum_;     // MEAN
+    std::vector<float> column_count_;   // MEAN: valid samples (float for SIMD)
+};
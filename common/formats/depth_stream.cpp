@@ -0,0 +1,476 @@
+#include "depth_stream.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr size_t ALIGNMENT = 8;
+
+uint64_t padTo8(uint64_t size) {
+    return (size + ALIGNMENT - 1) & ~static_cast<uint64_t>(ALIGNMENT - 1);
+}
+
+bool pwriteAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            std::cerr << "[DEPTH_STREAM] Write failed at offset " << offset << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+// Index + footer at @p offset, file cut right behind them (drops preallocation and torn records)
+bool writeTail(int fd, const std::vector<dsf::IndexEntry>& index, uint64_t offset, uint64_t& tail_size) {
+    dsf::IndexHeader index_header{};
+    index_header.magic = dsf::INDEX_MAGIC;
+    index_header.frame_count = index.size();
+
+    dsf::Footer footer{};
+    footer.index_offset = offset;
+    footer.frame_count = index.size();
+    std::memcpy(footer.magic, dsf::FOOTER_MAGIC, sizeof(footer.magic));
+
+    std::vector<uint8_t> tail(sizeof(index_header) + index.size() * sizeof(dsf::IndexEntry) + sizeof(footer));
+    uint8_t* out = tail.data();
+    std::memcpy(out, &index_header, sizeof(index_header));
+    out += sizeof(index_header);
+    if (!index.empty()) {
+        std::memcpy(out, index.data(), index.size() * sizeof(dsf::IndexEntry));
+        out += index.size() * sizeof(dsf::IndexEntry);
+    }
+    std::memcpy(out, &footer, sizeof(footer));
+
+    tail_size = tail.size();
+    if (!pwriteAll(fd, tail.data(), tail.size(), offset)) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(offset + tail.size())) != 0) {
+        std::cerr << "[DEPTH_STREAM] ftruncate failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// DepthStreamWriter
+// ============================================================================
+
+DepthStreamWriter::DepthStreamWriter() {
+}
+
+DepthStreamWriter::~DepthStreamWriter() {
+    if (fd_ >= 0) {
+        close();
+    }
+}
+
+bool DepthStreamWriter::open(const std::string& path, DepthCodec codec, int depth_scale, DepthPooling pooling,
+                             uint64_t preallocate_step) {
+    if (fd_ >= 0) {
+        std::cerr << "[DEPTH_STREAM] Writer already open: " << path_ << std::endl;
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[DEPTH_STREAM] Failed to create " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    path_ = path;
+    fd_ = fd;
+    codec_ = codec;
+    preallocate_step_ = preallocate_step;
+    allocated_end_ = 0;
+    index_.clear();
+    io_error_ = false;
+
+    dsf::FileHeader header{};
+    std::memcpy(header.magic, dsf::FILE_MAGIC, sizeof(header.magic));
+    header.version = dsf::FORMAT_VERSION;
+    header.header_size = sizeof(dsf::FileHeader);
+    header.created_unix_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    header.codec = static_cast<uint32_t>(codec);
+    header.depth_scale = static_cast<uint16_t>(std::max(1, depth_scale));
+    header.pooling = static_cast<uint16_t>(pooling);
+
+    if (!reserve(sizeof(header)) ||
+        !pwriteAll(fd_, reinterpret_cast<const uint8_t*>(&header), sizeof(header), 0)) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    file_offset_ = sizeof(header);
+    bytes_written_ = sizeof(header);
+
+    std::cout << "[DEPTH_STREAM] Writing " << path << " (" << depth_codec::codecName(codec);
+    if (header.depth_scale > 1) {
+        std::cout << ", 1/" << header.depth_scale << " resolution " << depth_downsample::poolingName(pooling);
+    }
+    if (preallocate_step_ > 0) {
+        std::cout << ", " << preallocate_step_ / (1024 * 1024) << "MB preallocation steps";
+    }
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+bool DepthStreamWriter::reserve(uint64_t end) {
+    if (preallocate_step_ == 0 || end <= allocated_end_) {
+        return true;
+    }
+    uint64_t target = allocated_end_;
+    while (target < end) {
+        target += preallocate_step_;
+    }
+    // KEEP_SIZE: the file size stays at the written data, so readers and crash recovery never see the reserve
+    if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated_end_),
+                    static_cast<off_t>(target - allocated_end_)) != 0) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS) {
+            std::cout << "[DEPTH_STREAM] fallocate not supported by this filesystem - writing without preallocation" << std::endl;
+            preallocate_step_ = 0;
+            return true;
+        }
+        // ENOSPC here is the real thing: the next write would fail as well
+        std::cerr << "[DEPTH_STREAM] fallocate failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    allocated_end_ = target;
+    return true;
+}
+
+bool DepthStreamWriter::writeFrame(uint64_t frame_number, uint64_t timestamp_ns, uint16_t width, uint16_t height,
+                                   const uint8_t* payload, size_t row_bytes, size_t rows, size_t stride) {
+    if (fd_ < 0 || io_error_) {
+        return false;
+    }
+    if (stride == 0) {
+        stride = row_bytes;
+    }
+
+    const uint64_t payload_size = static_cast<uint64_t>(row_bytes) * rows;
+    const uint64_t record_size = sizeof(dsf::FrameHeader) + padTo8(payload_size);
+
+    dsf::FrameHeader header{};
+    header.magic = dsf::FRAME_MAGIC;
+    header.codec = static_cast<uint32_t>(codec_);
+    header.width = width;
+    header.height = height;
+    header.frame_number = frame_number;
+    header.timestamp_ns = timestamp_ns;
+    header.payload_size = payload_size;
+
+    // One contiguous record -> one pwrite(); the staging buffer grows once to the frame size
+    if (record_.size() < record_size) {
+        record_.resize(record_size);
+    }
+    uint8_t* out = record_.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    if (stride == row_bytes) {
+        std::memcpy(out, payload, payload_size);
+    } else {
+        for (size_t y = 0; y < rows; y++) {
+            std::memcpy(out + y * row_bytes, payload + y * stride, row_bytes);
+        }
+    }
+    std::memset(out + payload_size, 0, record_size - sizeof(header) - payload_size);
+
+    if (!reserve(file_offset_ + record_size) || !pwriteAll(fd_, record_.data(), record_size, file_offset_)) {
+        io_error_ = true;
+        return false;
+    }
+
+    index_.push_back({frame_number, timestamp_ns, file_offset_, payload_size});
+    file_offset_ += record_size;
+    bytes_written_ += record_size;
+    return true;
+}
+
+bool DepthStreamWriter::close() {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    uint64_t tail_size = 0;
+    bool ok = !io_error_;
+    if (!writeTail(fd_, index_, file_offset_, tail_size)) {
+        ok = false;
+    }
+    bytes_written_ += tail_size;
+
+    if (::close(fd_) != 0) {
+        std::cerr << "[DEPTH_STREAM] close failed: " << strerror(errno) << std::endl;
+        ok = false;
+    }
+    fd_ = -1;
+
+    std::cout << "[DEPTH_STREAM] Closed " << path_ << ": " << index_.size() << " frames, "
+              << bytes_written_.load() / (1024 * 1024) << "MB" << (ok ? "" : " (WITH ERRORS)") << std::endl;
+
+    record_.clear();
+    record_.shrink_to_fit();
+    return ok;
+}
+
+bool DepthStreamWriter::repair(const std::string& path, std::string* error) {
+    DepthStreamReader reader;
+    if (!reader.open(path)) {
+        if (error) {
+            *error = reader.getLastError();
+        }
+        return false;
+    }
+    if (!reader.isRecovered()) {
+        return true;
+    }
+
+    // Records in file order (the reader sorts by frame number)
+    std::vector<dsf::IndexEntry> index = reader.getIndex();
+    std::sort(index.begin(), index.end(), [](const dsf::IndexEntry& a, const dsf::IndexEntry& b) {
+        return a.offset < b.offset;
+    });
+    uint64_t records_end = reader.getRecordsEnd();
+    reader.close();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (error) {
+            *error = "cannot open " + path + " for writing: " + strerror(errno);
+        }
+        return false;
+    }
+    uint64_t tail_size = 0;
+    bool ok = writeTail(fd, index, records_end, tail_size);
+    ok = (::fsync(fd) == 0) && ok;
+    ::close(fd);
+    if (!ok && error) {
+        *error = "cannot write index to " + path;
+    }
+    std::cout << "[DEPTH_STREAM] Repaired " << path << ": " << index.size() << " frames indexed" << std::endl;
+    return ok;
+}
+
+// ============================================================================
+// DepthStreamReader
+// ============================================================================
+
+DepthStreamReader::DepthStreamReader() {
+}
+
+DepthStreamReader::~DepthStreamReader() {
+    close();
+}
+
+void DepthStreamReader::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    records_end_ = 0;
+    recovered_ = false;
+    index_.clear();
+}
+
+bool DepthStreamReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        last_error_ = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(dsf::FileHeader)) {
+        last_error_ = "not a depth stream: " + path;
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);    // The mapping keeps the file referenced
+    if (addr == MAP_FAILED) {
+        last_error_ = "cannot map " + path + ": " + strerror(errno);
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = static_cast<uint64_t>(st.st_size);
+
+    dsf::FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, dsf::FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.header_size < sizeof(header) || header.header_size > size_) {
+        last_error_ = "not a depth stream: " + path;
+        close();
+        return false;
+    }
+    if (header.version > dsf::FORMAT_VERSION) {
+        last_error_ = "unsupported depth stream version " + std::to_string(header.version);
+        close();
+        return false;
+    }
+    codec_ = static_cast<DepthCodec>(header.codec);
+    depth_scale_ = header.depth_scale > 0 ? header.depth_scale : 1;
+    pooling_ = static_cast<DepthPooling>(header.pooling);
+
+    if (!loadIndex(header.header_size)) {
+        // No footer: recording was not closed - walk the records
+        index_.clear();
+        records_end_ = header.header_size;
+        scanRecords();
+        recovered_ = true;
+    }
+
+    std::stable_sort(index_.begin(), index_.end(), [](const dsf::IndexEntry& a, const dsf::IndexEntry& b) {
+        return a.frame_number < b.frame_number;
+    });
+    last_error_.clear();
+    return true;
+}
+
+bool DepthStreamReader::loadIndex(uint64_t records_start) {
+    dsf::Footer footer;
+    if (size_ < sizeof(dsf::FileHeader) + sizeof(footer)) {
+        return false;
+    }
+    std::memcpy(&footer, data_ + size_ - sizeof(footer), sizeof(footer));
+    if (std::memcmp(footer.magic, dsf::FOOTER_MAGIC, sizeof(footer.magic)) != 0) {
+        return false;
+    }
+
+    dsf::IndexHeader index_header;
+    if (footer.index_offset > size_ - sizeof(footer) - sizeof(index_header) ||
+        footer.frame_count > (size_ - sizeof(footer) - footer.index_offset - sizeof(index_header)) / sizeof(dsf::IndexEntry)) {
+        return false;
+    }
+    std::memcpy(&index_header, data_ + footer.index_offset, sizeof(index_header));
+    if (index_header.magic != dsf::INDEX_MAGIC || index_header.frame_count != footer.frame_count) {
+        return false;
+    }
+
+    index_.resize(footer.frame_count);
+    if (!index_.empty()) {
+        std::memcpy(index_.data(), data_ + footer.index_offset + sizeof(index_header),
+                    index_.size() * sizeof(dsf::IndexEntry));
+    }
+    // Subtraction form: offset + payload_size may come from a corrupt index and overflow
+    for (const auto& entry : index_) {
+        if (entry.offset < records_start || entry.offset > footer.index_offset ||
+            footer.index_offset - entry.offset < sizeof(dsf::FrameHeader) ||
+            entry.payload_size > footer.index_offset - entry.offset - sizeof(dsf::FrameHeader)) {
+            return false;
+        }
+    }
+    records_end_ = footer.index_offset;
+    return true;
+}
+
+void DepthStreamReader::scanRecords() {
+    uint64_t offset = records_end_;
+    while (offset + sizeof(dsf::FrameHeader) <= size_) {
+        dsf::FrameHeader header;
+        std::memcpy(&header, data_ + offset, sizeof(header));
+        if (header.magic != dsf::FRAME_MAGIC ||
+            header.payload_size > size_ - offset - sizeof(header)) {
+            break;      // Index, torn record or never-written (zero) tail
+        }
+        uint64_t record_size = sizeof(header) + padTo8(header.payload_size);
+        index_.push_back({header.frame_number, header.timestamp_ns, offset, header.payload_size});
+        offset += std::min(record_size, size_ - offset);
+    }
+    records_end_ = offset;
+}
+
+bool DepthStreamReader::frameHeader(size_t i, dsf::FrameHeader& out) const {
+    if (i >= index_.size()) {
+        return false;
+    }
+    std::memcpy(&out, data_ + index_[i].offset, sizeof(out));
+    // Only the index entry's size was bounds-checked against the mapping
+    return out.payload_size == index_[i].payload_size;
+}
+
+bool DepthStreamReader::framePayload(size_t i, const uint8_t*& data, size_t& size) const {
+    if (i >= index_.size()) {
+        return false;
+    }
+    data = data_ + index_[i].offset + sizeof(dsf::FrameHeader);
+    size = static_cast<size_t>(index_[i].payload_size);
+    return true;
+}
+
+const float* DepthStreamReader::frameFloats(size_t i) const {
+    dsf::FrameHeader header;
+    if (!frameHeader(i, header) || static_cast<DepthCodec>(header.codec) != DepthCodec::FLOAT32 ||
+        index_[i].payload_size < static_cast<uint64_t>(header.width) * header.height * sizeof(float)) {
+        return nullptr;
+    }
+    // Payload offsets are multiples of 8 (header sizes and record padding)
+    return reinterpret_cast<const float*>(data_ + index_[i].offset + sizeof(dsf::FrameHeader));
+}
+
+bool DepthStreamReader::readFrame(size_t i, DepthImage& out, std::string* error) const {
+    dsf::FrameHeader header;
+    if (i >= index_.size()) {
+        if (error) {
+            *error = "frame " + std::to_string(i) + " out of range";
+        }
+        return false;
+    }
+    if (!frameHeader(i, header)) {
+        if (error) {
+            *error = "frame " + std::to_string(index_[i].frame_number) + " payload size does not match the index";
+        }
+        return false;
+    }
+    const uint8_t* payload = data_ + index_[i].offset + sizeof(dsf::FrameHeader);
+
+    if (static_cast<DepthCodec>(header.codec) == DepthCodec::FLOAT32) {
+        const float* floats = frameFloats(i);
+        if (!floats) {
+            if (error) {
+                *error = "truncated frame " + std::to_string(header.frame_number);
+            }
+            return false;
+        }
+        out.width = header.width;
+        out.height = header.height;
+        out.frame_number = static_cast<int>(header.frame_number);
+        out.codec = DepthCodec::FLOAT32;
+        out.data.assign(floats, floats + static_cast<size_t>(header.width) * header.height);
+        return true;
+    }
+
+    if (!decodeDepthBlob(payload, static_cast<size_t>(index_[i].payload_size), out, error)) {
+        return false;
+    }
+    out.frame_number = static_cast<int>(header.frame_number);
+    return true;
+}
+
+bool DepthStreamReader::findFrame(uint64_t frame_number, size_t& i) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), frame_number,
+                               [](const dsf::IndexEntry& entry, uint64_t value) { return entry.frame_number < value; });
+    if (it == index_.end() || it->frame_number != frame_number) {
+        return false;
+    }
+    i = static_cast<size_t>(it - index_.begin());
+    return true;
+}
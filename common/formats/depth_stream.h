@@ -0,0 +1,219 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "depth_codec.h"
+#include "depth_downsample.h"
+
+/**
+ * @brief Append-only depth stream for SVO2_DEPTH_INFO recordings (depth.dsf)
+ *
+ * Replaces one depth_NNNNNN.depth file per captured frame with a single file
+ * per recording, grown in large fallocate() steps so the stick sees
+ * sequential appends instead of a create/close and a directory entry per frame.
+ *
+ * Layout (little-endian):
+ *
+ *   FileHeader
+ *   FrameHeader, payload, pad to 8      (frame 0)
+ *   FrameHeader, payload, pad to 8      (frame 1) ...
+ *   IndexHeader, IndexEntry x frame_count
+ *   Footer
+ *
+ * Payload is float32 rows (width * height, FLOAT32) or a self-describing
+ * depth_codec blob (compressed codecs). Reduced-resolution captures store the
+ * pooled maps; FileHeader::depth_scale / pooling say how they were made. Every FrameHeader repeats its magic,
+ * size and dimensions, so a file without footer (power loss, crash) is
+ * re-indexed by walking the records; DepthStreamWriter::repair() writes the
+ * recovered index back.
+ */
+namespace dsf {
+
+constexpr char FILE_MAGIC[8] = {'D', 'S', 'T', 'R', 'E', 'A', 'M', '1'};
+constexpr char FOOTER_MAGIC[8] = {'D', 'S', 'T', 'E', 'N', 'D', '0', '1'};
+constexpr uint32_t FRAME_MAGIC = 0x30524644;   // "DFR0"
+constexpr uint32_t INDEX_MAGIC = 0x30584944;   // "DIX0"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t created_unix_ns;
+    uint32_t codec;             // DepthCodec of all frames
+    uint32_t flags;
+    uint16_t depth_scale;       // Camera pixels per stored pixel per axis: 1, 2, 4 (0 = 1, older files)
+    uint16_t pooling;           // DepthPooling used when depth_scale > 1
+    uint32_t reserved[7];
+};
+
+struct FrameHeader {
+    uint32_t magic;             // FRAME_MAGIC
+    uint32_t codec;             // DepthCodec
+    uint16_t width;
+    uint16_t height;
+    uint32_t flags;
+    uint64_t frame_number;      // Recorder (SVO) frame number
+    uint64_t timestamp_ns;      // ZED image timestamp
+    uint64_t payload_size;      // Without padding
+};
+
+struct IndexHeader {
+    uint32_t magic;             // INDEX_MAGIC
+    uint32_t reserved;
+    uint64_t frame_count;
+};
+
+struct IndexEntry {
+    uint64_t frame_number;
+    uint64_t timestamp_ns;
+    uint64_t offset;            // File offset of the FrameHeader
+    uint64_t payload_size;
+};
+
+struct Footer {
+    uint64_t index_offset;
+    uint64_t frame_count;
+    char magic[8];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(FrameHeader) == 40, "FrameHeader layout");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout");
+static_assert(sizeof(Footer) == 24, "Footer layout");
+
+}  // namespace dsf
+
+/**
+ * @brief Writer for depth.dsf
+ *
+ * Not thread-safe: use from one thread at a time. In DepthDataWriter the
+ * writer thread calls writeFrame(); open() and close() run in start()/stop()
+ * before that thread starts and after it has been joined.
+ */
+class DepthStreamWriter {
+public:
+    DepthStreamWriter();
+    ~DepthStreamWriter();
+
+    /**
+     * @brief Create the stream file
+     * @param path Output file (truncated if it exists)
+     * @param depth_scale Downsampling factor of the frames that will be written (recorded in the header)
+     * @param preallocate_step Bytes reserved per fallocate() (0 = no preallocation)
+     */
+    bool open(const std::string& path, DepthCodec codec, int depth_scale = 1,
+              DepthPooling pooling = DepthPooling::MIN, uint64_t preallocate_step = 256ULL * 1024 * 1024);
+
+    /**
+     * @brief Append one frame
+     * @param payload First row (FLOAT32) or the depth_codec blob (rows = 1)
+     * @param stride Distance between rows (0 = row_bytes); row padding is dropped
+     */
+    bool writeFrame(uint64_t frame_number, uint64_t timestamp_ns, uint16_t width, uint16_t height,
+                    const uint8_t* payload, size_t row_bytes, size_t rows = 1, size_t stride = 0);
+
+    /**
+     * @brief Write index + footer, release unused preallocation and close
+     */
+    bool close();
+
+    /**
+     * @brief Rebuild the index of a stream that was not closed (crash, power loss)
+     *
+     * Walks the frame records, truncates a torn last record and appends index
+     * + footer. No-op for a complete file.
+     */
+    static bool repair(const std::string& path, std::string* error = nullptr);
+
+    bool isOpen() const { return fd_ >= 0; }
+    const std::string& getPath() const { return path_; }
+
+    uint64_t getBytesWritten() const { return bytes_written_.load(); }
+    uint64_t getFrameCount() const { return index_.size(); }
+
+private:
+    bool reserve(uint64_t end);
+
+    std::string path_;
+    int fd_{-1};
+    DepthCodec codec_{DepthCodec::FLOAT32};
+    uint64_t file_offset_{0};               // End of the last complete record
+    uint64_t preallocate_step_{0};
+    uint64_t allocated_end_{0};             // fallocate()d up to here
+    std::vector<uint8_t> record_;           // Staging buffer: header + payload + padding
+    std::vector<dsf::IndexEntry> index_;
+    std::atomic<uint64_t> bytes_written_{0};
+    bool io_error_{false};
+};
+
+/**
+ * @brief Memory-mapped random-access reader for depth.dsf
+ *
+ * Frame i (in frame_number order) is one index lookup away; FLOAT32 frames
+ * are read in place from the mapping. Files without footer are re-indexed
+ * in memory (isRecovered()). Once open, const methods are safe to call from
+ * several threads.
+ */
+class DepthStreamReader {
+public:
+    DepthStreamReader();
+    ~DepthStreamReader();
+
+    DepthStreamReader(const DepthStreamReader&) = delete;
+    DepthStreamReader& operator=(const DepthStreamReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    bool isRecovered() const { return recovered_; }
+    DepthCodec getCodec() const { return codec_; }
+
+    // Downsampling of the stored frames (1 = full camera resolution)
+    int getDepthScale() const { return depth_scale_; }
+    DepthPooling getPooling() const { return pooling_; }
+
+    size_t getFrameCount() const { return index_.size(); }
+    const std::vector<dsf::IndexEntry>& getIndex() const { return index_; }
+
+    // Header of frame i, false if out of range or its payload_size disagrees with the index
+    bool frameHeader(size_t i, dsf::FrameHeader& out) const;
+
+    // Payload of frame i inside the mapping (no copy)
+    bool framePayload(size_t i, const uint8_t*& data, size_t& size) const;
+
+    // FLOAT32 frames only: depth rows inside the mapping (width * height floats), else nullptr
+    const float* frameFloats(size_t i) const;
+
+    // Decode frame i (any codec) to float32 metres
+    bool readFrame(size_t i, DepthImage& out, std::string* error = nullptr) const;
+
+    // Position of a recorder frame number in the index (binary search)
+    bool findFrame(uint64_t frame_number, size_t& i) const;
+
+    // End of the last complete frame record (where repair() writes the index)
+    uint64_t getRecordsEnd() const { return records_end_; }
+
+    // Reason open() failed
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    bool loadIndex(uint64_t records_start);
+    void scanRecords();
+
+    const uint8_t* data_{nullptr};
+    uint64_t size_{0};
+    DepthCodec codec_{DepthCodec::FLOAT32};
+    int depth_scale_{1};
+    DepthPooling pooling_{DepthPooling::MIN};
+    uint64_t records_end_{0};
+    bool recovered_{false};
+    std::vector<dsf::IndexEntry> index_;
+    std::string last_error_;
+};
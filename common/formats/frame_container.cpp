@@ -0,0 +1,515 @@
+#include "frame_container.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr size_t ALIGNMENT = 8;
+
+size_t padTo8(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+bool pwriteAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            std::cerr << "[FRAME_CONTAINER] Write failed at offset " << offset << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+// Index + footer at @p offset, file cut right behind them (drops a torn last record)
+bool writeTail(int fd, const std::vector<dfc::IndexEntry>& index, uint64_t offset, uint64_t& tail_size) {
+    dfc::IndexHeader index_header{};
+    index_header.magic = dfc::INDEX_MAGIC;
+    index_header.frame_count = index.size();
+
+    dfc::Footer footer{};
+    footer.index_offset = offset;
+    footer.frame_count = index.size();
+    std::memcpy(footer.magic, dfc::FOOTER_MAGIC, sizeof(footer.magic));
+
+    std::vector<uint8_t> tail(sizeof(index_header) + index.size() * sizeof(dfc::IndexEntry) + sizeof(footer));
+    uint8_t* out = tail.data();
+    std::memcpy(out, &index_header, sizeof(index_header));
+    out += sizeof(index_header);
+    if (!index.empty()) {
+        std::memcpy(out, index.data(), index.size() * sizeof(dfc::IndexEntry));
+        out += index.size() * sizeof(dfc::IndexEntry);
+    }
+    std::memcpy(out, &footer, sizeof(footer));
+
+    tail_size = tail.size();
+    if (!pwriteAll(fd, tail.data(), tail.size(), offset)) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(offset + tail.size())) != 0) {
+        std::cerr << "[FRAME_CONTAINER] ftruncate failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// FrameContainerWriter
+// ============================================================================
+
+FrameContainerWriter::FrameContainerWriter() {
+}
+
+FrameContainerWriter::~FrameContainerWriter() {
+    if (fd_ >= 0) {
+        close();
+    }
+}
+
+bool FrameContainerWriter::open(const std::string& path, size_t buffer_size) {
+    if (fd_ >= 0) {
+        std::cerr << "[FRAME_CONTAINER] Writer already open: " << path_ << std::endl;
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[FRAME_CONTAINER] Failed to create " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    path_ = path;
+    fd_ = fd;
+    buffer_size_ = std::max<size_t>(buffer_size, 64 * 1024);
+    buffer_.assign(buffer_size_, 0);
+    buffer_used_ = 0;
+    file_offset_ = 0;
+    spare_buffers_.clear();
+    flushes_in_flight_ = 0;
+    closing_ = false;
+    index_.clear();
+    bytes_written_ = 0;
+    frame_count_ = 0;
+    io_error_ = false;
+
+    dfc::FileHeader header{};
+    std::memcpy(header.magic, dfc::FILE_MAGIC, sizeof(header.magic));
+    header.version = dfc::FORMAT_VERSION;
+    header.header_size = sizeof(dfc::FileHeader);
+    header.created_unix_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::memcpy(buffer_.data(), &header, sizeof(header));
+    buffer_used_ = sizeof(header);
+    bytes_written_ = sizeof(header);
+
+    std::cout << "[FRAME_CONTAINER] Writing " << path << " (" << buffer_size_ / 1024 << "KB write blocks)" << std::endl;
+    return true;
+}
+
+void FrameContainerWriter::rotateBufferLocked(std::vector<PendingBlock>& to_flush) {
+    if (buffer_used_ == 0) {
+        return;
+    }
+
+    PendingBlock block;
+    block.data = std::move(buffer_);
+    block.used = buffer_used_;
+    block.offset = file_offset_;
+    to_flush.push_back(std::move(block));
+    flushes_in_flight_++;
+
+    file_offset_ += buffer_used_;
+    buffer_used_ = 0;
+
+    if (!spare_buffers_.empty()) {
+        buffer_ = std::move(spare_buffers_.back());
+        spare_buffers_.pop_back();
+    } else {
+        buffer_.assign(buffer_size_, 0);
+    }
+}
+
+size_t FrameContainerWriter::recordSize(const std::vector<dfc::ChunkData>& chunks) {
+    size_t record_size = sizeof(dfc::FrameRecordHeader);
+    for (const auto& chunk : chunks) {
+        record_size += sizeof(dfc::ChunkHeader) + padTo8(chunk.payloadSize());
+    }
+    return record_size;
+}
+
+bool FrameContainerWriter::writeFrame(uint64_t frame_number, uint64_t timestamp_ns, uint32_t flags,
+                                      const std::vector<dfc::ChunkData>& chunks) {
+    size_t record_size = recordSize(chunks);
+
+    std::vector<PendingBlock> to_flush;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0 || closing_ || io_error_) {
+            return false;
+        }
+
+        // Full buffers are written after the lock is released (pwrite at their own offset)
+        if (buffer_used_ + record_size > buffer_.size()) {
+            rotateBufferLocked(to_flush);
+            if (record_size > buffer_.size()) {
+                buffer_.resize(record_size);    // Oversized frame: one-off larger block
+            }
+        }
+
+        uint64_t record_offset = file_offset_ + buffer_used_;
+        uint8_t* out = buffer_.data() + buffer_used_;
+
+        dfc::FrameRecordHeader header{};
+        header.magic = dfc::FRAME_MAGIC;
+        header.chunk_count = static_cast<uint32_t>(chunks.size());
+        header.record_size = record_size;
+        header.frame_number = frame_number;
+        header.timestamp_ns = timestamp_ns;
+        header.flags = flags;
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+
+        for (const auto& chunk : chunks) {
+            dfc::ChunkHeader chunk_header{};
+            chunk_header.type = static_cast<uint32_t>(chunk.type);
+            chunk_header.encoding = static_cast<uint32_t>(chunk.encoding);
+            chunk_header.width = chunk.width;
+            chunk_header.height = chunk.height;
+            chunk_header.depth_scale = chunk.depth_scale;
+            chunk_header.pooling = chunk.pooling;
+            chunk_header.size = chunk.payloadSize();
+            std::memcpy(out, &chunk_header, sizeof(chunk_header));
+            out += sizeof(chunk_header);
+
+            size_t stride = chunk.stride ? chunk.stride : chunk.row_bytes;
+            if (stride == chunk.row_bytes) {
+                std::memcpy(out, chunk.data, chunk.payloadSize());
+                out += chunk.payloadSize();
+            } else {
+                for (size_t row = 0; row < chunk.rows; row++) {
+                    std::memcpy(out, chunk.data + row * stride, chunk.row_bytes);
+                    out += chunk.row_bytes;
+                }
+            }
+
+            size_t padding = padTo8(chunk.payloadSize()) - chunk.payloadSize();
+            std::memset(out, 0, padding);
+            out += padding;
+        }
+
+        buffer_used_ += record_size;
+        index_.push_back({frame_number, timestamp_ns, record_offset, record_size});
+        bytes_written_ += record_size;
+        frame_count_++;
+    }
+
+    return writeBlocks(to_flush);
+}
+
+bool FrameContainerWriter::writeBlocks(std::vector<PendingBlock>& blocks) {
+    bool ok = true;
+    for (auto& block : blocks) {
+        if (!pwriteAll(fd_, block.data.data(), block.used, block.offset)) {
+            ok = false;
+        }
+    }
+
+    if (!blocks.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& block : blocks) {
+            // Keep one spare per in-flight block; oversized one-off blocks are released
+            if (block.data.size() == buffer_size_) {
+                spare_buffers_.push_back(std::move(block.data));
+            }
+            flushes_in_flight_--;
+        }
+        if (!ok) {
+            io_error_ = true;
+        }
+    }
+    flush_done_.notify_all();
+    return ok;
+}
+
+bool FrameContainerWriter::close() {
+    std::vector<PendingBlock> to_flush;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (fd_ < 0) {
+            return false;
+        }
+        closing_ = true;
+        rotateBufferLocked(to_flush);
+    }
+    bool ok = writeBlocks(to_flush);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Other threads may still be writing their blocks
+    flush_done_.wait(lock, [this] { return flushes_in_flight_ == 0; });
+
+    // Trailing index + footer
+    uint64_t tail_size = 0;
+    ok = !io_error_ && ok;
+    if (!writeTail(fd_, index_, file_offset_, tail_size)) {
+        ok = false;
+    }
+    bytes_written_ += tail_size;
+
+    if (::close(fd_) != 0) {
+        std::cerr << "[FRAME_CONTAINER] close failed: " << strerror(errno) << std::endl;
+        ok = false;
+    }
+    fd_ = -1;
+
+    std::cout << "[FRAME_CONTAINER] Closed " << path_ << ": " << index_.size() << " frames, "
+              << bytes_written_.load() / (1024 * 1024) << "MB" << (ok ? "" : " (WITH ERRORS)") << std::endl;
+
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    spare_buffers_.clear();
+    return ok;
+}
+
+bool FrameContainerWriter::repair(const std::string& path, std::string* error) {
+    FrameContainerReader reader;
+    if (!reader.open(path)) {
+        if (error) {
+            *error = reader.getLastError();
+        }
+        return false;
+    }
+    if (!reader.isRecovered()) {
+        return true;
+    }
+
+    // Records in file order (the reader sorts by frame number)
+    std::vector<dfc::IndexEntry> index = reader.getIndex();
+    std::sort(index.begin(), index.end(), [](const dfc::IndexEntry& a, const dfc::IndexEntry& b) {
+        return a.offset < b.offset;
+    });
+    uint64_t records_end = reader.getRecordsEnd();
+    reader.close();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (error) {
+            *error = "cannot open " + path + " for writing: " + strerror(errno);
+        }
+        return false;
+    }
+    uint64_t tail_size = 0;
+    bool ok = writeTail(fd, index, records_end, tail_size);
+    ok = (::fsync(fd) == 0) && ok;
+    ::close(fd);
+    if (!ok && error) {
+        *error = "cannot write index to " + path;
+    }
+    std::cout << "[FRAME_CONTAINER] Repaired " << path << ": " << index.size() << " frames indexed" << std::endl;
+    return ok;
+}
+
+// ============================================================================
+// FrameContainerReader
+// ============================================================================
+
+FrameContainerReader::FrameContainerReader() {
+}
+
+FrameContainerReader::~FrameContainerReader() {
+    close();
+}
+
+void FrameContainerReader::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    index_.clear();
+    file_size_ = 0;
+    records_end_ = 0;
+    recovered_ = false;
+}
+
+bool FrameContainerReader::readAt(uint64_t offset, void* out, size_t size) const {
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    while (size > 0) {
+        ssize_t got = ::pread(fd_, dst, size, static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        dst += got;
+        size -= static_cast<size_t>(got);
+        offset += static_cast<uint64_t>(got);
+    }
+    return true;
+}
+
+bool FrameContainerReader::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        last_error_ = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        last_error_ = "cannot stat " + path;
+        close();
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+
+    dfc::FileHeader header;
+    if (file_size_ < sizeof(header) || !readAt(0, &header, sizeof(header)) ||
+        std::memcmp(header.magic, dfc::FILE_MAGIC, sizeof(header.magic)) != 0) {
+        last_error_ = "not a frame container: " + path;
+        close();
+        return false;
+    }
+    if (header.version > dfc::FORMAT_VERSION) {
+        last_error_ = "unsupported container version " + std::to_string(header.version);
+        close();
+        return false;
+    }
+
+    if (!loadIndex()) {
+        // No footer: recording was not closed - walk the records
+        index_.clear();
+        records_end_ = header.header_size >= sizeof(header) && header.header_size <= file_size_
+                       ? header.header_size : sizeof(header);
+        scanRecords();
+        recovered_ = true;
+    }
+
+    // Encoder threads append out of order - present frames by number
+    std::stable_sort(index_.begin(), index_.end(), [](const dfc::IndexEntry& a, const dfc::IndexEntry& b) {
+        return a.frame_number < b.frame_number;
+    });
+
+    last_error_.clear();
+    return true;
+}
+
+bool FrameContainerReader::loadIndex() {
+    dfc::Footer footer;
+    if (file_size_ < sizeof(dfc::FileHeader) + sizeof(footer) ||
+        !readAt(file_size_ - sizeof(footer), &footer, sizeof(footer)) ||
+        std::memcmp(footer.magic, dfc::FOOTER_MAGIC, sizeof(footer.magic)) != 0) {
+        return false;
+    }
+
+    dfc::IndexHeader index_header;
+    if (footer.index_offset > file_size_ - sizeof(footer) - sizeof(index_header) ||
+        footer.frame_count > (file_size_ - sizeof(footer) - footer.index_offset - sizeof(index_header)) / sizeof(dfc::IndexEntry)) {
+        return false;
+    }
+    if (!readAt(footer.index_offset, &index_header, sizeof(index_header)) ||
+        index_header.magic != dfc::INDEX_MAGIC || index_header.frame_count != footer.frame_count) {
+        return false;
+    }
+
+    index_.resize(footer.frame_count);
+    if (!index_.empty() &&
+        !readAt(footer.index_offset + sizeof(index_header), index_.data(), index_.size() * sizeof(dfc::IndexEntry))) {
+        return false;
+    }
+    for (const auto& entry : index_) {
+        if (entry.record_size < sizeof(dfc::FrameRecordHeader) || entry.offset > footer.index_offset ||
+            entry.record_size > footer.index_offset - entry.offset) {
+            return false;
+        }
+    }
+    records_end_ = footer.index_offset;
+    return true;
+}
+
+void FrameContainerReader::scanRecords() {
+    uint64_t offset = records_end_;
+    dfc::FrameRecordHeader header;
+    while (offset + sizeof(header) <= file_size_ && readAt(offset, &header, sizeof(header))) {
+        if (header.magic != dfc::FRAME_MAGIC || header.record_size < sizeof(header) ||
+            header.record_size % ALIGNMENT != 0 || header.record_size > file_size_ - offset ||
+            header.chunk_count > (header.record_size - sizeof(header)) / sizeof(dfc::ChunkHeader)) {
+            break;      // Index, torn record or never-written (zero) tail
+        }
+        index_.push_back({header.frame_number, header.timestamp_ns, offset, header.record_size});
+        offset += header.record_size;
+    }
+    records_end_ = offset;
+}
+
+bool FrameContainerReader::readFrame(size_t i, dfc::FrameRecord& out) const {
+    if (fd_ < 0 || i >= index_.size()) {
+        last_error_ = "frame index out of range";
+        return false;
+    }
+
+    const dfc::IndexEntry& entry = index_[i];
+    if (entry.offset + entry.record_size > file_size_ || entry.record_size < sizeof(dfc::FrameRecordHeader)) {
+        last_error_ = "frame record outside file";
+        return false;
+    }
+
+    std::vector<uint8_t> record(entry.record_size);
+    if (!readAt(entry.offset, record.data(), record.size())) {
+        last_error_ = "read failed";
+        return false;
+    }
+
+    dfc::FrameRecordHeader header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    if (header.magic != dfc::FRAME_MAGIC || header.record_size != entry.record_size) {
+        last_error_ = "corrupt frame record";
+        return false;
+    }
+
+    out.frame_number = header.frame_number;
+    out.timestamp_ns = header.timestamp_ns;
+    out.flags = header.flags;
+    out.chunks.resize(header.chunk_count);
+
+    size_t pos = sizeof(header);
+    for (auto& chunk : out.chunks) {
+        dfc::ChunkHeader chunk_header;
+        if (pos + sizeof(chunk_header) > record.size()) {
+            last_error_ = "truncated chunk header";
+            return false;
+        }
+        std::memcpy(&chunk_header, record.data() + pos, sizeof(chunk_header));
+        pos += sizeof(chunk_header);
+        if (pos + chunk_header.size > record.size()) {
+            last_error_ = "truncated chunk payload";
+            return false;
+        }
+
+        chunk.type = static_cast<dfc::ChunkType>(chunk_header.type);
+        chunk.encoding = static_cast<dfc::ChunkEncoding>(chunk_header.encoding);
+        chunk.width = chunk_header.width;
+        chunk.height = chunk_header.height;
+        chunk.depth_scale = chunk_header.depth_scale > 0 ? chunk_header.depth_scale : 1;
+        chunk.pooling = chunk_header.pooling;
+        chunk.data.assign(record.data() + pos, record.data() + pos + chunk_header.size);
+        pos += padTo8(chunk_header.size);
+    }
+    return true;
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Append-only chunked container for RAW_FRAMES recordings (frames.dfc)
+ *
+ * Replaces the three files per frame (left/right JPEG + depth .dat) with a
+ * single file written in large sequential blocks, so a flight needs one open
+ * file handle instead of tens of thousands of directory entries on the USB
+ * stick.
+ *
+ * Layout (little-endian):
+ *
+ *   FileHeader
+ *   FrameRecord 0:  FrameRecordHeader, { ChunkHeader, payload, pad to 8 } x chunk_count
+ *   FrameRecord 1 ...
+ *   IndexHeader, IndexEntry x frame_count
+ *   Footer
+ *
+ * Frames may be appended by several threads; records land in file order,
+ * which is not necessarily frame_number order. The index is written on
+ * close(); the reader sorts it by frame_number. A container that was never
+ * closed (crash, power loss) is re-indexed by walking the frame records;
+ * FrameContainerWriter::repair() writes the rebuilt index back.
+ */
+namespace dfc {
+
+constexpr char FILE_MAGIC[8] = {'D', 'F', 'C', 'N', 'T', 'R', '0', '1'};
+constexpr char FOOTER_MAGIC[8] = {'D', 'F', 'C', 'E', 'N', 'D', '0', '1'};
+constexpr uint32_t FRAME_MAGIC = 0x304D5246;   // "FRM0"
+constexpr uint32_t INDEX_MAGIC = 0x30584449;   // "IDX0"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+enum class ChunkType : uint32_t {
+    LEFT_JPEG = 1,
+    RIGHT_JPEG = 2,
+    DEPTH = 3
+};
+
+// Payload encoding of a chunk (JPEG chunks always use RAW)
+enum class ChunkEncoding : uint32_t {
+    RAW = 0,            // JPEG bytes / float32 depth rows, width * height
+    DEPTH_CODEC = 1,    // Self-describing depth_codec blob (see depth_codec.h)
+};
+
+// Frame flags
+constexpr uint32_t FRAME_FLAG_CORRUPTED = 1u << 0;   // grab() returned CORRUPTED_FRAME
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t created_unix_ns;
+    uint32_t flags;
+    uint32_t reserved[9];
+};
+
+struct FrameRecordHeader {
+    uint32_t magic;             // FRAME_MAGIC
+    uint32_t chunk_count;
+    uint64_t record_size;       // Including this header and all chunks
+    uint64_t frame_number;
+    uint64_t timestamp_ns;      // ZED image timestamp
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct ChunkHeader {
+    uint32_t type;              // ChunkType
+    uint32_t encoding;          // ChunkEncoding
+    uint16_t width;
+    uint16_t height;
+    uint16_t depth_scale;       // DEPTH: camera pixels per stored pixel per axis (0 = 1, older files)
+    uint16_t pooling;           // DEPTH: DepthPooling used when depth_scale > 1
+    uint64_t size;              // Payload bytes (without padding)
+};
+
+struct IndexHeader {
+    uint32_t magic;             // INDEX_MAGIC
+    uint32_t reserved;
+    uint64_t frame_count;
+};
+
+struct IndexEntry {
+    uint64_t frame_number;
+    uint64_t timestamp_ns;
+    uint64_t offset;            // File offset of the FrameRecordHeader
+    uint64_t record_size;
+};
+
+struct Footer {
+    uint64_t index_offset;
+    uint64_t frame_count;
+    char magic[8];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(FrameRecordHeader) == 40, "FrameRecordHeader layout");
+static_assert(sizeof(ChunkHeader) == 24, "ChunkHeader layout");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout");
+static_assert(sizeof(Footer) == 24, "Footer layout");
+
+/**
+ * @brief Payload to append - either one contiguous block or strided rows
+ *
+ * For strided data (e.g. an sl::Mat with row padding) set rows/row_bytes/stride;
+ * the writer copies row_bytes of each row and drops the padding.
+ */
+struct ChunkData {
+    ChunkType type = ChunkType::LEFT_JPEG;
+    ChunkEncoding encoding = ChunkEncoding::RAW;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t depth_scale = 1;   // DEPTH chunks: downsampling factor (see ChunkHeader)
+    uint16_t pooling = 0;
+    const uint8_t* data = nullptr;
+    size_t row_bytes = 0;       // Bytes per row (contiguous: total size)
+    size_t rows = 1;
+    size_t stride = 0;          // Distance between rows (0 = row_bytes)
+
+    static ChunkData contiguous(ChunkType type, const uint8_t* data, size_t size,
+                                uint16_t width = 0, uint16_t height = 0) {
+        ChunkData chunk;
+        chunk.type = type;
+        chunk.width = width;
+        chunk.height = height;
+        chunk.data = data;
+        chunk.row_bytes = size;
+        return chunk;
+    }
+
+    size_t payloadSize() const { return row_bytes * rows; }
+};
+
+/**
+ * @brief One decoded chunk
+ */
+struct Chunk {
+    ChunkType type = ChunkType::LEFT_JPEG;
+    ChunkEncoding encoding = ChunkEncoding::RAW;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t depth_scale = 1;
+    uint16_t pooling = 0;
+    std::vector<uint8_t> data;
+};
+
+struct FrameRecord {
+    uint64_t frame_number = 0;
+    uint64_t timestamp_ns = 0;
+    uint32_t flags = 0;
+    std::vector<Chunk> chunks;
+
+    const Chunk* find(ChunkType type) const {
+        for (const auto& chunk : chunks) {
+            if (chunk.type == type) {
+                return &chunk;
+            }
+        }
+        return nullptr;
+    }
+};
+
+}  // namespace dfc
+
+/**
+ * @brief Thread-safe writer for frames.dfc
+ */
+class FrameContainerWriter {
+public:
+    FrameContainerWriter();
+    ~FrameContainerWriter();
+
+    /**
+     * @brief Create the container file
+     * @param path Output file (truncated if it exists)
+     * @param buffer_size Bytes collected before each write() (large = near-sequential USB throughput)
+     */
+    bool open(const std::string& path, size_t buffer_size = 8 * 1024 * 1024);
+
+    /**
+     * @brief Append one frame (safe to call from several encoder threads)
+     * @return false on I/O error
+     */
+    bool writeFrame(uint64_t frame_number, uint64_t timestamp_ns, uint32_t flags,
+                    const std::vector<dfc::ChunkData>& chunks);
+
+    /**
+     * @brief Flush buffered frames, write index + footer and close the file
+     */
+    bool close();
+
+    /**
+     * @brief Rebuild the index of a container that was not closed (crash, power loss)
+     *
+     * Walks the frame records, truncates a torn last record and appends index
+     * + footer. No-op for a complete file.
+     */
+    static bool repair(const std::string& path, std::string* error = nullptr);
+
+    // On-disk size of a frame record with these chunks (header + chunks + padding)
+    static size_t recordSize(const std::vector<dfc::ChunkData>& chunks);
+
+    bool isOpen() const { return fd_ >= 0; }
+    const std::string& getPath() const { return path_; }
+
+    // Bytes handed to the container (including buffered, not yet written data)
+    uint64_t getBytesWritten() const { return bytes_written_.load(); }
+    uint64_t getFrameCount() const { return frame_count_.load(); }
+
+private:
+    // Filled buffer waiting for pwrite() outside the lock
+    struct PendingBlock {
+        std::vector<uint8_t> data;
+        size_t used = 0;
+        uint64_t offset = 0;
+    };
+
+    void rotateBufferLocked(std::vector<PendingBlock>& to_flush);
+    bool writeBlocks(std::vector<PendingBlock>& blocks);
+
+    std::string path_;
+    int fd_{-1};
+    size_t buffer_size_{0};
+
+    std::mutex mutex_;
+    std::condition_variable flush_done_;
+    std::vector<uint8_t> buffer_;
+    size_t buffer_used_{0};
+    uint64_t file_offset_{0};               // File offset of buffer_[0]
+    std::vector<std::vector<uint8_t>> spare_buffers_;
+    int flushes_in_flight_{0};
+    bool closing_{false};
+
+    std::vector<dfc::IndexEntry> index_;
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> frame_count_{0};
+    std::atomic<bool> io_error_{false};
+};
+
+/**
+ * @brief Random-access reader for frames.dfc
+ *
+ * Files without a valid footer are re-indexed in memory by walking the frame
+ * records up to the first torn or unwritten one (isRecovered()).
+ */
+class FrameContainerReader {
+public:
+    FrameContainerReader();
+    ~FrameContainerReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    bool isRecovered() const { return recovered_; }
+
+    // Frames sorted by frame_number
+    size_t getFrameCount() const { return index_.size(); }
+    const std::vector<dfc::IndexEntry>& getIndex() const { return index_; }
+
+    // Read the i-th frame (in frame_number order)
+    bool readFrame(size_t i, dfc::FrameRecord& out) const;
+
+    const std::string& getLastError() const { return last_error_; }
+
+    // End of the last complete frame record (where repair() writes the index)
+    uint64_t getRecordsEnd() const { return records_end_; }
+
+private:
+    bool readAt(uint64_t offset, void* out, size_t size) const;
+    bool loadIndex();
+    void scanRecords();
+
+    int fd_{-1};
+    uint64_t file_size_{0};
+    uint64_t records_end_{0};
+    bool recovered_{false};
+    std::vector<dfc::IndexEntry> index_;
+    mutable std::string last_error_;
+};
@@ -0,0 +1,278 @@
+#include "sensor_log.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Records are collected into blocks of this size before each write()
+constexpr size_t WRITE_BLOCK_BYTES = 64 * 1024;
+
+// Partial blocks are written at least this often (bounds data loss on power cut)
+constexpr int WRITE_INTERVAL_MS = 1000;
+
+}  // namespace
+
+namespace sensor_log {
+
+const char* csvHeader(Layout layout) {
+    if (layout == Layout::RAW_FRAMES) {
+        return "frame_number,timestamp_ms,rotation_x,rotation_y,rotation_z,"
+               "accel_x,accel_y,accel_z,gyro_x,gyro_y,gyro_z,"
+               "mag_x,mag_y,mag_z,pressure,temperature";
+    }
+    return "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
+           "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature";
+}
+
+std::string csvRow(Layout layout, const SensorRecord& r) {
+    // Same stream formatting as the recorders' former operator<< rows
+    std::ostringstream row;
+    if (layout == Layout::RAW_FRAMES) {
+        row << r.frame_number << ","
+            << r.imu_timestamp_ns / 1000000ULL << ","
+            << r.orientation[0] << "," << r.orientation[1] << "," << r.orientation[2] << ",";
+    } else {
+        row << r.wall_time_ms << ","
+            << r.euler[0] << "," << r.euler[1] << "," << r.euler[2] << ",";
+    }
+    row << r.accel[0] << "," << r.accel[1] << "," << r.accel[2] << ","
+        << r.gyro[0] << "," << r.gyro[1] << "," << r.gyro[2] << ","
+        << r.mag[0] << "," << r.mag[1] << "," << r.mag[2] << ","
+        << r.pressure << "," << r.temperature;
+    return row.str();
+}
+
+}  // namespace sensor_log
+
+// ============================================================================
+// SensorLogWriter
+// ============================================================================
+
+SensorLogWriter::SensorLogWriter(size_t ring_capacity) : ring_(ring_capacity) {
+}
+
+SensorLogWriter::~SensorLogWriter() {
+    if (fd_.load() >= 0) {
+        close();
+    }
+}
+
+bool SensorLogWriter::open(const std::string& path, sensor_log::Layout layout) {
+    if (fd_ >= 0) {
+        std::cerr << "[SENSOR_LOG] Writer already open: " << path_ << std::endl;
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[SENSOR_LOG] Failed to create " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    path_ = path;
+    fd_ = fd;
+    block_.clear();
+    block_.reserve(WRITE_BLOCK_BYTES + sizeof(sensor_log::SensorRecord));
+    records_written_ = 0;
+    dropped_ = 0;
+    io_error_ = false;
+    flush_requested_ = false;
+
+    sensor_log::FileHeader header{};
+    std::memcpy(header.magic, sensor_log::FILE_MAGIC, sizeof(header.magic));
+    header.version = sensor_log::FORMAT_VERSION;
+    header.header_size = sizeof(sensor_log::FileHeader);
+    header.record_size = sizeof(sensor_log::SensorRecord);
+    header.layout = static_cast<uint32_t>(layout);
+    header.created_unix_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    if (!writeAll(reinterpret_cast<const uint8_t*>(&header), sizeof(header))) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    writer_thread_ = std::make_unique<std::thread>(&SensorLogWriter::writerLoop, this);
+    accepting_ = true;
+    return true;
+}
+
+bool SensorLogWriter::push(const sensor_log::SensorRecord& record) {
+    // close() clears accepting_ and then waits for pushes_in_flight_ to reach 0 before
+    // its final drain: a push either sees accepting_ == false or is drained into this file
+    pushes_in_flight_.fetch_add(1);
+    bool stored = accepting_.load() && ring_.tryPush(record);
+    pushes_in_flight_.fetch_sub(1);
+    if (!stored) {
+        dropped_++;
+    }
+    return stored;
+}
+
+void SensorLogWriter::flush() {
+    flush_requested_ = true;
+    wake_cv_.notify_one();
+}
+
+bool SensorLogWriter::close() {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    // Stop accepting and wait out a push that already passed the check (a few ns)
+    accepting_ = false;
+    while (pushes_in_flight_.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_cv_.notify_one();
+    if (writer_thread_ && writer_thread_->joinable()) {
+        writer_thread_->join();
+    }
+    writer_thread_.reset();
+
+    // Writer thread is gone - drain whatever the producer pushed last
+    bool ok = drain() && !io_error_;
+
+    ::close(fd_);
+    fd_ = -1;
+
+    std::cout << "[SENSOR_LOG] Closed " << path_ << " (" << records_written_.load() << " records";
+    if (dropped_ > 0) {
+        std::cout << ", " << dropped_.load() << " dropped";
+    }
+    std::cout << ")" << std::endl;
+    return ok;
+}
+
+bool SensorLogWriter::drain() {
+    sensor_log::SensorRecord record;
+    bool ok = true;
+    while (ring_.tryPop(record)) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+        block_.insert(block_.end(), bytes, bytes + sizeof(record));
+        if (block_.size() >= WRITE_BLOCK_BYTES) {
+            ok &= writeAll(block_.data(), block_.size());
+            records_written_ += block_.size() / sizeof(record);
+            block_.clear();
+        }
+    }
+    if (!block_.empty()) {
+        ok &= writeAll(block_.data(), block_.size());
+        records_written_ += block_.size() / sizeof(record);
+        block_.clear();
+    }
+    if (!ok) {
+        io_error_ = true;
+    }
+    return ok;
+}
+
+void SensorLogWriter::writerLoop() {
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS),
+                              [this] { return !running_ || flush_requested_.load(); });
+        }
+        flush_requested_ = false;
+        drain();
+    }
+}
+
+bool SensorLogWriter::writeAll(const uint8_t* data, size_t size) {
+    ScopedLatency timer(write_latency_);
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            std::cerr << "[SENSOR_LOG] Write failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// ============================================================================
+// SensorLogReader
+// ============================================================================
+
+bool SensorLogReader::open(const std::string& path) {
+    records_.clear();
+    truncated_ = false;
+    last_error_.clear();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        last_error_ = std::string("cannot open: ") + strerror(errno);
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[64 * 1024];
+    while (true) {
+        ssize_t got = ::read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        data.insert(data.end(), chunk, chunk + got);
+    }
+    ::close(fd);
+
+    sensor_log::FileHeader header;
+    if (data.size() < sizeof(header)) {
+        last_error_ = "file too small";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, sensor_log::FILE_MAGIC, sizeof(header.magic)) != 0) {
+        last_error_ = "not a sensor log";
+        return false;
+    }
+    if (header.version == 0 || header.version > sensor_log::FORMAT_VERSION) {
+        last_error_ = "unsupported version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.header_size < sizeof(header) || header.record_size == 0 || header.header_size > data.size()) {
+        last_error_ = "invalid header";
+        return false;
+    }
+
+    version_ = header.version;
+    layout_ = static_cast<sensor_log::Layout>(header.layout);
+    created_unix_ns_ = header.created_unix_ns;
+
+    // Older/newer writers may use a different record size: copy the common prefix
+    const size_t record_size = header.record_size;
+    const size_t known = std::min(record_size, sizeof(sensor_log::SensorRecord));
+    size_t offset = header.header_size;
+    records_.reserve((data.size() - offset) / record_size);
+    while (offset + record_size <= data.size()) {
+        sensor_log::SensorRecord record{};
+        std::memcpy(&record, data.data() + offset, known);
+        records_.push_back(record);
+        offset += record_size;
+    }
+    truncated_ = (offset != data.size());
+    return true;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "spsc_ring.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief Binary IMU/magnetometer/barometer log (sensors.slog / sensor_data.slog)
+ *
+ * Replaces the per-row CSV written from the grab threads. Each sample is a
+ * fixed-size SensorRecord; the recorder pushes it into a lock-free ring and a
+ * writer thread appends records in large blocks. tools/sensor_log_export turns
+ * a log back into the CSV layout the recorders used to write.
+ *
+ * Layout (little-endian): FileHeader, SensorRecord x N (no footer - a log cut
+ * short by power loss is valid up to its last complete record).
+ *
+ * Versioning: readers accept any version <= FORMAT_VERSION and skip
+ * record bytes beyond the fields they know (header.record_size), so fields
+ * can be appended to SensorRecord without breaking old tools.
+ */
+namespace sensor_log {
+
+constexpr char FILE_MAGIC[8] = {'D', 'S', 'E', 'N', 'S', 'L', 'O', 'G'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr const char* FILE_EXTENSION = ".slog";
+
+// Which CSV layout the exporter reproduces
+enum class Layout : uint32_t {
+    ZED_SVO = 0,        // timestamp,rotation_x..z (Euler),accel,gyro,mag,pressure,temperature
+    RAW_FRAMES = 1      // frame_number,timestamp_ms,rotation_x..z (quaternion xyz),accel,gyro,mag,pressure,temperature
+};
+
+// SensorRecord::flags - which sensors delivered a new sample since the previous record
+constexpr uint32_t FLAG_IMU_NEW = 1u << 0;
+constexpr uint32_t FLAG_MAG_NEW = 1u << 1;
+constexpr uint32_t FLAG_BARO_NEW = 1u << 2;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;       // sizeof(SensorRecord) of the writer
+    uint32_t layout;            // Layout
+    uint64_t created_unix_ns;
+    uint32_t reserved[8];
+};
+
+struct SensorRecord {
+    int64_t frame_number;       // Recorder frame number (-1 if not frame-aligned)
+    uint64_t imu_timestamp_ns;  // sl::SensorsData::IMUData::timestamp
+    int64_t wall_time_ms;       // system_clock when the sample was taken
+    float orientation[4];       // IMU pose quaternion (x, y, z, w)
+    float euler[3];             // IMU pose Euler angles (sl::Orientation::getEulerAngles)
+    float accel[3];             // m/s^2
+    float gyro[3];              // deg/s
+    float mag[3];               // uT (calibrated)
+    float pressure;             // hPa
+    float temperature;          // IMU temperature in C
+    uint32_t flags;             // FLAG_* bits (0 in logs written before ImuSampler)
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(SensorRecord) == 104, "SensorRecord layout");
+
+const char* csvHeader(Layout layout);
+
+// One CSV row (no newline) in the format the recorders used to write
+std::string csvRow(Layout layout, const SensorRecord& record);
+
+}  // namespace sensor_log
+
+/**
+ * @brief Asynchronous writer for sensor logs
+ *
+ * push() may be called from exactly one thread (the IMU sampler) and never
+ * blocks; a full ring drops the sample and counts it. The producer may keep
+ * pushing while the log is closed and reopened for a new segment: the ring is
+ * allocated once and outlives every segment, and close() stops accepting and
+ * waits for a push in progress before its final drain, so every accepted
+ * sample lands in the file that was open when it was pushed. Samples between
+ * close() and the next open() are dropped.
+ */
+class SensorLogWriter {
+public:
+    /**
+     * @param ring_capacity Records buffered between producer and writer thread (4096 = 10s at 400Hz)
+     */
+    explicit SensorLogWriter(size_t ring_capacity = 4096);
+    ~SensorLogWriter();
+
+    SensorLogWriter(const SensorLogWriter&) = delete;
+    SensorLogWriter& operator=(const SensorLogWriter&) = delete;
+
+    /**
+     * @brief Create the log and start the writer thread
+     */
+    bool open(const std::string& path, sensor_log::Layout layout);
+
+    // Producer side: copy the record into the ring (lock-free, no syscalls)
+    bool push(const sensor_log::SensorRecord& record);
+
+    // Ask the writer thread to write out everything pushed so far (does not wait)
+    void flush();
+
+    // Drain the ring, write remaining records and close the file
+    bool close();
+
+    bool isOpen() const { return fd_.load() >= 0; }
+    const std::string& getPath() const { return path_; }
+    uint64_t getRecordsWritten() const { return records_written_.load(); }
+    uint64_t getDropped() const { return dropped_.load(); }
+
+    // Duration of each block write() on the writer thread (kept across segments)
+    const LatencyHistogram& getWriteLatency() const { return write_latency_; }
+    void resetLatency() { write_latency_.reset(); }
+
+private:
+    void writerLoop();
+    bool drain();
+    bool writeAll(const uint8_t* data, size_t size);
+
+    std::string path_;
+    std::atomic<int> fd_{-1};
+
+    SpscRing<sensor_log::SensorRecord> ring_;
+    std::atomic<bool> accepting_{false};        // push() may store into ring_
+    std::atomic<int> pushes_in_flight_{0};      // push() calls between their accepting_ check and tryPush()
+    std::vector<uint8_t> block_;        // Writer thread only
+
+    std::unique_ptr<std::thread> writer_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> flush_requested_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::atomic<uint64_t> records_written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> io_error_{false};
+    LatencyHistogram write_latency_;
+};
+
+/**
+ * @brief Reader for sensor logs (whole file is loaded on open)
+ */
+class SensorLogReader {
+public:
+    bool open(const std::string& path);
+
+    sensor_log::Layout getLayout() const { return layout_; }
+    uint32_t getVersion() const { return version_; }
+    uint64_t getCreatedUnixNs() const { return created_unix_ns_; }
+    const std::vector<sensor_log::SensorRecord>& getRecords() const { return records_; }
+    bool isTruncated() const { return truncated_; }
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    sensor_log::Layout layout_{sensor_log::Layout::ZED_SVO};
+    uint32_t version_{0};
+    uint64_t created_unix_ns_{0};
+    std::vector<sensor_log::SensorRecord> records_;
+    bool truncated_{false};
+    std::string last_error_;
+};
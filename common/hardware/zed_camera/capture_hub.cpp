@@ -0,0 +1,333 @@
+#include "capture_hub.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+// LATEST subscribers that have not asked for a frame for this long no longer keep the idle grab running
+constexpr int64_t DEMAND_TIMEOUT_MS = 2000;
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+// ============================================================================
+// FrameSubscription
+// ============================================================================
+
+FrameSubscription::FrameSubscription(const SubscriberConfig& config)
+    : config_(config),
+      rate_divisor_(config.rate_divisor > 0 ? config.rate_divisor : 1) {
+    if (config_.mailbox == MailboxType::QUEUE) {
+        // BLOCK would stall the grab thread behind a slow consumer
+        BackpressurePolicy policy = (config_.policy == BackpressurePolicy::BLOCK)
+                                        ? BackpressurePolicy::DROP_OLDEST : config_.policy;
+        queue_ = std::make_unique<BoundedQueue<CapturedFramePtr>>(config_.queue_capacity, policy);
+    }
+}
+
+bool FrameSubscription::waitFrame(CapturedFramePtr& out, std::chrono::milliseconds timeout) {
+    touch();
+
+    if (queue_) {
+        return queue_->popFor(out, timeout);
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    wait_cv_.wait_for(lock, timeout, [this] { return closed_.load() || latest_seq_.load() > taken_seq_; });
+    uint64_t seq = latest_seq_.load();
+    if (seq <= taken_seq_) {
+        return false;
+    }
+    taken_seq_ = seq;
+    out = std::atomic_load(&latest_);
+    return out != nullptr;
+}
+
+CapturedFramePtr FrameSubscription::latest() {
+    touch();
+    return std::atomic_load(&latest_);
+}
+
+uint64_t FrameSubscription::getDropped() const {
+    return queue_ ? queue_->dropped() : 0;
+}
+
+void FrameSubscription::deliver(const CapturedFramePtr& frame) {
+    if (closed_) {
+        return;
+    }
+    if (queue_) {
+        if (queue_->push(frame)) {
+            delivered_++;
+        }
+        return;
+    }
+
+    std::atomic_store(&latest_, frame);
+    latest_seq_++;
+    delivered_++;
+    {
+        // Pairs with the predicate check in waitFrame() - no lost wakeups
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    wait_cv_.notify_all();
+}
+
+void FrameSubscription::close() {
+    closed_ = true;
+    if (queue_) {
+        queue_->close();
+    }
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    wait_cv_.notify_all();
+}
+
+bool FrameSubscription::isDemanding() const {
+    if (closed_) {
+        return false;
+    }
+    if (queue_) {
+        return true;
+    }
+    return steadyMillis() - last_demand_ms_.load() < DEMAND_TIMEOUT_MS;
+}
+
+void FrameSubscription::touch() {
+    last_demand_ms_ = steadyMillis();
+}
+
+// ============================================================================
+// CaptureHub
+// ============================================================================
+
+CaptureHub::CaptureHub(FrameSource& source)
+    : source_(source),
+      image_pool_([] { return std::make_unique<sl::Mat>(); }),
+      depth_pool_([] { return std::make_unique<sl::Mat>(); }) {
+}
+
+CaptureHub::~CaptureHub() {
+    stopIdleGrab();
+
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (auto& subscription : subscribers_) {
+        subscription->close();
+    }
+    subscribers_.clear();
+}
+
+std::shared_ptr<FrameSubscription> CaptureHub::subscribe(const SubscriberConfig& config) {
+    auto subscription = std::make_shared<FrameSubscription>(config);
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        subscribers_.push_back(subscription);
+    }
+    grab_cv_.notify_all();
+
+    std::cout << "[CAPTURE_HUB] Subscriber '" << config.name << "' added (every "
+              << subscription->getRateDivisor() << ". frame"
+              << (config.image ? ", image" : "") << (config.depth ? ", depth" : "")
+              << (config.sensors ? ", sensors" : "") << ")" << std::endl;
+    return subscription;
+}
+
+void CaptureHub::unsubscribe(const std::shared_ptr<FrameSubscription>& subscription) {
+    if (!subscription) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        subscribers_.erase(std::remove(subscribers_.begin(), subscribers_.end(), subscription), subscribers_.end());
+    }
+    subscription->close();
+    std::cout << "[CAPTURE_HUB] Subscriber '" << subscription->getConfig().name << "' removed ("
+              << subscription->getDelivered() << " frames delivered, "
+              << subscription->getDropped() << " dropped)" << std::endl;
+}
+
+void CaptureHub::acquireGrab(const std::string& owner) {
+    std::unique_lock<std::mutex> lock(grab_mutex_);
+    grab_cv_.wait(lock, [this] { return !grab_leased_ && !idle_grabbing_; });
+    grab_leased_ = true;
+    grab_owner_ = owner;
+}
+
+void CaptureHub::releaseGrab() {
+    {
+        std::lock_guard<std::mutex> lock(grab_mutex_);
+        grab_leased_ = false;
+        grab_owner_.clear();
+    }
+    grab_cv_.notify_all();
+}
+
+bool CaptureHub::wantsDepth() const {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (const auto& subscription : subscribers_) {
+        if (subscription->getConfig().depth && !subscription->isClosed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+LatencyReport CaptureHub::getLatencyReport() const {
+    return {
+        {"hub.retrieve_image", retrieve_image_latency_.summary()},
+        {"hub.retrieve_measure", retrieve_measure_latency_.summary()},
+        {"hub.sensors", sensors_latency_.summary()},
+    };
+}
+
+void CaptureHub::resetLatency() {
+    retrieve_image_latency_.reset();
+    retrieve_measure_latency_.reset();
+    sensors_latency_.reset();
+}
+
+bool CaptureHub::hasDemandLocked() const {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (const auto& subscription : subscribers_) {
+        if (!subscription->getConfig().recording_only && subscription->isDemanding()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PublishResult CaptureHub::publish(FrameSource& source, uint64_t frame_number, bool corrupted, bool recording) {
+    published_frames_++;
+
+    PublishResult result;
+    std::vector<std::shared_ptr<FrameSubscription>> due;
+    bool need_image = false;
+    bool need_depth = false;
+    bool need_sensors = false;
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        for (const auto& subscription : subscribers_) {
+            const SubscriberConfig& config = subscription->getConfig();
+            if (subscription->isClosed() || (config.recording_only && !recording)) {
+                continue;
+            }
+            if (frame_number % static_cast<uint64_t>(subscription->getRateDivisor()) != 0) {
+                continue;
+            }
+            need_image |= config.image;
+            need_depth |= config.depth;
+            need_sensors |= config.sensors;
+            due.push_back(subscription);
+        }
+    }
+    if (due.empty()) {
+        return result;
+    }
+
+    // Retrieve each product once, shared by all due subscribers
+    auto frame = std::make_shared<CapturedFrame>();
+    frame->frame_number = frame_number;
+    frame->timestamp_ns = source.getImageTimestamp().getNanoseconds();
+    frame->corrupted = corrupted;
+    frame->recording = recording;
+    frame->capture_time = std::chrono::steady_clock::now();
+
+    if (need_image) {
+        std::shared_ptr<sl::Mat> image = image_pool_.acquire();
+        if (image) {
+            ScopedLatency timer(retrieve_image_latency_);
+            if (source.retrieveImage(*image, sl::VIEW::LEFT) == sl::ERROR_CODE::SUCCESS) {
+                frame->image = std::move(image);
+            }
+        }
+    }
+    if (need_depth) {
+        std::shared_ptr<sl::Mat> depth = depth_pool_.acquire();
+        if (depth) {
+            auto start = std::chrono::steady_clock::now();
+            sl::ERROR_CODE err = source.retrieveMeasure(*depth, sl::MEASURE::DEPTH);
+            result.depth_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            retrieve_measure_latency_.record(result.depth_time);
+            if (err == sl::ERROR_CODE::SUCCESS) {
+                frame->depth = std::move(depth);
+                result.depth_retrieved = true;
+            }
+        }
+    }
+    if (need_sensors) {
+        ScopedLatency timer(sensors_latency_);
+        frame->has_sensors = (source.getSensorsData(frame->sensors, sl::TIME_REFERENCE::IMAGE) == sl::ERROR_CODE::SUCCESS);
+    }
+
+    CapturedFramePtr published = std::move(frame);
+    for (auto& subscription : due) {
+        subscription->deliver(published);
+    }
+    return result;
+}
+
+void CaptureHub::startIdleGrab() {
+    if (idle_running_) {
+        return;
+    }
+    idle_running_ = true;
+    idle_thread_ = std::make_unique<std::thread>(&CaptureHub::idleLoop, this);
+}
+
+void CaptureHub::stopIdleGrab() {
+    if (!idle_running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(grab_mutex_);
+        idle_running_ = false;
+    }
+    grab_cv_.notify_all();
+    if (idle_thread_ && idle_thread_->joinable()) {
+        idle_thread_->join();
+    }
+    idle_thread_.reset();
+}
+
+void CaptureHub::idleLoop() {
+    while (idle_running_) {
+        {
+            // Demand is re-checked periodically: subscribers do not notify the hub when they start waiting
+            std::unique_lock<std::mutex> lock(grab_mutex_);
+            grab_cv_.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                return !idle_running_ || (!grab_leased_ && hasDemandLocked());
+            });
+            if (!idle_running_) {
+                break;
+            }
+            if (grab_leased_ || !hasDemandLocked()) {
+                continue;
+            }
+            idle_grabbing_ = true;
+        }
+
+        sl::RuntimeParameters runtime_params;
+        runtime_params.enable_depth = wantsDepth();
+        sl::ERROR_CODE err = source_.grab(runtime_params);
+        bool corrupted = (err == sl::ERROR_CODE::CORRUPTED_FRAME);
+        if (err == sl::ERROR_CODE::SUCCESS || corrupted) {
+            idle_frames_++;
+            publish(source_, ++idle_sequence_, corrupted, false);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(grab_mutex_);
+            idle_grabbing_ = false;
+        }
+        grab_cv_.notify_all();
+
+        if (err != sl::ERROR_CODE::SUCCESS && !corrupted) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+}
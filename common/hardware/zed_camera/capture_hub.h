@@ -0,0 +1,194 @@
+#pragma once
+
+#include <sl/Camera.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "frame_source.h"
+#include "bounded_queue.h"
+#include "object_pool.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief One grabbed frame as published by the CaptureHub
+ *
+ * Only the products a due subscriber asked for are retrieved; the rest stay
+ * nullptr / has_sensors = false. Buffers return to the hub's pools when the
+ * last subscriber drops the frame.
+ */
+struct CapturedFrame {
+    uint64_t frame_number = 0;          // Recording frame number (ZEDRecorder/RawFrameRecorder counter) or idle sequence
+    uint64_t timestamp_ns = 0;          // ZED image timestamp
+    bool corrupted = false;             // grab() returned CORRUPTED_FRAME
+    bool recording = false;             // Grabbed by a recorder loop (false = idle preview grab)
+    std::shared_ptr<sl::Mat> image;     // Left BGRA
+    std::shared_ptr<sl::Mat> depth;     // Depth float32 (metres)
+    sl::SensorsData sensors;
+    bool has_sensors = false;
+    std::chrono::steady_clock::time_point capture_time;
+};
+
+using CapturedFramePtr = std::shared_ptr<const CapturedFrame>;
+
+// What publish() retrieved for its subscribers (lets the grabbing loop skip its own copies)
+struct PublishResult {
+    bool depth_retrieved = false;               // retrieveMeasure(DEPTH) succeeded this frame
+    std::chrono::microseconds depth_time{0};    // Duration of that retrieveMeasure
+};
+
+enum class MailboxType {
+    LATEST,         // Single slot, overwritten by every publish (preview, visualisation)
+    QUEUE           // Bounded FIFO with backpressure policy (writers that want every due frame)
+};
+
+struct SubscriberConfig {
+    std::string name;
+    int rate_divisor = 1;                   // Deliver every n-th frame (by frame_number)
+    bool image = false;
+    bool depth = false;
+    bool sensors = false;
+    bool recording_only = false;            // Ignore idle preview grabs
+    MailboxType mailbox = MailboxType::LATEST;
+    size_t queue_capacity = 4;              // QUEUE only
+    BackpressurePolicy policy = BackpressurePolicy::DROP_OLDEST;   // QUEUE only - BLOCK would stall the grab thread
+};
+
+/**
+ * @brief Subscriber side of the CaptureHub
+ *
+ * Owned by the consumer; the hub keeps a reference until unsubscribe() or its
+ * own destruction, after which waitFrame() returns false.
+ */
+class FrameSubscription {
+public:
+    explicit FrameSubscription(const SubscriberConfig& config);
+
+    /**
+     * @brief Wait for the next frame
+     * LATEST: a frame newer than the last one returned. QUEUE: the oldest queued frame.
+     * @return false on timeout or once the subscription is closed
+     */
+    bool waitFrame(CapturedFramePtr& out, std::chrono::milliseconds timeout);
+
+    // Most recent frame without waiting (LATEST only; nullptr if none yet)
+    CapturedFramePtr latest();
+
+    void setRateDivisor(int divisor) { rate_divisor_ = divisor > 0 ? divisor : 1; }
+    int getRateDivisor() const { return rate_divisor_.load(); }
+
+    const SubscriberConfig& getConfig() const { return config_; }
+    bool isClosed() const { return closed_.load(); }
+    uint64_t getDelivered() const { return delivered_.load(); }
+    uint64_t getDropped() const;
+
+private:
+    friend class CaptureHub;
+
+    void deliver(const CapturedFramePtr& frame);
+    void close();
+    bool isDemanding() const;           // Consumer asked for a frame recently (keeps idle grabbing alive)
+    void touch();
+
+    const SubscriberConfig config_;
+    std::atomic<int> rate_divisor_;
+    std::atomic<bool> closed_{false};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<int64_t> last_demand_ms_{0};
+
+    // LATEST mailbox: the producer only swaps the slot, it never waits for the consumer
+    CapturedFramePtr latest_;           // Accessed with std::atomic_load/atomic_store
+    std::atomic<uint64_t> latest_seq_{0};
+    uint64_t taken_seq_{0};             // Consumer side only
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // QUEUE mailbox
+    std::unique_ptr<BoundedQueue<CapturedFramePtr>> queue_;
+};
+
+/**
+ * @brief Single point that fans grabbed frames out to recorders, writers and preview
+ *
+ * Exactly one thread grabs from the camera at a time. While a recorder is
+ * recording it holds the grab (acquireGrab) and calls publish() after each of
+ * its own grab() calls, so subscribers see the recording frame numbers. When
+ * nobody holds the grab and a subscriber is waiting for frames, the hub's own
+ * idle thread grabs (livestream preview before/between recordings).
+ *
+ * Subscribers never touch the camera: the hub retrieves image/depth/sensors
+ * once per frame, only if a subscriber due for that frame asked for it.
+ */
+class CaptureHub {
+public:
+    explicit CaptureHub(FrameSource& source);
+    ~CaptureHub();
+
+    CaptureHub(const CaptureHub&) = delete;
+    CaptureHub& operator=(const CaptureHub&) = delete;
+
+    std::shared_ptr<FrameSubscription> subscribe(const SubscriberConfig& config);
+    void unsubscribe(const std::shared_ptr<FrameSubscription>& subscription);
+
+    /**
+     * @brief Take over grab() for a recorder loop (blocks until an idle grab in progress finished)
+     */
+    void acquireGrab(const std::string& owner);
+    void releaseGrab();
+
+    /**
+     * @brief Hand the just-grabbed frame to all due subscribers (call on the grabbing thread)
+     * @param source Source that was grabbed (may differ from the hub's source in dual-camera mode)
+     */
+    PublishResult publish(FrameSource& source, uint64_t frame_number, bool corrupted, bool recording = true);
+
+    // Idle preview thread (started by the owning recorder after the camera is open)
+    void startIdleGrab();
+    void stopIdleGrab();
+
+    // True if any subscriber wants depth (grab owners should keep enable_depth on)
+    bool wantsDepth() const;
+
+    int getSourceFPS() const { return source_.getFPS(); }
+    uint64_t getPublishedFrames() const { return published_frames_.load(); }
+    uint64_t getIdleFrames() const { return idle_frames_.load(); }
+
+    // retrieveImage/retrieveMeasure/getSensorsData times inside publish() ("hub.*" stages)
+    LatencyReport getLatencyReport() const;
+    void resetLatency();
+
+private:
+    void idleLoop();
+    bool hasDemandLocked() const;
+
+    FrameSource& source_;
+
+    mutable std::mutex subscribers_mutex_;
+    std::vector<std::shared_ptr<FrameSubscription>> subscribers_;
+
+    // Grab ownership
+    std::mutex grab_mutex_;
+    std::condition_variable grab_cv_;
+    bool grab_leased_{false};
+    bool idle_grabbing_{false};
+    std::string grab_owner_;
+
+    std::unique_ptr<std::thread> idle_thread_;
+    std::atomic<bool> idle_running_{false};
+    uint64_t idle_sequence_{0};
+
+    ObjectPool<sl::Mat> image_pool_;
+    ObjectPool<sl::Mat> depth_pool_;
+
+    std::atomic<uint64_t> published_frames_{0};
+    std::atomic<uint64_t> idle_frames_{0};
+
+    LatencyHistogram retrieve_image_latency_;
+    LatencyHistogram retrieve_measure_latency_;
+    LatencyHistogram sensors_latency_;
+};
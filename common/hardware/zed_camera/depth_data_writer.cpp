@@ -3,6 +3,8 @@
 #include <chrono>
 #include <filesystem>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
@@ -10,7 +12,11 @@ DepthDataWriter::DepthDataWriter()
     : target_fps_(10)
     , running_(false)
     , frame_count_(0)
-    , current_fps_(0.0f) {
+    , current_fps_(0.0f)
+    , compression_ratio_(1.0f)
+    , codec_(DepthCodec::FLOAT32)
+    , write_queue_(WRITE_QUEUE_CAPACITY, BackpressurePolicy::DROP_NEWEST)
+    , depth_buffers_([] { return std::make_unique<std::vector<float>>(); }, WRITE_QUEUE_CAPACITY + 1) {
 }
 
 DepthDataWriter::~DepthDataWriter() {
@@ -30,26 +36,87 @@ bool DepthDataWriter::init(const std::string& output_dir, int target_fps) {
         return false;
     }
     
-    // Initialize depth matrix for retrieval
-    runtime_params_.enable_depth = true;
-    runtime_params_.confidence_threshold = 50;
-    runtime_params_.texture_confidence_threshold = 100;
-    
     std::cout << "[DEPTH_DATA] Initialized (target " << target_fps << " FPS)" << std::endl;
     return true;
 }
 
-void DepthDataWriter::start(sl::Camera& zed) {
+void DepthDataWriter::setCodec(DepthCodec codec) {
     if (running_) {
-        std::cout << "[DEPTH_DATA] Already running" << std::endl;
+        std::cerr << "[DEPTH_DATA] Cannot change codec while running" << std::endl;
+        return;
+    }
+    codec_ = codec;
+    std::cout << "[DEPTH_DATA] Codec: " << depth_codec::codecName(codec) << std::endl;
+}
+
+void DepthDataWriter::setDownsample(int scale, DepthPooling pooling) {
+    if (running_) {
+        std::cerr << "[DEPTH_DATA] Cannot change depth resolution while running" << std::endl;
         return;
     }
+    if (!depth_downsample::isValidScale(scale)) {
+        std::cerr << "[DEPTH_DATA] Invalid depth scale " << scale << " (1, 2 or 4)" << std::endl;
+        return;
+    }
+    downsampler_ = DepthDownsampler({scale, pooling});
+    std::cout << "[DEPTH_DATA] Depth resolution: " << depth_downsample::scaleName(scale);
+    if (scale > 1) {
+        std::cout << " (" << depth_downsample::poolingName(pooling) << " pooling)";
+    }
+    std::cout << std::endl;
+}
+
+bool DepthDataWriter::start(CaptureHub& hub) {
+    if (running_) {
+        std::cout << "[DEPTH_DATA] Already running" << std::endl;
+        return true;
+    }
+    
+    const DepthDownsampler::Config& downsample = downsampler_.getConfig();
+    if (!stream_.open(getStreamPath(), codec_, downsample.scale, downsample.pooling)) {
+        std::cerr << "[DEPTH_DATA] Failed to create depth stream: " << getStreamPath() << std::endl;
+        return false;
+    }
+    
+    // Every n-th recording frame instead of a timer: exact frame numbers, no polling
+    int source_fps = hub.getSourceFPS();
+    int divisor = 1;
+    if (target_fps_ > 0 && source_fps > target_fps_) {
+        divisor = static_cast<int>(std::lround(static_cast<double>(source_fps) / target_fps_));
+    }
+    
+    SubscriberConfig config;
+    config.name = "depth_data";
+    config.rate_divisor = std::max(1, divisor);
+    config.depth = true;
+    config.recording_only = true;
+    config.mailbox = MailboxType::QUEUE;
+    config.queue_capacity = 3;
+    config.policy = BackpressurePolicy::DROP_OLDEST;
+    
+    hub_ = &hub;
+    subscription_ = hub.subscribe(config);
     
     running_ = true;
     frame_count_ = 0;
+    frames_captured_ = 0;
+    frames_dropped_backpressure_ = 0;
+    frames_dropped_hub_ = 0;
+    write_errors_ = 0;
+    compression_ratio_ = 1.0f;
+    encoder_.resetStats();
+    frame_age_latency_.reset();
+    queue_wait_latency_.reset();
+    encode_latency_.reset();
+    save_latency_.reset();
+    written_latency_.reset();
+    write_queue_.reopen();
     
-    capture_thread_ = std::make_unique<std::thread>(&DepthDataWriter::captureLoop, this, &zed);
-    std::cout << "[DEPTH_DATA] Capture thread started (target " << target_fps_ << " FPS)" << std::endl;
+    writer_thread_ = std::make_unique<std::thread>(&DepthDataWriter::writerLoop, this);
+    capture_thread_ = std::make_unique<std::thread>(&DepthDataWriter::captureLoop, this);
+    std::cout << "[DEPTH_DATA] Capture + writer threads started (every " << config.rate_divisor << ". frame of "
+              << source_fps << " FPS, target " << target_fps_ << " FPS)" << std::endl;
+    return true;
 }
 
 void DepthDataWriter::stop() {
@@ -59,100 +126,206 @@ void DepthDataWriter::stop() {
     
     running_ = false;
     
+    // Closing the subscription wakes the capture thread
+    if (hub_ && subscription_) {
+        hub_->unsubscribe(subscription_);
+    }
+    
     if (capture_thread_ && capture_thread_->joinable()) {
         capture_thread_->join();
     }
-    
-    std::cout << "[DEPTH_DATA] Stopped. Total frames: " << frame_count_.load() << std::endl;
-}
-
-void DepthDataWriter::captureLoop(sl::Camera* zed) {
-    if (!zed) {
-        std::cerr << "[DEPTH_DATA] Invalid camera pointer!" << std::endl;
-        return;
+    if (subscription_) {
+        frames_dropped_hub_ = static_cast<long>(subscription_->getDropped());
     }
     
-    auto last_capture = std::chrono::steady_clock::now();
-    int capture_interval_ms = (target_fps_ > 0) ? (1000 / target_fps_) : 100;  // Default 100ms if no FPS set
+    // The writer keeps popping until the closed queue is empty - queued frames still reach the stream
+    size_t pending = write_queue_.size();
+    if (pending > 0) {
+        std::cout << "[DEPTH_DATA] Writing " << pending << " queued frames..." << std::endl;
+    }
+    write_queue_.close();
+    if (writer_thread_ && writer_thread_->joinable()) {
+        writer_thread_->join();
+    }
+    stream_.close();    // Index + footer; without them depth_viewer rebuilds the index by scanning
     
-    auto fps_start = std::chrono::steady_clock::now();
-    int fps_frame_count = 0;
+    DepthWriterStats stats = getStats();
+    std::cout << "[DEPTH_DATA] Stopped. Total frames: " << frame_count_.load();
+    if (codec_ != DepthCodec::FLOAT32) {
+        std::cout << " (compression " << compression_ratio_.load() << "x)";
+    }
+    if (stats.frames_dropped_backpressure > 0 || stats.frames_dropped_hub > 0) {
+        std::cout << " (" << stats.frames_dropped_backpressure << " dropped - write queue full, "
+                  << stats.frames_dropped_hub << " dropped in hub)";
+    }
+    if (stats.write_errors > 0) {
+        std::cout << " (" << stats.write_errors << " write errors)";
+    }
+    std::cout << " | write queue high water " << stats.queue_high_water << "/" << WRITE_QUEUE_CAPACITY << std::endl;
     
-    std::cout << "[DEPTH_DATA] Capture loop started (target FPS: " << target_fps_ 
-              << ", interval: " << capture_interval_ms << "ms)" << std::endl;
+    subscription_.reset();
+    hub_ = nullptr;
+}
+
+void DepthDataWriter::captureLoop() {
+    std::cout << "[DEPTH_DATA] Capture loop started (target FPS: " << target_fps_ << ")" << std::endl;
     
+    size_t buffer_floats = 0;
+    CapturedFramePtr frame;
     while (running_) {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_capture).count();
-        
-        // Skip this iteration if not enough time has passed (non-blocking FPS control)
-        if (elapsed < capture_interval_ms) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));  // Short sleep, don't block recording
+        if (!subscription_->waitFrame(frame, std::chrono::milliseconds(100))) {
+            if (subscription_->isClosed()) {
+                break;
+            }
+            continue;
+        }
+        // Depth not computed for this frame (e.g. recorder running without depth mode)
+        if (!frame->depth) {
             continue;
         }
         
-        last_capture = now;
+        auto pickup = std::chrono::steady_clock::now();
+        frame_age_latency_.record(pickup - frame->capture_time);
+        frames_dropped_hub_ = static_cast<long>(subscription_->getDropped());
         
-        // Retrieve depth map (non-blocking - uses already grabbed frame from main recording loop)
-        sl::ERROR_CODE err = zed->retrieveMeasure(depth_mat_, sl::MEASURE::DEPTH, sl::MEM::CPU);
-        if (err == sl::ERROR_CODE::SUCCESS) {
-            int frame_num = frame_count_.fetch_add(1);
-            
-            // Save asynchronously if possible (current impl is sync, could be optimized later)
-            if (saveDepthFrame(depth_mat_, frame_num)) {
-                fps_frame_count++;
-                
-                // Update FPS every second
-                auto fps_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - fps_start).count();
-                if (fps_elapsed >= 1000) {
-                    current_fps_ = (fps_frame_count * 1000.0f) / fps_elapsed;
-                    std::cout << "[DEPTH_DATA] Current FPS: " << current_fps_ << " (target: " << target_fps_ << ")" << std::endl;
-                    fps_frame_count = 0;
-                    fps_start = now;
-                }
-            } else {
-                std::cerr << "[DEPTH_DATA] Failed to save frame " << frame_num << std::endl;
+        const sl::Mat& depth = *frame->depth;
+        const int width = downsampler_.outputWidth(static_cast<int>(depth.getWidth()));
+        const int height = downsampler_.outputHeight(static_cast<int>(depth.getHeight()));
+        const size_t floats = static_cast<size_t>(width) * height;
+        
+        // Size every pooled buffer on the first frame so a later stall never allocates
+        if (floats != buffer_floats) {
+            std::vector<std::shared_ptr<std::vector<float>>> warm;
+            while (auto buffer = depth_buffers_.acquire()) {
+                buffer->resize(floats);
+                warm.push_back(std::move(buffer));
             }
+            buffer_floats = floats;
+        }
+        
+        // Writer behind by a full queue: drop before copying, keep picking up at the hub rate
+        std::shared_ptr<std::vector<float>> buffer = depth_buffers_.acquire();
+        if (!buffer) {
+            frames_dropped_backpressure_++;
+            frame.reset();
+            continue;
         }
-        // Note: retrieveMeasure may fail if no new frame available, which is normal
-        // Don't spam error messages for that case
+        buffer->resize(floats);
         
-        // Very short sleep to prevent CPU spinning
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Packed copy (scale 1) or pooled reduction - either way the hub buffer is read once
+        downsampler_.apply(depth.getPtr<sl::float1>(sl::MEM::CPU), static_cast<int>(depth.getWidth()),
+                           static_cast<int>(depth.getHeight()), depth.getStepBytes(sl::MEM::CPU), buffer->data());
+        
+        WriteJob job;
+        job.frame_number = frame->frame_number;
+        job.timestamp_ns = frame->timestamp_ns;
+        job.width = width;
+        job.height = height;
+        job.depth = std::move(buffer);
+        job.capture_time = frame->capture_time;
+        frame.reset();  // Return the depth buffer to the hub pool
+        
+        job.queued_time = std::chrono::steady_clock::now();
+        if (write_queue_.push(std::move(job))) {
+            frames_captured_++;
+        } else {
+            frames_dropped_backpressure_++;
+        }
     }
     
     std::cout << "[DEPTH_DATA] Capture loop ended" << std::endl;
 }
 
-bool DepthDataWriter::saveDepthFrame(const sl::Mat& depth, int frame_number) {
-    // Generate filename: depth_NNNNNN.depth
-    char filename[256];
-    snprintf(filename, sizeof(filename), "depth_%06d.depth", frame_number);
-    std::string filepath = output_dir_ + "/" + filename;
-    
-    // Open file for binary write
-    std::ofstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "[DEPTH_DATA] Failed to open file: " << filepath << std::endl;
-        return false;
-    }
-    
-    // Write header: width, height, frame_number (all 4 bytes each)
-    int width = depth.getWidth();
-    int height = depth.getHeight();
-    
-    file.write(reinterpret_cast<const char*>(&width), sizeof(int));
-    file.write(reinterpret_cast<const char*>(&height), sizeof(int));
-    file.write(reinterpret_cast<const char*>(&frame_number), sizeof(int));
-    
-    // Write depth data (32-bit floats)
-    // ZED depth is in meters, stored as float32
-    sl::float1* depth_ptr = depth.getPtr<sl::float1>();
-    size_t data_size = width * height * sizeof(float);
+void DepthDataWriter::writerLoop() {
+    auto fps_start = std::chrono::steady_clock::now();
+    int fps_frame_count = 0;
     
-    file.write(reinterpret_cast<const char*>(depth_ptr), data_size);
+    WriteJob job;
+    while (write_queue_.pop(job)) {
+        auto save_start = std::chrono::steady_clock::now();
+        queue_wait_latency_.record(save_start - job.queued_time);
+        
+        bool saved = saveDepthFrame(job);
+        auto now = std::chrono::steady_clock::now();
+        save_latency_.record(now - save_start);
+        if (saved) {
+            written_latency_.record(now - job.capture_time);
+            frame_count_++;
+            fps_frame_count++;
+            
+            // Update FPS every second
+            auto fps_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - fps_start).count();
+            if (fps_elapsed >= 1000) {
+                current_fps_ = (fps_frame_count * 1000.0f) / fps_elapsed;
+                std::cout << "[DEPTH_DATA] Current FPS: " << current_fps_ << " (target: " << target_fps_ << ")";
+                if (codec_ != DepthCodec::FLOAT32) {
+                    const DepthCodecStats& stats = encoder_.getStats();
+                    std::cout << " | " << depth_codec::codecName(codec_) << ": " << stats.ratio() << "x @ "
+                              << static_cast<int>(stats.mbPerSec()) << "MB/s";
+                }
+                long dropped = frames_dropped_backpressure_.load();
+                if (dropped > 0) {
+                    std::cout << " | queue " << write_queue_.size() << "/" << WRITE_QUEUE_CAPACITY
+                              << ", " << dropped << " dropped";
+                }
+                std::cout << std::endl;
+                fps_frame_count = 0;
+                fps_start = now;
+            }
+        } else {
+            write_errors_++;
+            std::cerr << "[DEPTH_DATA] Failed to save frame " << job.frame_number << std::endl;
+        }
+        
+        // Return the buffer to the pool before waiting for the next frame
+        job = WriteJob();
+    }
+}
+
+bool DepthDataWriter::saveDepthFrame(const WriteJob& job) {
+    const uint16_t width = static_cast<uint16_t>(job.width);
+    const uint16_t height = static_cast<uint16_t>(job.height);
+    const size_t row_bytes = job.width * sizeof(float);
     
-    file.close();
+    if (codec_ != DepthCodec::FLOAT32) {
+        // Compressed: self-describing depth_codec blob as the record payload
+        auto encode_start = std::chrono::steady_clock::now();
+        bool encoded = encoder_.encode(job.depth->data(), job.width, job.height, row_bytes,
+                                       codec_, static_cast<int>(job.frame_number));
+        encode_latency_.recordSince(encode_start);
+        if (!encoded) {
+            std::cerr << "[DEPTH_DATA] Failed to encode frame " << job.frame_number << ": "
+                      << encoder_.getLastError() << std::endl;
+            return false;
+        }
+        compression_ratio_ = static_cast<float>(encoder_.getStats().ratio());
+        return stream_.writeFrame(job.frame_number, job.timestamp_ns, width, height,
+                                  encoder_.data(), encoder_.size());
+    }
     
-    return true;
+    // Depth rows (32-bit floats, metres), already packed by the capture thread
+    return stream_.writeFrame(job.frame_number, job.timestamp_ns, width, height,
+                              reinterpret_cast<const uint8_t*>(job.depth->data()), row_bytes, job.height);
+}
+
+DepthWriterStats DepthDataWriter::getStats() const {
+    DepthWriterStats stats;
+    stats.frames_captured = frames_captured_.load();
+    stats.frames_written = frame_count_.load();
+    stats.frames_dropped_backpressure = frames_dropped_backpressure_.load();
+    stats.frames_dropped_hub = frames_dropped_hub_.load();
+    stats.write_errors = write_errors_.load();
+    stats.queue_depth = write_queue_.size();
+    stats.queue_high_water = write_queue_.highWater();
+    return stats;
+}
+
+LatencyReport DepthDataWriter::getLatencyReport() const {
+    return {
+        {"depth_writer.frame_age", frame_age_latency_.summary()},
+        {"depth_writer.queue_wait", queue_wait_latency_.summary()},
+        {"depth_writer.encode", encode_latency_.summary()},
+        {"depth_writer.save", save_latency_.summary()},
+        {"depth_writer.written", written_latency_.summary()},
+    };
 }
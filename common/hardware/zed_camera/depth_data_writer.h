@@ -1,20 +1,57 @@
 #pragma once
 
 #include <string>
-#include <fstream>
 #include <sl/Camera.hpp>
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <vector>
+#include <chrono>
+#include "depth_codec.h"
+#include "depth_downsample.h"
+#include "depth_stream.h"
+#include "capture_hub.h"
+#include "bounded_queue.h"
+#include "object_pool.h"
+#include "latency_histogram.h"
 
 /**
- * @brief Saves raw 32-bit depth data to binary files
+ * @brief Counters of the depth capture -> write pipeline
+ */
+struct DepthWriterStats {
+    long frames_captured = 0;           // Copied off the hub and queued for writing
+    long frames_written = 0;            // Appended to depth.dsf
+    long frames_dropped_backpressure = 0;   // Write queue full (USB stall) - frame not copied
+    long frames_dropped_hub = 0;        // Overwritten in the hub subscription before pickup
+    long write_errors = 0;              // Encode or stream write failed
+    size_t queue_depth = 0;             // Frames waiting for the writer thread
+    size_t queue_high_water = 0;        // Max queue length seen
+};
+
+/**
+ * @brief Saves raw 32-bit depth data to one depth stream per recording
  * 
- * Format: .depth files containing:
- * - Header: width (4 bytes), height (4 bytes), frame_number (4 bytes)
- * - Data: width * height * sizeof(float) bytes of depth values in meters
+ * Format: <output_dir>/depth.dsf (see depth_stream.h) - one record per frame
+ * with recorder frame number, ZED timestamp and width * height float32 metres,
+ * plus an index written at stop(). The file grows in fallocate() steps, so
+ * the stick sees sequential appends instead of one file per frame.
  * 
  * This format is MUCH faster than PNG encoding and preserves full 32-bit precision.
+ * 
+ * With a compressed codec (setCodec) each record holds a depth_codec blob
+ * instead (DepthBlobHeader with magic "DPC1" + payload); depth_viewer reads both.
+ *
+ * setDownsample() stores 1/2 or 1/4 resolution maps (NaN-aware block pooling
+ * in the capture thread); the factor and pooling go into the stream header.
+ *
+ * Depth maps come from a CaptureHub subscription (every n-th recording frame),
+ * so records carry the exact recorder frame number.
+ *
+ * Two threads: the capture thread copies each depth map into a pre-sized
+ * pooled buffer and hands the hub buffer straight back; the writer thread
+ * encodes and appends. A USB write stall therefore fills the bounded write
+ * queue instead of delaying pickup - once it is full, new frames are dropped
+ * (and counted) without being copied until the writer catches up.
  */
 class DepthDataWriter {
 public:
@@ -23,23 +60,42 @@ public:
     
     /**
      * @brief Initialize depth data writer
-     * @param output_dir Directory where .depth files will be saved
-     * @param target_fps Target FPS for depth capture (0 = every frame)
+     * @param output_dir Directory where depth.dsf will be written
+     * @param target_fps Target FPS for depth capture (0 = every frame; rounded to a divisor of the camera FPS)
      * @return true if initialization successful
      */
     bool init(const std::string& output_dir, int target_fps = 10);
     
     /**
-     * @brief Start depth data capture thread
-     * @param zed Reference to ZED camera for depth retrieval
+     * @brief Select the depth codec (before start(), default FLOAT32 legacy format)
+     */
+    void setCodec(DepthCodec codec);
+    DepthCodec getCodec() const { return codec_; }
+    
+    /**
+     * @brief Select the stored depth resolution (before start(), default full resolution)
+     * @param scale 1 (full), 2 (half) or 4 (quarter) per axis
      */
-    void start(sl::Camera& zed);
+    void setDownsample(int scale, DepthPooling pooling);
+    int getDepthScale() const { return downsampler_.getConfig().scale; }
     
     /**
-     * @brief Stop depth data capture
+     * @brief Create the depth stream, subscribe to the hub and start the capture thread
+     * @param hub Capture hub of the active recorder (depth of recording frames only)
+     * @return false if the stream file could not be created
+     */
+    bool start(CaptureHub& hub);
+    
+    /**
+     * @brief Stop depth data capture and close the stream (index + footer)
      */
     void stop();
     
+    /**
+     * @brief Path of the depth stream (valid after init())
+     */
+    std::string getStreamPath() const { return output_dir_ + "/depth.dsf"; }
+    
     /**
      * @brief Get current frame number
      */
@@ -50,19 +106,72 @@ public:
      */
     float getCurrentFPS() const { return current_fps_.load(); }
     
+    /**
+     * @brief Compression ratio (float32 bytes / written bytes) of the current capture
+     */
+    float getCompressionRatio() const { return compression_ratio_.load(); }
+    
+    /**
+     * @brief Capture/write/drop counters of the current (or last) capture
+     */
+    DepthWriterStats getStats() const;
+    
+    /**
+     * @brief Frame age at pickup, write queue wait, codec time, stream append time
+     *        and capture -> written latency since start()
+     */
+    LatencyReport getLatencyReport() const;
+    
+    // Frames the write queue can hold (~3.7 MB each at HD720) - ~0.8 s of USB stall at 10 FPS
+    static constexpr size_t WRITE_QUEUE_CAPACITY = 8;
+    
 private:
-    void captureLoop(sl::Camera* zed);
-    bool saveDepthFrame(const sl::Mat& depth, int frame_number);
+    /**
+     * @brief One depth map copied off the hub, waiting for the writer thread
+     */
+    struct WriteJob {
+        uint64_t frame_number = 0;
+        uint64_t timestamp_ns = 0;                      // ZED image timestamp
+        int width = 0;                                  // Stored size (reduced when downsampling)
+        int height = 0;
+        std::shared_ptr<std::vector<float>> depth;      // Packed rows (no sl::Mat padding), pooled
+        std::chrono::steady_clock::time_point capture_time;    // Hub publish
+        std::chrono::steady_clock::time_point queued_time;     // Copy done, handed to the writer
+    };
+    
+    void captureLoop();
+    void writerLoop();
+    bool saveDepthFrame(const WriteJob& job);
     
     std::string output_dir_;
     int target_fps_;
     std::atomic<bool> running_;
     std::atomic<int> frame_count_;
     std::atomic<float> current_fps_;
+    std::atomic<float> compression_ratio_;
+    
+    DepthCodec codec_;
+    DepthDownsampler downsampler_;  // Only used by the capture thread (copy + pooling in one pass)
+    DepthEncoder encoder_;          // Only used by the writer thread
+    DepthStreamWriter stream_;      // Written by the writer thread, opened/closed by start()/stop()
+    
+    BoundedQueue<WriteJob> write_queue_;
+    ObjectPool<std::vector<float>> depth_buffers_;  // Queue capacity + the one being written
+    
+    std::atomic<long> frames_captured_{0};
+    std::atomic<long> frames_dropped_backpressure_{0};
+    std::atomic<long> frames_dropped_hub_{0};     // Mirror of the subscription's drop count
+    std::atomic<long> write_errors_{0};
+    
+    LatencyHistogram frame_age_latency_;    // Hub publish -> capture thread pickup
+    LatencyHistogram queue_wait_latency_;   // Queued -> writer thread pickup
+    LatencyHistogram encode_latency_;
+    LatencyHistogram save_latency_;         // encode + append to the stream
+    LatencyHistogram written_latency_;      // Hub publish -> record appended
     
     std::unique_ptr<std::thread> capture_thread_;
+    std::unique_ptr<std::thread> writer_thread_;
     
-    // Depth retrieval configuration
-    sl::Mat depth_mat_;
-    sl::RuntimeParameters runtime_params_;
+    CaptureHub* hub_{nullptr};
+    std::shared_ptr<FrameSubscription> subscription_;
 };
@@ -0,0 +1,158 @@
+#include "frame_encoder_pool.h"
+#include <iostream>
+#include <algorithm>
+
+FrameEncoderPool::FrameEncoderPool(const Config& config, FrameWriter writer)
+    : config_(config),
+      writer_(std::move(writer)),
+      queue_(config.queue_capacity, config.policy),
+      // Enough buffers for every queued frame, one per busy worker, plus the one being grabbed
+      image_buffers_([] { return std::make_unique<sl::Mat>(); },
+                     2 * (config.queue_capacity + static_cast<size_t>(std::max(1, config.num_workers)) + 1)),
+      depth_buffers_([] { return std::make_unique<sl::Mat>(); },
+                     config.queue_capacity + static_cast<size_t>(std::max(1, config.num_workers)) + 1) {
+    if (config_.num_workers < 1) {
+        config_.num_workers = 1;
+    }
+}
+
+FrameEncoderPool::~FrameEncoderPool() {
+    stop();
+}
+
+void FrameEncoderPool::start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    queue_.reopen();
+
+    for (int i = 0; i < config_.num_workers; i++) {
+        workers_.emplace_back(&FrameEncoderPool::workerLoop, this);
+    }
+
+    const char* policy_name = config_.policy == BackpressurePolicy::BLOCK ? "BLOCK" :
+                              config_.policy == BackpressurePolicy::DROP_OLDEST ? "DROP_OLDEST" : "DROP_NEWEST";
+    std::cout << "[ENCODER_POOL] Started " << config_.num_workers << " workers, queue capacity "
+              << config_.queue_capacity << ", policy " << policy_name << std::endl;
+}
+
+void FrameEncoderPool::stop() {
+    if (!running_) {
+        return;
+    }
+
+    size_t pending = queue_.size();
+    if (pending > 0) {
+        std::cout << "[ENCODER_POOL] Draining " << pending << " queued frames..." << std::endl;
+    }
+
+    // Workers keep popping until the closed queue is empty
+    queue_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    running_ = false;
+
+    EncoderPoolStats stats = getStats();
+    std::cout << "[ENCODER_POOL] Stopped: " << stats.frames_completed << " written, "
+              << stats.frames_dropped << " dropped, " << stats.write_errors << " write errors, "
+              << "queue high water " << stats.queue_high_water << "/" << config_.queue_capacity << std::endl;
+}
+
+std::shared_ptr<sl::Mat> FrameEncoderPool::acquireImageBuffer() {
+    return image_buffers_.acquire();
+}
+
+std::shared_ptr<sl::Mat> FrameEncoderPool::acquireDepthBuffer() {
+    return depth_buffers_.acquire();
+}
+
+bool FrameEncoderPool::submit(RawFrameJob&& job) {
+    job.enqueue_time = std::chrono::steady_clock::now();
+    if (queue_.push(std::move(job))) {
+        frames_submitted_++;
+        return true;
+    }
+    // DROP_NEWEST drops are counted by the queue itself
+    if (queue_.isClosed()) {
+        frames_dropped_++;
+    }
+    return false;
+}
+
+void FrameEncoderPool::workerLoop() {
+    RawFrameJob job;
+    while (queue_.pop(job)) {
+        auto picked_up = std::chrono::steady_clock::now();
+        auto queue_wait = std::chrono::duration_cast<std::chrono::microseconds>(picked_up - job.enqueue_time);
+        queue_wait_us_ += queue_wait.count();
+        queue_wait_latency_.record(queue_wait);
+
+        RawFrameTimings timings;
+        if (!writer_(job, timings)) {
+            write_errors_++;
+        }
+        auto write_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - picked_up);
+        write_us_ += write_time.count();
+        write_latency_.record(write_time);
+        encode_us_ += static_cast<uint64_t>(timings.encode_ms * 1000.0);
+        encode_latency_.record(static_cast<uint64_t>(timings.encode_ms * 1000.0));
+        if (job.depth) {
+            depth_us_ += static_cast<uint64_t>(timings.depth_ms * 1000.0);
+            depth_latency_.record(static_cast<uint64_t>(timings.depth_ms * 1000.0));
+            depth_encode_us_ += static_cast<uint64_t>(timings.depth_encode_ms * 1000.0);
+            depth_raw_bytes_ += timings.depth_raw_bytes;
+            depth_encoded_bytes_ += timings.depth_encoded_bytes;
+            depth_frames_++;
+        }
+        frames_completed_++;
+
+        // Return buffers to the pools before waiting for the next job
+        job = RawFrameJob();
+    }
+}
+
+EncoderPoolStats FrameEncoderPool::getStats() const {
+    EncoderPoolStats stats;
+    stats.frames_submitted = frames_submitted_.load();
+    stats.frames_completed = frames_completed_.load();
+    stats.frames_dropped = frames_dropped_.load() + static_cast<long>(queue_.dropped());
+    stats.write_errors = write_errors_.load();
+    stats.queue_depth = queue_.size();
+    stats.queue_high_water = queue_.highWater();
+    stats.buffers_allocated = image_buffers_.created() + depth_buffers_.created();
+
+    long completed = stats.frames_completed;
+    long depth_frames = depth_frames_.load();
+    if (completed > 0) {
+        stats.avg_queue_wait_ms = queue_wait_us_.load() / 1000.0 / completed;
+        stats.avg_encode_ms = encode_us_.load() / 1000.0 / completed;
+        stats.avg_write_ms = write_us_.load() / 1000.0 / completed;
+    }
+    if (depth_frames > 0) {
+        stats.avg_depth_ms = depth_us_.load() / 1000.0 / depth_frames;
+    }
+    uint64_t depth_encoded = depth_encoded_bytes_.load();
+    if (depth_encoded > 0) {
+        stats.depth_compression_ratio = static_cast<double>(depth_raw_bytes_.load()) / depth_encoded;
+    }
+    uint64_t depth_encode_us = depth_encode_us_.load();
+    if (depth_encode_us > 0) {
+        stats.depth_encode_mb_per_sec = depth_raw_bytes_.load() / (1024.0 * 1024.0) / (depth_encode_us / 1e6);
+    }
+    return stats;
+}
+
+LatencyReport FrameEncoderPool::getLatencyReport() const {
+    return {
+        {"encoder.queue_wait", queue_wait_latency_.summary()},
+        {"encoder.encode", encode_latency_.summary()},
+        {"encoder.depth", depth_latency_.summary()},
+        {"encoder.write", write_latency_.summary()},
+    };
+}
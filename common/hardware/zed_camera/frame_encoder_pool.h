@@ -0,0 +1,135 @@
+#pragma once
+
+#include <sl/Camera.hpp>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include "bounded_queue.h"
+#include "object_pool.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief One grabbed RAW frame waiting to be encoded/written
+ *
+ * Buffers come from FrameEncoderPool and return to it when the job is destroyed.
+ */
+struct RawFrameJob {
+    long frame_number = 0;
+    uint64_t timestamp_ns = 0;          // ZED image timestamp
+    bool corrupted = false;             // grab() returned CORRUPTED_FRAME
+    std::shared_ptr<sl::Mat> left;      // nullptr if retrieval failed
+    std::shared_ptr<sl::Mat> right;
+    std::shared_ptr<sl::Mat> depth;     // nullptr when depth is disabled
+    std::chrono::steady_clock::time_point enqueue_time;
+};
+
+/**
+ * @brief Stage times reported by the frame writer for one job
+ */
+struct RawFrameTimings {
+    double encode_ms = 0.0;             // Left + right JPEG
+    double depth_ms = 0.0;              // Depth encode + write
+    double depth_encode_ms = 0.0;       // Depth codec only
+    size_t depth_raw_bytes = 0;         // float32 size of the depth map
+    size_t depth_encoded_bytes = 0;     // Size after the depth codec
+};
+
+/**
+ * @brief Per-stage counters of the RAW encode pipeline
+ */
+struct EncoderPoolStats {
+    long frames_submitted = 0;      // Accepted by submit()
+    long frames_completed = 0;      // Fully written by a worker
+    long frames_dropped = 0;        // Discarded by backpressure or buffer exhaustion
+    long write_errors = 0;          // Failed image/depth writes
+    size_t queue_depth = 0;         // Current queue length
+    size_t queue_high_water = 0;    // Max queue length seen
+    size_t buffers_allocated = 0;   // Pooled sl::Mat buffers created (image + depth)
+    double avg_queue_wait_ms = 0.0; // submit() -> worker pickup
+    double avg_encode_ms = 0.0;     // Left + right JPEG per frame
+    double avg_depth_ms = 0.0;      // Depth write per frame
+    double avg_write_ms = 0.0;      // Whole job (encode + depth + container/file I/O)
+    double depth_compression_ratio = 0.0;   // float32 bytes / encoded bytes
+    double depth_encode_mb_per_sec = 0.0;   // float32 MB per second of depth codec time
+};
+
+/**
+ * @brief Bounded queue + N worker threads that encode and write RAW frames
+ *
+ * The grab thread retrieves into pooled buffers (acquireImageBuffer/acquireDepthBuffer)
+ * and submit()s a job; workers run the frame writer off the grab thread.
+ * With BLOCK the grab thread waits for a free slot, the DROP_* policies
+ * discard frames instead and count them.
+ */
+class FrameEncoderPool {
+public:
+    struct Config {
+        int num_workers = 4;                // Orin Nano: 6 cores - leave grab + system threads room
+        size_t queue_capacity = 8;          // Frames (HD720 BGRA L+R+depth ~11MB each)
+        BackpressurePolicy policy = BackpressurePolicy::BLOCK;
+    };
+
+    // Encodes and stores one frame, reporting per-stage times; false on write error
+    using FrameWriter = std::function<bool(const RawFrameJob& job, RawFrameTimings& timings)>;
+
+    FrameEncoderPool(const Config& config, FrameWriter writer);
+    ~FrameEncoderPool();
+
+    // Start worker threads
+    void start();
+
+    // Close the queue, let workers finish all queued frames, join them
+    void stop();
+
+    // Pooled buffers for the grab thread (nullptr if all buffers are in flight)
+    std::shared_ptr<sl::Mat> acquireImageBuffer();
+    std::shared_ptr<sl::Mat> acquireDepthBuffer();
+
+    // Queue a frame - false if it was dropped
+    bool submit(RawFrameJob&& job);
+
+    // Count a frame the producer had to skip (e.g. no buffer available)
+    void recordDrop() { frames_dropped_++; }
+
+    EncoderPoolStats getStats() const;
+
+    // Per-job stage distributions ("encoder.*" stages)
+    LatencyReport getLatencyReport() const;
+    const Config& getConfig() const { return config_; }
+
+private:
+    void workerLoop();
+
+    Config config_;
+    FrameWriter writer_;
+
+    BoundedQueue<RawFrameJob> queue_;
+    ObjectPool<sl::Mat> image_buffers_;
+    ObjectPool<sl::Mat> depth_buffers_;
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+
+    // Counters (microsecond totals for averaging)
+    std::atomic<long> frames_submitted_{0};
+    std::atomic<long> frames_completed_{0};
+    std::atomic<long> frames_dropped_{0};
+    std::atomic<long> write_errors_{0};
+    std::atomic<long> depth_frames_{0};
+    std::atomic<uint64_t> queue_wait_us_{0};
+    std::atomic<uint64_t> encode_us_{0};
+    std::atomic<uint64_t> depth_us_{0};
+    std::atomic<uint64_t> write_us_{0};
+    std::atomic<uint64_t> depth_encode_us_{0};
+    std::atomic<uint64_t> depth_raw_bytes_{0};
+    std::atomic<uint64_t> depth_encoded_bytes_{0};
+
+    LatencyHistogram queue_wait_latency_;
+    LatencyHistogram encode_latency_;
+    LatencyHistogram depth_latency_;
+    LatencyHistogram write_latency_;
+};
@@ -0,0 +1,512 @@
+#include "frame_source.h"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// ZedFrameSource
+// ============================================================================
+
+int ZedFrameSource::getWidth() const {
+    return static_cast<int>(const_cast<sl::Camera&>(zed_).getCameraInformation().camera_configuration.resolution.width);
+}
+
+int ZedFrameSource::getHeight() const {
+    return static_cast<int>(const_cast<sl::Camera&>(zed_).getCameraInformation().camera_configuration.resolution.height);
+}
+
+int ZedFrameSource::getFPS() const {
+    return static_cast<int>(const_cast<sl::Camera&>(zed_).getCameraInformation().camera_configuration.fps);
+}
+
+sl::ERROR_CODE ZedFrameSource::grab(const sl::RuntimeParameters& params) {
+    return zed_.grab(params);
+}
+
+sl::ERROR_CODE ZedFrameSource::retrieveImage(sl::Mat& image, sl::VIEW view) {
+    return zed_.retrieveImage(image, view, sl::MEM::CPU);
+}
+
+sl::ERROR_CODE ZedFrameSource::retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) {
+    return zed_.retrieveMeasure(measure, measure_type, sl::MEM::CPU);
+}
+
+sl::ERROR_CODE ZedFrameSource::getSensorsData(sl::SensorsData& data, sl::TIME_REFERENCE reference) {
+    return zed_.getSensorsData(data, reference);
+}
+
+sl::Timestamp ZedFrameSource::getImageTimestamp() {
+    return zed_.getTimestamp(sl::TIME_REFERENCE::IMAGE);
+}
+
+// ============================================================================
+// OfflineFrameSource - pacing, timestamps, fault injection, synthetic sensors
+// ============================================================================
+
+OfflineFrameSource::OfflineFrameSource(const OfflineSourceTiming& timing)
+    : timing_(timing), rng_(timing.seed) {
+    if (timing_.fps <= 0) {
+        timing_.fps = 30;
+    }
+}
+
+sl::ERROR_CODE OfflineFrameSource::grab(const sl::RuntimeParameters& /*params*/) {
+    if (timing_.max_frames > 0 && frame_index_ + 1 >= timing_.max_frames) {
+        return sl::ERROR_CODE::END_OF_SVOFILE_REACHED;
+    }
+
+    if (!started_) {
+        next_deadline_ = std::chrono::steady_clock::now();
+        start_timestamp_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        image_timestamp_ns_ = start_timestamp_ns_.load();
+        started_ = true;  // After the timestamps - getSensorsData() may run on another thread
+    } else {
+        // Frame interval with optional uniform jitter (deterministic for a given seed)
+        int64_t interval_us = 1000000 / timing_.fps;
+        if (timing_.jitter_ms > 0) {
+            std::uniform_int_distribution<int64_t> jitter(-timing_.jitter_ms * 1000LL, timing_.jitter_ms * 1000LL);
+            interval_us = std::max<int64_t>(1000, interval_us + jitter(rng_));
+        }
+        next_deadline_ += std::chrono::microseconds(interval_us);
+        image_timestamp_ns_ += static_cast<uint64_t>(interval_us) * 1000ULL;
+    }
+
+    if (timing_.realtime) {
+        std::this_thread::sleep_until(next_deadline_);
+    }
+
+    frame_index_++;
+    if (!produceFrame(frame_index_)) {
+        return sl::ERROR_CODE::END_OF_SVOFILE_REACHED;
+    }
+
+    // Injected CORRUPTED_FRAME: data is still retrievable (same as the SDK behaviour)
+    if (timing_.corrupt_every_n > 0 && (frame_index_ + 1) % timing_.corrupt_every_n == 0) {
+        return sl::ERROR_CODE::CORRUPTED_FRAME;
+    }
+
+    return sl::ERROR_CODE::SUCCESS;
+}
+
+sl::ERROR_CODE OfflineFrameSource::getSensorsData(sl::SensorsData& data, sl::TIME_REFERENCE /*reference*/) {
+    if (!started_) {
+        return sl::ERROR_CODE::SENSORS_DATA_REQUIRED;
+    }
+
+    // Gentle deterministic motion: slow yaw, small roll/pitch oscillation
+    const uint64_t timestamp_ns = image_timestamp_ns_.load();
+    double t = static_cast<double>(timestamp_ns - start_timestamp_ns_.load()) / 1e9;
+    float roll = static_cast<float>(0.05 * std::sin(t * 1.3));
+    float pitch = static_cast<float>(0.04 * std::sin(t * 0.7));
+    float yaw = static_cast<float>(0.1 * t);
+
+    float cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+    float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+    float cy = std::cos(yaw * 0.5f), sy = std::sin(yaw * 0.5f);
+
+    sl::Orientation orientation;
+    orientation.ox = sr * cp * cy - cr * sp * sy;
+    orientation.oy = cr * sp * cy + sr * cp * sy;
+    orientation.oz = cr * cp * sy - sr * sp * cy;
+    orientation.ow = cr * cp * cy + sr * sp * sy;
+
+    data.imu.is_available = true;
+    data.imu.timestamp = sl::Timestamp(timestamp_ns);
+    data.imu.pose.setOrientation(orientation);
+    data.imu.linear_acceleration.x = static_cast<float>(0.2 * std::sin(t * 2.1));
+    data.imu.linear_acceleration.y = -9.81f + static_cast<float>(0.1 * std::cos(t * 1.7));
+    data.imu.linear_acceleration.z = static_cast<float>(0.15 * std::sin(t * 0.9));
+    data.imu.angular_velocity.x = static_cast<float>(3.0 * std::cos(t * 1.3));
+    data.imu.angular_velocity.y = static_cast<float>(1.6 * std::cos(t * 0.7));
+    data.imu.angular_velocity.z = 5.7f;
+
+    data.magnetometer.is_available = true;
+    data.magnetometer.timestamp = sl::Timestamp(timestamp_ns);
+    data.magnetometer.magnetic_field_calibrated.x = static_cast<float>(20.0 * std::cos(yaw));
+    data.magnetometer.magnetic_field_calibrated.y = static_cast<float>(-20.0 * std::sin(yaw));
+    data.magnetometer.magnetic_field_calibrated.z = -42.0f;
+
+    data.barometer.is_available = true;
+    data.barometer.timestamp = sl::Timestamp(timestamp_ns);
+    data.barometer.pressure = 1013.25f - static_cast<float>(0.01 * t);
+
+    data.temperature.temperature_map[sl::SensorsData::TemperatureData::SENSOR_LOCATION::IMU] = 35.0f;
+
+    return sl::ERROR_CODE::SUCCESS;
+}
+
+// ============================================================================
+// SyntheticFrameSource
+// ============================================================================
+
+SyntheticFrameSource::SyntheticFrameSource(const SyntheticSourceConfig& config)
+    : OfflineFrameSource(config.timing), config_(config) {
+    if (config_.pattern == SyntheticPattern::NOISE) {
+        // 256x256 tile, scrolled per frame - generating full frames of noise would dominate the benchmark
+        std::mt19937 rng(config_.timing.seed);
+        noise_.resize(256 * 256);
+        for (auto& px : noise_) {
+            px = rng() | 0xFF000000u;
+        }
+    }
+
+    std::cout << "[FRAME_SOURCE] Synthetic source " << config_.width << "x" << config_.height
+              << " @ " << config_.timing.fps << " FPS"
+              << (config_.timing.realtime ? "" : " (unpaced)")
+              << ", jitter ±" << config_.timing.jitter_ms << "ms"
+              << ", corrupt every " << config_.timing.corrupt_every_n << std::endl;
+}
+
+bool SyntheticFrameSource::produceFrame(long /*frame_index*/) {
+    // Content is rendered lazily in retrieveImage()/retrieveMeasure() so the cost
+    // of the copy lands where the real SDK spends it
+    return true;
+}
+
+sl::ERROR_CODE SyntheticFrameSource::retrieveImage(sl::Mat& image, sl::VIEW view) {
+    if (view != sl::VIEW::LEFT && view != sl::VIEW::RIGHT) {
+        return sl::ERROR_CODE::FAILURE;
+    }
+
+    if (!image.isInit() || static_cast<int>(image.getWidth()) != config_.width ||
+        static_cast<int>(image.getHeight()) != config_.height) {
+        image.alloc(config_.width, config_.height, sl::MAT_TYPE::U8_C4, sl::MEM::CPU);
+    }
+
+    // Right view is the left view shifted by a constant disparity
+    renderImage(image, currentFrameIndex(), view == sl::VIEW::RIGHT ? 24 : 0);
+    return sl::ERROR_CODE::SUCCESS;
+}
+
+sl::ERROR_CODE SyntheticFrameSource::retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) {
+    if (!config_.with_depth || measure_type != sl::MEASURE::DEPTH) {
+        return sl::ERROR_CODE::FAILURE;
+    }
+
+    if (!measure.isInit() || static_cast<int>(measure.getWidth()) != config_.width ||
+        static_cast<int>(measure.getHeight()) != config_.height) {
+        measure.alloc(config_.width, config_.height, sl::MAT_TYPE::F32_C1, sl::MEM::CPU);
+    }
+
+    renderDepth(measure, currentFrameIndex());
+    return sl::ERROR_CODE::SUCCESS;
+}
+
+void SyntheticFrameSource::renderImage(sl::Mat& image, long frame_index, int disparity_px) {
+    uint8_t* base = image.getPtr<sl::uchar1>(sl::MEM::CPU);
+    size_t step = image.getStepBytes(sl::MEM::CPU);
+    const int w = config_.width;
+    const int h = config_.height;
+    const int shift = static_cast<int>(frame_index * 4) + disparity_px;
+
+    for (int y = 0; y < h; y++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(base + y * step);
+        switch (config_.pattern) {
+            case SyntheticPattern::GRADIENT:
+                for (int x = 0; x < w; x++) {
+                    uint32_t b = static_cast<uint32_t>((x + shift) & 0xFF);
+                    uint32_t g = static_cast<uint32_t>((y + (shift >> 1)) & 0xFF);
+                    uint32_t r = static_cast<uint32_t>(((x + y) >> 2) & 0xFF);
+                    row[x] = 0xFF000000u | (r << 16) | (g << 8) | b;
+                }
+                break;
+            case SyntheticPattern::CHECKERBOARD:
+                for (int x = 0; x < w; x++) {
+                    bool on = (((x + shift) >> 5) ^ (y >> 5)) & 1;
+                    row[x] = on ? 0xFFF0F0F0u : 0xFF101010u;
+                }
+                break;
+            case SyntheticPattern::NOISE: {
+                const uint32_t* tile_row = &noise_[((y + frame_index) & 0xFF) * 256];
+                for (int x = 0; x < w; x++) {
+                    row[x] = tile_row[(x + shift) & 0xFF];
+                }
+                break;
+            }
+        }
+    }
+}
+
+void SyntheticFrameSource::renderDepth(sl::Mat& depth, long frame_index) {
+    uint8_t* base = depth.getPtr<sl::uchar1>(sl::MEM::CPU);
+    size_t step = depth.getStepBytes(sl::MEM::CPU);
+    const int w = config_.width;
+    const int h = config_.height;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // Ground plane tilting away from the camera (near at the bottom, far at the top)
+    // with an occlusion hole (NaN) and a sky band (+inf) like real NEURAL output
+    const int hole_x = static_cast<int>((frame_index * 7) % std::max(1, w - w / 8));
+    for (int y = 0; y < h; y++) {
+        float* row = reinterpret_cast<float*>(base + y * step);
+        float row_depth = 1.5f + 18.0f * (1.0f - static_cast<float>(y) / h);
+        bool sky = y < h / 10;
+        bool hole_row = (y > h / 2) && (y < h / 2 + h / 10);
+        for (int x = 0; x < w; x++) {
+            if (sky) {
+                row[x] = inf;
+            } else if (hole_row && x >= hole_x && x < hole_x + w / 8) {
+                row[x] = nan;
+            } else {
+                row[x] = row_depth + 0.0005f * static_cast<float>(x);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// ReplayFrameSource
+// ============================================================================
+
+namespace {
+
+std::vector<std::string> listSorted(const std::string& dir, const std::string& suffix) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        return files;
+    }
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            files.push_back(entry.path().string());
+        }
+    }
+    // frame_NNNNNN_* names sort chronologically
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Convert straight into the sl::Mat memory (same BGRA layout the SDK delivers)
+void toBGRA(const cv::Mat& bgr, sl::Mat& out) {
+    if (!out.isInit() || static_cast<int>(out.getWidth()) != bgr.cols ||
+        static_cast<int>(out.getHeight()) != bgr.rows) {
+        out.alloc(bgr.cols, bgr.rows, sl::MAT_TYPE::U8_C4, sl::MEM::CPU);
+    }
+    cv::Mat bgra(bgr.rows, bgr.cols, CV_8UC4, out.getPtr<sl::uchar1>(sl::MEM::CPU), out.getStepBytes(sl::MEM::CPU));
+    cv::cvtColor(bgr, bgra, cv::COLOR_BGR2BGRA);
+}
+
+}  // namespace
+
+ReplayFrameSource::ReplayFrameSource(const ReplaySourceConfig& config)
+    : OfflineFrameSource(config.timing), config_(config) {
+    std::string container_path = config_.base_dir + "/frames.dfc";
+    std::error_code ec;
+    if (fs::exists(container_path, ec)) {
+        if (!container_.open(container_path)) {
+            std::cerr << "[FRAME_SOURCE] Replay: " << container_.getLastError() << std::endl;
+            return;
+        }
+        if (container_.isRecovered()) {
+            std::cerr << "[FRAME_SOURCE] Replay: " << container_path << " was not closed - replaying "
+                      << container_.getFrameCount() << " recovered frames" << std::endl;
+        }
+        // Probe geometry from the first frame
+        if (container_.getFrameCount() == 0 || !produceContainerFrame(0)) {
+            std::cerr << "[FRAME_SOURCE] Replay: no readable frames in " << container_path << std::endl;
+            container_.close();
+            return;
+        }
+        width_ = static_cast<int>(left_.getWidth());
+        height_ = static_cast<int>(left_.getHeight());
+
+        std::cout << "[FRAME_SOURCE] Replay source: " << container_path << " ("
+                  << container_.getFrameCount() << " frames, " << width_ << "x" << height_
+                  << ", depth: " << (depth_valid_ ? "yes" : "no") << ")" << std::endl;
+        return;
+    }
+
+    left_files_ = listSorted(config_.base_dir + "/left", "_left.jpg");
+    right_files_ = listSorted(config_.base_dir + "/right", "_right.jpg");
+    depth_files_ = listSorted(config_.base_dir + "/depth", "_depth.dat");
+
+    if (left_files_.empty()) {
+        std::cerr << "[FRAME_SOURCE] Replay: no left images found in " << config_.base_dir << "/left" << std::endl;
+        return;
+    }
+
+    // Probe geometry from the first frame
+    cv::Mat probe = cv::imread(left_files_.front(), cv::IMREAD_COLOR);
+    width_ = probe.cols;
+    height_ = probe.rows;
+
+    std::cout << "[FRAME_SOURCE] Replay source: " << config_.base_dir << " ("
+              << left_files_.size() << " frames, " << width_ << "x" << height_
+              << ", depth: " << depth_files_.size() << ")" << std::endl;
+}
+
+long ReplayFrameSource::frameCount() const {
+    if (container_.isOpen()) {
+        return static_cast<long>(container_.getFrameCount());
+    }
+    return static_cast<long>(left_files_.size());
+}
+
+bool ReplayFrameSource::produceFrame(long frame_index) {
+    long count = frameCount();
+    if (count == 0 || (!config_.loop && frame_index >= count)) {
+        return false;
+    }
+    size_t i = static_cast<size_t>(frame_index % count);
+
+    if (container_.isOpen()) {
+        return produceContainerFrame(i);
+    }
+
+    // Decode up front: file I/O belongs to the source, not to the recorder under test
+    if (!loadImage(left_files_[i], left_)) {
+        return false;
+    }
+    right_valid_ = (i < right_files_.size());
+    if (right_valid_ && !loadImage(right_files_[i], right_)) {
+        return false;
+    }
+    depth_valid_ = (i < depth_files_.size()) && loadDepth(depth_files_[i], depth_);
+    return true;
+}
+
+bool ReplayFrameSource::produceContainerFrame(size_t i) {
+    if (!container_.readFrame(i, record_)) {
+        std::cerr << "[FRAME_SOURCE] Replay: frame " << i << ": " << container_.getLastError() << std::endl;
+        return false;
+    }
+
+    const dfc::Chunk* left = record_.find(dfc::ChunkType::LEFT_JPEG);
+    if (!left || !decodeImage(left->data, left_)) {
+        return false;
+    }
+    const dfc::Chunk* right = record_.find(dfc::ChunkType::RIGHT_JPEG);
+    right_valid_ = (right != nullptr);
+    if (right_valid_ && !decodeImage(right->data, right_)) {
+        return false;
+    }
+
+    const dfc::Chunk* depth = record_.find(dfc::ChunkType::DEPTH);
+    depth_valid_ = false;
+    if (depth && depth->encoding == dfc::ChunkEncoding::DEPTH_CODEC) {
+        std::string error;
+        if (decodeDepthBlob(depth->data.data(), depth->data.size(), depth_image_, &error)) {
+            depth_valid_ = storeDepth(depth_image_.data.data(), depth_image_.width, depth_image_.height, depth_);
+        } else {
+            std::cerr << "[FRAME_SOURCE] Replay: frame " << record_.frame_number << " depth: " << error << std::endl;
+        }
+    } else if (depth && depth->data.size() == static_cast<size_t>(depth->width) * depth->height * sizeof(float)) {
+        depth_valid_ = storeDepth(reinterpret_cast<const float*>(depth->data.data()), depth->width, depth->height, depth_);
+    }
+    return true;
+}
+
+sl::ERROR_CODE ReplayFrameSource::retrieveImage(sl::Mat& image, sl::VIEW view) {
+    const sl::Mat* src = nullptr;
+    if (view == sl::VIEW::LEFT) {
+        src = &left_;
+    } else if (view == sl::VIEW::RIGHT) {
+        src = right_valid_ ? &right_ : &left_;
+    }
+    if (!src || !src->isInit()) {
+        return sl::ERROR_CODE::FAILURE;
+    }
+    return src->copyTo(image, sl::COPY_TYPE::CPU_CPU);
+}
+
+sl::ERROR_CODE ReplayFrameSource::retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) {
+    if (measure_type != sl::MEASURE::DEPTH || !depth_valid_) {
+        return sl::ERROR_CODE::FAILURE;
+    }
+    return depth_.copyTo(measure, sl::COPY_TYPE::CPU_CPU);
+}
+
+bool ReplayFrameSource::loadImage(const std::string& path, sl::Mat& out) {
+    cv::Mat bgr = cv::imread(path, cv::IMREAD_COLOR);
+    if (bgr.empty()) {
+        std::cerr << "[FRAME_SOURCE] Replay: failed to decode " << path << std::endl;
+        return false;
+    }
+    toBGRA(bgr, out);
+    return true;
+}
+
+bool ReplayFrameSource::decodeImage(const std::vector<uint8_t>& jpeg, sl::Mat& out) {
+    cv::Mat encoded(1, static_cast<int>(jpeg.size()), CV_8UC1, const_cast<uint8_t*>(jpeg.data()));
+    cv::Mat bgr = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (bgr.empty()) {
+        std::cerr << "[FRAME_SOURCE] Replay: failed to decode frame " << record_.frame_number << std::endl;
+        return false;
+    }
+    toBGRA(bgr, out);
+    return true;
+}
+
+bool ReplayFrameSource::loadDepth(const std::string& path, sl::Mat& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamoff file_size = file.tellg();
+    if (file_size <= 0) {
+        return false;
+    }
+    std::vector<uint8_t>& bytes = depth_bytes_;
+    bytes.resize(static_cast<size_t>(file_size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), file_size)) {
+        return false;
+    }
+
+    // Compressed depth (RawFrameRecorder with a depth codec) carries a depth_codec header
+    if (depth_codec::isBlob(bytes.data(), bytes.size())) {
+        std::string error;
+        if (!decodeDepthBlob(bytes.data(), bytes.size(), depth_image_, &error)) {
+            std::cerr << "[FRAME_SOURCE] Replay: " << path << ": " << error << std::endl;
+            return false;
+        }
+        return storeDepth(depth_image_.data.data(), depth_image_.width, depth_image_.height, out);
+    }
+
+    // Legacy RawFrameRecorder format: width (int), height (int), float32 data
+    const size_t header_size = 2 * sizeof(int);
+    int width = 0;
+    int height = 0;
+    if (bytes.size() < header_size) {
+        return false;
+    }
+    std::memcpy(&width, bytes.data(), sizeof(int));
+    std::memcpy(&height, bytes.data() + sizeof(int), sizeof(int));
+    if (width <= 0 || height <= 0 ||
+        static_cast<uint64_t>(width) * static_cast<uint64_t>(height) > (bytes.size() - header_size) / sizeof(float)) {
+        std::cerr << "[FRAME_SOURCE] Replay: " << path << ": " << width << "x" << height
+                  << " does not fit the file" << std::endl;
+        return false;
+    }
+
+    return storeDepth(reinterpret_cast<const float*>(bytes.data() + header_size), width, height, out);
+}
+
+bool ReplayFrameSource::storeDepth(const float* values, int width, int height, sl::Mat& out) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    if (!out.isInit() || static_cast<int>(out.getWidth()) != width ||
+        static_cast<int>(out.getHeight()) != height) {
+        out.alloc(width, height, sl::MAT_TYPE::F32_C1, sl::MEM::CPU);
+    }
+
+    uint8_t* base = out.getPtr<sl::uchar1>(sl::MEM::CPU);
+    size_t step = out.getStepBytes(sl::MEM::CPU);
+    for (int y = 0; y < height; y++) {
+        std::memcpy(base + y * step, values + static_cast<size_t>(y) * width, width * sizeof(float));
+    }
+    return true;
+}
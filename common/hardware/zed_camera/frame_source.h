@@ -0,0 +1,212 @@
+#pragma once
+
+#include <sl/Camera.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "frame_container.h"
+#include "depth_codec.h"
+
+/**
+ * @brief Source of grabbed frames for the recorders
+ *
+ * Mirrors the subset of the sl::Camera API that ZEDRecorder and RawFrameRecorder
+ * use in their recording loops (grab / retrieveImage / retrieveMeasure /
+ * getSensorsData). The live backend forwards to a real sl::Camera; the synthetic
+ * and replay backends produce frames on the CPU so the complete capture-to-disk
+ * path (CSV formatting, JPEG encode, depth writes, byte accounting) can be run
+ * and benchmarked on a plain Linux box without a ZED 2i attached.
+ *
+ * Only CPU memory (sl::MEM::CPU) is produced by the offline backends.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool isOpened() const = 0;
+
+    // True when backed by a physical camera (SVO2 recording via enableRecording() possible)
+    virtual bool isLiveCamera() const { return false; }
+
+    // Human readable backend name for logging
+    virtual std::string getName() const = 0;
+
+    // Nominal frame geometry and rate of the source
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+    virtual int getFPS() const = 0;
+
+    virtual sl::ERROR_CODE grab(const sl::RuntimeParameters& params) = 0;
+    virtual sl::ERROR_CODE retrieveImage(sl::Mat& image, sl::VIEW view) = 0;
+    virtual sl::ERROR_CODE retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) = 0;
+    virtual sl::ERROR_CODE getSensorsData(sl::SensorsData& data, sl::TIME_REFERENCE reference) = 0;
+
+    // Timestamp of the most recently grabbed image
+    virtual sl::Timestamp getImageTimestamp() = 0;
+};
+
+/**
+ * @brief Live backend - forwards every call to an opened sl::Camera
+ *
+ * Does not own the camera; the recorder keeps owning (and opening/closing) it.
+ */
+class ZedFrameSource : public FrameSource {
+public:
+    explicit ZedFrameSource(sl::Camera& zed) : zed_(zed) {}
+
+    bool isOpened() const override { return zed_.isOpened(); }
+    bool isLiveCamera() const override { return true; }
+    std::string getName() const override { return "ZED"; }
+
+    int getWidth() const override;
+    int getHeight() const override;
+    int getFPS() const override;
+
+    sl::ERROR_CODE grab(const sl::RuntimeParameters& params) override;
+    sl::ERROR_CODE retrieveImage(sl::Mat& image, sl::VIEW view) override;
+    sl::ERROR_CODE retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) override;
+    sl::ERROR_CODE getSensorsData(sl::SensorsData& data, sl::TIME_REFERENCE reference) override;
+    sl::Timestamp getImageTimestamp() override;
+
+private:
+    sl::Camera& zed_;
+};
+
+// Image content generated by SyntheticFrameSource
+enum class SyntheticPattern {
+    GRADIENT,       // Diagonal colour gradient scrolling with the frame number (compresses like sky/terrain)
+    CHECKERBOARD,   // High-contrast moving checkerboard (worst case for JPEG)
+    NOISE           // Deterministic pseudo-random noise (incompressible)
+};
+
+/**
+ * @brief Pacing and fault injection shared by the offline backends
+ */
+struct OfflineSourceTiming {
+    int fps = 30;                   // Nominal frame rate
+    bool realtime = true;           // Sleep to hold the frame rate; false = as fast as possible
+    int jitter_ms = 0;              // Uniform +/- jitter applied to every frame interval
+    int corrupt_every_n = 0;        // Return CORRUPTED_FRAME for every n-th grab (0 = never)
+    long max_frames = 0;            // Return END_OF_SVOFILE_REACHED after this many frames (0 = unlimited)
+    uint32_t seed = 42;             // RNG seed - identical seeds produce identical runs
+};
+
+struct SyntheticSourceConfig {
+    int width = 1280;
+    int height = 720;
+    SyntheticPattern pattern = SyntheticPattern::GRADIENT;
+    bool with_depth = true;         // Produce a depth measure (plane + NaN holes)
+    OfflineSourceTiming timing;
+};
+
+struct ReplaySourceConfig {
+    std::string base_dir;           // RAW_FRAMES recording: frames.dfc, else left/, right/, depth/
+    bool loop = true;               // Restart at the first frame instead of ending
+    OfflineSourceTiming timing;
+};
+
+/**
+ * @brief Common pacing, timestamps, sensor synthesis and fault injection for offline backends
+ */
+class OfflineFrameSource : public FrameSource {
+public:
+    explicit OfflineFrameSource(const OfflineSourceTiming& timing);
+
+    int getFPS() const override { return timing_.fps; }
+    sl::ERROR_CODE grab(const sl::RuntimeParameters& params) override;
+    sl::ERROR_CODE getSensorsData(sl::SensorsData& data, sl::TIME_REFERENCE reference) override;
+    sl::Timestamp getImageTimestamp() override { return sl::Timestamp(image_timestamp_ns_); }
+
+protected:
+    // Prepare content for frame_index; false means no more frames are available
+    virtual bool produceFrame(long frame_index) = 0;
+
+    long currentFrameIndex() const { return frame_index_; }
+
+private:
+    OfflineSourceTiming timing_;
+    std::mt19937 rng_;
+    long frame_index_{-1};
+    std::atomic<uint64_t> image_timestamp_ns_{0};   // Atomic: sensors may be sampled from another thread
+    std::atomic<uint64_t> start_timestamp_ns_{0};
+    std::chrono::steady_clock::time_point next_deadline_;
+    std::atomic<bool> started_{false};
+};
+
+/**
+ * @brief Deterministic frame generator (no hardware, no files)
+ */
+class SyntheticFrameSource : public OfflineFrameSource {
+public:
+    explicit SyntheticFrameSource(const SyntheticSourceConfig& config);
+
+    bool isOpened() const override { return true; }
+    std::string getName() const override { return "SYNTHETIC"; }
+    int getWidth() const override { return config_.width; }
+    int getHeight() const override { return config_.height; }
+
+    sl::ERROR_CODE retrieveImage(sl::Mat& image, sl::VIEW view) override;
+    sl::ERROR_CODE retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) override;
+
+protected:
+    bool produceFrame(long frame_index) override;
+
+private:
+    void renderImage(sl::Mat& image, long frame_index, int disparity_px);
+    void renderDepth(sl::Mat& depth, long frame_index);
+
+    SyntheticSourceConfig config_;
+    std::vector<uint32_t> noise_;   // Pre-generated noise tile (NOISE pattern)
+};
+
+/**
+ * @brief Replays an existing RAW_FRAMES recording directory
+ *
+ * Reads frames.dfc when the directory has one (a container that was not
+ * closed is re-indexed by FrameContainerReader), else the legacy left/ right/
+ * depth/ files. Left/right JPEGs are decoded to BGRA and depth is loaded as
+ * F32_C1. Sensor data is synthesised (the recording's CSV is not parsed).
+ */
+class ReplayFrameSource : public OfflineFrameSource {
+public:
+    explicit ReplayFrameSource(const ReplaySourceConfig& config);
+
+    bool isOpened() const override { return frameCount() > 0; }
+    std::string getName() const override { return "REPLAY"; }
+    int getWidth() const override { return width_; }
+    int getHeight() const override { return height_; }
+
+    sl::ERROR_CODE retrieveImage(sl::Mat& image, sl::VIEW view) override;
+    sl::ERROR_CODE retrieveMeasure(sl::Mat& measure, sl::MEASURE measure_type) override;
+
+protected:
+    bool produceFrame(long frame_index) override;
+
+private:
+    long frameCount() const;
+    bool produceContainerFrame(size_t i);
+    bool loadImage(const std::string& path, sl::Mat& out);
+    bool decodeImage(const std::vector<uint8_t>& jpeg, sl::Mat& out);
+    bool loadDepth(const std::string& path, sl::Mat& out);
+    bool storeDepth(const float* values, int width, int height, sl::Mat& out);
+
+    ReplaySourceConfig config_;
+    FrameContainerReader container_;
+    dfc::FrameRecord record_;           // Reused across container frames
+    DepthImage depth_image_;            // Decoded DEPTH_CODEC chunk / blob file
+    std::vector<uint8_t> depth_bytes_;  // Reused depth file buffer
+    std::vector<std::string> left_files_;
+    std::vector<std::string> right_files_;
+    std::vector<std::string> depth_files_;
+    int width_{0};
+    int height_{0};
+
+    sl::Mat left_;
+    sl::Mat right_;
+    sl::Mat depth_;
+    bool right_valid_{false};
+    bool depth_valid_{false};
+};
@@ -0,0 +1,193 @@
+#include "imu_sampler.h"
+#include "sensor_record.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Intervals observed before gap detection starts (nominal interval must settle first)
+constexpr uint64_t GAP_WARMUP_SAMPLES = 50;
+
+// Smoothing of the nominal IMU interval (gaps excluded)
+constexpr double INTERVAL_EMA_ALPHA = 0.02;
+
+}  // namespace
+
+ImuSampler::ImuSampler() : ImuSampler(Config()) {
+}
+
+ImuSampler::ImuSampler(const Config& config) : config_(config) {
+}
+
+ImuSampler::~ImuSampler() {
+    stop();
+}
+
+bool ImuSampler::start(FrameSource& source, SensorLogWriter& log, FrameNumberFn frame_number,
+                       const std::string& name) {
+    if (running_) {
+        std::cerr << "[IMU_SAMPLER] Already running for " << name_ << std::endl;
+        return false;
+    }
+    if (!log.isOpen()) {
+        std::cerr << "[IMU_SAMPLER] Sensor log not open" << std::endl;
+        return false;
+    }
+
+    source_ = &source;
+    log_ = &log;
+    frame_number_ = std::move(frame_number);
+    name_ = name;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_ = ImuSamplerStats();
+    }
+    poll_latency_.reset();
+
+    running_ = true;
+    thread_ = std::make_unique<std::thread>(&ImuSampler::samplerLoop, this);
+    std::cout << "[IMU_SAMPLER] " << name_ << ": polling " << source.getName() << " sensors every "
+              << config_.poll_interval_us << "us" << std::endl;
+    return true;
+}
+
+void ImuSampler::stop() {
+    if (!thread_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        running_ = false;
+    }
+    stop_cv_.notify_all();
+    if (thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+    logStats(getStats(), "Stopped");
+}
+
+ImuSamplerStats ImuSampler::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void ImuSampler::logStats(const ImuSamplerStats& stats, const char* prefix) const {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1)
+         << "[IMU_SAMPLER] " << name_ << " " << prefix << ": "
+         << "IMU " << stats.imu_hz << " Hz | Mag " << stats.mag_hz << " Hz | Baro " << stats.baro_hz << " Hz | "
+         << stats.imu_samples << " samples, " << stats.gaps << " gaps";
+    if (stats.gaps > 0) {
+        line << " (max " << stats.max_gap_ms << " ms, nominal " << std::setprecision(2)
+             << stats.nominal_interval_ms << " ms)";
+    }
+    if (stats.dropped > 0) {
+        line << ", " << stats.dropped << " dropped";
+    }
+    std::cout << line.str() << std::endl;
+}
+
+void ImuSampler::samplerLoop() {
+    sl::SensorsData data;
+    uint64_t last_imu_ns = 0;
+    uint64_t last_mag_ns = 0;
+    uint64_t last_baro_ns = 0;
+    uint64_t intervals = 0;
+    double nominal_interval_ms = 0.0;
+
+    // Per-window counters for the achieved rates
+    uint64_t window_imu = 0;
+    uint64_t window_mag = 0;
+    uint64_t window_baro = 0;
+    auto window_start = std::chrono::steady_clock::now();
+    auto last_report = window_start;
+
+    const auto poll_interval = std::chrono::microseconds(std::max(100, config_.poll_interval_us));
+    auto next_poll = std::chrono::steady_clock::now();
+
+    while (running_) {
+        auto poll_start = std::chrono::steady_clock::now();
+        if (source_->getSensorsData(data, sl::TIME_REFERENCE::CURRENT) == sl::ERROR_CODE::SUCCESS) {
+            const uint64_t imu_ns = data.imu.timestamp.getNanoseconds();
+
+            // Deduplicate on the sensor timestamp: polling is faster than the IMU
+            if (imu_ns != 0 && imu_ns != last_imu_ns) {
+                sensor_log::SensorRecord record = makeSensorRecord(
+                    data, frame_number_ ? frame_number_() : -1);
+                record.flags = sensor_log::FLAG_IMU_NEW;
+
+                const uint64_t mag_ns = data.magnetometer.timestamp.getNanoseconds();
+                if (data.magnetometer.is_available && mag_ns != 0 && mag_ns != last_mag_ns) {
+                    record.flags |= sensor_log::FLAG_MAG_NEW;
+                    last_mag_ns = mag_ns;
+                    window_mag++;
+                }
+                const uint64_t baro_ns = data.barometer.timestamp.getNanoseconds();
+                if (data.barometer.is_available && baro_ns != 0 && baro_ns != last_baro_ns) {
+                    record.flags |= sensor_log::FLAG_BARO_NEW;
+                    last_baro_ns = baro_ns;
+                    window_baro++;
+                }
+
+                bool pushed = log_->push(record);
+                poll_latency_.recordSince(poll_start);
+                window_imu++;
+
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.imu_samples++;
+                if (record.flags & sensor_log::FLAG_MAG_NEW) stats_.mag_samples++;
+                if (record.flags & sensor_log::FLAG_BARO_NEW) stats_.baro_samples++;
+                if (!pushed) stats_.dropped++;
+
+                if (last_imu_ns != 0 && imu_ns > last_imu_ns) {
+                    const double dt_ms = static_cast<double>(imu_ns - last_imu_ns) / 1e6;
+                    bool is_gap = intervals >= GAP_WARMUP_SAMPLES &&
+                                  dt_ms > config_.gap_factor * nominal_interval_ms;
+                    if (is_gap) {
+                        stats_.gaps++;
+                        stats_.max_gap_ms = std::max(stats_.max_gap_ms, dt_ms);
+                    } else {
+                        nominal_interval_ms = (intervals == 0) ? dt_ms
+                            : (1.0 - INTERVAL_EMA_ALPHA) * nominal_interval_ms + INTERVAL_EMA_ALPHA * dt_ms;
+                        intervals++;
+                        stats_.nominal_interval_ms = nominal_interval_ms;
+                    }
+                }
+                last_imu_ns = imu_ns;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double window_s = std::chrono::duration<double>(now - window_start).count();
+        if (window_s >= 1.0) {
+            ImuSamplerStats snapshot;
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                stats_.imu_hz = window_imu / window_s;
+                stats_.mag_hz = window_mag / window_s;
+                stats_.baro_hz = window_baro / window_s;
+                snapshot = stats_;
+            }
+            window_imu = window_mag = window_baro = 0;
+            window_start = now;
+
+            if (config_.report_interval_s > 0 &&
+                now - last_report >= std::chrono::seconds(config_.report_interval_s)) {
+                logStats(snapshot, "Running");
+                last_report = now;
+            }
+        }
+
+        // Fixed-rate polling; after a stall resume from now instead of bursting
+        next_poll += poll_interval;
+        if (next_poll < now) {
+            next_poll = now + poll_interval;
+        }
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        stop_cv_.wait_until(lock, next_poll, [this] { return !running_.load(); });
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <sl/Camera.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <functional>
+#include <string>
+#include <cstdint>
+#include "frame_source.h"
+#include "sensor_log.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief Achieved sensor rates and IMU continuity of an ImuSampler run
+ */
+struct ImuSamplerStats {
+    uint64_t imu_samples = 0;       // Distinct IMU timestamps written (pushed to the log)
+    uint64_t mag_samples = 0;
+    uint64_t baro_samples = 0;
+    double imu_hz = 0.0;            // Rates over the last report window
+    double mag_hz = 0.0;
+    double baro_hz = 0.0;
+    uint64_t gaps = 0;              // IMU intervals > gap_factor x nominal interval
+    double max_gap_ms = 0.0;
+    double nominal_interval_ms = 0.0;
+    uint64_t dropped = 0;           // Sensor log ring full / log closed (segment switch)
+};
+
+/**
+ * @brief Dedicated thread polling IMU/magnetometer/barometer at native rate
+ *
+ * The grab loop used to call getSensorsData() on every 2nd-5th frame, which
+ * caps the IMU log at 6-30Hz and costs the grab thread an SDK call per sample.
+ * The sampler polls getSensorsData(CURRENT) on its own thread (the SDK keeps
+ * the sensor stream independent of grab()), faster than the IMU updates, and
+ * pushes a record only when the IMU timestamp changed. Magnetometer and
+ * barometer run slower than the IMU; their updates are marked with
+ * sensor_log::FLAG_MAG_NEW / FLAG_BARO_NEW on the record that first carries them.
+ *
+ * The sampler is the only producer of the SensorLogWriter while it runs.
+ */
+class ImuSampler {
+public:
+    struct Config {
+        int poll_interval_us = 1000;    // 1kHz polling: every 400Hz IMU sample is seen
+        double gap_factor = 3.0;        // Gap = interval above gap_factor x nominal interval
+        int report_interval_s = 10;     // Log achieved rates this often (0 = only at stop)
+    };
+
+    // Frame number stored with each record (-1 if not provided)
+    using FrameNumberFn = std::function<int64_t()>;
+
+    ImuSampler();
+    explicit ImuSampler(const Config& config);
+    ~ImuSampler();
+
+    ImuSampler(const ImuSampler&) = delete;
+    ImuSampler& operator=(const ImuSampler&) = delete;
+
+    /**
+     * @brief Start sampling into an open sensor log
+     * @param name Owner tag for log output
+     */
+    bool start(FrameSource& source, SensorLogWriter& log, FrameNumberFn frame_number,
+               const std::string& name);
+
+    // Join the sampler thread and log the final rates
+    void stop();
+
+    bool isRunning() const { return running_.load(); }
+    ImuSamplerStats getStats() const;
+
+    // getSensorsData() + push() per poll that produced a new sample
+    const LatencyHistogram& getPollLatency() const { return poll_latency_; }
+
+private:
+    void samplerLoop();
+    void logStats(const ImuSamplerStats& stats, const char* prefix) const;
+
+    Config config_;
+    FrameSource* source_{nullptr};
+    SensorLogWriter* log_{nullptr};
+    FrameNumberFn frame_number_;
+    std::string name_;
+
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> running_{false};
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+
+    mutable std::mutex stats_mutex_;
+    ImuSamplerStats stats_;
+    LatencyHistogram poll_latency_;
+};
@@ -0,0 +1,162 @@
+#include "jpeg_encoder.h"
+#include <jerror.h>
+#include <csetjmp>
+#include <new>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+JpegEncoder::JpegEncoder(int quality) : quality_(quality) {
+    cinfo_.err = jpeg_std_error(&error_.pub);
+    error_.pub.error_exit = &JpegEncoder::onError;
+    error_.owner = this;
+    jpeg_create_compress(&cinfo_);
+
+    // Destination writes into output_ (grown on demand, reused across frames)
+    destination_.init_destination = &JpegEncoder::initDestination;
+    destination_.empty_output_buffer = &JpegEncoder::emptyOutputBuffer;
+    destination_.term_destination = &JpegEncoder::termDestination;
+    cinfo_.dest = &destination_;
+    cinfo_.client_data = this;
+}
+
+JpegEncoder::~JpegEncoder() {
+    jpeg_destroy_compress(&cinfo_);
+}
+
+void JpegEncoder::onError(j_common_ptr cinfo) {
+    // Default libjpeg behaviour is exit() - jump back into encodeBGRA() instead
+    ErrorManager* err = reinterpret_cast<ErrorManager*>(cinfo->err);
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    err->owner->last_error_ = message;
+    std::longjmp(*static_cast<std::jmp_buf*>(err->owner->jump_buffer_), 1);
+}
+
+bool JpegEncoder::resizeOutput(size_t size) noexcept {
+    try {
+        output_.resize(size);
+        return true;
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+}
+
+void JpegEncoder::initDestination(j_compress_ptr cinfo) {
+    JpegEncoder* self = static_cast<JpegEncoder*>(cinfo->client_data);
+    if (self->output_.empty() && !self->resizeOutput(256 * 1024)) {
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);     // longjmp back into encodeBGRA()
+    }
+    cinfo->dest->next_output_byte = self->output_.data();
+    cinfo->dest->free_in_buffer = self->output_.size();
+}
+
+boolean JpegEncoder::emptyOutputBuffer(j_compress_ptr cinfo) {
+    // Buffer full: double it and continue behind the data already written
+    JpegEncoder* self = static_cast<JpegEncoder*>(cinfo->client_data);
+    size_t used = self->output_.size();
+    if (!self->resizeOutput(used * 2)) {
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 1);     // longjmp back into encodeBGRA()
+    }
+    cinfo->dest->next_output_byte = self->output_.data() + used;
+    cinfo->dest->free_in_buffer = self->output_.size() - used;
+    return TRUE;
+}
+
+void JpegEncoder::termDestination(j_compress_ptr cinfo) {
+    JpegEncoder* self = static_cast<JpegEncoder*>(cinfo->client_data);
+    self->output_size_ = self->output_.size() - cinfo->dest->free_in_buffer;
+}
+
+bool JpegEncoder::encodeBGRA(const uint8_t* bgra, int width, int height, size_t stride_bytes, int quality) {
+    output_size_ = 0;
+    if (!bgra || width <= 0 || height <= 0 || stride_bytes < static_cast<size_t>(width) * 4) {
+        last_error_ = "invalid image";
+        return false;
+    }
+
+    std::jmp_buf jump_buffer;
+    jump_buffer_ = &jump_buffer;
+    if (setjmp(jump_buffer)) {
+        jpeg_abort_compress(&cinfo_);
+        jump_buffer_ = nullptr;
+        output_size_ = 0;
+        return false;
+    }
+
+    cinfo_.image_width = static_cast<JDIMENSION>(width);
+    cinfo_.image_height = static_cast<JDIMENSION>(height);
+#ifdef JCS_EXTENSIONS
+    cinfo_.input_components = 4;
+    cinfo_.in_color_space = JCS_EXT_BGRX;   // Alpha byte skipped by the colour converter
+#else
+    cinfo_.input_components = 3;
+    cinfo_.in_color_space = JCS_RGB;
+#endif
+    jpeg_set_defaults(&cinfo_);
+    jpeg_set_quality(&cinfo_, quality >= 0 ? quality : quality_, TRUE);
+    cinfo_.dct_method = JDCT_ISLOW;
+
+    jpeg_start_compress(&cinfo_, TRUE);
+
+#ifdef JCS_EXTENSIONS
+    // Point libjpeg directly at the source rows (honours sl::Mat padding)
+    if (rows_.size() < static_cast<size_t>(height)) {
+        rows_.resize(height);
+    }
+    for (int y = 0; y < height; y++) {
+        rows_[y] = const_cast<JSAMPROW>(bgra + y * stride_bytes);
+    }
+    while (cinfo_.next_scanline < cinfo_.image_height) {
+        jpeg_write_scanlines(&cinfo_, &rows_[cinfo_.next_scanline], cinfo_.image_height - cinfo_.next_scanline);
+    }
+#else
+    // Plain libjpeg: drop alpha + swap to RGB one row at a time (no full-frame copy)
+    if (row_rgb_.size() < static_cast<size_t>(width) * 3) {
+        row_rgb_.resize(static_cast<size_t>(width) * 3);
+    }
+    JSAMPROW row_pointer = row_rgb_.data();
+    while (cinfo_.next_scanline < cinfo_.image_height) {
+        const uint8_t* src = bgra + cinfo_.next_scanline * stride_bytes;
+        uint8_t* dst = row_rgb_.data();
+        for (int x = 0; x < width; x++, src += 4, dst += 3) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+        jpeg_write_scanlines(&cinfo_, &row_pointer, 1);
+    }
+#endif
+
+    jpeg_finish_compress(&cinfo_);
+    jump_buffer_ = nullptr;
+    last_error_.clear();
+    return true;
+}
+
+bool JpegEncoder::writeToFile(const std::string& path) const {
+    if (output_size_ == 0) {
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    const uint8_t* ptr = output_.data();
+    size_t remaining = output_size_;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, ptr, remaining);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            ::close(fd);
+            return false;
+        }
+        ptr += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return ::close(fd) == 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <jpeglib.h>
+
+/**
+ * @brief JPEG encoder that compresses ZED BGRA frames in place
+ *
+ * Feeds the BGRA rows (with the sl::Mat row stride) straight into libjpeg-turbo
+ * as JCS_EXT_BGRX, so no intermediate BGR copy (cv::cvtColor) is needed. The
+ * compressor handle, the row pointer table and the output buffer persist
+ * between frames - after the first frame of a given size, the only heap
+ * traffic left is libjpeg's own per-image work pool (a few small blocks),
+ * no frame-sized buffers.
+ *
+ * Not thread-safe: use one encoder per thread (e.g. thread_local).
+ */
+class JpegEncoder {
+public:
+    explicit JpegEncoder(int quality = 90);
+    ~JpegEncoder();
+
+    JpegEncoder(const JpegEncoder&) = delete;
+    JpegEncoder& operator=(const JpegEncoder&) = delete;
+
+    /**
+     * @brief Encode a 4-channel BGRA image
+     * @param bgra First pixel of the first row
+     * @param width Width in pixels
+     * @param height Height in pixels
+     * @param stride_bytes Distance between rows in bytes (sl::Mat::getStepBytes())
+     * @param quality JPEG quality 1-100, -1 = encoder default
+     * @return true on success; result in data()/size()
+     */
+    bool encodeBGRA(const uint8_t* bgra, int width, int height, size_t stride_bytes, int quality = -1);
+
+    // Encoded JPEG of the last successful encodeBGRA() (valid until the next call)
+    const uint8_t* data() const { return output_.data(); }
+    size_t size() const { return output_size_; }
+
+    // Write the last encoded JPEG to a file (returns false on I/O error)
+    bool writeToFile(const std::string& path) const;
+
+    void setQuality(int quality) { quality_ = quality; }
+    int getQuality() const { return quality_; }
+
+    // Last libjpeg error message (empty if none)
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    struct ErrorManager {
+        jpeg_error_mgr pub;
+        JpegEncoder* owner;
+    };
+
+    static void onError(j_common_ptr cinfo);
+    static void initDestination(j_compress_ptr cinfo);
+    static boolean emptyOutputBuffer(j_compress_ptr cinfo);
+    static void termDestination(j_compress_ptr cinfo);
+    // output_.resize() without throwing: a bad_alloc must not unwind through libjpeg's C frames
+    bool resizeOutput(size_t size) noexcept;
+
+    jpeg_compress_struct cinfo_;
+    ErrorManager error_;
+    jpeg_destination_mgr destination_;
+
+    std::vector<uint8_t> output_;       // Grows to the largest frame seen, never shrinks
+    size_t output_size_{0};
+    std::vector<JSAMPROW> rows_;        // Row pointer table (one per image row)
+#ifndef JCS_EXTENSIONS
+    std::vector<uint8_t> row_rgb_;      // Plain libjpeg fallback: per-row BGRA -> RGB
+#endif
+
+    int quality_;
+    std::string last_error_;
+    void* jump_buffer_{nullptr};        // Active setjmp target during encodeBGRA()
+};
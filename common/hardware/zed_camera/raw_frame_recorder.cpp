@@ -1,14 +1,16 @@
 #include "raw_frame_recorder.h"
+#include "jpeg_encoder.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <filesystem>
 #include <iomanip>
 #include <sstream>
-#include <opencv2/opencv.hpp>
 
 RawFrameRecorder::RawFrameRecorder() 
-    : recording_(false), frame_count_(0), bytes_written_(0), current_fps_(0.0f) {
+    : recording_(false), frame_count_(0), bytes_written_(0), current_fps_(0.0f),
+      storage_format_(RawStorageFormat::CONTAINER), depth_codec_(DepthCodec::FLOAT32),
+      depth_scale_(1), depth_pooling_(DepthPooling::MIN) {
 }
 
 RawFrameRecorder::~RawFrameRecorder() {
@@ -20,11 +22,15 @@ RawFrameRecorder::~RawFrameRecorder() {
             record_thread_->join();
         }
         
-        // Close sensor file
-        if (sensor_file_.is_open()) {
-            sensor_file_.close();
+        // Close sensor log
+        imu_sampler_.stop();
+        if (sensor_log_.isOpen()) {
+            sensor_log_.close();
         }
         
+        // Hub grabs from the camera - stop it first
+        hub_.reset();
+        
         // Close ZED camera
         if (zed_.isOpened()) {
             zed_.close();
@@ -40,6 +46,8 @@ bool RawFrameRecorder::init(RecordingMode mode, DepthMode depth_mode) {
     std::cout << "[RAW_RECORDER] Initializing in mode: " << getRecordingModeName(mode) 
               << " with depth: " << getDepthModeName(depth_mode) << std::endl;
     
+    hub_.reset();
+    
     current_mode_ = mode;
     depth_mode_ = depth_mode;
     
@@ -124,6 +132,10 @@ bool RawFrameRecorder::init(RecordingMode mode, DepthMode depth_mode) {
         return false;
     }
     
+    source_ = std::make_unique<ZedFrameSource>(zed_);
+    hub_ = std::make_unique<CaptureHub>(*source_);
+    hub_->startIdleGrab();
+    
     std::cout << "[RAW_RECORDER] ZED camera initialized successfully" << std::endl;
     
     // Enable positional tracking for sensor data
@@ -136,6 +148,25 @@ bool RawFrameRecorder::init(RecordingMode mode, DepthMode depth_mode) {
     return true;
 }
 
+bool RawFrameRecorder::initWithSource(std::unique_ptr<FrameSource> source, RecordingMode mode, DepthMode depth_mode) {
+    if (!source || !source->isOpened()) {
+        std::cerr << "[RAW_RECORDER] Frame source not available" << std::endl;
+        return false;
+    }
+    
+    current_mode_ = mode;
+    depth_mode_ = depth_mode;
+    hub_.reset();
+    source_ = std::move(source);
+    hub_ = std::make_unique<CaptureHub>(*source_);
+    hub_->startIdleGrab();
+    
+    std::cout << "[RAW_RECORDER] Using " << source_->getName() << " frame source (" << source_->getWidth() << "x"
+              << source_->getHeight() << " @ " << source_->getFPS() << " FPS) with depth: "
+              << getDepthModeName(depth_mode) << std::endl;
+    return true;
+}
+
 void RawFrameRecorder::configureDepthMode() {
     // Note: Depth mode will be set via RuntimeParameters during grab()
     // This method prepares any necessary configuration
@@ -171,7 +202,7 @@ bool RawFrameRecorder::startRecording(const std::string& base_dir) {
         return false;
     }
     
-    if (!zed_.isOpened()) {
+    if (!source_ || !source_->isOpened()) {
         std::cerr << "[RAW_RECORDER] Camera not initialized" << std::endl;
         return false;
     }
@@ -184,40 +215,77 @@ bool RawFrameRecorder::startRecording(const std::string& base_dir) {
         return false;
     }
     
-    // Open sensor data file
-    sensor_path_ = base_dir + "/sensor_data.csv";
-    sensor_file_.open(sensor_path_);
-    if (!sensor_file_) {
+    // Single container file instead of three files per frame
+    if (storage_format_ == RawStorageFormat::CONTAINER) {
+        container_path_ = base_dir + "/frames.dfc";
+        container_writer_ = std::make_unique<FrameContainerWriter>();
+        if (!container_writer_->open(container_path_)) {
+            std::cerr << "[RAW_RECORDER] Failed to create frame container: " << container_path_ << std::endl;
+            container_writer_.reset();
+            return false;
+        }
+    }
+    
+    // Open binary sensor log (tools/sensor_log_export converts it to the former sensor_data.csv)
+    sensor_path_ = base_dir + "/sensor_data" + sensor_log::FILE_EXTENSION;
+    if (!sensor_log_.open(sensor_path_, sensor_log::Layout::RAW_FRAMES)) {
         std::cerr << "[RAW_RECORDER] Failed to open sensor file: " << sensor_path_ << std::endl;
+        if (container_writer_) {
+            container_writer_->close();
+            container_writer_.reset();
+        }
         return false;
     }
     
-    // Write CSV header
-    sensor_file_ << "frame_number,timestamp_ms,rotation_x,rotation_y,rotation_z,"
-                 << "accel_x,accel_y,accel_z,gyro_x,gyro_y,gyro_z,"
-                 << "mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
-    
     recording_ = true;
     frame_count_ = 0;
+    grab_latency_.reset();
+    retrieve_image_latency_.reset();
+    retrieve_measure_latency_.reset();
+    submit_latency_.reset();
+    publish_latency_.reset();
+    hub_->resetLatency();
+    sensor_log_.resetLatency();
     bytes_written_ = 0;
     current_fps_ = 0.0f;
     
+    // Start encoder workers before the grab thread produces the first frame
+    auto encoder_pool = std::make_shared<FrameEncoderPool>(
+        encoder_config_,
+        [this](const RawFrameJob& job, RawFrameTimings& timings) { return writeFrame(job, timings); });
+    encoder_pool->start();
+    {
+        std::lock_guard<std::mutex> lock(encoder_pool_mutex_);
+        encoder_pool_ = std::move(encoder_pool);    // A reader may still hold the previous pool
+    }
+    
+    // IMU/mag/baro at native rate on their own thread; records carry the last grabbed frame number
+    imu_sampler_.start(*source_, sensor_log_, [this] { return static_cast<int64_t>(frame_count_.load()) - 1; }, "RawFrameRecorder");
+    
     // Start recording thread
     record_thread_ = std::make_unique<std::thread>(&RawFrameRecorder::recordingLoop, this);
     
     std::cout << "[RAW_RECORDER] Recording started: " << base_dir << std::endl;
-    std::cout << "[RAW_RECORDER]   Left images: " << left_dir_ << std::endl;
-    std::cout << "[RAW_RECORDER]   Right images: " << right_dir_ << std::endl;
-    std::cout << "[RAW_RECORDER]   Depth maps: " << depth_dir_ << std::endl;
+    if (storage_format_ == RawStorageFormat::CONTAINER) {
+        std::cout << "[RAW_RECORDER]   Frame container: " << container_path_ << std::endl;
+    } else {
+        std::cout << "[RAW_RECORDER]   Left images: " << left_dir_ << std::endl;
+        std::cout << "[RAW_RECORDER]   Right images: " << right_dir_ << std::endl;
+        std::cout << "[RAW_RECORDER]   Depth maps: " << depth_dir_ << std::endl;
+    }
+    if (depth_mode_ != DepthMode::NONE) {
+        std::cout << "[RAW_RECORDER]   Depth codec: " << depth_codec::codecName(depth_codec_) << std::endl;
+        if (depth_scale_ > 1) {
+            std::cout << "[RAW_RECORDER]   Depth resolution: 1/" << depth_scale_ << " ("
+                      << depth_downsample::poolingName(depth_pooling_) << " pooling)" << std::endl;
+        }
+    }
     std::cout << "[RAW_RECORDER]   Sensor data: " << sensor_path_ << std::endl;
     
     return true;
 }
 
 void RawFrameRecorder::recordingLoop() {
-    sl::Mat left_image, right_image, depth_map;
-    sl::SensorsData sensor_data;
-    
     // Runtime parameters
     sl::RuntimeParameters runtime_params;
     runtime_params.enable_depth = (depth_mode_ != DepthMode::NONE);
@@ -229,11 +297,15 @@ void RawFrameRecorder::recordingLoop() {
     
     std::cout << "[RAW_RECORDER] Recording loop started" << std::endl;
     
+    // This loop is the only grabber while recording; subscribers get frames via publish()
+    hub_->acquireGrab("RawFrameRecorder");
+    
     while (recording_) {
         auto frame_start = std::chrono::steady_clock::now();
         
         // Grab new frame
-        sl::ERROR_CODE grab_result = zed_.grab(runtime_params);
+        sl::ERROR_CODE grab_result = source_->grab(runtime_params);
+        grab_latency_.recordSince(frame_start);
         
         // CRITICAL: Treat CORRUPTED_FRAME as warning, not fatal error
         // Common with fast shutter speeds, dark scenes, or covered lens (e.g., landing in grass)
@@ -248,53 +320,46 @@ void RawFrameRecorder::recordingLoop() {
             
             long current_frame = frame_count_.load();
             
-            // Retrieve left image
-            zed_.retrieveImage(left_image, sl::VIEW::LEFT);
-            std::string left_path = generateFramePath(left_dir_, current_frame, "left.jpg");
-            if (!saveImageJPEG(left_image, left_path)) {
-                std::cerr << "[RAW_RECORDER] Failed to save left image: " << left_path << std::endl;
-            }
-            
-            // Retrieve right image
-            zed_.retrieveImage(right_image, sl::VIEW::RIGHT);
-            std::string right_path = generateFramePath(right_dir_, current_frame, "right.jpg");
-            if (!saveImageJPEG(right_image, right_path)) {
-                std::cerr << "[RAW_RECORDER] Failed to save right image: " << right_path << std::endl;
+            // Grab thread only copies pixels into pooled buffers - encoding runs in the worker pool
+            RawFrameJob job;
+            job.frame_number = current_frame;
+            job.timestamp_ns = source_->getImageTimestamp().getNanoseconds();
+            job.corrupted = frame_corrupted;
+            job.left = encoder_pool_->acquireImageBuffer();
+            job.right = encoder_pool_->acquireImageBuffer();
+            if (depth_mode_ != DepthMode::NONE) {
+                job.depth = encoder_pool_->acquireDepthBuffer();
             }
             
-            // Retrieve and save depth map (if enabled)
-            if (depth_mode_ != DepthMode::NONE) {
-                zed_.retrieveMeasure(depth_map, sl::MEASURE::DEPTH);
-                std::string depth_path = generateFramePath(depth_dir_, current_frame, "depth.dat");
-                if (!saveDepthMap(depth_map, depth_path)) {
-                    std::cerr << "[RAW_RECORDER] Failed to save depth map: " << depth_path << std::endl;
+            if (!job.left || !job.right || (depth_mode_ != DepthMode::NONE && !job.depth)) {
+                // All buffers in flight (only possible with a DROP_* policy)
+                encoder_pool_->recordDrop();
+            } else {
+                // Retrieve left/right images
+                auto retrieve_start = std::chrono::steady_clock::now();
+                if (source_->retrieveImage(*job.left, sl::VIEW::LEFT) != sl::ERROR_CODE::SUCCESS) {
+                    job.left.reset();
                 }
+                if (source_->retrieveImage(*job.right, sl::VIEW::RIGHT) != sl::ERROR_CODE::SUCCESS) {
+                    job.right.reset();
+                }
+                retrieve_image_latency_.recordSince(retrieve_start);
+                
+                // Retrieve depth map (if enabled)
+                if (job.depth) {
+                    ScopedLatency timer(retrieve_measure_latency_);
+                    if (source_->retrieveMeasure(*job.depth, sl::MEASURE::DEPTH) != sl::ERROR_CODE::SUCCESS) {
+                        job.depth.reset();
+                    }
+                }
+                
+                ScopedLatency timer(submit_latency_);
+                encoder_pool_->submit(std::move(job));
             }
             
-            // Get sensor data
-            if (zed_.getSensorsData(sensor_data, sl::TIME_REFERENCE::CURRENT) == sl::ERROR_CODE::SUCCESS) {
-                auto imu_data = sensor_data.imu;
-                auto mag_data = sensor_data.magnetometer;
-                auto baro_data = sensor_data.barometer;
-                
-                // Write sensor data to CSV
-                sensor_file_ << current_frame << ","
-                            << sensor_data.imu.timestamp.getMilliseconds() << ","
-                            << imu_data.pose.getOrientation().ox << ","
-                            << imu_data.pose.getOrientation().oy << ","
-                            << imu_data.pose.getOrientation().oz << ","
-                            << imu_data.linear_acceleration.x << ","
-                            << imu_data.linear_acceleration.y << ","
-                            << imu_data.linear_acceleration.z << ","
-                            << imu_data.angular_velocity.x << ","
-                            << imu_data.angular_velocity.y << ","
-                            << imu_data.angular_velocity.z << ","
-                            << mag_data.magnetic_field_calibrated.x << ","
-                            << mag_data.magnetic_field_calibrated.y << ","
-                            << mag_data.magnetic_field_calibrated.z << ","
-                            << baro_data.pressure << ","
-                            << sensor_data.temperature.temperature_map[sl::SensorsData::TemperatureData::SENSOR_LOCATION::IMU]
-                            << std::endl;
+            {
+                ScopedLatency timer(publish_latency_);
+                hub_->publish(*source_, static_cast<uint64_t>(current_frame), frame_corrupted);
             }
             
             // Increment frame count
@@ -306,8 +371,18 @@ void RawFrameRecorder::recordingLoop() {
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - loop_start).count();
             if (elapsed >= 1) {
                 current_fps_ = fps_frame_count / static_cast<float>(elapsed);
+                EncoderPoolStats stats = encoder_pool_->getStats();
                 std::cout << "[RAW_RECORDER] Frame " << current_frame << " | FPS: " 
-                          << std::fixed << std::setprecision(1) << current_fps_.load() << std::endl;
+                          << std::fixed << std::setprecision(1) << current_fps_.load()
+                          << " | Queue: " << stats.queue_depth << "/" << encoder_config_.queue_capacity
+                          << " | Dropped: " << stats.frames_dropped
+                          << " | Encode: " << stats.avg_encode_ms << "ms"
+                          << " | Write: " << stats.avg_write_ms << "ms";
+                if (depth_codec_ != DepthCodec::FLOAT32 && stats.depth_compression_ratio > 0.0) {
+                    std::cout << " | Depth: " << stats.depth_compression_ratio << "x @ "
+                              << std::setprecision(0) << stats.depth_encode_mb_per_sec << "MB/s";
+                }
+                std::cout << std::endl;
                 fps_frame_count = 0;
                 loop_start = now;
             }
@@ -321,6 +396,7 @@ void RawFrameRecorder::recordingLoop() {
         }
     }
     
+    hub_->releaseGrab();
     std::cout << "[RAW_RECORDER] Recording loop finished. Total frames: " << frame_count_.load() << std::endl;
 }
 
@@ -338,22 +414,107 @@ void RawFrameRecorder::stopRecording() {
         record_thread_.reset();
     }
     
-    // Close sensor file
-    if (sensor_file_.is_open()) {
-        sensor_file_.flush();
-        sensor_file_.close();
+    // Let the workers write all queued frames
+    if (encoder_pool_) {
+        encoder_pool_->stop();
+    }
+    
+    // Flush remaining frames and write the frame index
+    if (container_writer_) {
+        if (!container_writer_->close()) {
+            std::cerr << "[RAW_RECORDER] Error finalizing frame container: " << container_path_ << std::endl;
+        }
+        container_writer_.reset();
+    }
+    
+    // Write remaining sensor records and close the log
+    imu_sampler_.stop();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
     std::cout << "[RAW_RECORDER] Recording stopped. Frames captured: " << frame_count_.load() << std::endl;
 }
 
+LatencyReport RawFrameRecorder::getLatencyReport() const {
+    LatencyReport report = {
+        {"raw.grab", grab_latency_.summary()},
+        {"raw.retrieve_image", retrieve_image_latency_.summary()},
+        {"raw.retrieve_measure", retrieve_measure_latency_.summary()},
+        {"raw.submit", submit_latency_.summary()},
+        {"raw.publish", publish_latency_.summary()},
+    };
+    std::shared_ptr<FrameEncoderPool> encoder_pool;
+    {
+        std::lock_guard<std::mutex> lock(encoder_pool_mutex_);
+        encoder_pool = encoder_pool_;
+    }
+    if (encoder_pool) {
+        LatencyReport pool_report = encoder_pool->getLatencyReport();
+        report.insert(report.end(), pool_report.begin(), pool_report.end());
+    }
+    if (hub_) {
+        LatencyReport hub_report = hub_->getLatencyReport();
+        report.insert(report.end(), hub_report.begin(), hub_report.end());
+    }
+    report.emplace_back("sensor.poll", imu_sampler_.getPollLatency().summary());
+    report.emplace_back("sensor.write", sensor_log_.getWriteLatency().summary());
+    return report;
+}
+
 void RawFrameRecorder::close() {
     stopRecording();
     
+    // Stop idle preview grabs before the camera goes away
+    hub_.reset();
+    
     if (zed_.isOpened()) {
         zed_.close();
         std::cout << "[RAW_RECORDER] Camera closed" << std::endl;
     }
+    
+    // Release offline sources (ZedFrameSource is recreated by the next init())
+    source_.reset();
+}
+
+void RawFrameRecorder::setEncoderConfig(const FrameEncoderPool::Config& config) {
+    if (recording_) {
+        std::cerr << "[RAW_RECORDER] Cannot change encoder configuration while recording" << std::endl;
+        return;
+    }
+    encoder_config_ = config;
+}
+
+void RawFrameRecorder::setStorageFormat(RawStorageFormat format) {
+    if (recording_) {
+        std::cerr << "[RAW_RECORDER] Cannot change storage format while recording" << std::endl;
+        return;
+    }
+    storage_format_ = format;
+}
+
+void RawFrameRecorder::setDepthCodec(DepthCodec codec) {
+    if (recording_) {
+        std::cerr << "[RAW_RECORDER] Cannot change depth codec while recording" << std::endl;
+        return;
+    }
+    depth_codec_ = codec;
+    std::cout << "[RAW_RECORDER] Depth codec set to: " << depth_codec::codecName(codec) << std::endl;
+}
+
+void RawFrameRecorder::setDepthDownsample(int scale, DepthPooling pooling) {
+    if (recording_) {
+        std::cerr << "[RAW_RECORDER] Cannot change depth resolution while recording" << std::endl;
+        return;
+    }
+    if (!depth_downsample::isValidScale(scale)) {
+        std::cerr << "[RAW_RECORDER] Invalid depth scale " << scale << " (1, 2 or 4)" << std::endl;
+        return;
+    }
+    depth_scale_ = scale;
+    depth_pooling_ = pooling;
+    std::cout << "[RAW_RECORDER] Depth resolution set to: " << depth_downsample::scaleName(scale)
+              << " (" << depth_downsample::poolingName(pooling) << ")" << std::endl;
 }
 
 void RawFrameRecorder::setDepthMode(DepthMode depth_mode) {
@@ -381,6 +542,18 @@ float RawFrameRecorder::getCurrentFPS() const {
     return current_fps_;
 }
 
+EncoderPoolStats RawFrameRecorder::getEncoderStats() const {
+    std::shared_ptr<FrameEncoderPool> encoder_pool;
+    {
+        std::lock_guard<std::mutex> lock(encoder_pool_mutex_);
+        encoder_pool = encoder_pool_;
+    }
+    if (!encoder_pool) {
+        return EncoderPoolStats();
+    }
+    return encoder_pool->getStats();
+}
+
 std::string RawFrameRecorder::getDepthModeName(DepthMode mode) const {
     switch (mode) {
         case DepthMode::NEURAL_PLUS: return "NEURAL_PLUS";
@@ -411,6 +584,11 @@ bool RawFrameRecorder::createDirectoryStructure(const std::string& base_dir) {
         // Create base directory
         std::filesystem::create_directories(base_dir);
         
+        // Container recordings keep everything in frames.dfc
+        if (storage_format_ == RawStorageFormat::CONTAINER) {
+            return true;
+        }
+        
         // Create subdirectories
         left_dir_ = base_dir + "/left";
         right_dir_ = base_dir + "/right";
@@ -421,6 +599,19 @@ bool RawFrameRecorder::createDirectoryStructure(const std::string& base_dir) {
         
         if (depth_mode_ != DepthMode::NONE) {
             std::filesystem::create_directories(depth_dir_);
+            
+            // Neither the legacy .dat header (width, height) nor the codec blob header has a field
+            // for the downsampling factor: record it once per recording next to the maps, so a
+            // 1/2 or 1/4 pooled map can be told apart from a low-resolution camera mode
+            std::ofstream info(depth_dir_ + "/" + DEPTH_INFO_FILE);
+            info << "# frame_*_depth.dat: depth maps stored at 1/depth_scale of the camera resolution per axis\n"
+                 << "depth_scale=" << depth_scale_ << "\n"
+                 << "pooling=" << depth_downsample::poolingName(depth_pooling_) << "\n"
+                 << "codec=" << depth_codec::codecName(depth_codec_) << "\n";
+            if (!info) {
+                std::cerr << "[RAW_RECORDER] Failed to write " << depth_dir_ << "/" << DEPTH_INFO_FILE << std::endl;
+                return false;
+            }
         }
         
         std::cout << "[RAW_RECORDER] Directory structure created: " << base_dir << std::endl;
@@ -432,58 +623,218 @@ bool RawFrameRecorder::createDirectoryStructure(const std::string& base_dir) {
     }
 }
 
-bool RawFrameRecorder::saveImageJPEG(const sl::Mat& image, const std::string& path, int quality) {
-    try {
-        // Convert sl::Mat to cv::Mat
-        cv::Mat cv_image(image.getHeight(), image.getWidth(), CV_8UC4, image.getPtr<sl::uchar1>());
-        
-        // Convert BGRA to BGR (remove alpha channel)
-        cv::Mat cv_image_bgr;
-        cv::cvtColor(cv_image, cv_image_bgr, cv::COLOR_BGRA2BGR);
-        
-        // Save as JPEG with specified quality
-        std::vector<int> compression_params;
-        compression_params.push_back(cv::IMWRITE_JPEG_QUALITY);
-        compression_params.push_back(quality);
-        
-        bool success = cv::imwrite(path, cv_image_bgr, compression_params);
-        
-        if (success) {
-            // Update bytes written (approximate)
-            size_t file_size = std::filesystem::file_size(path);
-            bytes_written_ += file_size;
+bool RawFrameRecorder::writeFrame(const RawFrameJob& job, RawFrameTimings& timings) {
+    if (storage_format_ == RawStorageFormat::CONTAINER) {
+        return writeFrameToContainer(job, timings);
+    }
+    
+    bool ok = true;
+    auto encode_start = std::chrono::steady_clock::now();
+    if (job.left) {
+        ok &= saveImageJPEG(*job.left, generateFramePath(left_dir_, job.frame_number, "left.jpg"));
+    }
+    if (job.right) {
+        ok &= saveImageJPEG(*job.right, generateFramePath(right_dir_, job.frame_number, "right.jpg"));
+    }
+    auto depth_start = std::chrono::steady_clock::now();
+    timings.encode_ms = std::chrono::duration<double, std::milli>(depth_start - encode_start).count();
+    
+    if (job.depth) {
+        ok &= saveDepthMap(prepareDepth(*job.depth), generateFramePath(depth_dir_, job.frame_number, "depth.dat"),
+                           job.frame_number, timings);
+        timings.depth_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - depth_start).count();
+    }
+    return ok;
+}
+
+bool RawFrameRecorder::writeFrameToContainer(const RawFrameJob& job, RawFrameTimings& timings) {
+    // Separate encoders per eye - both outputs must stay valid until writeFrame() copies them
+    thread_local JpegEncoder left_encoder;
+    thread_local JpegEncoder right_encoder;
+    
+    std::vector<dfc::ChunkData> chunks;
+    chunks.reserve(3);
+    
+    auto encode_start = std::chrono::steady_clock::now();
+    auto encode = [&chunks](JpegEncoder& encoder, const sl::Mat& image, dfc::ChunkType type) {
+        int width = static_cast<int>(image.getWidth());
+        int height = static_cast<int>(image.getHeight());
+        if (!encoder.encodeBGRA(image.getPtr<sl::uchar1>(sl::MEM::CPU), width, height,
+                                image.getStepBytes(sl::MEM::CPU))) {
+            std::cerr << "[RAW_RECORDER] Error encoding image: " << encoder.getLastError() << std::endl;
+            return false;
         }
-        
-        return success;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "[RAW_RECORDER] Error saving image: " << e.what() << std::endl;
+        chunks.push_back(dfc::ChunkData::contiguous(type, encoder.data(), encoder.size(),
+                                                    static_cast<uint16_t>(width), static_cast<uint16_t>(height)));
+        return true;
+    };
+    
+    bool ok = true;
+    if (job.left) {
+        ok &= encode(left_encoder, *job.left, dfc::ChunkType::LEFT_JPEG);
+    }
+    if (job.right) {
+        ok &= encode(right_encoder, *job.right, dfc::ChunkType::RIGHT_JPEG);
+    }
+    auto depth_start = std::chrono::steady_clock::now();
+    timings.encode_ms = std::chrono::duration<double, std::milli>(depth_start - encode_start).count();
+    
+    DepthView depth_view;
+    if (job.depth) {
+        depth_view = prepareDepth(*job.depth);
+    }
+    if (job.depth && depth_codec_ != DepthCodec::FLOAT32) {
+        // Encoded blob carries its own codec/size header
+        const DepthEncoder* encoder = encodeDepth(depth_view, job.frame_number, timings);
+        if (encoder) {
+            dfc::ChunkData depth = dfc::ChunkData::contiguous(
+                dfc::ChunkType::DEPTH, encoder->data(), encoder->size(),
+                static_cast<uint16_t>(depth_view.width), static_cast<uint16_t>(depth_view.height));
+            depth.encoding = dfc::ChunkEncoding::DEPTH_CODEC;
+            depth.depth_scale = static_cast<uint16_t>(depth_scale_);
+            depth.pooling = static_cast<uint16_t>(depth_pooling_);
+            chunks.push_back(depth);
+        } else {
+            ok = false;
+        }
+    } else if (job.depth) {
+        // Rows are copied straight out of the sl::Mat or the pooled map (row padding dropped) - no staging buffer
+        dfc::ChunkData depth;
+        depth.type = dfc::ChunkType::DEPTH;
+        depth.width = static_cast<uint16_t>(depth_view.width);
+        depth.height = static_cast<uint16_t>(depth_view.height);
+        depth.depth_scale = static_cast<uint16_t>(depth_scale_);
+        depth.pooling = static_cast<uint16_t>(depth_pooling_);
+        depth.data = reinterpret_cast<const uint8_t*>(depth_view.data);
+        depth.row_bytes = depth_view.width * sizeof(float);
+        depth.rows = depth_view.height;
+        depth.stride = depth_view.stride;
+        chunks.push_back(depth);
+        timings.depth_raw_bytes = timings.depth_encoded_bytes = depth.payloadSize();
+    }
+    
+    uint32_t flags = job.corrupted ? dfc::FRAME_FLAG_CORRUPTED : 0;
+    if (container_writer_->writeFrame(static_cast<uint64_t>(job.frame_number), job.timestamp_ns, flags, chunks)) {
+        bytes_written_ += FrameContainerWriter::recordSize(chunks);
+    } else {
+        ok = false;
+    }
+    
+    if (job.depth) {
+        timings.depth_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - depth_start).count();
+    }
+    return ok;
+}
+
+bool RawFrameRecorder::saveImageJPEG(const sl::Mat& image, const std::string& path, int quality) {
+    // One encoder per worker thread - compressor and output buffer are reused across frames
+    thread_local JpegEncoder encoder;
+    
+    // Encode the BGRA buffer directly (no cvtColor BGR copy)
+    if (!encoder.encodeBGRA(image.getPtr<sl::uchar1>(sl::MEM::CPU), static_cast<int>(image.getWidth()),
+                            static_cast<int>(image.getHeight()), image.getStepBytes(sl::MEM::CPU), quality)) {
+        std::cerr << "[RAW_RECORDER] Error encoding image: " << encoder.getLastError() << std::endl;
+        return false;
+    }
+    
+    if (!encoder.writeToFile(path)) {
         return false;
     }
+    
+    // Encoded size is exact - no need to stat the file
+    bytes_written_ += encoder.size();
+    return true;
 }
 
-bool RawFrameRecorder::saveDepthMap(const sl::Mat& depth, const std::string& path) {
+RawFrameRecorder::DepthView RawFrameRecorder::prepareDepth(const sl::Mat& depth) {
+    DepthView view;
+    view.data = depth.getPtr<sl::float1>(sl::MEM::CPU);
+    view.width = static_cast<int>(depth.getWidth());
+    view.height = static_cast<int>(depth.getHeight());
+    view.stride = depth.getStepBytes(sl::MEM::CPU);
+    if (depth_scale_ <= 1) {
+        return view;
+    }
+    
+    // One downsampler + output buffer per worker thread, rebuilt when the setting changes between recordings
+    thread_local DepthDownsampler downsampler;
+    thread_local std::vector<float> reduced;
+    const DepthDownsampler::Config& config = downsampler.getConfig();
+    if (config.scale != depth_scale_ || config.pooling != depth_pooling_) {
+        downsampler = DepthDownsampler({depth_scale_, depth_pooling_});
+    }
+    
+    const int width = downsampler.outputWidth(view.width);
+    const int height = downsampler.outputHeight(view.height);
+    reduced.resize(static_cast<size_t>(width) * height);
+    downsampler.apply(view.data, view.width, view.height, view.stride, reduced.data());
+    
+    view.data = reduced.data();
+    view.width = width;
+    view.height = height;
+    view.stride = width * sizeof(float);
+    return view;
+}
+
+const DepthEncoder* RawFrameRecorder::encodeDepth(const DepthView& depth, long frame_number, RawFrameTimings& timings) {
+    // One encoder per worker thread - zlib state and scratch buffers are reused across frames
+    thread_local DepthEncoder encoder;
+    
+    auto start = std::chrono::steady_clock::now();
+    if (!encoder.encode(depth.data, depth.width, depth.height, depth.stride,
+                        depth_codec_, static_cast<int>(frame_number))) {
+        std::cerr << "[RAW_RECORDER] Error encoding depth map: " << encoder.getLastError() << std::endl;
+        return nullptr;
+    }
+    timings.depth_encode_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    timings.depth_raw_bytes = static_cast<size_t>(depth.width) * depth.height * sizeof(float);
+    timings.depth_encoded_bytes = encoder.size();
+    return &encoder;
+}
+
+bool RawFrameRecorder::saveDepthMap(const DepthView& depth, const std::string& path, long frame_number,
+                                    RawFrameTimings& timings) {
     try {
-        // Save depth map as binary file (32-bit float values)
         std::ofstream file(path, std::ios::binary);
         if (!file) {
             return false;
         }
         
-        // Write dimensions
-        int width = depth.getWidth();
-        int height = depth.getHeight();
+        if (depth_codec_ != DepthCodec::FLOAT32) {
+            // Compressed: self-describing depth_codec blob
+            const DepthEncoder* encoder = encodeDepth(depth, frame_number, timings);
+            if (!encoder) {
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(encoder->data()), encoder->size());
+            file.close();
+            bytes_written_ += encoder->size();
+            return static_cast<bool>(file);
+        }
+        
+        // Save depth map as binary file (32-bit float values)
+        // Write dimensions (of the stored map - depth_scale_ and pooling are in depth/depth_info.txt)
+        int width = depth.width;
+        int height = depth.height;
         file.write(reinterpret_cast<const char*>(&width), sizeof(int));
         file.write(reinterpret_cast<const char*>(&height), sizeof(int));
         
-        // Write depth data
-        size_t data_size = width * height * sizeof(float);
-        file.write(reinterpret_cast<const char*>(depth.getPtr<sl::uchar1>()), data_size);
+        // Write depth data row by row (sl::Mat rows may be padded)
+        size_t row_size = width * sizeof(float);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(depth.data);
+        for (int y = 0; y < height; y++) {
+            file.write(reinterpret_cast<const char*>(data + y * depth.stride), row_size);
+        }
         
         file.close();
         
         // Update bytes written
+        size_t data_size = row_size * height;
         bytes_written_ += data_size + 2 * sizeof(int);
+        timings.depth_raw_bytes = timings.depth_encoded_bytes = data_size;
         
         return true;
         
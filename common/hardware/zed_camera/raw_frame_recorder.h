@@ -5,10 +5,17 @@
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <mutex>
 
 // Forward declaration - RecordingMode is defined in zed_recorder.h
 // Include zed_recorder.h to get the shared enum
 #include "zed_recorder.h"
+#include "frame_encoder_pool.h"
+#include "frame_container.h"
+#include "depth_codec.h"
+#include "depth_downsample.h"
+#include "imu_sampler.h"
+#include "latency_histogram.h"
 
 // Depth computation modes (matching ZED SDK options)
 enum class DepthMode {
@@ -25,6 +32,12 @@ enum class DepthMode {
     NONE            // No depth computation (images only)
 };
 
+// On-disk layout of a RAW_FRAMES recording
+enum class RawStorageFormat {
+    CONTAINER,      // frames.dfc - one chunked file for all frames (default)
+    DIRECTORIES     // left/, right/, depth/ - three files per frame (legacy)
+};
+
 class RawFrameRecorder {
 public:
     RawFrameRecorder();
@@ -34,9 +47,14 @@ public:
     bool init(RecordingMode mode = RecordingMode::HD720_30FPS, 
               DepthMode depth_mode = DepthMode::NEURAL_LITE);
     
+    // Initialize with an external frame source (synthetic/replay - no camera needed)
+    bool initWithSource(std::unique_ptr<FrameSource> source,
+                        RecordingMode mode = RecordingMode::HD720_30FPS,
+                        DepthMode depth_mode = DepthMode::NEURAL_LITE);
+    
     // Start raw frame recording
     // base_dir: e.g., /media/angelo/DRONE_DATA/flight_20251112_143022/
-    // Creates subdirectories: left/, right/, depth/, and sensor_data.csv
+    // Creates frames.dfc (CONTAINER) or left/, right/, depth/ (DIRECTORIES), and sensor_data.slog
     bool startRecording(const std::string& base_dir);
     
     // Stop recording
@@ -48,6 +66,31 @@ public:
     // Change depth mode (can be called before init or between recordings)
     void setDepthMode(DepthMode depth_mode);
     
+    // Encoder worker pool configuration (applied at next startRecording)
+    void setEncoderConfig(const FrameEncoderPool::Config& config);
+    const FrameEncoderPool::Config& getEncoderConfig() const { return encoder_config_; }
+    
+    // Storage layout (applied at next startRecording)
+    void setStorageFormat(RawStorageFormat format);
+    RawStorageFormat getStorageFormat() const { return storage_format_; }
+    
+    // Depth map codec (applied at next startRecording, default FLOAT32)
+    void setDepthCodec(DepthCodec codec);
+    DepthCodec getDepthCodec() const { return depth_codec_; }
+    
+    // Stored depth resolution (applied at next startRecording): 1 = full, 2 = half, 4 = quarter
+    void setDepthDownsample(int scale, DepthPooling pooling);
+    int getDepthScale() const { return depth_scale_; }
+    DepthPooling getDepthPooling() const { return depth_pooling_; }
+    
+    // DIRECTORIES recordings: depth/depth_info.txt holds depth_scale=, pooling= and codec= lines
+    // (frames.dfc stores them in each depth chunk header instead)
+    static constexpr const char* DEPTH_INFO_FILE = "depth_info.txt";
+    
+    // Files of the current/last recording (container path empty for DIRECTORIES)
+    const std::string& getContainerPath() const { return container_path_; }
+    const std::string& getSensorPath() const { return sensor_path_; }
+    
     // Status
     bool isRecording() const;
     long getFrameCount() const;
@@ -59,6 +102,7 @@ public:
     
     // Performance info
     float getCurrentFPS() const;  // Actual achieved FPS
+    EncoderPoolStats getEncoderStats() const;  // Queue/encode/drop counters of the current recording
     
     // Camera settings
     bool setCameraExposure(int exposure_value);  // -1 = auto, 0-100 = manual
@@ -70,12 +114,20 @@ public:
     // Get camera reference (for snapshot/livestream)
     sl::Camera* getCamera() { return &zed_; }
     
+    // Fan-out of grabbed frames to depth writers / visualisation / preview (nullptr before init)
+    CaptureHub* getCaptureHub() { return hub_.get(); }
+    ImuSamplerStats getImuStats() const { return imu_sampler_.getStats(); }
+    LatencyReport getLatencyReport() const;  // Per-stage p50/p95/p99/max since startRecording()
+    
 private:
     sl::Camera zed_;
+    std::unique_ptr<FrameSource> source_;  // Frame source used by recordingLoop (ZedFrameSource after init())
+    std::unique_ptr<CaptureHub> hub_;      // Sole grabber outside recordingLoop; destroyed before source_
     std::atomic<bool> recording_;
     std::atomic<long> frame_count_;
     std::atomic<size_t> bytes_written_;
-    std::ofstream sensor_file_;
+    SensorLogWriter sensor_log_;           // Binary IMU log, written on its own thread
+    ImuSampler imu_sampler_;               // Sole producer of sensor_log_ - polls sensors at native rate
     std::unique_ptr<std::thread> record_thread_;
     
     RecordingMode current_mode_;
@@ -86,17 +138,49 @@ private:
     std::string right_dir_;
     std::string depth_dir_;
     std::string sensor_path_;
+    std::string container_path_;
     
     // Performance tracking
     std::atomic<float> current_fps_;
+    LatencyHistogram grab_latency_;             // Grab thread stages (reset by startRecording)
+    LatencyHistogram retrieve_image_latency_;   // Left + right
+    LatencyHistogram retrieve_measure_latency_;
+    LatencyHistogram submit_latency_;           // Blocks while the encoder queue is full (BLOCK policy)
+    LatencyHistogram publish_latency_;
+    
+    // JPEG/depth encoding off the grab thread
+    FrameEncoderPool::Config encoder_config_;
+    // Replaced by startRecording while status/HTTP threads read stats: those take a reference under
+    // encoder_pool_mutex_ (the grab thread and stopRecording use it directly, startRecording is not concurrent with them)
+    std::shared_ptr<FrameEncoderPool> encoder_pool_;
+    mutable std::mutex encoder_pool_mutex_;
+    
+    // Storage
+    RawStorageFormat storage_format_;
+    std::unique_ptr<FrameContainerWriter> container_writer_;
+    DepthCodec depth_codec_;
+    int depth_scale_;
+    DepthPooling depth_pooling_;
+    
+    // Depth map as stored: rows of the sl::Mat itself, or of a per-thread pooled copy (depth_scale_ > 1)
+    struct DepthView {
+        const float* data = nullptr;
+        int width = 0;
+        int height = 0;
+        size_t stride = 0;      // Bytes between rows
+    };
     
     // Recording loop
     void recordingLoop();
     
     // Helper methods
     bool createDirectoryStructure(const std::string& base_dir);
+    bool writeFrame(const RawFrameJob& job, RawFrameTimings& timings);       // Encoder worker callback
+    bool writeFrameToContainer(const RawFrameJob& job, RawFrameTimings& timings);
     bool saveImageJPEG(const sl::Mat& image, const std::string& path, int quality = 90);
-    bool saveDepthMap(const sl::Mat& depth, const std::string& path);
+    DepthView prepareDepth(const sl::Mat& depth);
+    bool saveDepthMap(const DepthView& depth, const std::string& path, long frame_number, RawFrameTimings& timings);
+    const DepthEncoder* encodeDepth(const DepthView& depth, long frame_number, RawFrameTimings& timings);
     std::string generateFramePath(const std::string& dir, long frame_num, const std::string& suffix);
     
     // Depth computation configuration
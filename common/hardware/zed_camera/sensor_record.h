@@ -0,0 +1,42 @@
+#pragma once
+
+#include <sl/Camera.hpp>
+#include <chrono>
+#include "sensor_log.h"
+
+/**
+ * @brief Copy one ZED sensor sample into a fixed-size sensor log record
+ *
+ * Plain float copies only - formatting happens offline in sensor_log_export.
+ */
+inline sensor_log::SensorRecord makeSensorRecord(sl::SensorsData& data, int64_t frame_number) {
+    sensor_log::SensorRecord record{};
+    record.frame_number = frame_number;
+    record.imu_timestamp_ns = data.imu.timestamp.getNanoseconds();
+    record.wall_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    sl::Orientation orientation = data.imu.pose.getOrientation();
+    record.orientation[0] = orientation.ox;
+    record.orientation[1] = orientation.oy;
+    record.orientation[2] = orientation.oz;
+    record.orientation[3] = orientation.ow;
+
+    sl::float3 euler = data.imu.pose.getEulerAngles();
+    const sl::float3& accel = data.imu.linear_acceleration;
+    const sl::float3& gyro = data.imu.angular_velocity;
+    const sl::float3& mag = data.magnetometer.magnetic_field_calibrated;
+    for (int i = 0; i < 3; i++) {
+        record.euler[i] = euler[i];
+        record.accel[i] = accel[i];
+        record.gyro[i] = gyro[i];
+        record.mag[i] = mag[i];
+    }
+
+    record.pressure = data.barometer.pressure;
+    float temperature = 0.0f;
+    if (data.temperature.get(sl::SensorsData::TemperatureData::SENSOR_LOCATION::IMU, temperature) == sl::ERROR_CODE::SUCCESS) {
+        record.temperature = temperature;
+    }
+    return record;
+}
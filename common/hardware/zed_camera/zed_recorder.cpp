@@ -3,11 +3,34 @@
 #include <chrono>
 #include <thread>
 #include <filesystem>
-#include <unistd.h>  // für sync()
+#include <unistd.h>  // für fsync()
+#include <fcntl.h>
 #include <cstdlib>   // für system()
 #include <sstream>
 #include <iomanip>
 
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// fsync one file or directory - only the recording's own data, not every dirty page on the system
+bool fsyncPath(const std::string& path, int flags = O_RDONLY) {
+    if (path.empty()) {
+        return true;
+    }
+    int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = (::fsync(fd) == 0);
+    ::close(fd);
+    return ok;
+}
+
+}  // namespace
+
 ZEDRecorder::ZEDRecorder() : recording_(false), bytes_written_(0) {
 }
 
@@ -21,10 +44,14 @@ ZEDRecorder::~ZEDRecorder() {
         }
         
         // Schließe Sensordatei sauber
-        if (sensor_file_.is_open()) {
-            sensor_file_.close();
+        imu_sampler_.stop();
+        if (sensor_log_.isOpen()) {
+            sensor_log_.close();
         }
         
+        // Hub grabs from the camera - stop it first
+        hub_.reset();
+        
         // Schließe ZED Kamera
         if (zed_.isOpened()) {
             zed_.close();
@@ -39,6 +66,8 @@ ZEDRecorder::~ZEDRecorder() {
 }
 
 bool ZEDRecorder::init(RecordingMode mode) {
+    hub_.reset();
+    
     // ZED Kameraparameter je nach Modus einstellen
     sl::InitParameters init_params;
     
@@ -122,32 +151,59 @@ bool ZEDRecorder::init(RecordingMode mode) {
         return false;
     }
     
+    source_ = std::make_unique<ZedFrameSource>(zed_);
+    hub_ = std::make_unique<CaptureHub>(*source_);
+    hub_->startIdleGrab();
+    
     std::cout << "ZED camera initialized successfully" << std::endl;
     return true;
 }
 
+bool ZEDRecorder::initWithSource(std::unique_ptr<FrameSource> source, RecordingMode mode) {
+    if (!source || !source->isOpened()) {
+        std::cerr << "[ZED] Frame source not available" << std::endl;
+        return false;
+    }
+    
+    current_mode_ = mode;
+    hub_.reset();
+    source_ = std::move(source);
+    hub_ = std::make_unique<CaptureHub>(*source_);
+    hub_->startIdleGrab();
+    
+    std::cout << "[ZED] Using " << source_->getName() << " frame source (" << source_->getWidth() << "x"
+              << source_->getHeight() << " @ " << source_->getFPS() << " FPS) in mode: " << getModeName(mode) << std::endl;
+    return true;
+}
+
 bool ZEDRecorder::startRecording(const std::string& video_path, const std::string& sensor_path) {
     if (recording_) {
         return false; // Bereits aufnehmend
     }
     
+    if (!source_ || !source_->isOpened()) {
+        std::cerr << "[ZED] Cannot start recording: no frame source initialized" << std::endl;
+        return false;
+    }
+    
     // Auto-segmentation variables removed - not needed with NTFS/exFAT support
     
     // Use direct paths (auto-segmentation disabled)
     std::string actual_video_path = video_path;
     std::string actual_sensor_path = sensor_path;
     
+    grab_latency_.reset();
+    depth_latency_.reset();
+    publish_latency_.reset();
+    hub_->resetLatency();
+    sensor_log_.resetLatency();
+    
     // Öffne Sensordaten-Datei
-    sensor_file_.open(actual_sensor_path);
-    if (!sensor_file_) {
+    if (!sensor_log_.open(actual_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "Failed to open sensor file: " << actual_sensor_path << std::endl;
         return false;
     }
     
-    // Schreibe Header für alle verfügbaren Sensordaten
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
-    
     // Setze Aufnahmeparameter
     sl::RecordingParameters rec_params;
     rec_params.video_filename = actual_video_path.c_str();
@@ -165,12 +221,24 @@ bool ZEDRecorder::startRecording(const std::string& video_path, const std::strin
         case RecordingMode::VGA_100FPS:   rec_params.target_framerate = 100; break;
     }
     
+    if (!source_->isLiveCamera()) {
+        // Offline source: no camera to encode SVO2 from - run the loop (grab, depth, sensors) only
+        std::cout << "[ZED] " << source_->getName() << " source: SVO recording skipped, capturing sensors only" << std::endl;
+        current_video_path_ = actual_video_path;
+        recording_ = true;
+        bytes_written_ = 0;
+        current_frame_number_ = 0;
+        startImuSampler(*source_);
+        record_thread_ = std::make_unique<std::thread>(&ZEDRecorder::recordingLoop, this, actual_video_path);
+        return true;
+    }
+    
     std::cout << "[ZED] Using LOSSLESS compression with target FPS: " << rec_params.target_framerate << std::endl;
     
     sl::ERROR_CODE err = zed_.enableRecording(rec_params);
     if (err != sl::ERROR_CODE::SUCCESS) {
         std::cerr << "Error starting recording: " << err << std::endl;
-        sensor_file_.close();
+        sensor_log_.close();
         return false;
     }
     
@@ -200,7 +268,7 @@ bool ZEDRecorder::startRecording(const std::string& video_path, const std::strin
         std::cerr << "CRITICAL ERROR: ZED recording enabled but SVO file was not created!" << std::endl;
         std::cerr << "Expected file: " << actual_video_path << " or " << actual_video_path << "2" << std::endl;
         zed_.disableRecording();
-        sensor_file_.close();
+        sensor_log_.close();
         return false;
     }
     
@@ -209,6 +277,18 @@ bool ZEDRecorder::startRecording(const std::string& video_path, const std::strin
     
     recording_ = true;
     bytes_written_ = 0;
+    
+    // File size sampled once per second on a background thread instead of stat() per frame
+    write_monitor_.start(current_video_path_, [this, large_file_ticks = 0](const WriteRateSample& sample) mutable {
+        bytes_written_ = sample.bytes;
+        
+        // AUTO-SEGMENTATION DISABLED - No longer needed with NTFS/exFAT >4GB support
+        // NTFS/exFAT Support: No hard 4GB limit - only warn at very large sizes (every 10s, as before)
+        if (sample.bytes > 17179869184ULL && ++large_file_ticks % 10 == 0) {  // Warn at 16GB
+            std::cout << "[ZED] INFO: Large file recording (" 
+                      << sample.bytes/1024/1024/1024 << "GB). Ensure sufficient disk space." << std::endl;
+        }
+    });
     current_frame_number_ = 0;  // Reset frame counter for synchronized naming
     
     std::cout << "[ZED] Auto-segmentation: DISABLED (>4GB files supported on NTFS/exFAT)" << std::endl;
@@ -229,26 +309,17 @@ bool ZEDRecorder::startRecording(const std::string& video_path, const std::strin
     std::cout << "[ZED] Waiting for recording subsystem to stabilize..." << std::endl;
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     
+    // IMU/mag/baro on their own thread at native rate (grab loop no longer touches sensors)
+    startImuSampler(*source_);
+    
     // Starte Aufnahme-Thread
     record_thread_ = std::make_unique<std::thread>(&ZEDRecorder::recordingLoop, this, actual_video_path);
     
     return true;
 }
 
-void ZEDRecorder::recordingLoop(const std::string& video_path) {
-    sl::SensorsData sensor_data;
-    int sensor_skip_counter = 0;
-    
-    // Bestimme Sensor-Sampling-Rate basierend auf FPS
-    int sensor_skip_rate = 1; // Default: jeden Frame
-    if (current_mode_ == RecordingMode::HD720_30FPS || 
-        current_mode_ == RecordingMode::HD1080_30FPS) {
-        sensor_skip_rate = 2;  // Jeden 2. Frame für 30FPS Modi
-    } else if (current_mode_ == RecordingMode::HD720_60FPS) {
-        sensor_skip_rate = 3;  // Jeden 3. Frame für 60FPS
-    } else if (current_mode_ == RecordingMode::VGA_100FPS) {
-        sensor_skip_rate = 5;  // Jeden 5. Frame für 100FPS
-    }
+void ZEDRecorder::recordingLoop([[maybe_unused]] const std::string& video_path) {
+    // Sensors are sampled by imu_sampler_ on its own thread - this loop only grabs
     
     int consecutive_failures = 0;
     const int max_consecutive_failures = 10;
@@ -261,12 +332,17 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
     int warmup_frames = 5;
     bool warmup_complete = false;
     
+    // This loop is the only grabber while recording; subscribers get frames via publish()
+    hub_->acquireGrab("ZEDRecorder");
+    
     while (recording_) {
         // Use appropriate camera instance for grabbing frames
-        sl::Camera& active_camera = (dual_camera_mode_ && using_secondary_) ? zed_secondary_ : zed_;
+        FrameSource& active_source = (dual_camera_mode_ && using_secondary_ && secondary_source_) ? *secondary_source_ : *source_;
         
         // Erfasse neuen Frame mit Error-Handling
-        sl::ERROR_CODE grab_result = active_camera.grab();
+        auto grab_start = std::chrono::steady_clock::now();
+        sl::ERROR_CODE grab_result = active_source.grab(sl::RuntimeParameters());
+        grab_latency_.recordSince(grab_start);
         
         // CRITICAL: Treat CORRUPTED_FRAME as warning, not fatal error
         // Common with fast shutter speeds, dark scenes, or covered lens (e.g., landing in grass)
@@ -292,6 +368,11 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
             
             // Increment frame counter for synchronized depth map naming
             current_frame_number_++;
+            PublishResult published;
+            {
+                ScopedLatency timer(publish_latency_);
+                published = hub_->publish(active_source, static_cast<uint64_t>(current_frame_number_.load()), frame_corrupted);
+            }
             
             // GAP DETECTION: Check for frame timing gaps
             auto current_frame_time = std::chrono::steady_clock::now();
@@ -306,91 +387,43 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
             last_frame_time = current_frame_time;
             
             // PERFORMANCE TEST: Compute depth map if enabled (without saving)
+            // With depth subscribers the hub already retrieved (or will retrieve on its due frames)
+            // the map; a second full copy here would only double the memory traffic
             if (compute_depth_) {
-                auto depth_start = std::chrono::high_resolution_clock::now();
-                
-                // Retrieve depth map (triggers computation)
-                sl::ERROR_CODE depth_result = active_camera.retrieveMeasure(depth_map_, sl::MEASURE::DEPTH, sl::MEM::CPU);
-                
-                auto depth_end = std::chrono::high_resolution_clock::now();
-                auto depth_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(depth_end - depth_start).count();
+                std::chrono::microseconds depth_time{0};
+                bool depth_measured = false;
+                if (published.depth_retrieved) {
+                    depth_time = published.depth_time;
+                    depth_measured = true;
+                } else if (!hub_->wantsDepth()) {
+                    auto depth_start = std::chrono::steady_clock::now();
+                    
+                    // Retrieve depth map (triggers computation)
+                    if (active_source.retrieveMeasure(depth_map_, sl::MEASURE::DEPTH) == sl::ERROR_CODE::SUCCESS) {
+                        depth_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - depth_start);
+                        depth_latency_.record(depth_time);
+                        depth_measured = true;
+                    }
+                }
                 
                 // Calculate depth computation FPS (rolling average)
-                if (depth_time_ms > 0) {
-                    float instant_depth_fps = 1000.0f / depth_time_ms;
+                if (depth_measured && depth_time.count() > 0) {
+                    float instant_depth_fps = 1000000.0f / depth_time.count();
                     depth_fps_ = (depth_fps_ * 0.9f) + (instant_depth_fps * 0.1f); // Smooth average
                 }
                 
                 // Log performance periodically
                 static int depth_log_counter = 0;
-                if (++depth_log_counter % 90 == 0) {  // Log every ~3 seconds at 30fps
+                if (depth_measured && ++depth_log_counter % 90 == 0) {  // Log every ~3 seconds at 30fps
                     std::cout << "[ZED PERF] Depth computation: " << depth_fps_.load() << " FPS (took " 
-                              << depth_time_ms << "ms)" << std::endl;
-                }
-            }
-            
-            // Intelligente Sensor-Erfassung basierend auf Modus
-            bool capture_sensors = (sensor_skip_counter % sensor_skip_rate == 0);
-            
-            if (capture_sensors && active_camera.getSensorsData(sensor_data, sl::TIME_REFERENCE::CURRENT) == sl::ERROR_CODE::SUCCESS) {
-                auto rotation = sensor_data.imu.pose.getEulerAngles();
-                auto accel = sensor_data.imu.linear_acceleration;
-                auto gyro = sensor_data.imu.angular_velocity;
-                
-                // Magnetometer und Barometer können optional sein
-                auto mag = sensor_data.magnetometer.magnetic_field_calibrated;
-                auto pressure = sensor_data.barometer.pressure;
-                
-                // In Datei schreiben
-                if (sensor_file_.is_open()) {
-                    auto now = std::chrono::system_clock::now();
-                    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        now.time_since_epoch()).count();
-                    
-                    sensor_file_ << ms << "," 
-                               << rotation[0] << "," << rotation[1] << "," << rotation[2] << ","
-                               << accel[0] << "," << accel[1] << "," << accel[2] << ","
-                               << gyro[0] << "," << gyro[1] << "," << gyro[2] << ","
-                               << mag[0] << "," << mag[1] << "," << mag[2] << ","
-                               << pressure << ",0.0" << std::endl; // Temperatur placeholder
+                              << depth_time.count() / 1000.0 << "ms)" << std::endl;
                 }
             }
             
-            // Aktualisiere geschriebene Bytes (verwende aktuellen Pfad)
-            if (std::filesystem::exists(current_video_path_)) {
-                bytes_written_ = std::filesystem::file_size(current_video_path_);
-            } else if (std::filesystem::exists(video_path)) {
-                bytes_written_ = std::filesystem::file_size(video_path);
-            }
-            
-            // BUFFER MONITORING: Track file size growth rate to detect buffer issues
-            static auto last_size_check = std::chrono::steady_clock::now();
-            static size_t last_file_size = 0;
-            auto now_check = std::chrono::steady_clock::now();
-            
-            if (std::chrono::duration_cast<std::chrono::seconds>(now_check - last_size_check).count() > 10) {
-                size_t size_growth = bytes_written_ - last_file_size;
-                size_t growth_rate_mb_per_sec = size_growth / (1024 * 1024 * 10);  // MB/s over 10s
-                
-                // Warn if file size stopped growing (indicates buffer buildup)
-                if (size_growth < 10485760 && bytes_written_ > 1073741824) {  // <10MB growth in 10s for >1GB file
-                    std::cout << "[ZED] WARNING: File size plateau detected - potential buffer buildup!" << std::endl;
-                }
-                
-            // AUTO-SEGMENTATION DISABLED - No longer needed with NTFS/exFAT >4GB support
-            // Files can now grow beyond 4GB without corruption on NTFS/exFAT formatted USB drives
-            
-            // NTFS/exFAT Support: No hard 4GB limit - only warn at very large sizes
-            if (bytes_written_ > 17179869184) {  // Warn at 16GB (reasonable large file warning)
-                std::cout << "[ZED] INFO: Large file recording (" 
-                          << bytes_written_/1024/1024/1024 << "GB). Ensure sufficient disk space." << std::endl;
-            }
-                last_file_size = bytes_written_;
-                last_size_check = now_check;
-            }
+            // Bytes written / MB/s / plateau detection: see write_monitor_ (no filesystem calls per frame)
             
             // Regelmäßige Filesystem-Syncs für Datenintegrität (alle 30 Sekunden)
-            sensor_skip_counter++;
             static int sync_counter = 0;
             sync_counter++;
             
@@ -398,7 +431,6 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
             static int status_counter = 0;
             if (++status_counter % 1800 == 0) {  // Status every ~60 seconds
                 std::cout << "[ZED] Recording status: " << bytes_written_/1024/1024 << "MB" << std::endl;
-                sensor_file_.flush();  // Periodic sensor data flush
             }
         } else {
             // Handle grab failures (USB reset, disconnection, etc.)
@@ -420,8 +452,8 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
                 break;
             }
             
-            // Längere Pause bei Fehlern um ZED-Recovery zu ermöglichen
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Längere Pause bei Fehlern um ZED-Recovery zu ermöglichen (stopRecording() weckt sofort)
+            waitUnlessStopped(std::chrono::milliseconds(100));
             continue;
         }
         
@@ -436,107 +468,99 @@ void ZEDRecorder::recordingLoop(const std::string& video_path) {
             case RecordingMode::HD2K_15FPS:   sleep_ms = 10; break; // 15FPS = längere Pause
             default: sleep_ms = 10; break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        waitUnlessStopped(std::chrono::milliseconds(sleep_ms));
     }
     
     // CRITICAL: Recording loop ended - quick cleanup only
     std::cout << "[ZED] Recording loop ended, performing quick cleanup..." << std::endl;
+    hub_->releaseGrab();
     
-    // Final sensor file flush (quick operation)
-    if (sensor_file_.is_open()) {
-        sensor_file_.flush();
+    // Final sensor log flush (only wakes the writer thread)
+    if (sensor_log_.isOpen()) {
+        sensor_log_.flush();
     }
     
     // NO blocking sync in recording loop - save for shutdown sequence
     std::cout << "[ZED] Recording loop cleanup completed." << std::endl;
 }
 
+void ZEDRecorder::waitUnlessStopped(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    stop_cv_.wait_for(lock, timeout, [this]() { return !recording_; });
+}
+
 void ZEDRecorder::stopRecording() {
-    if (recording_) {
-        std::cout << "Stopping recording - setting flag..." << std::endl;
+    if (!recording_) {
+        return;
+    }
+    
+    // Every phase ends on a completion event (thread join, SDK call returning, fsync) - no fixed sleeps
+    auto stop_start = std::chrono::steady_clock::now();
+    RecordingStopTiming timing;
+    std::cout << "[ZED] Stopping recording..." << std::endl;
+    
+    // STEP 1: Signal the loop; the flag is set under stop_mutex_ so the pacing wait cannot miss it
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
         recording_ = false;
-        
-        // Kurz warten damit der Recording-Thread das Flag sieht
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // Versuche Thread zu beenden mit OPTIMIERTEM Timeout
-        if (record_thread_ && record_thread_->joinable()) {
-            std::cout << "Waiting for recording thread to finish..." << std::endl;
-            
-            // OPTIMIERT: Reduzierter max_wait für schnellere Stopps
-            int max_wait_seconds = 5;  // Von 15 auf 5 Sekunden reduziert
-            auto start_wait = std::chrono::steady_clock::now();
-            bool thread_finished = false;
-            
-            while (!thread_finished && 
-                   std::chrono::duration_cast<std::chrono::seconds>(
-                       std::chrono::steady_clock::now() - start_wait).count() < max_wait_seconds) {
-                
-                if (record_thread_->joinable()) {
-                    // OPTIMIERT: Schnellere Check-Intervalle
-                    std::this_thread::sleep_for(std::chrono::milliseconds(200));  // Von 500ms auf 200ms
-                } else {
-                    thread_finished = true;
-                }
-            }
-            
-            if (record_thread_->joinable()) {
-                std::cout << "Joining recording thread..." << std::endl;
-                record_thread_->join();
-                std::cout << "Recording thread joined successfully." << std::endl;
-            } else {
-                std::cout << "Thread already finished." << std::endl;
-            }
-        }
-        
-        // ENHANCED: Large file corruption prevention shutdown sequence
-        std::cout << "Disabling ZED recording..." << std::endl;
-        
+    }
+    stop_cv_.notify_all();
+    if (record_thread_ && record_thread_->joinable()) {
+        record_thread_->join();     // Returns once the in-flight grab finished and the grab was released
+    }
+    timing.loop_exit_ms = elapsedMs(stop_start);
+    
+    // Last sample stays in bytes_written_
+    write_monitor_.stop();
+    
+    // STEP 2: Finalize the SVO2 - disableRecording() returns after the SDK wrote and closed the file
+    // (offline sources never enabled SVO recording - nothing to finalize)
+    bool live_source = !source_ || source_->isLiveCamera();
+    if (live_source) {
+        auto finalize_start = std::chrono::steady_clock::now();
         try {
-            // STEP 1: Pre-disable sync for large files (prevent in-flight corruption)
-            if (bytes_written_ > 1073741824) {  // >1GB files
-                std::cout << "Large file pre-shutdown sync..." << std::endl;
-                sync();  // Flush any pending writes
-                std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Let ZED buffers settle
-            }
-            
-            // STEP 2: Disable ZED recording
             zed_.disableRecording();
-            std::cout << "ZED recording disabled." << std::endl;
-            
-            // STEP 3: Critical wait for large files - ZED SDK needs time to flush buffers
-            int wait_time_ms = (bytes_written_ > 2147483648) ? 3000 :    // >2GB = 3s wait
-                              (bytes_written_ > 1073741824) ? 2000 :     // >1GB = 2s wait  
-                              500;                                       // <1GB = 0.5s wait
-            
-            std::cout << "Waiting " << wait_time_ms << "ms for ZED buffer flush (file size: " 
-                      << bytes_written_/1024/1024 << "MB)..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(wait_time_ms));
-            
-            // STEP 4: Final critical sync
-            std::cout << "Final filesystem sync..." << std::endl;
-            sync();
-            
-            // STEP 5: Verify file integrity
-            if (std::filesystem::exists(current_video_path_)) {
-                auto final_size = std::filesystem::file_size(current_video_path_);
-                std::cout << "Final file size: " << final_size/1024/1024 << "MB" << std::endl;
-            }
-            
-            std::cout << "ZED recording finalized with enhanced large file protection." << std::endl;
-            
         } catch (const std::exception& e) {
-            std::cerr << "Error during ZED recording shutdown: " << e.what() << std::endl;
+            std::cerr << "[ZED] Error during ZED recording shutdown: " << e.what() << std::endl;
         }
-        
-        if (sensor_file_.is_open()) {
-            std::cout << "Closing sensor file..." << std::endl;
-            sensor_file_.close();
-            std::cout << "Sensor file closed." << std::endl;
-        }
-        
-        std::cout << "Recording stopped successfully." << std::endl;
+        timing.finalize_ms = elapsedMs(finalize_start);
     }
+    
+    // STEP 3: Drain and close the sensor log (writer thread writes what is left in its ring)
+    auto sensor_start = std::chrono::steady_clock::now();
+    std::string sensor_path = sensor_log_.isOpen() ? sensor_log_.getPath() : "";
+    imu_sampler_.stop();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
+    }
+    timing.sensor_close_ms = elapsedMs(sensor_start);
+    
+    // STEP 4: Make the recording durable - fsync its files and directory instead of a global sync()
+    auto fsync_start = std::chrono::steady_clock::now();
+    bool synced = true;
+    if (live_source) {
+        synced &= fsyncPath(current_video_path_);
+    }
+    synced &= fsyncPath(sensor_path);
+    std::string directory = std::filesystem::path(current_video_path_).parent_path().string();
+    synced &= fsyncPath(directory, O_RDONLY | O_DIRECTORY);
+    timing.fsync_ms = elapsedMs(fsync_start);
+    if (!synced) {
+        std::cerr << "[ZED] Warning: fsync of recording files failed" << std::endl;
+    }
+    
+    std::error_code ec;
+    auto final_size = std::filesystem::file_size(current_video_path_, ec);
+    timing.bytes = ec ? bytes_written_.load() : static_cast<uint64_t>(final_size);
+    timing.total_ms = elapsedMs(stop_start);
+    last_stop_timing_ = timing;
+    
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(0)
+         << "[ZED] Recording stopped in " << timing.total_ms << "ms (loop exit " << timing.loop_exit_ms
+         << "ms, finalize " << timing.finalize_ms << "ms, sensors " << timing.sensor_close_ms
+         << "ms, fsync " << timing.fsync_ms << "ms) - " << timing.bytes / 1024 / 1024 << "MB";
+    std::cout << line.str() << std::endl;
 }
 
 void ZEDRecorder::enableDepthComputation(bool enable, sl::DEPTH_MODE mode) {
@@ -574,10 +598,14 @@ void ZEDRecorder::close() {
     }
     
     // Schließe Sensordatei
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    imu_sampler_.stop();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
+    // Stop idle preview grabs before the camera goes away
+    hub_.reset();
+    
     // Schließe ZED Kamera explizit
     try {
         if (zed_.isOpened()) {
@@ -591,26 +619,45 @@ void ZEDRecorder::close() {
         std::cerr << "[ZED] Error closing camera: " << e.what() << std::endl;
     }
     
+    // Release offline sources (ZedFrameSource is recreated by the next init())
+    source_.reset();
+    
     std::cout << "[ZED] Camera close completed" << std::endl;
 }
 
+void ZEDRecorder::startImuSampler(FrameSource& source) {
+    // Segment switches close/reopen sensor_log_ underneath the sampler (samples in between are dropped)
+    imu_sampler_.start(source, sensor_log_, [this] { return static_cast<int64_t>(current_frame_number_.load()); }, "ZEDRecorder");
+}
+
+LatencyReport ZEDRecorder::getLatencyReport() const {
+    LatencyReport report = {
+        {"svo.grab", grab_latency_.summary()},
+        {"svo.retrieve_measure", depth_latency_.summary()},
+        {"svo.publish", publish_latency_.summary()},
+    };
+    if (hub_) {
+        LatencyReport hub_report = hub_->getLatencyReport();
+        report.insert(report.end(), hub_report.begin(), hub_report.end());
+    }
+    report.emplace_back("sensor.poll", imu_sampler_.getPollLatency().summary());
+    report.emplace_back("sensor.write", sensor_log_.getWriteLatency().summary());
+    return report;
+}
+
 bool ZEDRecorder::isRecording() const {
     return recording_;
 }
 
 long ZEDRecorder::getBytesWritten() const {
-    // Use filesystem directly for accurate large file sizes
-    try {
-        if (!current_video_path_.empty() && std::filesystem::exists(current_video_path_)) {
-            auto size = std::filesystem::file_size(current_video_path_);
-            return static_cast<long>(size);
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Error getting file size: " << e.what() << std::endl;
-    }
+    // Sampled by write_monitor_ (size_t atomic - files >4GB on NTFS/exFAT)
     return static_cast<long>(bytes_written_.load());
 }
 
+double ZEDRecorder::getWriteRateMBps() const {
+    return write_monitor_.getMBPerSec();
+}
+
 bool ZEDRecorder::switchToNewSegment(const std::string& new_video_path, const std::string& new_sensor_path) {
     if (!recording_) {
         std::cerr << "Cannot switch segment: not currently recording" << std::endl;
@@ -631,24 +678,20 @@ bool ZEDRecorder::switchToNewSegment(const std::string& new_video_path, const st
     zed_.disableRecording();
     
     // Close current sensor file
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
     // STEP 3: Immediately start new recording with minimal gap
     std::cout << "[ZED] Starting new segment..." << std::endl;
     
     // Open new sensor file
-    sensor_file_.open(new_sensor_path);
-    if (!sensor_file_.is_open()) {
+    if (!sensor_log_.open(new_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "Failed to open new sensor file: " << new_sensor_path << std::endl;
         recording_ = false;
         return false;
     }
     
-    // Write sensor header
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
     
     // Set up new recording parameters
     sl::RecordingParameters rec_params;
@@ -659,7 +702,7 @@ bool ZEDRecorder::switchToNewSegment(const std::string& new_video_path, const st
     sl::ERROR_CODE err = zed_.enableRecording(rec_params);
     if (err != sl::ERROR_CODE::SUCCESS) {
         std::cerr << "Failed to start new segment: " << err << std::endl;
-        sensor_file_.close();
+        sensor_log_.close();
         recording_ = false;
         return false;
     }
@@ -689,6 +732,7 @@ bool ZEDRecorder::switchToNewSegment(const std::string& new_video_path, const st
     // Update tracking variables
     current_video_path_ = actual_video_path;
     bytes_written_ = 0;  // Reset byte counter for new segment
+    write_monitor_.setPath(current_video_path_);
     
     std::cout << "[ZED] SEGMENTATION SUCCESS: New file created: " << actual_video_path << std::endl;
     return true;
@@ -710,21 +754,17 @@ bool ZEDRecorder::fastSwitchToNewSegment(const std::string& new_video_path, cons
     zed_.disableRecording();
     
     // STEP 2: Close current sensor file
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
     // STEP 3: Open new sensor file immediately
-    sensor_file_.open(new_sensor_path);
-    if (!sensor_file_.is_open()) {
+    if (!sensor_log_.open(new_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "[ZED] FAST-SWITCH FAILED: Cannot open new sensor file" << std::endl;
         recording_ = false;
         return false;
     }
     
-    // Write sensor header
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
     
     // STEP 4: Immediate re-enable with new file (like ZED Explorer start button)
     sl::RecordingParameters rec_params;
@@ -735,7 +775,7 @@ bool ZEDRecorder::fastSwitchToNewSegment(const std::string& new_video_path, cons
     sl::ERROR_CODE err = zed_.enableRecording(rec_params);
     if (err != sl::ERROR_CODE::SUCCESS) {
         std::cerr << "[ZED] FAST-SWITCH FAILED: Cannot start new recording: " << err << std::endl;
-        sensor_file_.close();
+        sensor_log_.close();
         recording_ = false;
         return false;
     }
@@ -765,6 +805,7 @@ bool ZEDRecorder::fastSwitchToNewSegment(const std::string& new_video_path, cons
     // Update tracking
     current_video_path_ = actual_video_path;
     bytes_written_ = 0;
+    write_monitor_.setPath(current_video_path_);
     
     auto switch_end = std::chrono::steady_clock::now();
     auto switch_time = std::chrono::duration_cast<std::chrono::milliseconds>(switch_end - switch_start).count();
@@ -849,21 +890,17 @@ bool ZEDRecorder::dualInstanceSwitch(const std::string& new_video_path, const st
     }
     
     // STEP 2: Close old sensor file and open new one
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
-    sensor_file_.open(new_sensor_path);
-    if (!sensor_file_.is_open()) {
+    if (!sensor_log_.open(new_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "[ZED] OVERLAPPED SWITCH: Failed to open new sensor file" << std::endl;
         zed_.disableRecording();
         recording_ = false;
         return false;
     }
     
-    // Write sensor header
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
     
     // STEP 3: Verify new file creation (minimal wait)
     bool file_created = false;
@@ -890,6 +927,7 @@ bool ZEDRecorder::dualInstanceSwitch(const std::string& new_video_path, const st
     // Update tracking
     current_video_path_ = actual_video_path;
     bytes_written_ = 0;
+    write_monitor_.setPath(current_video_path_);
     next_recording_prepared_ = false; // Reset for next segment
     
     auto switch_end = std::chrono::steady_clock::now();
@@ -938,6 +976,7 @@ bool ZEDRecorder::initDualCamera() {
         return false;
     }
     
+    secondary_source_ = std::make_unique<ZedFrameSource>(zed_secondary_);
     dual_camera_mode_ = true;
     std::cout << "[ZED] Dual camera mode enabled - ready for instant switching!" << std::endl;
     return true;
@@ -982,26 +1021,27 @@ bool ZEDRecorder::instantSwapRecording(const std::string& new_video_path, const
     // Switch active camera flag
     using_secondary_ = !using_secondary_;
     
+    // Sample sensors from the camera that is recording now
+    imu_sampler_.stop();
+    startImuSampler(using_secondary_ ? *secondary_source_ : *source_);
+    
     // Handle sensor file switch
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
-    sensor_file_.open(new_sensor_path);
-    if (!sensor_file_.is_open()) {
+    if (!sensor_log_.open(new_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "[ZED] INSTANT SWAP: Failed to open new sensor file" << std::endl;
         next_camera.disableRecording();
         recording_ = false;
         return false;
     }
     
-    // Write sensor header
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
     
     // Update tracking
     current_video_path_ = new_video_path;
     bytes_written_ = 0;
+    write_monitor_.setPath(current_video_path_);
     
     auto swap_end = std::chrono::steady_clock::now();
     auto swap_time = std::chrono::duration_cast<std::chrono::milliseconds>(swap_end - swap_start).count();
@@ -1074,21 +1114,17 @@ bool ZEDRecorder::memoryBufferedSwitch(const std::string& new_video_path, const
     buffer_thread.join();
     
     // STEP 6: Quick file handling
-    if (sensor_file_.is_open()) {
-        sensor_file_.close();
+    if (sensor_log_.isOpen()) {
+        sensor_log_.close();
     }
     
-    sensor_file_.open(new_sensor_path);
-    if (!sensor_file_.is_open()) {
+    if (!sensor_log_.open(new_sensor_path, sensor_log::Layout::ZED_SVO)) {
         std::cerr << "[ZED] MEMORY-BUFFERED SWITCH: Failed to open new sensor file" << std::endl;
         zed_.disableRecording();
         recording_ = false;
         return false;
     }
     
-    // Write sensor header
-    sensor_file_ << "timestamp,rotation_x,rotation_y,rotation_z,accel_x,accel_y,accel_z,"
-                 << "gyro_x,gyro_y,gyro_z,mag_x,mag_y,mag_z,pressure,temperature" << std::endl;
     
     // STEP 7: Process buffered frames into new recording
     std::cout << "[ZED] Processing " << temp_buffer.size() << " buffered frames..." << std::endl;
@@ -1098,6 +1134,7 @@ bool ZEDRecorder::memoryBufferedSwitch(const std::string& new_video_path, const
     // Update tracking
     current_video_path_ = new_video_path;
     bytes_written_ = 0;
+    write_monitor_.setPath(current_video_path_);
     
     auto switch_end = std::chrono::steady_clock::now();
     auto switch_time = std::chrono::duration_cast<std::chrono::milliseconds>(switch_end - switch_start).count();
@@ -1125,6 +1162,11 @@ bool ZEDRecorder::getLatestDepthMap(sl::Mat& out_depth) {
         return false;
     }
     
+    // depth_map_ is only refreshed while no hub subscriber takes depth (see recordingLoop)
+    if (hub_ && hub_->wantsDepth()) {
+        return false;
+    }
+    
     // Copy the current depth map to output using ZED SDK clone method
     if (depth_map_.isInit()) {
         out_depth.clone(depth_map_);  // Correct ZED SDK syntax: dest.clone(source)
@@ -5,6 +5,14 @@
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "frame_source.h"
+#include "capture_hub.h"
+#include "write_rate_monitor.h"
+#include "imu_sampler.h"
+#include "latency_histogram.h"
 
 enum class RecordingMode {
     HD720_60FPS,     // 720p @ 60fps
@@ -15,6 +23,16 @@ enum class RecordingMode {
     VGA_100FPS       // VGA @ 100fps
 };
 
+// Phase durations of one stopRecording() call
+struct RecordingStopTiming {
+    double loop_exit_ms = 0.0;      // Stop signal -> recording thread joined (at most one grab)
+    double finalize_ms = 0.0;       // disableRecording(): SDK writes and closes the SVO2
+    double sensor_close_ms = 0.0;   // IMU sampler stop + sensor log drain/close
+    double fsync_ms = 0.0;          // fsync of the SVO2, sensor log and recording directory
+    double total_ms = 0.0;
+    uint64_t bytes = 0;             // Final SVO2 size
+};
+
 class ZEDRecorder {
 public:
     ZEDRecorder();
@@ -23,12 +41,25 @@ public:
     // Initialisiere die Kamera mit spezifischem Modus
     bool init(RecordingMode mode = RecordingMode::HD720_30FPS);
     
+    // Initialisiere mit externer Bildquelle (synthetisch/Replay, ohne Kamera)
+    // Offline sources record sensors only - SVO2 needs a live camera
+    bool initWithSource(std::unique_ptr<FrameSource> source, RecordingMode mode = RecordingMode::HD720_30FPS);
+    
+    // Active frame source (nullptr before init)
+    FrameSource* getFrameSource() { return source_.get(); }
+    
+    // Fan-out of grabbed frames to depth writers / visualisation / preview (nullptr before init)
+    CaptureHub* getCaptureHub() { return hub_.get(); }
+    
     // Starte Aufnahme
     bool startRecording(const std::string& video_path, const std::string& sensor_path);
     
-    // Stoppe Aufnahme
+    // Stoppe Aufnahme: weckt die Aufnahmeschleife sofort, finalisiert SVO2 + Sensorlog, fsync nur dieser Dateien
     void stopRecording();
     
+    // Timing breakdown of the last stopRecording() (valid once it returned)
+    RecordingStopTiming getLastStopTiming() const { return last_stop_timing_; }
+    
     // Schließe Kamera explizit (für ordnungsgemäßen Neustart)
     void close();
     
@@ -40,7 +71,8 @@ public:
     float getDepthComputationFPS() const { return depth_fps_; }
     
     // Get latest depth map (for visualization)
-    // Returns true if depth data is available, false otherwise
+    // Returns true if depth data is available, false otherwise (also while the
+    // CaptureHub serves depth subscribers - subscribe with depth = true instead)
     bool getLatestDepthMap(sl::Mat& out_depth);
     
     // Get current frame number (for synchronized depth map naming)
@@ -62,6 +94,9 @@ public:
     // Get current recording mode
     RecordingMode getCurrentMode() const { return current_mode_; }
     
+    // SVO file of the current/last recording (".svo2" resolved by startRecording)
+    const std::string& getVideoPath() const { return current_video_path_; }
+    
     // === PRODUCTION READY FEATURES ===
     
     // Auto-segmentation DISABLED - no longer needed with NTFS/exFAT >4GB support
@@ -87,6 +122,9 @@ public:
     // Status
     bool isRecording() const;
     long getBytesWritten() const;
+    double getWriteRateMBps() const;  // Smoothed SVO file growth rate (sampled once per second)
+    ImuSamplerStats getImuStats() const { return imu_sampler_.getStats(); }  // Achieved IMU/mag/baro rates and gaps
+    LatencyReport getLatencyReport() const;  // Per-stage p50/p95/p99/max since startRecording()
     // int getCurrentSegment() const { return current_segment_; } // DISABLED: Segmentation removed
     
     // Hilfsfunktion für Modus-Namen
@@ -94,10 +132,17 @@ public:
     
 private:
     sl::Camera zed_;
+    std::unique_ptr<FrameSource> source_;  // Frame source used by recordingLoop (ZedFrameSource after init())
+    std::unique_ptr<CaptureHub> hub_;      // Sole grabber outside recordingLoop; destroyed before source_
     std::atomic<bool> recording_;
     std::atomic<size_t> bytes_written_;  // FIX: Support files >4GB
-    std::ofstream sensor_file_;
+    WriteRateMonitor write_monitor_;     // Background size sampler - keeps stat() out of recordingLoop
+    SensorLogWriter sensor_log_;         // Binary IMU log, written on its own thread
+    ImuSampler imu_sampler_;             // Sole producer of sensor_log_ - polls sensors at native rate
     std::unique_ptr<std::thread> record_thread_;
+    std::mutex stop_mutex_;                  // Guards the recording_ -> false transition for stop_cv_
+    std::condition_variable stop_cv_;        // Wakes recordingLoop's pacing wait on stop
+    RecordingStopTiming last_stop_timing_;
     RecordingMode current_mode_;
     std::string current_video_path_;  // Aktueller Videodateipfad (.svo oder .svo2)
     
@@ -108,6 +153,11 @@ private:
     sl::Mat depth_map_;  // Reusable depth map buffer
     std::atomic<int> current_frame_number_{0};  // Current frame number for synchronized naming
     
+    // Stage latencies of recordingLoop (reset by startRecording)
+    LatencyHistogram grab_latency_;
+    LatencyHistogram depth_latency_;
+    LatencyHistogram publish_latency_;
+    
     // Auto-segmentation support - DISABLED (no longer needed with NTFS/exFAT)
     // std::atomic<bool> auto_segment_{false};
     // std::atomic<int> current_segment_{1};
@@ -121,6 +171,7 @@ private:
     
     // [EXPERIMENTAL] Dual-camera support for instant switching (requires 2 ZED cameras)
     sl::Camera zed_secondary_;
+    std::unique_ptr<FrameSource> secondary_source_;
     bool dual_camera_mode_{false};
     bool using_secondary_{false};
     
@@ -133,6 +184,8 @@ private:
     
     // Aufnahme-Thread
     void recordingLoop(const std::string& video_path);
+    void waitUnlessStopped(std::chrono::milliseconds timeout);   // Pacing sleep that ends early on stop
+    void startImuSampler(FrameSource& source);
     
     // Helper methods for auto-segmentation
     std::string generateSegmentPath(const std::string& base_path, int segment_num, const std::string& extension);
@@ -0,0 +1,105 @@
+#include "event_broadcaster.h"
+#include <iostream>
+
+EventBroadcaster::EventBroadcaster() : EventBroadcaster(Config()) {
+}
+
+EventBroadcaster::EventBroadcaster(const Config& config) : config_(config) {
+}
+
+EventBroadcaster::~EventBroadcaster() {
+    closeAll();
+}
+
+std::string EventBroadcaster::format(const std::string& event, const std::string& data) {
+    std::string chunk;
+    chunk.reserve(event.size() + data.size() + 16);
+    if (!event.empty()) {
+        chunk += "event: " + event + "\n";
+    }
+    // Multi-line payloads need one "data:" line each
+    size_t pos = 0;
+    while (true) {
+        size_t end = data.find('\n', pos);
+        chunk += "data: ";
+        chunk.append(data, pos, end == std::string::npos ? std::string::npos : end - pos);
+        chunk += "\n";
+        if (end == std::string::npos) {
+            break;
+        }
+        pos = end + 1;
+    }
+    chunk += "\n";
+    return chunk;
+}
+
+HttpResponse EventBroadcaster::openStream(const std::string& initial_event, const std::string& initial_data) {
+    auto stream = std::make_shared<HttpStream>(config_.client_backlog);
+    std::string first = "retry: " + std::to_string(config_.retry_ms) + "\n\n";
+    if (!initial_data.empty()) {
+        first += format(initial_event, initial_data);
+    }
+    stream->send(std::make_shared<const std::string>(std::move(first)));
+
+    size_t clients = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (clients_.size() >= config_.max_clients) {
+            return HttpResponse::make(503, "text/plain", "Too many event clients");
+        }
+        clients_.push_back(stream);
+        clients = clients_.size();
+    }
+    std::cout << "[EVENTS] Client connected (" << clients << " clients)" << std::endl;
+
+    HttpResponse response = HttpResponse::makeStream("text/event-stream", stream);
+    response.setHeader("X-Accel-Buffering", "no");
+    return response;
+}
+
+void EventBroadcaster::publish(const std::string& event, const std::string& data) {
+    broadcast(std::make_shared<const std::string>(format(event, data)));
+    published_++;
+}
+
+void EventBroadcaster::heartbeat() {
+    static const auto ping = std::make_shared<const std::string>(": ping\n\n");
+    broadcast(ping);
+}
+
+void EventBroadcaster::closeAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& client : clients_) {
+        dropped_by_removed_ += client->getDropped();
+        client->close();
+    }
+    clients_.clear();
+}
+
+size_t EventBroadcaster::getClientCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
+
+uint64_t EventBroadcaster::getDropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t dropped = dropped_by_removed_;
+    for (const auto& client : clients_) {
+        dropped += client->getDropped();
+    }
+    return dropped;
+}
+
+void EventBroadcaster::broadcast(const std::shared_ptr<const std::string>& chunk) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        // send() fails once the server detached the stream (client gone)
+        if (!(*it)->send(chunk)) {
+            dropped_by_removed_ += (*it)->getDropped();
+            it = clients_.erase(it);
+            std::cout << "[EVENTS] Client disconnected (" << clients_.size() << " clients)" << std::endl;
+        } else {
+            ++it;
+        }
+    }
+}
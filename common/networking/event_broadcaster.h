@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "http_server.h"
+
+/**
+ * @brief Server-Sent Events (text/event-stream) fan-out
+ *
+ * publish() formats an event once and queues the same buffer on every
+ * connected client's HttpStream. A client that cannot keep up drops its
+ * oldest queued events (HttpStream backlog), so publishers must send a full
+ * state event now and then for clients to resynchronise after drops.
+ *
+ * Thread-safe: openStream() runs on the HTTP reactor, publish() on any thread.
+ */
+class EventBroadcaster {
+public:
+    struct Config {
+        size_t max_clients = 8;
+        size_t client_backlog = 16;     // Events queued per client before the oldest are dropped
+        int retry_ms = 2000;            // Reconnect delay sent to EventSource clients
+    };
+
+    EventBroadcaster();
+    explicit EventBroadcaster(const Config& config);
+    ~EventBroadcaster();
+
+    EventBroadcaster(const EventBroadcaster&) = delete;
+    EventBroadcaster& operator=(const EventBroadcaster&) = delete;
+
+    /**
+     * @brief Route handler body: attach a client, optionally with a first event
+     * @return Streaming response, or 503 when too many clients are connected
+     */
+    HttpResponse openStream(const std::string& initial_event = "", const std::string& initial_data = "");
+
+    // Send one event ("event: <name>\ndata: <data>\n\n") to every client
+    void publish(const std::string& event, const std::string& data);
+
+    // Comment line that keeps idle connections (and proxies) from timing out
+    void heartbeat();
+
+    // End all streams (server shutdown)
+    void closeAll();
+
+    size_t getClientCount() const;
+    uint64_t getPublished() const { return published_.load(); }
+    uint64_t getDropped() const;
+
+    static std::string format(const std::string& event, const std::string& data);
+
+private:
+    void broadcast(const std::shared_ptr<const std::string>& chunk);
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<HttpStream>> clients_;
+    uint64_t dropped_by_removed_{0};    // Drops of clients that already disconnected
+    std::atomic<uint64_t> published_{0};
+};
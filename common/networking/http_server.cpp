@@ -0,0 +1,1036 @@
+#include "http_server.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace {
+
+constexpr int MAX_EPOLL_EVENTS = 64;
+constexpr size_t READ_CHUNK = 16 * 1024;
+constexpr size_t FILE_CHUNK = 256 * 1024;          // Per sendfile() call - bounds the reactor's time on a cold USB read
+constexpr int THROTTLE_POLL_MS = 20;                // Reactor wakeup while file bodies wait for rate tokens
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(start, end - start + 1);
+}
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default:  return "";
+    }
+}
+
+HttpResponse errorResponse(int status) {
+    HttpResponse response = HttpResponse::make(status, "text/plain",
+                                               std::to_string(status) + " " + reasonPhrase(status) + "\n");
+    response.close_connection = true;
+    return response;
+}
+
+}  // namespace
+
+// ============================================================================
+// HttpRequest / HttpResponse
+// ============================================================================
+
+std::string HttpRequest::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return "";
+}
+
+std::string HttpRequest::queryParam(const std::string& name) const {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        size_t equals = query.find('=', pos);
+        if (equals != std::string::npos && equals < end && query.compare(pos, equals - pos, name) == 0 &&
+            equals - pos == name.size()) {
+            return query.substr(equals + 1, end - equals - 1);
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+void HttpResponse::setHeader(const std::string& name, const std::string& value) {
+    std::string lower = toLower(name);
+    for (auto& entry : headers) {
+        if (toLower(entry.first) == lower) {
+            entry.second = value;
+            return;
+        }
+    }
+    headers.emplace_back(name, value);
+}
+
+HttpResponse HttpResponse::make(int status, const std::string& content_type, std::string body) {
+    HttpResponse response;
+    response.status = status;
+    response.reason = reasonPhrase(status);
+    response.setHeader("Content-Type", content_type);
+    response.body = std::move(body);
+    return response;
+}
+
+HttpResponse HttpResponse::makeStream(const std::string& content_type, std::shared_ptr<HttpStream> stream) {
+    HttpResponse response = make(200, content_type, "");
+    response.setHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+    response.stream = std::move(stream);
+    return response;
+}
+
+HttpResponse HttpResponse::makeFile(const HttpRequest& request, const std::string& path,
+                                    const std::string& content_type) {
+    auto file = std::make_shared<HttpFileBody>();
+    file->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (file->fd < 0 || fstat(file->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return make(404, "text/plain", "Not Found");
+    }
+    const uint64_t total = static_cast<uint64_t>(st.st_size);
+
+    // Single range only ("bytes=a-b", "bytes=a-", "bytes=-n"); anything else gets the whole file
+    uint64_t first = 0;
+    uint64_t last = total > 0 ? total - 1 : 0;
+    bool partial = false;
+    std::string range = request.header("range");
+    if (range.compare(0, 6, "bytes=") == 0 && range.find(',') == std::string::npos) {
+        std::string spec = trim(range.substr(6));
+        size_t dash = spec.find('-');
+        if (dash != std::string::npos) {
+            std::string from = spec.substr(0, dash);
+            std::string to = spec.substr(dash + 1);
+            char* end = nullptr;
+            if (from.empty() && !to.empty()) {
+                uint64_t suffix = std::strtoull(to.c_str(), &end, 10);
+                if (*end == '\0' && suffix > 0 && total > 0) {
+                    first = suffix >= total ? 0 : total - suffix;
+                    partial = true;
+                }
+            } else if (!from.empty()) {
+                first = std::strtoull(from.c_str(), &end, 10);
+                bool valid = (*end == '\0');
+                if (valid && !to.empty()) {
+                    last = std::min<uint64_t>(std::strtoull(to.c_str(), &end, 10), last);
+                    valid = (*end == '\0');
+                }
+                if (valid && (first >= total || first > last)) {
+                    HttpResponse response = make(416, "text/plain", "");
+                    response.setHeader("Content-Range", "bytes */" + std::to_string(total));
+                    return response;
+                }
+                partial = valid;
+            }
+        }
+    }
+    if (!partial) {
+        first = 0;
+        last = total > 0 ? total - 1 : 0;
+    }
+
+    file->offset = first;
+    file->length = total > 0 ? last - first + 1 : 0;
+    posix_fadvise(file->fd, static_cast<off_t>(first), static_cast<off_t>(file->length), POSIX_FADV_SEQUENTIAL);
+
+    HttpResponse response = make(partial ? 206 : 200, content_type, "");
+    response.setHeader("Accept-Ranges", "bytes");
+    if (partial) {
+        response.setHeader("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+                                                std::to_string(total));
+    }
+    response.file = std::move(file);
+    return response;
+}
+
+HttpResponse HttpResponse::fromRaw(const std::string& raw) {
+    HttpResponse response;
+    size_t header_end = raw.find("\r\n\r\n");
+    if (raw.compare(0, 5, "HTTP/") != 0 || header_end == std::string::npos) {
+        response.setHeader("Content-Type", "text/plain");
+        response.body = raw;
+        return response;
+    }
+
+    // Status line: "HTTP/1.1 200 OK"
+    size_t line_end = raw.find("\r\n");
+    std::istringstream status_line(raw.substr(0, line_end));
+    std::string version;
+    status_line >> version >> response.status;
+    std::getline(status_line, response.reason);
+    response.reason = trim(response.reason);
+
+    size_t pos = line_end + 2;
+    while (pos < header_end) {
+        size_t next = raw.find("\r\n", pos);
+        std::string line = raw.substr(pos, next - pos);
+        pos = next + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = trim(line.substr(0, colon));
+        std::string lower = toLower(name);
+        if (lower == "content-length" || lower == "connection") {
+            continue;
+        }
+        response.headers.emplace_back(name, trim(line.substr(colon + 1)));
+    }
+    response.body = raw.substr(header_end + 4);
+    return response;
+}
+
+// ============================================================================
+// HttpStream
+// ============================================================================
+
+HttpStream::HttpStream(size_t max_pending) : max_pending_(std::max<size_t>(1, max_pending)) {
+}
+
+bool HttpStream::send(std::shared_ptr<const std::string> chunk) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || disconnected_) {
+        return false;
+    }
+    if (pending_.size() >= max_pending_) {
+        pending_.pop_front();       // Slow consumer: skip the stalest chunk
+        dropped_++;
+    }
+    pending_.push_back(std::move(chunk));
+    if (server_) {
+        server_->notifyStreams();
+    }
+    return true;
+}
+
+void HttpStream::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    if (server_) {
+        server_->notifyStreams();
+    }
+}
+
+bool HttpStream::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !closed_ && !disconnected_;
+}
+
+size_t HttpStream::getPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+void HttpStream::attach(HttpServer* server) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    server_ = server;
+}
+
+void HttpStream::detach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    server_ = nullptr;
+    disconnected_ = true;
+    pending_.clear();
+}
+
+bool HttpStream::next(std::shared_ptr<const std::string>& chunk, bool& finished) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+        finished = closed_;
+        return false;
+    }
+    chunk = std::move(pending_.front());
+    pending_.pop_front();
+    return true;
+}
+
+HttpFileBody::~HttpFileBody() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+// ============================================================================
+// HttpServer
+// ============================================================================
+
+HttpServer::HttpServer() : HttpServer(Config()) {
+}
+
+HttpServer::HttpServer(const Config& config)
+    : config_(config), tasks_(config.handler_queue, BackpressurePolicy::DROP_NEWEST),
+      file_rate_limit_(config.file_rate_limit), file_tokens_time_(std::chrono::steady_clock::now()) {
+    fallback_ = [](const HttpRequest&) {
+        return HttpResponse::make(404, "text/html", "<h1>404 Not Found</h1>");
+    };
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::addRoute(const std::string& method, const std::string& path, Dispatch dispatch, Handler handler) {
+    routes_[{method, path}] = Route{dispatch, std::move(handler)};
+}
+
+void HttpServer::addPrefixRoute(const std::string& method, const std::string& prefix, Dispatch dispatch,
+                                Handler handler) {
+    prefix_routes_.push_back({{method, prefix}, Route{dispatch, std::move(handler)}});
+}
+
+const HttpServer::Route* HttpServer::findRoute(const HttpRequest& request) const {
+    auto it = routes_.find({request.method, request.path});
+    if (it != routes_.end()) {
+        return &it->second;
+    }
+    const Route* best = nullptr;
+    size_t best_length = 0;
+    for (const auto& entry : prefix_routes_) {
+        const std::string& prefix = entry.first.second;
+        if (entry.first.first == request.method && prefix.size() > best_length &&
+            request.path.compare(0, prefix.size(), prefix) == 0) {
+            best = &entry.second;
+            best_length = prefix.size();
+        }
+    }
+    return best;
+}
+
+void HttpServer::setFileTransfersPaused(bool paused) {
+    if (files_paused_.exchange(paused) && !paused) {
+        wake();     // Resume held downloads
+    }
+}
+
+void HttpServer::setFallback(Handler handler) {
+    fallback_ = std::move(handler);
+}
+
+void HttpServer::setTickHandler(TickHandler handler) {
+    tick_handler_ = std::move(handler);
+}
+
+bool HttpServer::start() {
+    if (running_ || reactor_thread_) {
+        return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "[HTTP] Socket creation failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(static_cast<uint16_t>(config_.port));
+
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listen_fd_, 64) < 0) {
+        std::cerr << "[HTTP] Bind/listen on port " << config_.port << " failed: " << strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "[HTTP] epoll/eventfd setup failed: " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+    running_ = true;
+    for (int i = 0; i < std::max(1, config_.handler_threads); i++) {
+        workers_.emplace_back(&HttpServer::workerLoop, this);
+    }
+    reactor_thread_ = std::make_unique<std::thread>(&HttpServer::reactorLoop, this);
+
+    std::cout << "[HTTP] Listening on port " << config_.port << " (" << routes_.size() + prefix_routes_.size() << " routes, "
+              << workers_.size() << " handler threads)" << std::endl;
+    return true;
+}
+
+void HttpServer::requestStop() {
+    running_ = false;
+    wake();
+}
+
+void HttpServer::stop() {
+    requestStop();
+    if (reactor_thread_ && reactor_thread_->joinable()) {
+        reactor_thread_->join();
+    }
+    reactor_thread_.reset();
+
+    // Handlers still running finish; their completions are discarded
+    tasks_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+LatencyReport HttpServer::getLatencyReport() const {
+    return {
+        {"http.inline", inline_latency_.summary()},
+        {"http.pool", pool_latency_.summary()},
+        {"http.pool_wait", pool_wait_latency_.summary()},
+    };
+}
+
+void HttpServer::wake() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void HttpServer::reactorLoop() {
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    auto last_tick = std::chrono::steady_clock::now();
+
+    while (running_) {
+        int timeout_ms = have_throttled_ ? std::min(THROTTLE_POLL_MS, config_.tick_interval_ms) : config_.tick_interval_ms;
+        int count = epoll_wait(epoll_fd_, events, MAX_EPOLL_EVENTS, timeout_ms);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "[HTTP] epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == listen_fd_) {
+                acceptClients();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                uint64_t value;
+                while (::read(wake_fd_, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+
+            if (flags & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (flags & EPOLLOUT) {
+                flushOutput(conn);
+                if (connections_.count(fd) == 0) {
+                    continue;
+                }
+                if (conn.stream) {
+                    pumpStream(conn);   // Next chunk queued while this one was draining
+                } else {
+                    processInput(conn); // Requests that arrived while the response was draining
+                }
+                if (connections_.count(fd) == 0) {
+                    continue;
+                }
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP)) {
+                readClient(conn);
+            }
+        }
+
+        drainCompletions();
+        if (streams_dirty_.exchange(false)) {
+            pumpStreams();
+        }
+        resumeThrottled();
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_tick >= std::chrono::milliseconds(config_.tick_interval_ms)) {
+            last_tick = now;
+            sweepIdle();
+            if (tick_handler_) {
+                tick_handler_();
+            }
+        }
+    }
+
+    for (auto& entry : connections_) {
+        if (entry.second->stream) {
+            entry.second->stream->detach();
+        }
+        ::close(entry.first);
+    }
+    connections_.clear();
+    connection_count_ = 0;
+    std::cout << "[HTTP] Reactor stopped" << std::endl;
+}
+
+void HttpServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // EAGAIN: backlog drained
+        }
+        if (connections_.size() >= config_.max_connections) {
+            ::close(fd);
+            continue;
+        }
+
+        // Small JSON responses: do not wait for Nagle
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->id = next_connection_id_++;
+        conn->last_activity = std::chrono::steady_clock::now();
+
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+        connection_count_ = connections_.size();
+    }
+}
+
+void HttpServer::readClient(Connection& conn) {
+    const int fd = conn.fd;
+    char buffer[READ_CHUNK];
+    while (true) {
+        ssize_t got = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            conn.in.append(buffer, static_cast<size_t>(got));
+            conn.last_activity = std::chrono::steady_clock::now();
+            if (conn.in.size() > config_.max_header_bytes + config_.max_body_bytes) {
+                closeConnection(fd);
+                return;
+            }
+            continue;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // Peer closed (or error) - a running POOL handler's response is dropped
+        closeConnection(fd);
+        return;
+    }
+    processInput(conn);
+}
+
+void HttpServer::processInput(Connection& conn) {
+    const int fd = conn.fd;
+    // One request in flight per connection; pipelined requests wait in conn.in
+    while (!conn.busy && !conn.out && !conn.close_after_write && !conn.stream) {
+        HttpRequest request;
+        int error_status = 0;
+        ParseResult result = parseRequest(conn, request, error_status);
+        if (result == ParseResult::INCOMPLETE) {
+            return;
+        }
+        if (result == ParseResult::ERROR) {
+            queueResponse(conn, errorResponse(error_status), false);
+            return;
+        }
+        requests_++;
+        dispatch(conn, std::move(request));
+        if (connections_.count(fd) == 0) {
+            return;
+        }
+    }
+}
+
+HttpServer::ParseResult HttpServer::parseRequest(Connection& conn, HttpRequest& request, int& error_status) {
+    size_t header_end = conn.in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (conn.in.size() > config_.max_header_bytes) {
+            error_status = 431;
+            return ParseResult::ERROR;
+        }
+        return ParseResult::INCOMPLETE;
+    }
+    if (header_end > config_.max_header_bytes) {
+        error_status = 431;
+        return ParseResult::ERROR;
+    }
+
+    // Request line: METHOD SP target SP version
+    size_t line_end = conn.in.find("\r\n");
+    std::istringstream request_line(conn.in.substr(0, line_end));
+    if (!(request_line >> request.method >> request.target >> request.version) ||
+        request.version.compare(0, 5, "HTTP/") != 0) {
+        error_status = 400;
+        return ParseResult::ERROR;
+    }
+    size_t query_pos = request.target.find('?');
+    request.path = request.target.substr(0, query_pos);
+    if (query_pos != std::string::npos) {
+        request.query = request.target.substr(query_pos + 1);
+    }
+
+    size_t pos = line_end + 2;
+    while (pos < header_end) {
+        size_t next = conn.in.find("\r\n", pos);
+        std::string line = conn.in.substr(pos, next - pos);
+        pos = next + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            error_status = 400;
+            return ParseResult::ERROR;
+        }
+        request.headers.emplace_back(toLower(trim(line.substr(0, colon))), trim(line.substr(colon + 1)));
+    }
+
+    if (!request.header("transfer-encoding").empty()) {
+        error_status = 501;     // No chunked uploads - the UI only sends small form bodies
+        return ParseResult::ERROR;
+    }
+    size_t content_length = 0;
+    std::string length_value = request.header("content-length");
+    if (!length_value.empty()) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(length_value.c_str(), &end, 10);
+        if (end == length_value.c_str() || *end != '\0') {
+            error_status = 400;
+            return ParseResult::ERROR;
+        }
+        if (parsed > config_.max_body_bytes) {
+            error_status = 413;
+            return ParseResult::ERROR;
+        }
+        content_length = static_cast<size_t>(parsed);
+    }
+
+    size_t total = header_end + 4 + content_length;
+    if (conn.in.size() < total) {
+        return ParseResult::INCOMPLETE;
+    }
+    request.body = conn.in.substr(header_end + 4, content_length);
+    conn.in.erase(0, total);
+
+    std::string connection = toLower(request.header("connection"));
+    if (request.version == "HTTP/1.0") {
+        request.keep_alive = (connection == "keep-alive");
+    } else {
+        request.keep_alive = (connection != "close");
+    }
+    return ParseResult::COMPLETE;
+}
+
+void HttpServer::dispatch(Connection& conn, HttpRequest&& request) {
+    const Route* route = findRoute(request);
+    const bool keep_alive = request.keep_alive;
+
+    if (!route || route->dispatch == Dispatch::INLINE) {
+        const Handler& handler = route ? route->handler : fallback_;
+        auto start = std::chrono::steady_clock::now();
+        HttpResponse response;
+        try {
+            response = handler(request);
+        } catch (const std::exception& e) {
+            std::cerr << "[HTTP] Handler for " << request.path << " threw: " << e.what() << std::endl;
+            response = errorResponse(500);
+        }
+        inline_latency_.recordSince(start);
+        queueResponse(conn, response, keep_alive);
+        return;
+    }
+
+    // POOL: the connection waits (no further parsing) until the completion arrives
+    conn.busy = true;
+    const int fd = conn.fd;
+    const uint64_t id = conn.id;
+    Handler handler = route->handler;
+    auto queued = std::chrono::steady_clock::now();
+    auto shared_request = std::make_shared<HttpRequest>(std::move(request));
+    bool accepted = tasks_.push([this, fd, id, keep_alive, handler, shared_request, queued]() {
+        auto start = std::chrono::steady_clock::now();
+        pool_wait_latency_.record(start - queued);
+        HttpResponse response;
+        try {
+            response = handler(*shared_request);
+        } catch (const std::exception& e) {
+            std::cerr << "[HTTP] Handler for " << shared_request->path << " threw: " << e.what() << std::endl;
+            response = errorResponse(500);
+        }
+        pool_latency_.recordSince(start);
+        {
+            std::lock_guard<std::mutex> lock(completions_mutex_);
+            completions_.push_back(Completion{fd, id, std::move(response), keep_alive});
+        }
+        wake();
+    });
+    if (!accepted) {
+        conn.busy = false;
+        queueResponse(conn, errorResponse(503), false);
+    }
+}
+
+void HttpServer::drainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex_);
+        ready.swap(completions_);
+    }
+    for (auto& completion : ready) {
+        auto it = connections_.find(completion.fd);
+        if (it == connections_.end() || it->second->id != completion.id) {
+            continue;   // Client went away while the handler ran
+        }
+        Connection& conn = *it->second;
+        conn.busy = false;
+        queueResponse(conn, completion.response, completion.keep_alive);
+        if (connections_.count(completion.fd) != 0) {
+            processInput(conn);     // Pipelined request waiting behind this one
+        }
+    }
+}
+
+void HttpServer::queueResponse(Connection& conn, const HttpResponse& response, bool keep_alive) {
+    const bool keep = keep_alive && !response.close_connection && running_;
+
+    // A shared body (cached asset) is written from its own buffer after the head
+    const size_t body_size = response.file ? response.file->length
+                             : response.shared_body ? response.shared_body->size() : response.body.size();
+    std::string data;
+    data.reserve(256 + (response.shared_body ? 0 : body_size));
+    data += "HTTP/1.1 " + std::to_string(response.status) + " " + response.reason + "\r\n";
+    for (const auto& header : response.headers) {
+        data += header.first + ": " + header.second + "\r\n";
+    }
+    if (response.stream) {
+        // Body runs until the stream ends - the connection is not reused
+        data += "Connection: close\r\n\r\n";
+        conn.stream = response.stream;
+        conn.stream->attach(this);
+        streams_dirty_ = true;
+    } else {
+        if (response.status != 304 && response.status != 204) {   // Bodyless by definition
+            data += "Content-Length: " + std::to_string(body_size) + "\r\n";
+        }
+        data += keep ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        conn.close_after_write = !keep;
+    }
+    if (response.file) {
+        conn.out_file = response.file;
+    } else if (response.shared_body) {
+        conn.out_body = response.shared_body;
+    } else {
+        data += response.body;
+    }
+
+    conn.out = std::make_shared<const std::string>(std::move(data));
+    conn.out_offset = 0;
+    flushOutput(conn);
+}
+
+void HttpServer::flushOutput(Connection& conn) {
+    const int fd = conn.fd;
+    while (conn.out && conn.out_offset < outputSize(conn)) {
+        // Head and shared body in one syscall; out_offset runs across both
+        struct iovec iov[2];
+        int iov_count = 0;
+        const size_t head_size = conn.out->size();
+        if (conn.out_offset < head_size) {
+            iov[iov_count].iov_base = const_cast<char*>(conn.out->data() + conn.out_offset);
+            iov[iov_count].iov_len = head_size - conn.out_offset;
+            iov_count++;
+        }
+        if (conn.out_body) {
+            size_t body_offset = conn.out_offset > head_size ? conn.out_offset - head_size : 0;
+            iov[iov_count].iov_base = const_cast<char*>(conn.out_body->data() + body_offset);
+            iov[iov_count].iov_len = conn.out_body->size() - body_offset;
+            iov_count++;
+        }
+        struct msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+        ssize_t sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn.out_offset += static_cast<size_t>(sent);
+            conn.last_activity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateEvents(conn);     // Socket buffer full - resume on EPOLLOUT
+            return;
+        }
+        closeConnection(fd);
+        return;
+    }
+    if (conn.out_file && !sendFileBody(conn)) {
+        return;     // Waiting for the socket or rate tokens, or the connection was closed
+    }
+
+    conn.out.reset();
+    conn.out_body.reset();
+    conn.out_file.reset();
+    conn.out_offset = 0;
+    if (conn.close_after_write) {
+        closeConnection(fd);
+        return;
+    }
+    updateEvents(conn);
+}
+
+bool HttpServer::sendFileBody(Connection& conn) {
+    const int fd = conn.fd;
+    HttpFileBody& file = *conn.out_file;
+    while (file.length > 0) {
+        const uint64_t limit = file_rate_limit_.load();
+        if (files_paused_ || (limit > 0 && file_tokens_ < 1.0)) {
+            conn.throttled = true;      // resumeThrottled() picks it up again
+            have_throttled_ = true;
+            updateEvents(conn);
+            return false;
+        }
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(file.length, FILE_CHUNK));
+        if (limit > 0) {
+            chunk = std::min(chunk, static_cast<size_t>(file_tokens_));
+        }
+        off_t offset = static_cast<off_t>(file.offset);
+        ssize_t sent = ::sendfile(fd, file.fd, &offset, chunk);
+        if (sent > 0) {
+            file.offset += static_cast<uint64_t>(sent);
+            file.length -= static_cast<uint64_t>(sent);
+            file_bytes_sent_ += static_cast<uint64_t>(sent);
+            if (limit > 0) {
+                file_tokens_ -= static_cast<double>(sent);
+            }
+            conn.last_activity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateEvents(conn);
+            return false;
+        }
+        // 0 = file shrank below the announced length; the response cannot be completed
+        closeConnection(fd);
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::resumeThrottled() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - file_tokens_time_).count();
+    file_tokens_time_ = now;
+    const uint64_t limit = file_rate_limit_.load();
+    if (limit > 0) {
+        // Burst of at most 100ms (but always one full chunk) after an idle period
+        double burst = std::max(static_cast<double>(limit) / 10.0, static_cast<double>(FILE_CHUNK));
+        file_tokens_ = std::min(file_tokens_ + elapsed * static_cast<double>(limit), burst);
+    }
+    if (!have_throttled_ || files_paused_ || (limit > 0 && file_tokens_ < 1.0)) {
+        return;
+    }
+
+    have_throttled_ = false;
+    std::vector<int> throttled;
+    for (const auto& entry : connections_) {
+        if (entry.second->throttled) {
+            throttled.push_back(entry.first);
+        }
+    }
+    for (int fd : throttled) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) {
+            continue;
+        }
+        Connection& conn = *it->second;
+        conn.throttled = false;
+        flushOutput(conn);
+        it = connections_.find(fd);
+        if (it != connections_.end() && !it->second->out) {
+            processInput(*it->second);     // Requests pipelined behind the download
+        }
+    }
+}
+
+size_t HttpServer::outputSize(const Connection& conn) {
+    return conn.out->size() + (conn.out_body ? conn.out_body->size() : 0);
+}
+
+void HttpServer::pumpStream(Connection& conn) {
+    const int fd = conn.fd;
+    // Hand the stream's chunks to the socket until it would block
+    while (!conn.out) {
+        std::shared_ptr<const std::string> chunk;
+        bool finished = false;
+        if (!conn.stream->next(chunk, finished)) {
+            if (finished) {
+                closeConnection(fd);
+            }
+            return;
+        }
+        conn.out = std::move(chunk);
+        conn.out_offset = 0;
+        flushOutput(conn);
+        if (connections_.count(fd) == 0) {
+            return;
+        }
+    }
+}
+
+void HttpServer::pumpStreams() {
+    std::vector<int> streaming;
+    for (const auto& entry : connections_) {
+        if (entry.second->stream && !entry.second->out) {
+            streaming.push_back(entry.first);
+        }
+    }
+    for (int fd : streaming) {
+        auto it = connections_.find(fd);
+        if (it != connections_.end()) {
+            pumpStream(*it->second);
+        }
+    }
+}
+
+void HttpServer::notifyStreams() {
+    streams_dirty_ = true;
+    wake();
+}
+
+void HttpServer::updateEvents(Connection& conn) {
+    bool want_write = conn.out && !conn.throttled && (conn.out_offset < outputSize(conn) || conn.out_file);
+    if (want_write == conn.want_write) {
+        return;
+    }
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | (want_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = conn.fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &event);
+    conn.want_write = want_write;
+}
+
+void HttpServer::closeConnection(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    if (it->second->stream) {
+        it->second->stream->detach();   // Producer sees send() == false
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections_.erase(it);
+    connection_count_ = connections_.size();
+}
+
+void HttpServer::sweepIdle() {
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::milliseconds(config_.idle_timeout_ms);
+    std::vector<int> idle;
+    for (const auto& entry : connections_) {
+        const Connection& conn = *entry.second;
+        if (!conn.busy && !conn.out && !conn.stream && now - conn.last_activity > timeout) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (int fd : idle) {
+        closeConnection(fd);
+    }
+}
+
+void HttpServer::workerLoop() {
+    std::function<void()> task;
+    while (tasks_.pop(task)) {
+        task();
+        task = nullptr;
+    }
+}
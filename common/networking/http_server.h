@@ -0,0 +1,304 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "bounded_queue.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief One parsed HTTP/1.x request
+ */
+struct HttpRequest {
+    std::string method;             // "GET", "POST", ...
+    std::string target;             // As sent, including the query string
+    std::string path;               // target without "?query"
+    std::string query;
+    std::string version;            // "HTTP/1.1"
+    std::vector<std::pair<std::string, std::string>> headers;  // Names lower-cased
+    std::string body;
+    bool keep_alive = true;
+
+    // Value of a header (name in lower case), empty if missing
+    std::string header(const std::string& name) const;
+
+    // Value of a query parameter ("?fps=4" -> "4"), not percent-decoded; empty if missing
+    std::string queryParam(const std::string& name) const;
+};
+
+class HttpServer;
+
+/**
+ * @brief Server-push body of a streaming response (MJPEG, event streams)
+ *
+ * Producers send() from any thread; the reactor writes chunks in order as the
+ * socket accepts them. Chunks are shared, so one encoded frame can be queued on
+ * any number of streams without copying. A client that falls behind never
+ * holds more than max_pending chunks: the oldest not-yet-started chunk is
+ * dropped (slow consumer), the chunk being written is always completed.
+ */
+class HttpStream {
+public:
+    explicit HttpStream(size_t max_pending = 2);
+
+    HttpStream(const HttpStream&) = delete;
+    HttpStream& operator=(const HttpStream&) = delete;
+
+    // Queue a chunk; false once the client disconnected or close() was called
+    bool send(std::shared_ptr<const std::string> chunk);
+
+    // End the response after the queued chunks are written
+    void close();
+
+    bool isOpen() const;
+    size_t getPending() const;
+    uint64_t getDropped() const { return dropped_.load(); }
+
+private:
+    friend class HttpServer;
+
+    void attach(HttpServer* server);
+    void detach();
+    // Reactor side: next chunk to write; finished = closed and drained
+    bool next(std::shared_ptr<const std::string>& chunk, bool& finished);
+
+    mutable std::mutex mutex_;
+    std::deque<std::shared_ptr<const std::string>> pending_;
+    const size_t max_pending_;
+    HttpServer* server_{nullptr};
+    bool closed_{false};            // close() by the producer
+    bool disconnected_{false};      // Client gone or server stopped
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief Byte range of an open file, sent with sendfile() by the reactor
+ *
+ * Owns the descriptor; it is closed when the response is finished.
+ */
+struct HttpFileBody {
+    int fd = -1;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+
+    HttpFileBody() = default;
+    HttpFileBody(const HttpFileBody&) = delete;
+    HttpFileBody& operator=(const HttpFileBody&) = delete;
+    ~HttpFileBody();
+};
+
+/**
+ * @brief Response returned by a route handler
+ *
+ * Content-Length and Connection are always set by the server. A response with
+ * a stream has no Content-Length: the headers (and body, if any) are sent,
+ * then the stream's chunks until either side closes it.
+ */
+struct HttpResponse {
+    int status = 200;
+    std::string reason = "OK";
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool close_connection = false;  // Close after sending even if the client asked for keep-alive
+    std::shared_ptr<HttpStream> stream;
+    std::shared_ptr<const std::string> shared_body;     // Sent instead of body without copying (cached assets)
+    std::shared_ptr<HttpFileBody> file;                 // Sent instead of body with sendfile() (downloads)
+
+    void setHeader(const std::string& name, const std::string& value);
+
+    static HttpResponse make(int status, const std::string& content_type, std::string body);
+    static HttpResponse makeStream(const std::string& content_type, std::shared_ptr<HttpStream> stream);
+
+    /**
+     * @brief Regular file as the body, honouring a single "Range: bytes=" request
+     * @return 200 (whole file), 206 (range), 416 (unsatisfiable range) or 404
+     *
+     * Opens the file on the calling thread - use from POOL routes.
+     */
+    static HttpResponse makeFile(const HttpRequest& request, const std::string& path, const std::string& content_type);
+
+    /**
+     * @brief Adopt a complete pre-formatted response ("HTTP/1.1 200 OK\r\n...\r\n\r\nbody")
+     *
+     * Lets the existing generate*() helpers keep building raw responses;
+     * Content-Length/Connection headers in @p raw are replaced.
+     */
+    static HttpResponse fromRaw(const std::string& raw);
+};
+
+/**
+ * @brief Event-driven HTTP/1.1 server (epoll reactor + small handler pool)
+ *
+ * One reactor thread accepts clients and does all socket I/O non-blocking:
+ * requests are parsed incrementally (headers, then Content-Length bodies),
+ * responses may be written over several EPOLLOUT wakeups, and connections
+ * stay open for keep-alive until the idle timeout. INLINE routes run on the
+ * reactor and must be fast (status JSON); POOL routes (snapshot encode,
+ * camera control) run on handler threads so they never delay other clients.
+ *
+ * A connection handles one request at a time - pipelined requests wait in its
+ * input buffer until the previous response has been written. A streaming
+ * response (HttpStream) occupies its connection until it ends.
+ */
+class HttpServer {
+public:
+    struct Config {
+        int port = 8080;
+        int handler_threads = 2;
+        size_t handler_queue = 32;              // Pending POOL requests (more -> 503)
+        size_t max_connections = 64;
+        size_t max_header_bytes = 16 * 1024;
+        size_t max_body_bytes = 1024 * 1024;
+        int idle_timeout_ms = 15000;            // Keep-alive connections without a request
+        int tick_interval_ms = 250;             // Tick handler period
+        uint64_t file_rate_limit = 0;           // File body bytes/s over all connections (0 = unlimited)
+    };
+
+    enum class Dispatch {
+        INLINE,     // On the reactor thread - must not block
+        POOL        // On a handler thread
+    };
+
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+    using TickHandler = std::function<void()>;
+
+    HttpServer();
+    explicit HttpServer(const Config& config);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Exact path match (query string ignored); register before start()
+    void addRoute(const std::string& method, const std::string& path, Dispatch dispatch, Handler handler);
+
+    // Paths starting with @p prefix (after exact routes, longest prefix wins); register before start()
+    void addPrefixRoute(const std::string& method, const std::string& prefix, Dispatch dispatch, Handler handler);
+
+    // Unmatched requests (default: 404); runs INLINE
+    void setFallback(Handler handler);
+
+    // Called on the reactor thread every tick_interval_ms
+    void setTickHandler(TickHandler handler);
+
+    // Bind, listen and start the reactor and handler threads
+    bool start();
+
+    // Ask the reactor to exit (non-blocking, safe from handlers and other threads)
+    void requestStop();
+
+    // requestStop() and join all threads - not from a handler
+    void stop();
+
+    // Hold all file bodies (e.g. while recording); they resume where they stopped
+    void setFileTransfersPaused(bool paused);
+    bool areFileTransfersPaused() const { return files_paused_.load(); }
+    void setFileRateLimit(uint64_t bytes_per_second) { file_rate_limit_ = bytes_per_second; }
+    uint64_t getFileBytesSent() const { return file_bytes_sent_.load(); }
+
+    bool isRunning() const { return running_.load(); }
+    size_t getConnectionCount() const { return connection_count_.load(); }
+    uint64_t getRequestCount() const { return requests_.load(); }
+
+    // Handler times ("http.inline" / "http.pool") and pool queueing ("http.pool_wait")
+    LatencyReport getLatencyReport() const;
+
+private:
+    friend class HttpStream;
+
+    struct Route {
+        Dispatch dispatch;
+        Handler handler;
+    };
+
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;
+        std::string in;
+        std::shared_ptr<const std::string> out;     // Response or stream chunk being written
+        std::shared_ptr<const std::string> out_body;    // Shared body written after out
+        size_t out_offset = 0;                          // Across out and out_body
+        std::shared_ptr<HttpFileBody> out_file;         // Sent after out/out_body
+        std::shared_ptr<HttpStream> stream;
+        bool throttled = false;             // File body waiting for rate tokens or unpause
+        bool busy = false;                  // POOL handler running for this connection
+        bool close_after_write = false;
+        bool want_write = false;            // EPOLLOUT registered
+        std::chrono::steady_clock::time_point last_activity;
+    };
+
+    struct Completion {
+        int fd;
+        uint64_t id;
+        HttpResponse response;
+        bool keep_alive;
+    };
+
+    enum class ParseResult { INCOMPLETE, COMPLETE, ERROR };
+
+    void reactorLoop();
+    void acceptClients();
+    void readClient(Connection& conn);
+    void processInput(Connection& conn);
+    ParseResult parseRequest(Connection& conn, HttpRequest& request, int& error_status);
+    void dispatch(Connection& conn, HttpRequest&& request);
+    void queueResponse(Connection& conn, const HttpResponse& response, bool keep_alive);
+    void flushOutput(Connection& conn);
+    bool sendFileBody(Connection& conn);
+    void resumeThrottled();
+    const Route* findRoute(const HttpRequest& request) const;
+    static size_t outputSize(const Connection& conn);
+    void pumpStream(Connection& conn);
+    void pumpStreams();
+    void notifyStreams();
+    void updateEvents(Connection& conn);
+    void closeConnection(int fd);
+    void drainCompletions();
+    void sweepIdle();
+    void workerLoop();
+    void wake();
+
+    Config config_;
+    std::map<std::pair<std::string, std::string>, Route> routes_;
+    std::vector<std::pair<std::pair<std::string, std::string>, Route>> prefix_routes_;
+    Handler fallback_;
+    TickHandler tick_handler_;
+
+    int listen_fd_{-1};
+    int epoll_fd_{-1};
+    int wake_fd_{-1};
+    std::atomic<bool> running_{false};
+    std::unique_ptr<std::thread> reactor_thread_;
+    std::vector<std::thread> workers_;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;   // Reactor thread only
+    uint64_t next_connection_id_{1};
+
+    BoundedQueue<std::function<void()>> tasks_;
+    std::mutex completions_mutex_;
+    std::vector<Completion> completions_;
+    std::atomic<bool> streams_dirty_{false};        // A stream got a chunk or was closed
+
+    // File body throttling (token bucket refilled by the reactor)
+    std::atomic<uint64_t> file_rate_limit_{0};
+    std::atomic<bool> files_paused_{false};
+    std::atomic<uint64_t> file_bytes_sent_{0};
+    double file_tokens_{0.0};                       // Reactor thread only
+    std::chrono::steady_clock::time_point file_tokens_time_;
+    bool have_throttled_{false};
+
+    std::atomic<size_t> connection_count_{0};
+    std::atomic<uint64_t> requests_{0};
+    LatencyHistogram inline_latency_;
+    LatencyHistogram pool_latency_;
+    LatencyHistogram pool_wait_latency_;
+};
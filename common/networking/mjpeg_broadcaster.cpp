@@ -0,0 +1,303 @@
+#include "mjpeg_broadcaster.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr const char* BOUNDARY = "frame";
+
+// Wait for a new hub frame at most this long before re-checking clients/stop
+constexpr auto FRAME_WAIT = std::chrono::milliseconds(200);
+
+// Retry interval while no camera is available
+constexpr auto SUBSCRIBE_RETRY = std::chrono::milliseconds(500);
+
+}  // namespace
+
+MjpegBroadcaster::MjpegBroadcaster() : MjpegBroadcaster(Config()) {
+}
+
+MjpegBroadcaster::MjpegBroadcaster(const Config& config) : config_(config), encoder_(config.quality) {
+    config_.max_fps = std::max(1, config_.max_fps);
+    config_.default_fps = std::min(std::max(1, config_.default_fps), config_.max_fps);
+}
+
+MjpegBroadcaster::~MjpegBroadcaster() {
+    stop();
+}
+
+bool MjpegBroadcaster::start(HubProvider hub_provider) {
+    if (running_) {
+        return false;
+    }
+    hub_provider_ = std::move(hub_provider);
+    running_ = true;
+    thread_ = std::make_unique<std::thread>(&MjpegBroadcaster::broadcastLoop, this);
+    std::cout << "[MJPEG] Broadcaster started (max " << config_.max_fps << " FPS, width "
+              << config_.preview_width << ", quality " << config_.quality << ")" << std::endl;
+    return true;
+}
+
+void MjpegBroadcaster::stop() {
+    if (!thread_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        running_ = false;
+    }
+    clients_cv_.notify_all();
+    if (thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (auto& client : clients_) {
+            client.stream->close();
+        }
+        clients_.clear();
+    }
+
+    // A hub that went away was released first, so a remaining one is still alive
+    {
+        std::lock_guard<std::mutex> lock(subscription_mutex_);
+        dropSubscription();
+    }
+    std::cout << "[MJPEG] Broadcaster stopped (" << getStats().frames_encoded << " frames encoded)" << std::endl;
+}
+
+HttpResponse MjpegBroadcaster::openStream(const HttpRequest& request) {
+    int fps = config_.default_fps;
+    std::string fps_value = request.queryParam("fps");
+    if (!fps_value.empty()) {
+        fps = std::atoi(fps_value.c_str());
+    }
+    fps = std::min(std::max(1, fps), config_.max_fps);
+
+    auto stream = std::make_shared<HttpStream>(config_.client_backlog);
+    size_t clients = 0;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        if (!running_) {
+            return HttpResponse::make(503, "text/plain", "Preview not available");
+        }
+        if (clients_.size() >= config_.max_clients) {
+            return HttpResponse::make(503, "text/plain", "Too many preview clients");
+        }
+        Client client;
+        client.stream = stream;
+        client.fps = fps;
+        client.interval = std::chrono::microseconds(1000000 / fps);
+        client.next_due = std::chrono::steady_clock::now();
+        clients_.push_back(std::move(client));
+        clients = clients_.size();
+    }
+    clients_cv_.notify_all();
+
+    std::cout << "[MJPEG] Client connected at " << fps << " FPS (" << clients << " clients)" << std::endl;
+    return HttpResponse::makeStream(std::string("multipart/x-mixed-replace; boundary=") + BOUNDARY, stream);
+}
+
+void MjpegBroadcaster::releaseSubscription() {
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    dropSubscription();
+}
+
+MjpegStats MjpegBroadcaster::getStats() const {
+    MjpegStats stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats = stats_;
+    }
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    stats.clients = clients_.size();
+    stats.dropped = dropped_by_removed_;
+    for (const auto& client : clients_) {
+        stats.dropped += client.stream->getDropped();
+    }
+    return stats;
+}
+
+LatencyReport MjpegBroadcaster::getLatencyReport() const {
+    return {
+        {"mjpeg.encode", encode_latency_.summary()},
+        {"mjpeg.frame_age", frame_age_latency_.summary()},
+    };
+}
+
+int MjpegBroadcaster::maxClientFps() const {
+    int fps = 1;
+    for (const auto& client : clients_) {
+        fps = std::max(fps, client.fps);
+    }
+    return fps;
+}
+
+void MjpegBroadcaster::dropSubscription() {
+    if (subscription_ && subscribed_hub_) {
+        subscribed_hub_->unsubscribe(subscription_);
+    }
+    subscription_.reset();
+    subscribed_hub_ = nullptr;
+    subscribed_fps_ = 0;
+}
+
+std::shared_ptr<FrameSubscription> MjpegBroadcaster::ensureSubscription(int fps) {
+    // Held across provider + subscribe: releaseSubscription() waits for a hub handed out before the swap
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    if (subscription_ && !subscription_->isClosed()) {
+        if (fps != subscribed_fps_) {
+            subscription_->setRateDivisor(std::max(1, source_fps_ / fps));
+            subscribed_fps_ = fps;
+        }
+        return subscription_;
+    }
+
+    subscription_.reset();
+    subscribed_hub_ = hub_provider_ ? hub_provider_() : nullptr;
+    if (!subscribed_hub_) {
+        return nullptr;
+    }
+    SubscriberConfig config;
+    config.name = "mjpeg";
+    config.image = true;
+    config.mailbox = MailboxType::LATEST;
+    source_fps_ = subscribed_hub_->getSourceFPS();
+    config.rate_divisor = std::max(1, source_fps_ / fps);
+    subscription_ = subscribed_hub_->subscribe(config);
+    subscribed_fps_ = fps;
+    return subscription_;
+}
+
+std::shared_ptr<const std::string> MjpegBroadcaster::encodePart(const CapturedFrame& frame) {
+    ScopedLatency timer(encode_latency_);
+    const sl::Mat& image = *frame.image;
+    const int width = static_cast<int>(image.getWidth());
+    const int height = static_cast<int>(image.getHeight());
+
+    // Wrap the BGRA frame (no copy) and scale it into the persistent preview buffer
+    cv::Mat bgra(height, width, CV_8UC4, image.getPtr<sl::uchar1>(sl::MEM::CPU), image.getStepBytes(sl::MEM::CPU));
+    const cv::Mat* source = &bgra;
+    if (config_.preview_width > 0 && width > config_.preview_width) {
+        int scaled_height = std::max(1, static_cast<int>(std::lround(
+            static_cast<double>(height) * config_.preview_width / width)));
+        cv::resize(bgra, scaled_, cv::Size(config_.preview_width, scaled_height), 0, 0, cv::INTER_AREA);
+        source = &scaled_;
+    }
+
+    if (!encoder_.encodeBGRA(source->data, source->cols, source->rows, source->step)) {
+        std::cerr << "[MJPEG] JPEG encode failed: " << encoder_.getLastError() << std::endl;
+        return nullptr;
+    }
+
+    std::string header = std::string("--") + BOUNDARY + "\r\n"
+                         "Content-Type: image/jpeg\r\n"
+                         "Content-Length: " + std::to_string(encoder_.size()) + "\r\n\r\n";
+    auto part = std::make_shared<std::string>();
+    part->reserve(header.size() + encoder_.size() + 2);
+    part->append(header);
+    part->append(reinterpret_cast<const char*>(encoder_.data()), encoder_.size());
+    part->append("\r\n");
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.last_frame_bytes = encoder_.size();
+    stats_.width = source->cols;
+    stats_.height = source->rows;
+    return part;
+}
+
+void MjpegBroadcaster::broadcastLoop() {
+    auto window_start = std::chrono::steady_clock::now();
+    uint64_t window_frames = 0;
+    std::vector<std::shared_ptr<HttpStream>> due;
+
+    while (running_) {
+        int fps = 0;
+        {
+            std::unique_lock<std::mutex> lock(clients_mutex_);
+            // Forget clients that disconnected (stream detached by the server)
+            for (auto it = clients_.begin(); it != clients_.end();) {
+                if (!it->stream->isOpen()) {
+                    dropped_by_removed_ += it->stream->getDropped();
+                    it = clients_.erase(it);
+                    std::cout << "[MJPEG] Client disconnected (" << clients_.size() << " clients)" << std::endl;
+                } else {
+                    ++it;
+                }
+            }
+            if (clients_.empty()) {
+                {
+                    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+                    stats_.encode_fps = 0.0;
+                }
+                window_frames = 0;
+                window_start = std::chrono::steady_clock::now();
+
+                // Nobody watching: stop asking the hub for frames
+                lock.unlock();
+                releaseSubscription();
+                lock.lock();
+                clients_cv_.wait_for(lock, SUBSCRIBE_RETRY, [this] { return !running_ || !clients_.empty(); });
+                continue;
+            }
+            fps = maxClientFps();
+        }
+
+        // Local reference: a release may drop subscription_ while this thread waits (the hub closes it)
+        std::shared_ptr<FrameSubscription> subscription = ensureSubscription(fps);
+        if (!subscription) {
+            std::unique_lock<std::mutex> lock(clients_mutex_);
+            clients_cv_.wait_for(lock, SUBSCRIBE_RETRY, [this] { return !running_.load(); });
+            continue;
+        }
+
+        CapturedFramePtr frame;
+        if (!subscription->waitFrame(frame, FRAME_WAIT) || !frame || !frame->image) {
+            continue;
+        }
+
+        // Clients due for a frame (half an interval early is fine - frames arrive with jitter)
+        auto now = std::chrono::steady_clock::now();
+        due.clear();
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            for (auto& client : clients_) {
+                if (now + client.interval / 2 < client.next_due) {
+                    continue;
+                }
+                due.push_back(client.stream);
+                client.next_due += client.interval;
+                if (client.next_due < now) {
+                    client.next_due = now + client.interval;
+                }
+            }
+        }
+        if (due.empty()) {
+            continue;
+        }
+
+        // Encode once, queue the same buffer on every due client
+        std::shared_ptr<const std::string> part = encodePart(*frame);
+        if (!part) {
+            continue;
+        }
+        for (const auto& stream : due) {
+            stream->send(part);
+        }
+        frame_age_latency_.recordSince(frame->capture_time);
+
+        window_frames++;
+        now = std::chrono::steady_clock::now();
+        double window_s = std::chrono::duration<double>(now - window_start).count();
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.frames_encoded++;
+        if (window_s >= 1.0) {
+            stats_.encode_fps = window_frames / window_s;
+            window_frames = 0;
+            window_start = now;
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "capture_hub.h"
+#include "jpeg_encoder.h"
+#include "http_server.h"
+#include "latency_histogram.h"
+
+/**
+ * @brief Live preview counters of an MjpegBroadcaster
+ */
+struct MjpegStats {
+    size_t clients = 0;
+    uint64_t frames_encoded = 0;
+    double encode_fps = 0.0;            // Encoded preview frames per second (last window)
+    size_t last_frame_bytes = 0;
+    int width = 0;                      // Preview size of the last encoded frame
+    int height = 0;
+    uint64_t dropped = 0;               // Frames skipped for slow clients (all clients so far)
+};
+
+/**
+ * @brief multipart/x-mixed-replace (MJPEG) live preview fed by the CaptureHub
+ *
+ * One thread takes the newest frame the recorder (or the hub's idle grab)
+ * published, scales it to the preview width, encodes it once, and queues the
+ * same encoded part on every client stream that is due for a frame. Each
+ * client picks its own rate (?fps=N, capped at Config::max_fps); the hub
+ * subscription runs at the fastest client's rate. Slow clients drop frames in
+ * their HttpStream instead of delaying the others.
+ *
+ * Nothing is subscribed while no client is connected, so the preview costs
+ * the recording loop nothing unless somebody is watching.
+ */
+class MjpegBroadcaster {
+public:
+    struct Config {
+        int max_fps = 15;
+        int default_fps = 2;            // Clients without ?fps=
+        int preview_width = 640;        // Height keeps the camera aspect ratio; 0 = native
+        int quality = 75;
+        size_t client_backlog = 1;      // Encoded frames queued per client beyond the one being sent
+        size_t max_clients = 8;
+    };
+
+    // Hub of the active recorder; nullptr while the camera is unavailable (reinit, shutdown).
+    // The hub must outlive the subscription: call releaseSubscription() before destroying it.
+    using HubProvider = std::function<CaptureHub*()>;
+
+    MjpegBroadcaster();
+    explicit MjpegBroadcaster(const Config& config);
+    ~MjpegBroadcaster();
+
+    MjpegBroadcaster(const MjpegBroadcaster&) = delete;
+    MjpegBroadcaster& operator=(const MjpegBroadcaster&) = delete;
+
+    bool start(HubProvider hub_provider);
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Route handler: attach the requesting client ("GET /stream.mjpg?fps=4")
+     * @return Streaming response, or 503 when stopped / too many clients
+     */
+    HttpResponse openStream(const HttpRequest& request);
+
+    /**
+     * @brief Unsubscribe from the hub before it is destroyed (camera about to be closed)
+     *
+     * Synchronous: waits for a subscribe in progress on the broadcast thread, and on
+     * return no hub pointer is kept. Re-subscribes once the provider returns a hub again,
+     * so the provider must already have stopped returning the old one.
+     */
+    void releaseSubscription();
+
+    MjpegStats getStats() const;
+
+    // "mjpeg.encode" (scale + JPEG) and "mjpeg.frame_age" (capture -> queued on the streams)
+    LatencyReport getLatencyReport() const;
+
+private:
+    struct Client {
+        std::shared_ptr<HttpStream> stream;
+        std::chrono::microseconds interval;
+        std::chrono::steady_clock::time_point next_due;
+        int fps;
+    };
+
+    void broadcastLoop();
+    std::shared_ptr<FrameSubscription> ensureSubscription(int fps);
+    void dropSubscription();            // subscription_mutex_ held
+    std::shared_ptr<const std::string> encodePart(const CapturedFrame& frame);
+    int maxClientFps() const;           // clients_mutex_ held
+
+    Config config_;
+    HubProvider hub_provider_;
+
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex clients_mutex_;
+    std::condition_variable clients_cv_;
+    std::vector<Client> clients_;
+    uint64_t dropped_by_removed_{0};    // Drops of clients that already disconnected
+
+    // Hub subscription: broadcast thread, releaseSubscription() and stop()
+    std::mutex subscription_mutex_;
+    std::shared_ptr<FrameSubscription> subscription_;
+    CaptureHub* subscribed_hub_{nullptr};   // Alive while set (released before the hub goes away)
+    int subscribed_fps_{0};
+    int source_fps_{0};
+
+    // Broadcast thread only
+    JpegEncoder encoder_;
+    cv::Mat scaled_;                    // Persistent preview-size BGRA buffer
+
+    mutable std::mutex stats_mutex_;
+    MjpegStats stats_;
+
+    LatencyHistogram encode_latency_;
+    LatencyHistogram frame_age_latency_;
+};
@@ -0,0 +1,88 @@
+#include "static_asset.h"
+#include <cstdio>
+#include <cstdint>
+#include <zlib.h>
+
+namespace {
+
+// FNV-1a: stable across runs, so browsers keep their cache over controller restarts
+uint64_t fnv1a(const std::string& data) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+StaticAsset::StaticAsset(const std::string& content_type, std::string body)
+    : content_type_(content_type) {
+    char tag[24];
+    std::snprintf(tag, sizeof(tag), "%016llx", static_cast<unsigned long long>(fnv1a(body)));
+    etag_ = std::string("\"") + tag + "\"";
+    gzip_etag_ = std::string("\"") + tag + "-gz\"";
+
+    std::string compressed = gzipCompress(body);
+    if (!compressed.empty() && compressed.size() < body.size()) {
+        gzip_ = std::make_shared<const std::string>(std::move(compressed));
+    }
+    identity_ = std::make_shared<const std::string>(std::move(body));
+}
+
+std::string StaticAsset::gzipCompress(const std::string& data) {
+    z_stream stream{};
+    // windowBits 15 + 16: gzip header/trailer instead of raw zlib
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return "";
+    }
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END ? out : "";
+}
+
+bool StaticAsset::matchesETag(const std::string& if_none_match) const {
+    if (if_none_match.empty()) {
+        return false;
+    }
+    if (if_none_match.find('*') != std::string::npos) {
+        return true;
+    }
+    // Weak comparison (RFC 7232): "W/" prefixes and either encoding variant match
+    return if_none_match.find(etag_) != std::string::npos ||
+           if_none_match.find(gzip_etag_) != std::string::npos;
+}
+
+HttpResponse StaticAsset::serve(const HttpRequest& request) const {
+    if (!identity_) {
+        return HttpResponse::make(404, "text/plain", "Not Found");
+    }
+
+    const bool use_gzip = gzip_ && request.header("accept-encoding").find("gzip") != std::string::npos;
+    const std::string& etag = use_gzip ? gzip_etag_ : etag_;
+
+    HttpResponse response;
+    if (matchesETag(request.header("if-none-match"))) {
+        response = HttpResponse::make(304, content_type_, "");
+        response.headers.clear();       // 304 carries no Content-Type
+    } else {
+        response = HttpResponse::make(200, content_type_, "");
+        response.shared_body = use_gzip ? gzip_ : identity_;
+        if (use_gzip) {
+            response.setHeader("Content-Encoding", "gzip");
+        }
+    }
+    response.setHeader("ETag", etag);
+    response.setHeader("Cache-Control", "no-cache");    // Always revalidate - a 304 is a few hundred bytes
+    if (gzip_) {
+        response.setHeader("Vary", "Accept-Encoding");
+    }
+    return response;
+}
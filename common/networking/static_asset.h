@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include "http_server.h"
+
+/**
+ * @brief Immutable web asset prepared once: identity + gzip bodies and an ETag
+ *
+ * serve() answers conditional requests (If-None-Match) with 304 and picks the
+ * gzip body when the client accepts it. Both bodies are shared with the
+ * response, so serving never copies them.
+ */
+class StaticAsset {
+public:
+    StaticAsset() = default;
+    StaticAsset(const std::string& content_type, std::string body);
+
+    HttpResponse serve(const HttpRequest& request) const;
+
+    bool empty() const { return !identity_; }
+    size_t size() const { return identity_ ? identity_->size() : 0; }
+    size_t gzipSize() const { return gzip_ ? gzip_->size() : 0; }
+    const std::string& etag() const { return etag_; }
+
+    // gzip (RFC 1952) of @p data at maximum compression; empty on failure
+    static std::string gzipCompress(const std::string& data);
+
+private:
+    bool matchesETag(const std::string& if_none_match) const;
+
+    std::string content_type_;
+    std::shared_ptr<const std::string> identity_;
+    std::shared_ptr<const std::string> gzip_;       // nullptr when compression did not help
+    std::string etag_;                              // Quoted; the gzip variant adds "-gz"
+    std::string gzip_etag_;
+};
@@ -0,0 +1,214 @@
+#include "recording_index.h"
+#include <algorithm>
+#include <iostream>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+int64_t mtimeNs(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+}  // namespace
+
+RecordingIndex::RecordingIndex(const std::string& root, const std::string& prefix)
+    : root_(root), prefix_(prefix) {
+}
+
+int64_t RecordingIndex::parseStartTime(const std::string& id, const std::string& prefix) {
+    // flight_YYYYMMDD_HHMMSS (local time, see StorageHandler::createTimestampedDir)
+    struct tm time_info {};
+    if (id.size() < prefix.size() + 15 ||
+        strptime(id.c_str() + prefix.size(), "%Y%m%d_%H%M%S", &time_info) == nullptr) {
+        return 0;
+    }
+    time_info.tm_isdst = -1;
+    return static_cast<int64_t>(mktime(&time_info));
+}
+
+void RecordingIndex::refresh(std::chrono::milliseconds min_interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (refreshed_ && now - last_refresh_ < min_interval) {
+        return;
+    }
+    refreshed_ = true;
+    last_refresh_ = now;
+
+    DIR* dir = opendir(root_.c_str());
+    if (!dir) {
+        entries_.clear();
+        return;
+    }
+    std::vector<std::string> present;
+    while (struct dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        if (name.compare(0, prefix_.size(), prefix_) != 0) {
+            continue;
+        }
+        struct stat st;
+        if (stat((root_ + "/" + name).c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            present.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    // Drop recordings that were deleted, rescan new/changed/active ones
+    std::sort(present.begin(), present.end());
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (!std::binary_search(present.begin(), present.end(), it->first)) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const auto& id : present) {
+        Entry& entry = entries_[id];
+        entry.info.active = (id == active_);
+        if (entry.dirty || entry.info.active || changed(entry)) {
+            scan(id, entry);
+            entry.dirty = false;
+            rescans_++;
+        }
+    }
+}
+
+bool RecordingIndex::changed(const Entry& entry) const {
+    for (const auto& dir : entry.dir_mtimes) {
+        struct stat st;
+        if (stat(dir.first.c_str(), &st) != 0 || mtimeNs(st) != dir.second) {
+            return true;
+        }
+    }
+    return entry.dir_mtimes.empty();
+}
+
+void RecordingIndex::scan(const std::string& id, Entry& entry) const {
+    RecordingInfo& info = entry.info;
+    info.id = id;
+    info.bytes = 0;
+    info.files.clear();
+    info.last_modified = 0;
+    info.start_time = parseStartTime(id, prefix_);
+    entry.dir_mtimes.clear();
+
+    // Iterative walk; directory mtimes are remembered for change detection
+    std::vector<std::string> pending{""};
+    while (!pending.empty()) {
+        std::string relative = pending.back();
+        pending.pop_back();
+        std::string path = root_ + "/" + id + (relative.empty() ? "" : "/" + relative);
+
+        struct stat dir_st;
+        if (stat(path.c_str(), &dir_st) != 0) {
+            continue;
+        }
+        entry.dir_mtimes.push_back({path, mtimeNs(dir_st)});
+
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            continue;
+        }
+        while (struct dirent* item = readdir(dir)) {
+            std::string name = item->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string child = relative.empty() ? name : relative + "/" + name;
+            struct stat st;
+            if (stat((path + "/" + name).c_str(), &st) != 0) {
+                continue;
+            }
+            if (S_ISDIR(st.st_mode)) {
+                pending.push_back(child);
+            } else if (S_ISREG(st.st_mode)) {
+                info.files.push_back({child, static_cast<uint64_t>(st.st_size)});
+                info.bytes += static_cast<uint64_t>(st.st_size);
+                info.last_modified = std::max<int64_t>(info.last_modified, st.st_mtim.tv_sec);
+            }
+        }
+        closedir(dir);
+    }
+
+    std::sort(info.files.begin(), info.files.end(),
+              [](const RecordingFile& a, const RecordingFile& b) { return a.path < b.path; });
+    info.file_count = info.files.size();
+    info.duration_s = (info.start_time > 0 && info.last_modified > info.start_time)
+                          ? static_cast<double>(info.last_modified - info.start_time) : 0.0;
+}
+
+void RecordingIndex::setActive(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_.empty()) {
+        auto it = entries_.find(active_);
+        if (it != entries_.end()) {
+            it->second.dirty = true;   // Final sizes after the recorder closed its files
+        }
+    }
+    active_ = id;
+    refreshed_ = false;
+}
+
+void RecordingIndex::invalidate(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : entries_) {
+        if (id.empty() || entry.first == id) {
+            entry.second.dirty = true;
+        }
+    }
+    refreshed_ = false;
+}
+
+std::vector<RecordingInfo> RecordingIndex::list(bool with_files) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RecordingInfo> result;
+    result.reserve(entries_.size());
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {     // Names sort by time
+        result.push_back(it->second.info);
+        if (!with_files) {
+            result.back().files.clear();
+        }
+    }
+    return result;
+}
+
+bool RecordingIndex::find(const std::string& id, RecordingInfo& info) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        return false;
+    }
+    info = it->second.info;
+    return true;
+}
+
+std::string RecordingIndex::resolve(const std::string& id, const std::string& relative) const {
+    if (relative.empty() || relative[0] == '/') {
+        return "";
+    }
+    size_t pos = 0;
+    while (pos <= relative.size()) {
+        size_t end = relative.find('/', pos);
+        if (end == std::string::npos) {
+            end = relative.size();
+        }
+        // No "..", ".", hidden files or empty components
+        if (end == pos || relative[pos] == '.') {
+            return "";
+        }
+        pos = end + 1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.count(id) == 0) {
+        return "";
+    }
+    return root_ + "/" + id + "/" + relative;
+}
+
+uint64_t RecordingIndex::getRescanCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rescans_;
+}
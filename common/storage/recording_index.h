@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief One file of a recording, path relative to the recording directory
+ */
+struct RecordingFile {
+    std::string path;               // "video.svo2", "depth_data/depth.dsf"
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Summary of one flight directory on the USB stick
+ */
+struct RecordingInfo {
+    std::string id;                 // Directory name ("flight_20251016_093000")
+    uint64_t bytes = 0;
+    size_t file_count = 0;
+    int64_t start_time = 0;         // Unix seconds from the directory name (0 if it does not parse)
+    int64_t last_modified = 0;      // Newest file mtime, unix seconds
+    double duration_s = 0.0;        // last_modified - start_time (files close shortly after the last frame)
+    bool active = false;            // Recording still being written
+    std::vector<RecordingFile> files;
+};
+
+/**
+ * @brief Incrementally maintained listing of the flight directories under a mount path
+ *
+ * refresh() lists the mount directory and rescans only recordings whose
+ * directory mtimes (the recording directory and its subdirectories) changed,
+ * plus the active recording; everything else is served from the index. A
+ * full walk happens once per recording, not once per request.
+ *
+ * Thread-safe; refresh() is meant for handler threads, not the HTTP reactor.
+ */
+class RecordingIndex {
+public:
+    explicit RecordingIndex(const std::string& root, const std::string& prefix = "flight_");
+
+    // Rescan changed recordings; no-op when called again within min_interval
+    void refresh(std::chrono::milliseconds min_interval = std::chrono::milliseconds(2000));
+
+    // Recording currently being written (rescanned on every refresh); "" = none
+    void setActive(const std::string& id);
+
+    // Force a rescan of @p id (or of everything) on the next refresh
+    void invalidate(const std::string& id = "");
+
+    // Newest first; files are left empty unless @p with_files
+    std::vector<RecordingInfo> list(bool with_files = false) const;
+    bool find(const std::string& id, RecordingInfo& info) const;
+
+    /**
+     * @brief Absolute path of a file inside a known recording
+     * @return Empty if @p id is not indexed or @p relative is absolute / contains ".." or hidden components
+     */
+    std::string resolve(const std::string& id, const std::string& relative) const;
+
+    const std::string& getRoot() const { return root_; }
+    uint64_t getRescanCount() const;
+
+private:
+    struct Entry {
+        RecordingInfo info;
+        std::vector<std::pair<std::string, int64_t>> dir_mtimes;    // Directory -> mtime (ns) at the last scan
+        bool dirty = true;
+    };
+
+    bool changed(const Entry& entry) const;
+    void scan(const std::string& id, Entry& entry) const;
+    static int64_t parseStartTime(const std::string& id, const std::string& prefix);
+
+    const std::string root_;
+    const std::string prefix_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    std::string active_;
+    std::chrono::steady_clock::time_point last_refresh_;
+    bool refreshed_{false};
+    uint64_t rescans_{0};
+};
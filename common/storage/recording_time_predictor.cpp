@@ -0,0 +1,98 @@
+#include "recording_time_predictor.h"
+#include <algorithm>
+#include <sys/statvfs.h>
+
+namespace {
+
+constexpr double MB = 1024.0 * 1024.0;
+
+}  // namespace
+
+RecordingTimePredictor::RecordingTimePredictor(const std::string& mount_path)
+    : RecordingTimePredictor(mount_path, Config()) {
+}
+
+RecordingTimePredictor::RecordingTimePredictor(const std::string& mount_path, const Config& config)
+    : mount_path_(mount_path), config_(config) {
+    config_.ewma_alpha = std::min(std::max(config_.ewma_alpha, 0.01), 1.0);
+}
+
+void RecordingTimePredictor::update(const std::string& mode, double recorder_mb_per_sec, bool recording) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (sampled_ && now - last_sample_ < config_.min_sample_interval) {
+        return;
+    }
+
+    struct statvfs fs;
+    if (statvfs(mount_path_.c_str(), &fs) != 0) {
+        return;
+    }
+    uint64_t free_bytes = static_cast<uint64_t>(fs.f_bavail) * fs.f_frsize;
+    double dt = std::chrono::duration<double>(now - last_sample_).count();
+
+    // Free-space decline between two samples of the same recording (also counts files the recorder does not)
+    double decline_mb_per_sec = 0.0;
+    if (recording && was_recording_ && sampled_ && dt > 0.0 && free_bytes < free_bytes_) {
+        decline_mb_per_sec = (free_bytes_ - free_bytes) / MB / dt;
+    }
+    if (recording) {
+        double sample = std::max(recorder_mb_per_sec, decline_mb_per_sec);
+        if (sample > 0.0) {
+            auto it = rates_.find(mode);
+            if (it == rates_.end()) {
+                rates_[mode] = sample;
+            } else {
+                it->second += config_.ewma_alpha * (sample - it->second);
+            }
+        }
+    }
+
+    free_bytes_ = free_bytes;
+    total_bytes_ = static_cast<uint64_t>(fs.f_blocks) * fs.f_frsize;
+    last_sample_ = now;
+    sampled_ = true;
+    was_recording_ = recording;
+}
+
+double RecordingTimePredictor::rateLocked(const std::string& mode, double fallback_mb_per_sec) const {
+    auto it = rates_.find(mode);
+    return it != rates_.end() ? it->second : fallback_mb_per_sec;
+}
+
+double RecordingTimePredictor::usableBytesLocked() const {
+    return static_cast<double>(free_bytes_) - static_cast<double>(config_.reserve_bytes);
+}
+
+double RecordingTimePredictor::getRate(const std::string& mode, double fallback_mb_per_sec) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rateLocked(mode, fallback_mb_per_sec);
+}
+
+int RecordingTimePredictor::predictSeconds(const std::string& mode, double fallback_mb_per_sec) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double rate = rateLocked(mode, fallback_mb_per_sec);
+    if (!sampled_ || rate <= 0.0) {
+        return -1;
+    }
+    return static_cast<int>(std::max(0.0, usableBytesLocked() / MB / rate));
+}
+
+bool RecordingTimePredictor::shouldStop(const std::string& mode, double fallback_mb_per_sec) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!sampled_) {
+        return false;
+    }
+    double rate = std::max(rateLocked(mode, fallback_mb_per_sec), 0.0);
+    return usableBytesLocked() <= config_.stop_margin_s * rate * MB;
+}
+
+uint64_t RecordingTimePredictor::getFreeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_bytes_;
+}
+
+uint64_t RecordingTimePredictor::getTotalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_;
+}
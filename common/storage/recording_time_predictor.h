@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Predicts how many seconds the selected mode can still record on the stick
+ *
+ * Free space comes from statvfs() on the mount, sampled at most once per
+ * min_sample_interval (callers may ask several times per second). Each mode
+ * keeps an EWMA of its write rate, learned while it records: the larger of the
+ * rate the recorder reports and the rate at which free space shrinks (which
+ * also covers depth files and logs the recorder does not count). Modes that
+ * never recorded use the caller's estimate.
+ *
+ * Thread-safe.
+ */
+class RecordingTimePredictor {
+public:
+    struct Config {
+        double ewma_alpha = 0.2;                        // Weight of a new 1 Hz sample
+        uint64_t reserve_bytes = 256ULL * 1024 * 1024;  // Never planned for: FS metadata, SVO2 trailer, log tails
+        double stop_margin_s = 15.0;                    // Written between the early-stop request and closed files
+        std::chrono::milliseconds min_sample_interval{1000};
+    };
+
+    explicit RecordingTimePredictor(const std::string& mount_path);
+    RecordingTimePredictor(const std::string& mount_path, const Config& config);
+
+    /**
+     * @brief Sample free space (throttled) and, while recording, learn the rate of @p mode
+     * @param recorder_mb_per_sec Rate reported by the recorder (0 if unknown)
+     * @param recording False when idle: only free space is refreshed
+     */
+    void update(const std::string& mode, double recorder_mb_per_sec, bool recording);
+
+    // Learned rate of @p mode, or @p fallback_mb_per_sec if it never recorded
+    double getRate(const std::string& mode, double fallback_mb_per_sec) const;
+
+    // Seconds @p mode can still record; -1 if free space or rate are unknown
+    int predictSeconds(const std::string& mode, double fallback_mb_per_sec) const;
+
+    // Free space (minus reserve) no longer covers stop_margin_s at the current rate
+    bool shouldStop(const std::string& mode, double fallback_mb_per_sec) const;
+
+    uint64_t getFreeBytes() const;
+    uint64_t getTotalBytes() const;
+
+private:
+    double usableBytesLocked() const;
+    double rateLocked(const std::string& mode, double fallback_mb_per_sec) const;
+
+    const std::string mount_path_;
+    Config config_;
+
+    mutable std::mutex mutex_;
+    bool sampled_{false};
+    uint64_t free_bytes_{0};
+    uint64_t total_bytes_{0};
+    std::chrono::steady_clock::time_point last_sample_;
+    bool was_recording_{false};
+    std::map<std::string, double> rates_;              // Mode -> EWMA MB/s
+};
@@ -1,4 +1,5 @@
 #include "storage.h"
+#include "storage_flusher.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -186,7 +187,7 @@ std::string StorageHandler::getVideoPath() const {
 }
 
 std::string StorageHandler::getSensorDataPath() const {
-    return recording_dir_ + "/sensors.csv";
+    return recording_dir_ + "/sensors.slog";  // Binary sensor log (tools/sensor_log_export -> CSV)
 }
 
 std::string StorageHandler::getLogPath() const {
@@ -253,12 +254,12 @@ std::string StorageHandler::getRawDepthPath() const {
 }
 
 std::string StorageHandler::getRawSensorPath() const {
-    return recording_dir_ + "/sensor_data.csv";
+    return recording_dir_ + "/sensor_data.slog";
 }
 
 void StorageHandler::unmountUSB() {
     if (is_mounted_) {
-        sync();  // Sicherstellen, dass alle Daten geschrieben wurden
+        StorageFlusher::syncFilesystem(mount_path_);  // Nur den USB-Stick flushen, nicht das ganze System
         
         // Nur unmounten wenn wir selbst gemountet haben (nicht unter /media/angelo)
         if (mount_path_.find("/media/angelo") != 0) {
@@ -0,0 +1,348 @@
+#include "storage_benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char* const BY_UUID_DIR = "/dev/disk/by-uuid";
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string realPath(const std::string& path) {
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) ? std::string(resolved) : path;
+}
+
+// Mount source (e.g. /dev/sda1) of the longest mount point containing @p path - for FUSE mounts
+std::string mountSource(const std::string& path) {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    std::string best_point;
+    std::string best_source;
+    while (std::getline(mountinfo, line)) {
+        // id parent major:minor root mount_point options [optional...] - fstype source super_options
+        std::istringstream fields(line);
+        std::string id, parent, devno, root, point;
+        fields >> id >> parent >> devno >> root >> point;
+        size_t separator = line.find(" - ");
+        if (separator == std::string::npos) {
+            continue;
+        }
+        std::istringstream tail(line.substr(separator + 3));
+        std::string fstype, source;
+        tail >> fstype >> source;
+
+        for (size_t pos; (pos = point.find("\\040")) != std::string::npos;) {
+            point.replace(pos, 4, " ");
+        }
+        bool contains = path == point ||
+                        (path.compare(0, point.size(), point) == 0 &&
+                         (point == "/" || path[point.size()] == '/'));
+        if (contains && point.size() > best_point.size()) {
+            best_point = point;
+            best_source = source;
+        }
+    }
+    return best_source;
+}
+
+bool removeTree(const std::string& dir) {
+    DIR* handle = opendir(dir.c_str());
+    if (handle) {
+        while (struct dirent* entry = readdir(handle)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                unlink((dir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(handle);
+    }
+    return rmdir(dir.c_str()) == 0;
+}
+
+}  // namespace
+
+const char* storageFitName(StorageFit fit) {
+    switch (fit) {
+        case StorageFit::OK: return "ok";
+        case StorageFit::MARGINAL: return "marginal";
+        case StorageFit::INSUFFICIENT: return "insufficient";
+        default: return "unknown";
+    }
+}
+
+StorageBenchmark::StorageBenchmark() : StorageBenchmark(Config()) {
+}
+
+StorageBenchmark::StorageBenchmark(const Config& config) : config_(config) {
+    config_.seq_block = std::max<size_t>(config_.seq_block & ~static_cast<size_t>(4095), 4096);
+}
+
+std::string StorageBenchmark::filesystemUUID(const std::string& path) {
+    struct stat target;
+    if (stat(path.c_str(), &target) != 0) {
+        return "";
+    }
+    std::string source = realPath(mountSource(realPath(path)));
+
+    DIR* dir = opendir(BY_UUID_DIR);
+    if (!dir) {
+        return "";
+    }
+    std::string uuid;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string link = std::string(BY_UUID_DIR) + "/" + entry->d_name;
+        struct stat device;
+        if (stat(link.c_str(), &device) != 0 || !S_ISBLK(device.st_mode)) {
+            continue;
+        }
+        // Kernel filesystems report the block device as st_dev; FUSE (ntfs-3g) only via the mount source
+        if (device.st_rdev == target.st_dev || (!source.empty() && realPath(link) == source)) {
+            uuid = entry->d_name;
+            break;
+        }
+    }
+    closedir(dir);
+    return uuid;
+}
+
+StorageBenchmarkResult StorageBenchmark::cached(const std::string& mount_path) const {
+    StorageBenchmarkResult result;
+    std::string uuid = filesystemUUID(mount_path);
+    if (!uuid.empty()) {
+        loadCache(uuid, result);
+    }
+    return result;
+}
+
+StorageBenchmarkResult StorageBenchmark::run(const std::string& mount_path, bool force) {
+    cancel_ = false;
+    StorageBenchmarkResult result;
+    result.uuid = filesystemUUID(mount_path);
+    if (!force && !result.uuid.empty() && loadCache(result.uuid, result)) {
+        std::cout << "[STORAGE_BENCH] Cached result for " << result.uuid << ": "
+                  << result.seq_write_mb_per_sec << " MB/s, " << result.small_files_per_sec << " files/s" << std::endl;
+        return result;
+    }
+
+    std::string dir = mount_path + "/.storage_bench";
+    removeTree(dir);        // Leftovers of an interrupted run
+    if (mkdir(dir.c_str(), 0755) != 0) {
+        std::cerr << "[STORAGE_BENCH] Cannot create " << dir << ": " << strerror(errno) << std::endl;
+        return result;
+    }
+
+    std::cout << "[STORAGE_BENCH] Benchmarking " << mount_path
+              << (result.uuid.empty() ? "" : " (UUID " + result.uuid + ")") << "..." << std::endl;
+    bool ok = measureSequential(dir, result) && measureSmallFiles(dir, result) && measureFsync(dir, result);
+    removeTree(dir);
+
+    if (!ok) {
+        std::cout << "[STORAGE_BENCH] " << (cancel_ ? "Cancelled" : "Failed") << std::endl;
+        return StorageBenchmarkResult();
+    }
+    result.valid = true;
+    result.measured_at = static_cast<int64_t>(std::time(nullptr));
+    std::cout << "[STORAGE_BENCH] Sequential " << result.seq_write_mb_per_sec << " MB/s"
+              << (result.direct_io ? " (O_DIRECT)" : " (buffered)") << ", "
+              << result.small_files_per_sec << " files/s, fsync p50 " << result.fsync_p50_ms
+              << "ms max " << result.fsync_max_ms << "ms" << std::endl;
+    if (!result.uuid.empty()) {
+        saveCache(result);
+    }
+    return result;
+}
+
+bool StorageBenchmark::measureSequential(const std::string& dir, StorageBenchmarkResult& result) {
+    std::string path = dir + "/sequential.bin";
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, 4096, config_.seq_block) != 0) {
+        return false;
+    }
+    // Incompressible-looking content: no filesystem or controller shortcut on zero pages
+    uint32_t state = 0x9E3779B9u;
+    for (size_t i = 0; i < config_.seq_block / sizeof(uint32_t); i++) {
+        state = state * 1664525u + 1013904223u;
+        static_cast<uint32_t*>(buffer)[i] = state;
+    }
+
+    bool ok = false;
+    for (bool direct : {true, false}) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (direct ? O_DIRECT : 0), 0644);
+        if (fd < 0) {
+            continue;       // exFAT via FUSE etc. refuse O_DIRECT - retry buffered
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t written = 0;
+        bool failed = false;
+        while (written < config_.seq_bytes && !cancel_) {
+            ssize_t n = ::write(fd, buffer, config_.seq_block);
+            if (n != static_cast<ssize_t>(config_.seq_block)) {
+                failed = true;
+                break;
+            }
+            written += static_cast<uint64_t>(n);
+        }
+        failed = failed || cancel_ || ::fdatasync(fd) != 0;
+        double elapsed = secondsSince(start);
+        ::close(fd);
+        unlink(path.c_str());
+
+        if (!failed && elapsed > 0.0) {
+            result.seq_write_mb_per_sec = (written / (1024.0 * 1024.0)) / elapsed;
+            result.direct_io = direct;
+            ok = true;
+            break;
+        }
+        if (cancel_) {
+            break;
+        }
+    }
+    free(buffer);
+    return ok;
+}
+
+bool StorageBenchmark::measureSmallFiles(const std::string& dir, StorageBenchmarkResult& result) {
+    std::vector<char> data(config_.small_file_bytes, 'd');
+    auto start = std::chrono::steady_clock::now();
+    int created = 0;
+    for (; created < config_.small_files && !cancel_; created++) {
+        std::string path = dir + "/small_" + std::to_string(created) + ".bin";
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+        ::close(fd);
+        if (!ok) {
+            return false;
+        }
+    }
+    // Include the write-back: the page cache hides the metadata cost only until it fills up
+    int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::syncfs(dir_fd);
+        ::close(dir_fd);
+    }
+    double elapsed = secondsSince(start);
+    if (cancel_ || elapsed <= 0.0) {
+        return false;
+    }
+    result.small_files_per_sec = created / elapsed;
+    return true;
+}
+
+bool StorageBenchmark::measureFsync(const std::string& dir, StorageBenchmarkResult& result) {
+    std::string path = dir + "/fsync.bin";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<char> block(4096, 'f');
+    std::vector<double> latencies;
+    for (int i = 0; i < config_.fsync_rounds && !cancel_; i++) {
+        if (::write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+            break;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (::fsync(fd) != 0) {
+            break;
+        }
+        latencies.push_back(secondsSince(start) * 1000.0);
+    }
+    ::close(fd);
+    unlink(path.c_str());
+    if (cancel_ || latencies.empty()) {
+        return false;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    result.fsync_p50_ms = latencies[latencies.size() / 2];
+    result.fsync_max_ms = latencies.back();
+    return true;
+}
+
+StorageFit StorageBenchmark::assess(const StorageBenchmarkResult& result, double mb_per_sec, double files_per_sec) const {
+    if (!result.valid) {
+        return StorageFit::UNKNOWN;
+    }
+    // Fraction of the measured capacity the recording needs (the larger of bandwidth and file rate)
+    double load = mb_per_sec / std::max(result.seq_write_mb_per_sec, 0.001);
+    if (files_per_sec > 0.0) {
+        load = std::max(load, files_per_sec / std::max(result.small_files_per_sec, 0.001));
+    }
+    if (load > 1.0) {
+        return StorageFit::INSUFFICIENT;
+    }
+    return load > config_.safe_fraction ? StorageFit::MARGINAL : StorageFit::OK;
+}
+
+bool StorageBenchmark::loadCache(const std::string& uuid, StorageBenchmarkResult& result) const {
+    // One line per filesystem: uuid seq_mbps files_per_s fsync_p50_ms fsync_max_ms direct_io unix_time
+    std::ifstream cache(config_.cache_path);
+    std::string line;
+    while (std::getline(cache, line)) {
+        std::istringstream fields(line);
+        StorageBenchmarkResult entry;
+        int direct = 0;
+        if (fields >> entry.uuid >> entry.seq_write_mb_per_sec >> entry.small_files_per_sec >>
+                      entry.fsync_p50_ms >> entry.fsync_max_ms >> direct >> entry.measured_at &&
+            entry.uuid == uuid) {
+            entry.direct_io = direct != 0;
+            entry.valid = true;
+            entry.from_cache = true;
+            result = entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+void StorageBenchmark::saveCache(const StorageBenchmarkResult& result) const {
+    std::vector<std::string> lines;
+    {
+        std::ifstream cache(config_.cache_path);
+        std::string line;
+        while (std::getline(cache, line)) {
+            if (!line.empty() && line.compare(0, result.uuid.size() + 1, result.uuid + " ") != 0) {
+                lines.push_back(line);
+            }
+        }
+    }
+    std::ostringstream entry;
+    entry << result.uuid << " " << result.seq_write_mb_per_sec << " " << result.small_files_per_sec << " "
+          << result.fsync_p50_ms << " " << result.fsync_max_ms << " " << (result.direct_io ? 1 : 0) << " "
+          << result.measured_at;
+    lines.push_back(entry.str());
+
+    // Write-and-rename: a crash never leaves a truncated cache
+    std::string tmp = config_.cache_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const auto& line : lines) {
+            out << line << "\n";
+        }
+        if (!out) {
+            std::cerr << "[STORAGE_BENCH] Cannot write cache " << config_.cache_path << std::endl;
+            return;
+        }
+    }
+    std::rename(tmp.c_str(), config_.cache_path.c_str());
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Measured capabilities of one USB filesystem
+ */
+struct StorageBenchmarkResult {
+    bool valid = false;
+    std::string uuid;                   // Filesystem UUID ("" = unknown, result not cached)
+    double seq_write_mb_per_sec = 0.0;  // Large aligned writes incl. final fdatasync
+    double small_files_per_sec = 0.0;   // create + write + close, incl. syncfs at the end
+    double fsync_p50_ms = 0.0;          // 4 KiB append + fsync
+    double fsync_max_ms = 0.0;
+    bool direct_io = false;             // Sequential test bypassed the page cache (O_DIRECT)
+    int64_t measured_at = 0;            // Unix seconds
+    bool from_cache = false;
+};
+
+// How a required data rate compares to a benchmark result
+enum class StorageFit {
+    UNKNOWN,        // No valid benchmark
+    OK,             // Within Config::safe_fraction of what the stick sustains
+    MARGINAL,       // Above the safe fraction but below the measured rate
+    INSUFFICIENT    // Above the measured rate - the recorder will fall behind
+};
+
+const char* storageFitName(StorageFit fit);
+
+/**
+ * @brief Qualification benchmark for the recording stick, cached per filesystem UUID
+ *
+ * Measures sequential write throughput (4 MiB O_DIRECT writes, buffered +
+ * fdatasync where the filesystem refuses O_DIRECT), the rate of small file
+ * creation (one file per frame layouts) and fsync latency. Scratch files live
+ * in a hidden directory on the mount and are removed afterwards.
+ *
+ * run() is blocking (a few seconds on a USB 2.0 stick); cancel() from another
+ * thread aborts it between blocks.
+ */
+class StorageBenchmark {
+public:
+    struct Config {
+        uint64_t seq_bytes = 64ULL * 1024 * 1024;
+        size_t seq_block = 4 * 1024 * 1024;
+        int small_files = 200;
+        size_t small_file_bytes = 64 * 1024;
+        int fsync_rounds = 20;
+        double safe_fraction = 0.7;     // Headroom for SD/flash write stalls and filesystem overhead
+        std::string cache_path = "/home/angelo/Projects/Drone-Fieldtest/storage_benchmarks.txt";
+    };
+
+    StorageBenchmark();
+    explicit StorageBenchmark(const Config& config);
+
+    /**
+     * @brief Benchmark the filesystem at @p mount_path
+     * @param force Measure again even if a cached result for its UUID exists
+     */
+    StorageBenchmarkResult run(const std::string& mount_path, bool force = false);
+
+    // Cached result for the filesystem at @p mount_path (invalid if none)
+    StorageBenchmarkResult cached(const std::string& mount_path) const;
+
+    void cancel() { cancel_ = true; }
+
+    /**
+     * @brief Compare a required load with a result
+     * @param mb_per_sec Sustained write rate of the recording
+     * @param files_per_sec Files created per second (0 for single-file layouts)
+     */
+    StorageFit assess(const StorageBenchmarkResult& result, double mb_per_sec, double files_per_sec) const;
+
+    // UUID from /dev/disk/by-uuid of the block device backing @p path ("" if not found)
+    static std::string filesystemUUID(const std::string& path);
+
+private:
+    bool measureSequential(const std::string& dir, StorageBenchmarkResult& result);
+    bool measureSmallFiles(const std::string& dir, StorageBenchmarkResult& result);
+    bool measureFsync(const std::string& dir, StorageBenchmarkResult& result);
+
+    bool loadCache(const std::string& uuid, StorageBenchmarkResult& result) const;
+    void saveCache(const StorageBenchmarkResult& result) const;
+
+    Config config_;
+    std::atomic<bool> cancel_{false};
+};
@@ -0,0 +1,302 @@
+#include "storage_flusher.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+StorageFlusher::StorageFlusher() : StorageFlusher(Config()) {
+}
+
+StorageFlusher::StorageFlusher(const Config& config) : config_(config) {
+    if (config_.interval_ms <= 0) {
+        config_.interval_ms = 250;
+    }
+    if (config_.window_bytes == 0) {
+        config_.window_bytes = 8ULL * 1024 * 1024;
+    }
+}
+
+StorageFlusher::~StorageFlusher() {
+    stop();
+}
+
+void StorageFlusher::start(const std::string& mount_path) {
+    stop();
+    mount_path_ = mount_path;
+    running_ = true;
+    thread_ = std::make_unique<std::thread>(&StorageFlusher::flusherLoop, this);
+}
+
+void StorageFlusher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (thread_ && thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    for (auto& file : files_) {
+        closeFile(file);
+    }
+    files_.clear();
+}
+
+void StorageFlusher::track(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    to_track_.push_back(path);
+}
+
+void StorageFlusher::untrack(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    to_untrack_.push_back(path);
+}
+
+void StorageFlusher::untrackAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    untrack_all_ = true;
+    to_track_.clear();
+    to_untrack_.clear();
+}
+
+bool StorageFlusher::syncFilesystem(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[FLUSH] Cannot open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    bool ok = (::syncfs(fd) == 0);
+    if (!ok) {
+        std::cerr << "[FLUSH] syncfs(" << path << ") failed: " << strerror(errno) << std::endl;
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool StorageFlusher::syncMount() {
+    if (mount_path_.empty()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    bool ok = syncFilesystem(mount_path_);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (ok) {
+        std::lock_guard<std::mutex> lock(files_mutex_);
+        for (auto& file : files_) {
+            struct stat st;
+            if (file.fd >= 0 && fstat(file.fd, &st) == 0) {
+                file.size = static_cast<uint64_t>(st.st_size);
+            }
+            file.submitted = file.size;
+            file.confirmed = file.size;
+            file.synced = file.size;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.last_syncfs_ms = elapsed_ms;
+        if (ok) {
+            stats_.pending_bytes = 0;
+            stats_.backlog_s = 0.0;
+            stats_.backlog_warning = false;
+        }
+    }
+    std::cout << "[FLUSH] syncfs(" << mount_path_ << ") " << (ok ? "done" : "FAILED")
+              << " in " << static_cast<int>(elapsed_ms) << "ms" << std::endl;
+    return ok;
+}
+
+FlushStats StorageFlusher::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void StorageFlusher::closeFile(TrackedFile& file) {
+    if (file.fd >= 0) {
+        ::close(file.fd);
+        file.fd = -1;
+    }
+}
+
+void StorageFlusher::applyChanges() {
+    std::vector<std::string> add;
+    std::vector<std::string> remove;
+    bool remove_all;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        add.swap(to_track_);
+        remove.swap(to_untrack_);
+        remove_all = untrack_all_;
+        untrack_all_ = false;
+    }
+
+    if (remove_all) {
+        for (auto& file : files_) {
+            closeFile(file);
+        }
+        files_.clear();
+    }
+    for (const auto& path : remove) {
+        auto it = std::find_if(files_.begin(), files_.end(),
+                               [&](const TrackedFile& file) { return file.path == path; });
+        if (it != files_.end()) {
+            closeFile(*it);
+            files_.erase(it);
+        }
+    }
+    for (const auto& path : add) {
+        if (std::none_of(files_.begin(), files_.end(),
+                         [&](const TrackedFile& file) { return file.path == path; })) {
+            TrackedFile file;
+            file.path = path;
+            files_.push_back(file);
+        }
+    }
+}
+
+void StorageFlusher::writeBehind(TrackedFile& file) {
+    if (file.fd < 0) {
+        // Recorder may not have created the file yet
+        file.fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file.fd < 0) {
+            return;
+        }
+    }
+    struct stat st;
+    if (fstat(file.fd, &st) != 0) {
+        return;
+    }
+    file.size = static_cast<uint64_t>(st.st_size);
+    if (file.size < file.confirmed) {
+        file.submitted = file.confirmed = 0;     // Truncated and rewritten
+    }
+    if (file.unsupported) {
+        return;
+    }
+
+    const uint64_t window = config_.window_bytes;
+
+    // Start write-back of every completed window (asynchronous, returns immediately)
+    while (file.size - file.submitted >= window) {
+        if (sync_file_range(file.fd, file.submitted, window, SYNC_FILE_RANGE_WRITE) != 0) {
+            std::cerr << "[FLUSH] sync_file_range unsupported for " << file.path << " ("
+                      << strerror(errno) << ") - left to syncfs at stop" << std::endl;
+            file.unsupported = true;
+            return;
+        }
+        file.submitted += window;
+    }
+
+    // Bound the outstanding windows: wait for the oldest one and drop it from the page cache
+    while (file.submitted - file.confirmed > window * config_.max_inflight_windows) {
+        auto start = std::chrono::steady_clock::now();
+        sync_file_range(file.fd, file.confirmed, window,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        double waited_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (config_.drop_cache) {
+            posix_fadvise(file.fd, file.confirmed, window, POSIX_FADV_DONTNEED);
+        }
+        file.confirmed += window;
+
+        // Waits that actually blocked tell how fast the device drains
+        if (waited_s > 0.001) {
+            double sample = (window / (1024.0 * 1024.0)) / waited_s;
+            rate_mb_per_sec_ = rate_mb_per_sec_ > 0.0 ? rate_mb_per_sec_ * 0.8 + sample * 0.2 : sample;
+        }
+    }
+}
+
+uint64_t StorageFlusher::readSystemDirty() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    uint64_t total_kb = 0;
+    int found = 0;
+    while (found < 2 && std::getline(meminfo, line)) {
+        if (line.compare(0, 6, "Dirty:") == 0 || line.compare(0, 10, "Writeback:") == 0) {
+            std::istringstream fields(line.substr(line.find(':') + 1));
+            uint64_t kb = 0;
+            fields >> kb;
+            total_kb += kb;
+            found++;
+        }
+    }
+    return total_kb * 1024;
+}
+
+void StorageFlusher::publishStats() {
+    FlushStats stats;
+    stats.tracked_files = files_.size();
+    for (const auto& file : files_) {
+        stats.written_bytes += file.size;
+        stats.pending_bytes += file.size - std::min(file.confirmed, file.size);
+    }
+    stats.system_dirty_bytes = readSystemDirty();
+    stats.writeback_mb_per_sec = rate_mb_per_sec_;
+
+    // Untracked files on the stick (depth, logs) are only visible in the system-wide counter
+    double rate = rate_mb_per_sec_ > 0.0 ? rate_mb_per_sec_ : config_.assumed_mb_per_sec;
+    uint64_t backlog = std::max(stats.pending_bytes, stats.system_dirty_bytes);
+    stats.backlog_s = (backlog / (1024.0 * 1024.0)) / rate;
+    stats.backlog_warning = stats.tracked_files > 0 && stats.backlog_s > config_.warn_backlog_s;
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats.last_syncfs_ms = stats_.last_syncfs_ms;
+    stats_ = stats;
+}
+
+void StorageFlusher::flusherLoop() {
+    bool warned = false;
+    while (running_) {
+        std::vector<TrackedFile> files;
+        {
+            std::lock_guard<std::mutex> lock(files_mutex_);
+            applyChanges();
+            files = files_;
+        }
+
+        // sync_file_range(WAIT_*) can block for seconds on a slow stick: keep syncMount() out of it
+        for (auto& file : files) {
+            writeBehind(file);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(files_mutex_);
+            // Only this thread adds or removes entries, so files_ still lines up with the copy
+            for (size_t i = 0; i < files.size(); i++) {
+                TrackedFile& file = files[i];
+                // syncMount() may have confirmed more meanwhile (unless the file was truncated since)
+                uint64_t synced = files_[i].synced <= file.size ? files_[i].synced : 0;
+                file.synced = synced;
+                file.confirmed = std::max(file.confirmed, synced);
+                file.submitted = std::max(file.submitted, file.confirmed);
+                files_[i] = file;
+            }
+            publishStats();
+        }
+
+        bool warning = getStats().backlog_warning;
+        if (warning && !warned) {
+            FlushStats stats = getStats();
+            std::cout << "[FLUSH] WARNING: " << stats.system_dirty_bytes / 1024 / 1024
+                      << "MB dirty, ~" << static_cast<int>(stats.backlog_s) << "s to flush at "
+                      << static_cast<int>(stats.writeback_mb_per_sec) << "MB/s" << std::endl;
+        }
+        warned = warning;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::milliseconds(config_.interval_ms), [this]() { return !running_; });
+    }
+}
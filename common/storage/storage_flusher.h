@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Write-back state of the tracked recording files
+ */
+struct FlushStats {
+    size_t tracked_files = 0;
+    uint64_t written_bytes = 0;         // Sum of the tracked file sizes
+    uint64_t pending_bytes = 0;         // Written but not yet confirmed on disk (tracked files)
+    uint64_t system_dirty_bytes = 0;    // Dirty + Writeback from /proc/meminfo (all devices)
+    double writeback_mb_per_sec = 0.0;  // Measured device write-back rate (smoothed)
+    double backlog_s = 0.0;             // Time a syncfs() would need right now
+    bool backlog_warning = false;       // backlog_s above Config::warn_backlog_s
+    double last_syncfs_ms = 0.0;
+};
+
+/**
+ * @brief Targeted flushing for recording files instead of a global sync()
+ *
+ * While recording, a background thread issues rolling sync_file_range()
+ * write-behind on every tracked file: full windows are submitted for write-back
+ * as soon as they are written, and the thread waits for the oldest ones once
+ * more than max_inflight_windows are outstanding, so dirty pages never pile up
+ * into a multi-second stall at stop. Confirmed ranges are dropped from the page
+ * cache (posix_fadvise DONTNEED) - a recording is never read back on the drone.
+ *
+ * syncMount() finishes the job with syncfs() on the USB mount only; eMMC
+ * rootfs and system logs are left to the kernel.
+ *
+ * Files may not exist yet when tracked; the thread keeps trying to open them.
+ */
+class StorageFlusher {
+public:
+    struct Config {
+        int interval_ms = 250;
+        uint64_t window_bytes = 8ULL * 1024 * 1024;    // Write-behind granularity
+        uint64_t max_inflight_windows = 4;              // Submitted but unconfirmed windows per file
+        double assumed_mb_per_sec = 20.0;               // Backlog estimate before the first measurement
+        double warn_backlog_s = 2.0;
+        bool drop_cache = true;
+    };
+
+    StorageFlusher();
+    explicit StorageFlusher(const Config& config);
+    ~StorageFlusher();
+
+    StorageFlusher(const StorageFlusher&) = delete;
+    StorageFlusher& operator=(const StorageFlusher&) = delete;
+
+    // @p mount_path: any path on the filesystem syncMount() flushes (the USB mount point)
+    void start(const std::string& mount_path);
+    void stop();
+
+    void track(const std::string& path);
+    void untrack(const std::string& path);
+    void untrackAll();
+
+    /**
+     * @brief syncfs() of the mount; tracked files count as confirmed afterwards
+     * @return false if the mount cannot be opened or syncfs() failed
+     */
+    bool syncMount();
+
+    FlushStats getStats() const;
+    const std::string& getMountPath() const { return mount_path_; }
+    bool isRunning() const { return running_.load(); }
+
+    // syncfs() of the filesystem containing @p path (usable without an instance)
+    static bool syncFilesystem(const std::string& path);
+
+private:
+    struct TrackedFile {
+        std::string path;
+        int fd = -1;
+        uint64_t size = 0;
+        uint64_t submitted = 0;         // Write-back started up to here
+        uint64_t confirmed = 0;         // On disk up to here
+        uint64_t synced = 0;            // Confirmed by syncMount() (merged into confirmed by the flusher)
+        bool unsupported = false;       // sync_file_range() rejected by the filesystem
+    };
+
+    void flusherLoop();
+    void applyChanges();
+    void writeBehind(TrackedFile& file);
+    void publishStats();
+    static void closeFile(TrackedFile& file);
+    static uint64_t readSystemDirty();
+
+    Config config_;
+    std::string mount_path_;
+
+    std::mutex mutex_;                      // Pending track/untrack requests, stop wakeup
+    std::condition_variable cv_;
+    std::vector<std::string> to_track_;
+    std::vector<std::string> to_untrack_;
+    bool untrack_all_{false};
+
+    // files_: entries are only added/removed by the flusher thread (and stop() after the join);
+    // the blocking write-behind waits run on a copy, never under this lock
+    std::mutex files_mutex_;
+    std::vector<TrackedFile> files_;
+    double rate_mb_per_sec_{0.0};           // Flusher thread only
+
+    mutable std::mutex stats_mutex_;
+    FlushStats stats_;
+
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,161 @@
+#include "write_rate_monitor.h"
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+WriteRateMonitor::WriteRateMonitor() : WriteRateMonitor(Config()) {
+}
+
+WriteRateMonitor::WriteRateMonitor(const Config& config) : config_(config) {
+    if (config_.interval_ms <= 0) {
+        config_.interval_ms = 1000;
+    }
+}
+
+WriteRateMonitor::~WriteRateMonitor() {
+    stop();
+}
+
+void WriteRateMonitor::start(const std::string& path, Callback callback) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        path_changed_ = true;
+    }
+    callback_ = std::move(callback);
+    bytes_ = 0;
+    mb_per_sec_ = 0.0;
+    plateau_ = false;
+
+    running_ = true;
+    thread_ = std::make_unique<std::thread>(&WriteRateMonitor::samplerLoop, this);
+}
+
+void WriteRateMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (thread_ && thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+}
+
+void WriteRateMonitor::setPath(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        path_changed_ = true;
+    }
+    bytes_ = 0;
+    mb_per_sec_ = 0.0;
+    plateau_ = false;
+}
+
+void WriteRateMonitor::closeFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool WriteRateMonitor::sampleSize(uint64_t& size) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (path_changed_) {
+            closeFile();
+            history_.clear();
+            path_changed_ = false;
+        }
+        path = path_;
+    }
+
+    if (fd_ < 0) {
+        // Writer may not have created the file yet - retry next tick
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            return false;
+        }
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        closeFile();
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+void WriteRateMonitor::samplerLoop() {
+    const auto window = std::chrono::seconds(config_.plateau_window_s);
+
+    while (running_) {
+        uint64_t size = 0;
+        if (sampleSize(size)) {
+            auto now = std::chrono::steady_clock::now();
+
+            // File shrank (truncated, or preallocation trimmed at close): start over so the
+            // history never decreases - the plateau check subtracts its oldest size
+            if (!history_.empty() && size < history_.back().second) {
+                history_.clear();
+            }
+
+            // Rate over the last interval, smoothed to hide filesystem write-back bursts
+            double instant_rate = 0.0;
+            if (!history_.empty()) {
+                double dt = std::chrono::duration<double>(now - history_.back().first).count();
+                uint64_t previous = history_.back().second;
+                if (dt > 0.0 && size >= previous) {
+                    instant_rate = (size - previous) / (1024.0 * 1024.0) / dt;
+                }
+            }
+            double rate = history_.empty() ? 0.0 : mb_per_sec_.load() * 0.7 + instant_rate * 0.3;
+
+            history_.emplace_back(now, size);
+            while (history_.size() > 2 && now - history_[1].first >= window) {
+                history_.pop_front();
+            }
+
+            // Plateau only once a full window is covered
+            bool plateau = false;
+            if (now - history_.front().first >= window && size > config_.plateau_min_size) {
+                plateau = (size - history_.front().second) < config_.plateau_min_growth;
+            }
+            if (plateau && !plateau_) {
+                std::cout << "[WRITE_MONITOR] WARNING: File size plateau detected - potential buffer buildup! ("
+                          << size / (1024 * 1024) << "MB)" << std::endl;
+            } else if (!plateau && plateau_) {
+                std::cout << "[WRITE_MONITOR] File growing again (" << rate << " MB/s)" << std::endl;
+            }
+
+            bytes_ = size;
+            mb_per_sec_ = rate;
+            plateau_ = plateau;
+
+            if (callback_) {
+                WriteRateSample sample;
+                sample.bytes = size;
+                sample.mb_per_sec = rate;
+                sample.plateau = plateau;
+                sample.time = now;
+                callback_(sample);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::milliseconds(config_.interval_ms), [this] { return !running_; });
+    }
+
+    closeFile();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief One size sample of the monitored file
+ */
+struct WriteRateSample {
+    uint64_t bytes = 0;             // Current file size
+    double mb_per_sec = 0.0;        // Smoothed growth rate
+    bool plateau = false;           // File stopped growing (see WriteRateMonitor::Config)
+    std::chrono::steady_clock::time_point time;
+};
+
+/**
+ * @brief Low-rate background sampler for the size/growth of a file being written
+ *
+ * Replaces per-frame stat() calls in recording loops: a single thread fstat()s
+ * a held read-only descriptor once per interval and publishes size, MB/s and a
+ * plateau flag (file barely grew over plateau_window_s although it is already
+ * large - the writer is stalling and buffering in RAM).
+ *
+ * The file may not exist yet when start() is called; the sampler keeps trying
+ * to open it on every tick.
+ */
+class WriteRateMonitor {
+public:
+    struct Config {
+        int interval_ms = 1000;
+        int plateau_window_s = 10;
+        uint64_t plateau_min_growth = 10ULL * 1024 * 1024;     // <10MB growth per window ...
+        uint64_t plateau_min_size = 1024ULL * 1024 * 1024;     // ... for a file >1GB
+    };
+
+    // Called on the sampler thread after every sample
+    using Callback = std::function<void(const WriteRateSample&)>;
+
+    WriteRateMonitor();
+    explicit WriteRateMonitor(const Config& config);
+    ~WriteRateMonitor();
+
+    WriteRateMonitor(const WriteRateMonitor&) = delete;
+    WriteRateMonitor& operator=(const WriteRateMonitor&) = delete;
+
+    void start(const std::string& path, Callback callback = nullptr);
+    void stop();
+
+    // Follow a new file (segment switch); counters restart at zero
+    void setPath(const std::string& path);
+
+    bool isRunning() const { return running_.load(); }
+    uint64_t getBytes() const { return bytes_.load(); }
+    double getMBPerSec() const { return mb_per_sec_.load(); }
+    bool isPlateau() const { return plateau_.load(); }
+
+private:
+    void samplerLoop();
+    bool sampleSize(uint64_t& size);
+    void closeFile();
+
+    Config config_;
+    Callback callback_;
+
+    std::mutex mutex_;                      // path_, path_changed_, stop wakeup
+    std::condition_variable cv_;
+    std::string path_;
+    bool path_changed_{false};
+
+    int fd_{-1};                            // Sampler thread only
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> history_;   // Sampler thread only
+
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<double> mb_per_sec_{0.0};
+    std::atomic<bool> plateau_{false};
+};
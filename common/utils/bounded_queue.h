@@ -0,0 +1,178 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @brief What push() does when the queue is full
+ */
+enum class BackpressurePolicy {
+    BLOCK,          // Producer waits until a consumer frees a slot
+    DROP_OLDEST,    // Oldest queued item is discarded to make room (keeps the freshest data)
+    DROP_NEWEST     // Incoming item is discarded (keeps queued data in order)
+};
+
+/**
+ * @brief Bounded multi-producer / multi-consumer queue with a backpressure policy
+ *
+ * close() wakes all waiters; pop() keeps returning queued items until the
+ * queue is empty, so consumers drain remaining work before exiting.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity, BackpressurePolicy policy = BackpressurePolicy::BLOCK)
+        : capacity_(capacity > 0 ? capacity : 1), policy_(policy) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Enqueue an item
+     * @return false if the item was not queued (DROP_NEWEST on a full queue, or queue closed)
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (policy_ == BackpressurePolicy::BLOCK) {
+            not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        }
+        if (closed_) {
+            return false;
+        }
+
+        if (items_.size() >= capacity_) {
+            if (policy_ == BackpressurePolicy::DROP_NEWEST) {
+                dropped_++;
+                return false;
+            }
+            // DROP_OLDEST - evicted item is destroyed outside the lock
+            [[maybe_unused]] T evicted = std::move(items_.front());
+            items_.pop_front();
+            dropped_++;
+            items_.push_back(std::move(item));
+            updateHighWater();
+            lock.unlock();
+            not_empty_.notify_one();
+            return true;
+        }
+
+        items_.push_back(std::move(item));
+        updateHighWater();
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Dequeue an item, waiting until one is available
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        out = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Dequeue an item, waiting at most timeout
+     * @return false on timeout, or once the queue is closed and empty
+     */
+    template <typename Rep, typename Period>
+    bool popFor(T& out, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait_for(lock, timeout, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        out = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Dequeue an item without waiting
+     */
+    bool tryPop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return false;
+        }
+        out = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Reject further pushes and wake all waiting producers/consumers
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Re-open a closed queue (remaining items are kept)
+     */
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t capacity() const { return capacity_; }
+    BackpressurePolicy policy() const { return policy_; }
+
+    // Items discarded by the DROP_* policies since construction
+    size_t dropped() const { return dropped_.load(); }
+
+    // Largest queue depth observed since construction
+    size_t highWater() const { return high_water_.load(); }
+
+private:
+    void updateHighWater() {
+        if (items_.size() > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(items_.size(), std::memory_order_relaxed);
+        }
+    }
+
+    const size_t capacity_;
+    const BackpressurePolicy policy_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_{false};
+
+    std::atomic<size_t> dropped_{0};
+    std::atomic<size_t> high_water_{0};
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Percentiles of one LatencyHistogram (milliseconds)
+ */
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// Named stages of one pipeline, e.g. {"raw.grab", summary}
+using LatencyReport = std::vector<std::pair<std::string, LatencySummary>>;
+
+/**
+ * @brief Fixed-bucket log-linear latency histogram (microsecond resolution)
+ *
+ * Each power of two is split into 16 linear sub-buckets, so any recorded
+ * value is reported within ~6% from 1us up to ~70 minutes in 464 buckets.
+ * record() is a handful of relaxed atomic increments - no locks, no
+ * allocation - and may be called from any number of threads. Percentiles
+ * are computed on demand by the reader (summary()).
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 31;                  // Values clamp at 2^32 - 1 us
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t us) {
+        counts_[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t max = max_us_.load(std::memory_order_relaxed);
+        while (us > max && !max_us_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> elapsed) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        record(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    void recordSince(std::chrono::steady_clock::time_point start) {
+        record(std::chrono::steady_clock::now() - start);
+    }
+
+    // Not atomic with concurrent record() calls - a sample may be counted or lost
+    void reset() {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_us_.store(0, std::memory_order_relaxed);
+        max_us_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    LatencySummary summary() const {
+        std::array<uint64_t, BUCKETS> snapshot;
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            snapshot[i] = counts_[i].load(std::memory_order_relaxed);
+            total += snapshot[i];
+        }
+
+        LatencySummary summary;
+        if (total == 0) {
+            return summary;
+        }
+        const uint64_t max_us = max_us_.load(std::memory_order_relaxed);
+        summary.count = total;
+        summary.mean_ms = static_cast<double>(sum_us_.load(std::memory_order_relaxed)) / total / 1000.0;
+        summary.max_ms = max_us / 1000.0;
+        summary.p50_ms = percentile(snapshot, total, 0.50, max_us);
+        summary.p95_ms = percentile(snapshot, total, 0.95, max_us);
+        summary.p99_ms = percentile(snapshot, total, 0.99, max_us);
+        return summary;
+    }
+
+private:
+    static size_t bucketIndex(uint64_t us) {
+        if (us < SUB_BUCKETS) {
+            return static_cast<size_t>(us);
+        }
+        if (us >> (MAX_EXPONENT + 1)) {
+            us = (1ULL << (MAX_EXPONENT + 1)) - 1;
+        }
+        int exponent = 63 - __builtin_clzll(us);          // >= SUB_BUCKET_BITS
+        int shift = exponent - SUB_BUCKET_BITS;
+        // (us >> shift) is in [16, 32): sub-bucket within this power of two
+        return static_cast<size_t>(shift) * SUB_BUCKETS + static_cast<size_t>(us >> shift);
+    }
+
+    // Midpoint of a bucket's value range
+    static double bucketValueUs(size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return static_cast<double>(index);
+        }
+        int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        uint64_t lower = (index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return lower + ((1ULL << shift) - 1) / 2.0;
+    }
+
+    static double percentile(const std::array<uint64_t, BUCKETS>& counts, uint64_t total,
+                             double quantile, uint64_t max_us) {
+        uint64_t rank = static_cast<uint64_t>(quantile * total + 0.5);
+        if (rank == 0) {
+            rank = 1;
+        }
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            cumulative += counts[i];
+            if (cumulative >= rank) {
+                double value = bucketValueUs(i);
+                return (value < max_us ? value : max_us) / 1000.0;
+            }
+        }
+        return max_us / 1000.0;
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+/**
+ * @brief Records the lifetime of the scope into a histogram
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() { histogram_.recordSince(start_); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @brief Thread-safe pool of reusable objects (e.g. large frame buffers)
+ *
+ * acquire() hands out a std::shared_ptr whose deleter puts the object back into
+ * the pool instead of freeing it, so buffers circulate between producer and
+ * consumer threads without reallocating. Objects released after the pool has
+ * been destroyed are simply deleted.
+ */
+template <typename T>
+class ObjectPool {
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+    /**
+     * @param factory Creates a new object when the pool is empty
+     * @param max_objects Upper bound on objects alive at once (0 = unlimited)
+     */
+    explicit ObjectPool(Factory factory, size_t max_objects = 0)
+        : state_(std::make_shared<State>()), factory_(std::move(factory)), max_objects_(max_objects) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Get a recycled object, or create one
+     * @return nullptr if max_objects are already in use
+     */
+    std::shared_ptr<T> acquire() {
+        std::unique_ptr<T> object;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!state_->free.empty()) {
+                object = std::move(state_->free.back());
+                state_->free.pop_back();
+            } else if (max_objects_ == 0 || state_->created < max_objects_) {
+                state_->created++;
+            } else {
+                return nullptr;
+            }
+        }
+
+        // Create outside the lock - factories may allocate large buffers
+        if (!object) {
+            object = factory_();
+            if (!object) {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                state_->created--;
+                return nullptr;
+            }
+        }
+
+        std::weak_ptr<State> weak_state = state_;
+        return std::shared_ptr<T>(object.release(), [weak_state](T* ptr) {
+            if (auto state = weak_state.lock()) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->free.emplace_back(ptr);
+            } else {
+                delete ptr;
+            }
+        });
+    }
+
+    // Objects created so far (in use + idle)
+    size_t created() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->created;
+    }
+
+    // Idle objects ready for reuse
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->free.size();
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<T>> free;
+        size_t created = 0;
+    };
+
+    std::shared_ptr<State> state_;
+    Factory factory_;
+    const size_t max_objects_;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Sequence lock for a small trivially copyable snapshot
+ *
+ * Readers never block or take a lock: they copy the payload and retry if a
+ * write overlapped (sequence odd or changed), so they always see one complete
+ * store(). Writers are serialised by a mutex among themselves only. The
+ * payload lives in relaxed atomic words, so the racing copy is well defined.
+ */
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() { store(T{}); }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        const uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);     // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t words[WORDS];
+        uint64_t before;
+        uint64_t after;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> words_[WORDS];
+    std::mutex writer_mutex_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Lock-free single-producer / single-consumer ring buffer
+ *
+ * tryPush() is only called by one thread and tryPop() by one other thread;
+ * neither ever blocks or takes a lock, so the producer (e.g. a camera grab
+ * loop) pays a copy and two atomic operations per element. Capacity is
+ * rounded up to a power of two.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Producer side
+     * @return false if the ring is full (item not stored)
+     */
+    bool tryPush(const T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        buffer_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side
+     * @return false if the ring is empty
+     */
+    bool tryPop(T& out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = buffer_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently
+    size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_{0};
+
+    // Separate cache lines: producer and consumer do not invalidate each other's index
+    alignas(64) std::atomic<size_t> head_{0};   // Next slot to write (producer)
+    alignas(64) std::atomic<size_t> tail_{0};   // Next slot to read (consumer)
+};
@@ -4,9 +4,25 @@ Field Test Analysis - HD720@30FPS vs HD720@15FPS Comparison
 """
 
 import os
+import struct
 import sys
 from pathlib import Path
 
+def count_sensor_records(sensor_file):
+    """Number of IMU samples in sensors.slog (binary) or a legacy sensors.csv"""
+    if sensor_file.suffix == '.slog':
+        # sensor_log::FileHeader: magic[8], version, header_size, record_size (uint32 LE)
+        with open(sensor_file, 'rb') as f:
+            header = f.read(20)
+        if len(header) < 20 or header[:8] != b'DSENSLOG':
+            return 0
+        _, header_size, record_size = struct.unpack('<III', header[8:20])
+        if record_size == 0:
+            return 0
+        return max(0, sensor_file.stat().st_size - header_size) // record_size
+    with open(sensor_file, 'r') as f:
+        return sum(1 for line in f) - 1  # -1 for header
+
 def analyze_recording(flight_dir):
     """Analyze a recording directory"""
     flight_path = Path(flight_dir)
@@ -21,8 +37,8 @@ def analyze_recording(flight_dir):
     for file in flight_path.iterdir():
         if file.suffix == '.svo2':
             video_file = file
-        elif file.name == 'sensors.csv':
-            sensor_file = file
+        elif file.name == 'sensors.slog' or (file.name == 'sensors.csv' and sensor_file is None):
+            sensor_file = file  # .slog since the binary sensor log, .csv in older recordings
     
     if not video_file or not sensor_file:
         print(f"❌ Missing files in {flight_dir}")
@@ -33,8 +49,7 @@ def analyze_recording(flight_dir):
     sensor_size_kb = sensor_file.stat().st_size / 1024
     
     # Count sensor readings
-    with open(sensor_file, 'r') as f:
-        sensor_count = sum(1 for line in f) - 1  # -1 for header
+    sensor_count = count_sensor_records(sensor_file)
     
     # Calculate data rate (assuming 30 seconds recording)
     data_rate_mb_per_sec = video_size_mb / 30
@@ -78,7 +78,7 @@ echo "Segments:" >> "$MAIN_DIR/recording_info.txt"
 for j in $(seq 1 $TOTAL_MINUTES); do
     SEGMENT_NAME="segment_$(printf "%02d" $j)_of_${TOTAL_MINUTES}"
     if [ -d "$MAIN_DIR/$SEGMENT_NAME" ]; then
-        echo "  $SEGMENT_NAME/ - Contains video.svo2 and sensors.csv" >> "$MAIN_DIR/recording_info.txt"
+        echo "  $SEGMENT_NAME/ - Contains video.svo2 and sensors.slog" >> "$MAIN_DIR/recording_info.txt"
     fi
 done
 
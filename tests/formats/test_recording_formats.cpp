@@ -0,0 +1,414 @@
+/**
+ * Round-trip and crash-recovery check for the recording formats
+ *
+ * For every depth codec (float32, mm16, mm16_zlib):
+ *   - depth_codec: encode -> decodeDepthBlob -> compare
+ *   - depth.dsf:   write -> read -> compare
+ *   - frames.dfc:  write -> read -> compare (left/right JPEG chunks + depth chunk)
+ * and for both containers:
+ *   - file cut before the footer (at the records end, inside the last record,
+ *     zero-filled preallocation after the records): the reader recovers every
+ *     complete record
+ *   - repair() rebuilds the footer and is idempotent (second run leaves the
+ *     file byte-identical)
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++17 -O2 -I. tests/formats/test_recording_formats.cpp \
+ *       common/formats/{frame_container,depth_stream,depth_codec,depth_downsample}.cpp \
+ *       -lz -lpthread -o test_recording_formats
+ *
+ * Usage: ./test_recording_formats [work_dir]   (default: a new directory under /tmp)
+ */
+#include "common/formats/depth_codec.h"
+#include "common/formats/depth_stream.h"
+#include "common/formats/frame_container.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+const DepthCodec CODECS[] = {DepthCodec::FLOAT32, DepthCodec::UINT16_MM, DepthCodec::UINT16_MM_DELTA_ZLIB};
+const int WIDTH = 96;
+const int HEIGHT = 64;
+const int PADDING = 8;          // Floats of row padding, like an sl::Mat step
+const int FRAMES = 6;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  [PASS] " : "  [FAIL] ") << what << std::endl;
+    if (!ok) {
+        failures++;
+    }
+}
+
+uint64_t frameNumber(int i) { return 100 + 2 * static_cast<uint64_t>(i); }
+uint64_t timestampNs(int i) { return 1700000000000000000ULL + static_cast<uint64_t>(i) * 16666667ULL; }
+
+// Depth map with row padding, plausible ranges and every sentinel
+std::vector<float> makeDepth(int seed) {
+    size_t stride = WIDTH + PADDING;
+    std::vector<float> depth(stride * HEIGHT, -1.0f);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            float value = 0.3f + 0.01f * ((x * 7 + y * 13 + seed * 31) % 2000);
+            int k = (x + y * WIDTH + seed) % 97;
+            if (k == 0) {
+                value = std::numeric_limits<float>::quiet_NaN();
+            } else if (k == 1) {
+                value = std::numeric_limits<float>::infinity();
+            } else if (k == 2) {
+                value = -std::numeric_limits<float>::infinity();
+            }
+            depth[y * stride + x] = value;
+        }
+    }
+    return depth;
+}
+
+// Stand-in for a JPEG: arbitrary bytes, different size per frame
+std::vector<uint8_t> makeImage(int seed, int salt) {
+    std::vector<uint8_t> image(1000 + seed * 37 + salt);
+    for (size_t i = 0; i < image.size(); i++) {
+        image[i] = static_cast<uint8_t>(i * 131 + seed * 17 + salt);
+    }
+    return image;
+}
+
+bool sameValue(float expected, float actual, float tolerance) {
+    if (std::isnan(expected) || std::isnan(actual)) {
+        return std::isnan(expected) && std::isnan(actual);
+    }
+    if (std::isinf(expected) || std::isinf(actual)) {
+        return expected == actual;
+    }
+    return std::fabs(expected - actual) <= tolerance;
+}
+
+// Decoded image against the padded source; mm codecs round to the nearest millimetre
+bool sameDepth(const std::vector<float>& source, const DepthImage& image, DepthCodec codec) {
+    if (image.width != WIDTH || image.height != HEIGHT ||
+        image.data.size() != static_cast<size_t>(WIDTH) * HEIGHT) {
+        return false;
+    }
+    float tolerance = codec == DepthCodec::FLOAT32 ? 0.0f : 0.0006f;
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            if (!sameValue(source[y * (WIDTH + PADDING) + x], image.data[y * WIDTH + x], tolerance)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data, size_t size) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(size));
+    return static_cast<bool>(file);
+}
+
+// Crash images of a closed file: what a writer that never reached close() leaves behind
+struct CrashCase {
+    std::string name;
+    std::vector<uint8_t> bytes;
+    int expected_frames;
+};
+
+std::vector<CrashCase> crashCases(const std::vector<uint8_t>& complete, uint64_t records_end,
+                                  uint64_t last_record_offset) {
+    std::vector<CrashCase> cases;
+    cases.push_back({"cut at records end", std::vector<uint8_t>(complete.begin(), complete.begin() + records_end),
+                     FRAMES});
+    uint64_t torn = last_record_offset + (records_end - last_record_offset) / 2;
+    cases.push_back({"cut inside last record", std::vector<uint8_t>(complete.begin(), complete.begin() + torn),
+                     FRAMES - 1});
+    CrashCase zeros{"zero-filled tail", std::vector<uint8_t>(complete.begin(), complete.begin() + records_end),
+                    FRAMES};
+    zeros.bytes.resize(records_end + 1024 * 1024, 0);     // Unwritten fallocate() space reads as zeros
+    cases.push_back(zeros);
+    return cases;
+}
+
+// ---------------------------------------------------------------------------
+// depth_codec
+// ---------------------------------------------------------------------------
+
+void testCodec(DepthCodec codec) {
+    std::vector<float> depth = makeDepth(3);
+    DepthEncoder encoder;
+    bool encoded = encoder.encode(depth.data(), WIDTH, HEIGHT, (WIDTH + PADDING) * sizeof(float), codec, 42);
+    check(encoded, "encode");
+    if (!encoded) {
+        return;
+    }
+    check(depth_codec::isBlob(encoder.data(), encoder.size()), "output is a depth_codec blob");
+
+    DepthImage image;
+    std::string error;
+    bool decoded = decodeDepthBlob(encoder.data(), encoder.size(), image, &error);
+    check(decoded, "decode" + (error.empty() ? "" : " (" + error + ")"));
+    check(decoded && image.codec == codec && image.frame_number == 42, "codec and frame number preserved");
+    check(decoded && sameDepth(depth, image, codec), "decoded depth matches");
+}
+
+// ---------------------------------------------------------------------------
+// depth.dsf
+// ---------------------------------------------------------------------------
+
+bool verifyStream(const std::string& path, DepthCodec codec, int expected_frames, bool expect_recovered,
+                  const std::string& label) {
+    DepthStreamReader reader;
+    if (!reader.open(path)) {
+        check(false, label + ": open (" + reader.getLastError() + ")");
+        return false;
+    }
+    bool ok = reader.isRecovered() == expect_recovered && reader.getCodec() == codec &&
+              reader.getFrameCount() == static_cast<size_t>(expected_frames);
+    for (int i = 0; ok && i < expected_frames; i++) {
+        const dsf::IndexEntry& entry = reader.getIndex()[i];
+        DepthImage image;
+        ok = entry.frame_number == frameNumber(i) && entry.timestamp_ns == timestampNs(i) &&
+             reader.readFrame(i, image) && sameDepth(makeDepth(i), image, codec);
+    }
+    check(ok, label + ": " + std::to_string(reader.getFrameCount()) + "/" + std::to_string(expected_frames) +
+              " frames" + (reader.isRecovered() ? " (recovered)" : ""));
+    return ok;
+}
+
+void testDepthStream(DepthCodec codec, const std::string& dir) {
+    std::string path = dir + "/depth_" + depth_codec::codecName(codec) + ".dsf";
+
+    DepthStreamWriter writer;
+    bool ok = writer.open(path, codec, 1, DepthPooling::MIN, 64 * 1024);
+    DepthEncoder encoder;
+    for (int i = 0; ok && i < FRAMES; i++) {
+        std::vector<float> depth = makeDepth(i);
+        size_t stride = (WIDTH + PADDING) * sizeof(float);
+        if (codec == DepthCodec::FLOAT32) {
+            ok = writer.writeFrame(frameNumber(i), timestampNs(i), WIDTH, HEIGHT,
+                                   reinterpret_cast<const uint8_t*>(depth.data()), WIDTH * sizeof(float), HEIGHT,
+                                   stride);
+        } else {
+            ok = encoder.encode(depth.data(), WIDTH, HEIGHT, stride, codec) &&
+                 writer.writeFrame(frameNumber(i), timestampNs(i), WIDTH, HEIGHT, encoder.data(), encoder.size());
+        }
+    }
+    ok = writer.close() && ok;
+    check(ok, "write " + std::to_string(FRAMES) + " frames");
+    if (!ok || !verifyStream(path, codec, FRAMES, false, "read back")) {
+        return;
+    }
+
+    std::vector<uint8_t> complete;
+    uint64_t records_end = 0;
+    uint64_t last_offset = 0;
+    {
+        DepthStreamReader reader;
+        reader.open(path);
+        records_end = reader.getRecordsEnd();
+        last_offset = reader.getIndex().back().offset;
+    }
+    readFile(path, complete);
+
+    for (const CrashCase& crash : crashCases(complete, records_end, last_offset)) {
+        std::string crash_path = dir + "/crash.dsf";
+        writeFile(crash_path, crash.bytes, crash.bytes.size());
+        if (!verifyStream(crash_path, codec, crash.expected_frames, true, crash.name)) {
+            continue;
+        }
+
+        std::string error;
+        std::vector<uint8_t> first;
+        std::vector<uint8_t> second;
+        bool repaired = DepthStreamWriter::repair(crash_path, &error);
+        readFile(crash_path, first);
+        repaired = DepthStreamWriter::repair(crash_path, &error) && repaired;
+        readFile(crash_path, second);
+        check(repaired, crash.name + ": repair" + (error.empty() ? "" : " (" + error + ")"));
+        check(!first.empty() && first == second, crash.name + ": second repair leaves the file unchanged");
+        verifyStream(crash_path, codec, crash.expected_frames, false, crash.name + ", repaired");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// frames.dfc
+// ---------------------------------------------------------------------------
+
+bool sameChunk(const dfc::Chunk* chunk, const std::vector<uint8_t>& expected) {
+    return chunk && chunk->data == expected;
+}
+
+bool verifyContainer(const std::string& path, DepthCodec codec, int expected_frames, bool expect_recovered,
+                     const std::string& label) {
+    FrameContainerReader reader;
+    if (!reader.open(path)) {
+        check(false, label + ": open (" + reader.getLastError() + ")");
+        return false;
+    }
+    bool ok = reader.isRecovered() == expect_recovered &&
+              reader.getFrameCount() == static_cast<size_t>(expected_frames);
+    for (int i = 0; ok && i < expected_frames; i++) {
+        dfc::FrameRecord record;
+        ok = reader.readFrame(i, record) && record.frame_number == frameNumber(i) &&
+             record.timestamp_ns == timestampNs(i) && record.flags == (i % 3 == 0 ? dfc::FRAME_FLAG_CORRUPTED : 0) &&
+             sameChunk(record.find(dfc::ChunkType::LEFT_JPEG), makeImage(i, 0)) &&
+             sameChunk(record.find(dfc::ChunkType::RIGHT_JPEG), makeImage(i, 1));
+        const dfc::Chunk* depth = ok ? record.find(dfc::ChunkType::DEPTH) : nullptr;
+        ok = depth != nullptr;
+        if (ok && depth->encoding == dfc::ChunkEncoding::RAW) {
+            DepthImage image;
+            image.width = depth->width;
+            image.height = depth->height;
+            image.data.resize(depth->data.size() / sizeof(float));
+            std::memcpy(image.data.data(), depth->data.data(), image.data.size() * sizeof(float));
+            ok = codec == DepthCodec::FLOAT32 && sameDepth(makeDepth(i), image, codec);
+        } else if (ok) {
+            DepthImage image;
+            ok = codec != DepthCodec::FLOAT32 && decodeDepthBlob(depth->data.data(), depth->data.size(), image) &&
+                 image.codec == codec && sameDepth(makeDepth(i), image, codec);
+        }
+    }
+    check(ok, label + ": " + std::to_string(reader.getFrameCount()) + "/" + std::to_string(expected_frames) +
+              " frames" + (reader.isRecovered() ? " (recovered)" : ""));
+    return ok;
+}
+
+void testFrameContainer(DepthCodec codec, const std::string& dir) {
+    std::string path = dir + "/frames_" + depth_codec::codecName(codec) + ".dfc";
+
+    // Smallest write block: the frames span several pwrite() blocks
+    FrameContainerWriter writer;
+    bool ok = writer.open(path, 64 * 1024);
+    DepthEncoder encoder;
+    for (int i = 0; ok && i < FRAMES; i++) {
+        std::vector<uint8_t> left = makeImage(i, 0);
+        std::vector<uint8_t> right = makeImage(i, 1);
+        std::vector<float> depth = makeDepth(i);
+
+        std::vector<dfc::ChunkData> chunks;
+        chunks.push_back(dfc::ChunkData::contiguous(dfc::ChunkType::LEFT_JPEG, left.data(), left.size(), WIDTH, HEIGHT));
+        chunks.push_back(dfc::ChunkData::contiguous(dfc::ChunkType::RIGHT_JPEG, right.data(), right.size(), WIDTH, HEIGHT));
+        if (codec == DepthCodec::FLOAT32) {
+            dfc::ChunkData chunk;
+            chunk.type = dfc::ChunkType::DEPTH;
+            chunk.width = WIDTH;
+            chunk.height = HEIGHT;
+            chunk.data = reinterpret_cast<const uint8_t*>(depth.data());
+            chunk.row_bytes = WIDTH * sizeof(float);
+            chunk.rows = HEIGHT;
+            chunk.stride = (WIDTH + PADDING) * sizeof(float);
+            chunks.push_back(chunk);
+        } else {
+            ok = encoder.encode(depth.data(), WIDTH, HEIGHT, (WIDTH + PADDING) * sizeof(float), codec);
+            dfc::ChunkData chunk = dfc::ChunkData::contiguous(dfc::ChunkType::DEPTH, encoder.data(), encoder.size(),
+                                                              WIDTH, HEIGHT);
+            chunk.encoding = dfc::ChunkEncoding::DEPTH_CODEC;
+            chunks.push_back(chunk);
+        }
+        ok = ok && writer.writeFrame(frameNumber(i), timestampNs(i), i % 3 == 0 ? dfc::FRAME_FLAG_CORRUPTED : 0,
+                                     chunks);
+    }
+    ok = writer.close() && ok;
+    check(ok, "write " + std::to_string(FRAMES) + " frames");
+    if (!ok || !verifyContainer(path, codec, FRAMES, false, "read back")) {
+        return;
+    }
+
+    std::vector<uint8_t> complete;
+    uint64_t records_end = 0;
+    uint64_t last_offset = 0;
+    {
+        FrameContainerReader reader;
+        reader.open(path);
+        records_end = reader.getRecordsEnd();
+        last_offset = reader.getIndex().back().offset;
+    }
+    readFile(path, complete);
+
+    for (const CrashCase& crash : crashCases(complete, records_end, last_offset)) {
+        std::string crash_path = dir + "/crash.dfc";
+        writeFile(crash_path, crash.bytes, crash.bytes.size());
+        if (!verifyContainer(crash_path, codec, crash.expected_frames, true, crash.name)) {
+            continue;
+        }
+
+        std::string error;
+        std::vector<uint8_t> first;
+        std::vector<uint8_t> second;
+        bool repaired = FrameContainerWriter::repair(crash_path, &error);
+        readFile(crash_path, first);
+        repaired = FrameContainerWriter::repair(crash_path, &error) && repaired;
+        readFile(crash_path, second);
+        check(repaired, crash.name + ": repair" + (error.empty() ? "" : " (" + error + ")"));
+        check(!first.empty() && first == second, crash.name + ": second repair leaves the file unchanged");
+        verifyContainer(crash_path, codec, crash.expected_frames, false, crash.name + ", repaired");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string dir;
+    if (argc > 1) {
+        dir = argv[1];
+        mkdir(dir.c_str(), 0755);
+    } else {
+        char pattern[] = "/tmp/recording_formats_XXXXXX";
+        if (!mkdtemp(pattern)) {
+            std::cerr << "Cannot create a work directory in /tmp" << std::endl;
+            return 1;
+        }
+        dir = pattern;
+    }
+
+    std::cout << "=" << std::string(80, '=') << std::endl;
+    std::cout << "  RECORDING FORMAT TEST (" << dir << ")" << std::endl;
+    std::cout << "=" << std::string(80, '=') << std::endl;
+
+    for (DepthCodec codec : CODECS) {
+        std::cout << std::endl << "--- " << depth_codec::codecName(codec) << ": depth_codec ---" << std::endl;
+        testCodec(codec);
+        std::cout << std::endl << "--- " << depth_codec::codecName(codec) << ": depth.dsf ---" << std::endl;
+        testDepthStream(codec, dir);
+        std::cout << std::endl << "--- " << depth_codec::codecName(codec) << ": frames.dfc ---" << std::endl;
+        testFrameContainer(codec, dir);
+    }
+
+    std::cout << std::endl << "=" << std::string(80, '=') << std::endl;
+    if (failures > 0) {
+        std::cout << "  " << failures << " CHECK(S) FAILED - files kept in " << dir << std::endl;
+        return 1;
+    }
+    std::cout << "  ALL CHECKS PASSED" << std::endl;
+
+    if (argc <= 1) {
+        for (DepthCodec codec : CODECS) {
+            unlink((dir + "/depth_" + depth_codec::codecName(codec) + ".dsf").c_str());
+            unlink((dir + "/frames_" + depth_codec::codecName(codec) + ".dfc").c_str());
+        }
+        unlink((dir + "/crash.dsf").c_str());
+        unlink((dir + "/crash.dfc").c_str());
+        rmdir(dir.c_str());
+    }
+    return 0;
+}
@@ -59,9 +59,29 @@ else
     echo "No SVO file found in $LATEST_DIR"
 fi
 
-# Check sensor file too
-SENSOR_FILE="$LATEST_DIR/sensors.csv"
+# Check sensor file too (binary sensors.slog; sensors.csv in older recordings)
+SENSOR_FILE="$LATEST_DIR/sensors.slog"
 if [ -f "$SENSOR_FILE" ]; then
+    echo -e "\n=== SENSOR FILE ==="
+    echo "Sensor file: $SENSOR_FILE"
+    echo "Size: $(du -h "$SENSOR_FILE" | cut -f1)"
+    # FileHeader: header_size at byte 12, record_size at byte 16 (uint32 LE)
+    HEADER_SIZE=$(od -An -t u4 -j 12 -N 4 "$SENSOR_FILE" | tr -d ' ')
+    RECORD_SIZE=$(od -An -t u4 -j 16 -N 4 "$SENSOR_FILE" | tr -d ' ')
+    if [ -n "$RECORD_SIZE" ] && [ "$RECORD_SIZE" -gt 0 ]; then
+        echo "Records: $(( ($(stat -c%s "$SENSOR_FILE") - HEADER_SIZE) / RECORD_SIZE ))"
+    fi
+    if command -v sensor_log_export >/dev/null 2>&1; then
+        SENSOR_CSV=$(mktemp --suffix=.csv)
+        sensor_log_export "$SENSOR_FILE" "$SENSOR_CSV" >/dev/null
+        echo "Last few entries:"
+        tail -3 "$SENSOR_CSV"
+        rm -f "$SENSOR_CSV"
+    else
+        echo "(build tools/sensor_log_export to print entries as CSV)"
+    fi
+elif [ -f "$LATEST_DIR/sensors.csv" ]; then
+    SENSOR_FILE="$LATEST_DIR/sensors.csv"
     echo -e "\n=== SENSOR FILE ==="
     echo "Sensor file: $SENSOR_FILE"
     echo "Size: $(du -h "$SENSOR_FILE" | cut -f1)"
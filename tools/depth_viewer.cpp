@@ -1,5 +1,6 @@
 // Depth Data Viewer
-// Reads .depth files and displays them as colorized depth maps or saves as PNG
+// Reads depth.dsf streams and legacy .depth files (DepthDataWriter) and RAW .dat depth maps -
+// float32 or any depth_codec variant - and displays them as colorized depth maps or saves as PNG
 
 #include <iostream>
 #include <fstream>
@@ -8,6 +9,23 @@
 #include <filesystem>
 #include <opencv2/opencv.hpp>
 #include <cmath>
+#include <iterator>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "depth_codec.h"
+#include "depth_colormap.h"
+#include "depth_stream.h"
 
 namespace fs = std::filesystem;
 
@@ -15,57 +33,419 @@ struct DepthFileHeader {
     int width;
     int height;
     int frame_number;
+    DepthCodec codec = DepthCodec::FLOAT32;
 };
 
-bool readDepthFile(const std::string& filepath, DepthFileHeader& header, std::vector<float>& depth_data) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filepath << std::endl;
-        return false;
+// Read-only mapping of a whole file (no copy into a buffer; pages fault in on first access)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() {
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& filepath) {
+        int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Failed to open file: " << filepath << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            std::cerr << "File too small: " << filepath << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);    // The mapping keeps the file referenced
+        if (addr == MAP_FAILED) {
+            std::cerr << "Failed to map " << filepath << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        madvise(addr, st.st_size, MADV_SEQUENTIAL | MADV_WILLNEED);
+        data_ = static_cast<const uint8_t*>(addr);
+        size_ = st.st_size;
+        return true;
     }
     
-    // Read header
-    file.read(reinterpret_cast<char*>(&header.width), sizeof(int));
-    file.read(reinterpret_cast<char*>(&header.height), sizeof(int));
-    file.read(reinterpret_cast<char*>(&header.frame_number), sizeof(int));
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+private:
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+};
+
+// Depth map pointing into the mapping (legacy float32) or into decoded storage (depth_codec blobs)
+struct DepthFrame {
+    DepthFileHeader header;
+    const float* data{nullptr};
+    std::vector<float> storage;
+};
+
+/**
+ * @brief Parse a mapped .depth / .dat file
+ * @param header_only Fill frame.header only (no decode, no size check of the payload)
+ */
+bool parseDepthFile(const std::string& filepath, const MappedFile& file, DepthFrame& frame, bool header_only = false) {
+    const uint8_t* bytes = file.data();
+    const size_t size = file.size();
+    DepthFileHeader& header = frame.header;
     
-    // Read depth data
-    size_t pixel_count = header.width * header.height;
-    depth_data.resize(pixel_count);
-    file.read(reinterpret_cast<char*>(depth_data.data()), pixel_count * sizeof(float));
+    // Compressed files carry a depth_codec header
+    if (depth_codec::isBlob(bytes, size)) {
+        if (header_only) {
+            depth_codec::DepthBlobHeader blob;
+            std::memcpy(&blob, bytes, sizeof(blob));
+            header.width = static_cast<int>(blob.width);
+            header.height = static_cast<int>(blob.height);
+            header.frame_number = blob.frame_number;
+            header.codec = static_cast<DepthCodec>(blob.codec);
+            return true;
+        }
+        DepthImage image;
+        std::string error;
+        if (!decodeDepthBlob(bytes, size, image, &error)) {
+            std::cerr << "Failed to decode " << filepath << ": " << error << std::endl;
+            return false;
+        }
+        header.width = image.width;
+        header.height = image.height;
+        header.frame_number = image.frame_number;
+        header.codec = image.codec;
+        frame.storage = std::move(image.data);
+        frame.data = frame.storage.data();
+        return true;
+    }
     
-    file.close();
+    // Legacy float32: .depth = width, height, frame_number; RAW .dat = width, height
+    size_t header_ints = (fs::path(filepath).extension() == ".dat") ? 2 : 3;
+    if (size < header_ints * sizeof(int)) {
+        std::cerr << "File too small: " << filepath << std::endl;
+        return false;
+    }
+    std::memcpy(&header.width, bytes, sizeof(int));
+    std::memcpy(&header.height, bytes + sizeof(int), sizeof(int));
+    header.frame_number = -1;
+    if (header_ints == 3) {
+        std::memcpy(&header.frame_number, bytes + 2 * sizeof(int), sizeof(int));
+    }
+    header.codec = DepthCodec::FLOAT32;
+    if (header_only) {
+        return true;
+    }
+    
+    // Depth data is used in place (4-byte aligned: the mapping is page aligned, the header 8 or 12 bytes)
+    size_t pixel_count = static_cast<size_t>(header.width) * header.height;
+    if (header.width <= 0 || header.height <= 0 || size < header_ints * sizeof(int) + pixel_count * sizeof(float)) {
+        std::cerr << "Truncated depth file: " << filepath << std::endl;
+        return false;
+    }
+    frame.data = reinterpret_cast<const float*>(bytes + header_ints * sizeof(int));
     return true;
 }
 
-cv::Mat depthToColorMap(const std::vector<float>& depth_data, int width, int height, float max_depth = 10.0f) {
+bool isDepthStream(const std::string& path) {
+    return fs::path(path).extension() == ".dsf";
+}
+
+bool openDepthStream(const std::string& path, DepthStreamReader& stream) {
+    if (!stream.open(path)) {
+        std::cerr << "Failed to open depth stream: " << stream.getLastError() << std::endl;
+        return false;
+    }
+    if (stream.isRecovered()) {
+        std::cerr << "Warning: " << path << " has no index (recording not closed) - rebuilt from "
+                  << stream.getFrameCount() << " frame records; 'repair' writes it back" << std::endl;
+    }
+    return true;
+}
+
+// Frame i of a stream: FLOAT32 in place from the mapping, compressed codecs decoded into frame.storage
+bool loadStreamFrame(const DepthStreamReader& stream, size_t i, DepthFrame& frame) {
+    dsf::FrameHeader record;
+    if (!stream.frameHeader(i, record)) {
+        std::cerr << "Frame index " << i << " out of range or corrupt" << std::endl;
+        return false;
+    }
+    frame.header = {record.width, record.height, static_cast<int>(record.frame_number),
+                    static_cast<DepthCodec>(record.codec)};
+    frame.data = stream.frameFloats(i);
+    if (frame.data) {
+        return true;
+    }
+    DepthImage image;
+    std::string error;
+    if (!stream.readFrame(i, image, &error)) {
+        std::cerr << "Failed to read frame " << record.frame_number << ": " << error << std::endl;
+        return false;
+    }
+    frame.storage = std::move(image.data);
+    frame.data = frame.storage.data();
+    return true;
+}
+
+/**
+ * @brief Load one depth map from a .depth/.dat file or a depth.dsf stream
+ * @param frame_number Stream only: recorder frame number (-1 = first frame)
+ */
+bool readDepthFile(const std::string& filepath, DepthFileHeader& header, std::vector<float>& depth_data,
+                   int64_t frame_number = -1) {
+    if (isDepthStream(filepath)) {
+        DepthStreamReader stream;
+        if (!openDepthStream(filepath, stream)) {
+            return false;
+        }
+        size_t i = 0;
+        if (frame_number >= 0 && !stream.findFrame(static_cast<uint64_t>(frame_number), i)) {
+            std::cerr << "Frame " << frame_number << " not in " << filepath << std::endl;
+            return false;
+        }
+        DepthFrame frame;
+        if (!loadStreamFrame(stream, i, frame)) {
+            return false;
+        }
+        header = frame.header;
+        depth_data.assign(frame.data, frame.data + static_cast<size_t>(header.width) * header.height);
+        return true;
+    }
+    
+    MappedFile file;
+    DepthFrame frame;
+    if (!file.open(filepath) || !parseDepthFile(filepath, file, frame)) {
+        return false;
+    }
+    header = frame.header;
+    if (!frame.storage.empty()) {
+        depth_data = std::move(frame.storage);
+    } else {
+        depth_data.assign(frame.data, frame.data + static_cast<size_t>(header.width) * header.height);
+    }
+    return true;
+}
+
+cv::Mat depthToColorMap(const std::vector<float>& depth_data, int width, int height,
+                        const DepthColormap& colormap, int threads = 1) {
     cv::Mat depth_image(height, width, CV_8UC3);
+    colormap.apply(depth_data.data(), width, height, width * sizeof(float),
+                   depth_image.data, depth_image.step, threads);
+    return depth_image;
+}
+
+// Colormap throughput on one file: LUT kernel (1 thread and --threads) vs. OpenCV convertTo + applyColorMap
+void benchmarkColorMap(const std::vector<float>& depth_data, int width, int height,
+                       const DepthColormap& colormap, int threads, int frames) {
+    using Clock = std::chrono::steady_clock;
+    auto report = [&](const std::string& name, Clock::time_point start) {
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        double fps = seconds > 0.0 ? frames / seconds : 0.0;
+        std::cout << "  " << name << ": " << fps << " frames/s ("
+                  << fps * width * height / 1e6 << " MPix/s)" << std::endl;
+    };
     
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int idx = y * width + x;
-            float depth = depth_data[idx];
-            
-            // Handle invalid depth (NaN, inf, too far)
-            if (std::isnan(depth) || std::isinf(depth) || depth > max_depth || depth <= 0.0f) {
-                depth_image.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 0, 0); // Black for invalid
-                continue;
+    cv::Mat out(height, width, CV_8UC3);
+    std::cout << "Colormap benchmark: " << width << "x" << height << ", " << frames << " frames, "
+              << depth_colormap::colormapName(colormap.getConfig().type) << " LUT "
+              << colormap.getConfig().lut_size << std::endl;
+    
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        colormap.apply(depth_data.data(), width, height, width * sizeof(float), out.data, out.step, 1);
+    }
+    report("LUT, 1 thread", start);
+    
+    if (threads > 1) {
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            colormap.apply(depth_data.data(), width, height, width * sizeof(float), out.data, out.step, threads);
+        }
+        report("LUT, " + std::to_string(threads) + " threads", start);
+    }
+    
+    // Reference: whole-frame OpenCV path (no NaN masking, JET only)
+    cv::Mat depth(height, width, CV_32FC1, const_cast<float*>(depth_data.data()));
+    cv::Mat normalized;
+    const DepthColormap::Config& config = colormap.getConfig();
+    double alpha = 255.0 / (config.far_m - config.near_m);
+    start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        depth.convertTo(normalized, CV_8UC1, alpha, -config.near_m * alpha);
+        cv::applyColorMap(normalized, out, cv::COLORMAP_JET);
+    }
+    report("OpenCV applyColorMap", start);
+}
+
+struct BatchOptions {
+    std::string input_dir;
+    std::string output_dir;
+    std::string format = "png";     // "png" | "jpg"
+    int jpeg_quality = 90;
+    int png_compression = 3;
+    bool resume = false;            // Skip frames whose output already exists
+    int threads = 1;
+};
+
+// Output name of one input file: depth_<frame>.<ext> when the header knows the frame, else <stem>.<ext>
+std::string batchOutputName(const fs::path& input, const DepthFileHeader& header, const std::string& extension) {
+    return (header.frame_number >= 0)
+        ? "depth_" + std::to_string(header.frame_number) + "." + extension
+        : input.stem().string() + "." + extension;
+}
+
+/**
+ * @brief Convert a directory of depth files on all cores
+ *
+ * Workers claim the next unprocessed file from a shared atomic cursor, so a
+ * slow file (zlib decode, large PNG) never holds up the others. Each worker
+ * runs map -> decode -> colourise -> encode -> write for its file, which keeps
+ * every stage busy across the pool. Outputs are written to a hidden temporary
+ * name and renamed, so --resume never sees a half-written image.
+ */
+bool runBatch(const BatchOptions& options, const DepthColormap& colormap) {
+    // Jobs: files of a directory, or frames of a depth.dsf stream
+    std::vector<fs::path> files;
+    DepthStreamReader stream;
+    try {
+        if (isDepthStream(options.input_dir)) {
+            if (!openDepthStream(options.input_dir, stream)) {
+                return false;
+            }
+        } else {
+            for (const auto& entry : fs::directory_iterator(options.input_dir)) {
+                if (entry.path().extension() == ".depth" || entry.path().extension() == ".dat") {
+                    files.push_back(entry.path());
+                }
+            }
+        }
+        fs::create_directories(options.output_dir);
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Batch: " << e.what() << std::endl;
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+    const size_t job_count = stream.isOpen() ? stream.getFrameCount() : files.size();
+    
+    std::vector<int> params;
+    if (options.format == "jpg") {
+        params = {cv::IMWRITE_JPEG_QUALITY, options.jpeg_quality};
+    } else {
+        params = {cv::IMWRITE_PNG_COMPRESSION, options.png_compression};
+    }
+    
+    const int threads = std::max(1, std::min<int>(options.threads, static_cast<int>(job_count)));
+    std::cout << "Batch: " << job_count << (stream.isOpen() ? " stream frames, " : " files, ") << threads << " threads, "
+              << options.format << " output" << (options.resume ? ", resume" : "") << std::endl;
+    
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> converted{0};
+    std::atomic<size_t> skipped{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> input_bytes{0};
+    std::atomic<int> running{threads};
+    
+    auto worker = [&]() {
+        cv::Mat image;      // Reused across frames of the same size
+        size_t index;
+        while ((index = next.fetch_add(1)) < job_count) {
+            fs::path input;
+            MappedFile file;
+            DepthFrame frame;
+            uint64_t job_bytes = 0;
+            if (stream.isOpen()) {
+                dsf::FrameHeader record;
+                if (!stream.frameHeader(index, record)) {
+                    failed++;
+                    continue;
+                }
+                frame.header = {record.width, record.height, static_cast<int>(record.frame_number),
+                                static_cast<DepthCodec>(record.codec)};
+                job_bytes = record.payload_size;
+            } else {
+                input = files[index];
+                if (!file.open(input.string()) || !parseDepthFile(input.string(), file, frame, true)) {
+                    failed++;
+                    continue;
+                }
+                job_bytes = file.size();
             }
             
-            // Normalize depth to 0-255 range
-            int depth_value = static_cast<int>((depth / max_depth) * 255.0f);
-            depth_value = std::min(255, std::max(0, depth_value));
+            const std::string name = batchOutputName(input, frame.header, options.format);
+            const std::string out_path = options.output_dir + "/" + name;
+            if (options.resume) {
+                std::error_code ec;
+                uintmax_t existing = fs::file_size(out_path, ec);
+                if (!ec && existing > 0) {
+                    skipped++;
+                    continue;
+                }
+            }
             
-            // Apply COLORMAP_JET
-            cv::Mat single_pixel(1, 1, CV_8UC1, cv::Scalar(depth_value));
-            cv::Mat colored_pixel;
-            cv::applyColorMap(single_pixel, colored_pixel, cv::COLORMAP_JET);
+            if (stream.isOpen() ? !loadStreamFrame(stream, index, frame) : !parseDepthFile(input.string(), file, frame)) {
+                failed++;
+                continue;
+            }
+            image.create(frame.header.height, frame.header.width, CV_8UC3);
+            colormap.apply(frame.data, frame.header.width, frame.header.height, frame.header.width * sizeof(float),
+                           image.data, image.step, 1);
             
-            depth_image.at<cv::Vec3b>(y, x) = colored_pixel.at<cv::Vec3b>(0, 0);
+            const std::string tmp_path = options.output_dir + "/.tmp_" + name;
+            if (!cv::imwrite(tmp_path, image, params) || std::rename(tmp_path.c_str(), out_path.c_str()) != 0) {
+                std::cerr << "Failed to save: " << out_path << std::endl;
+                std::remove(tmp_path.c_str());
+                failed++;
+                continue;
+            }
+            converted++;
+            input_bytes += job_bytes;
         }
+        running--;
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(worker);
     }
     
-    return depth_image;
+    // Progress once per second: frames/s and ETA over converted frames (skips are near free)
+    auto last_report = start;
+    while (running > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report < std::chrono::seconds(1) || running == 0) {
+            continue;
+        }
+        last_report = now;
+        double seconds = std::chrono::duration<double>(now - start).count();
+        size_t done = converted + skipped + failed;
+        double fps = converted / seconds;
+        double eta = fps > 0.0 ? (job_count - done) / fps : 0.0;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Processed " << done << "/" << job_count
+             << " - " << fps << " frames/s, " << input_bytes / (1024.0 * 1024.0) / seconds << " MB/s in, ETA "
+             << eta << "s";
+        std::cout << line.str() << std::endl;
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1) << "Batch conversion complete: " << converted << " frames";
+    if (skipped > 0) {
+        summary << ", " << skipped << " skipped (existing)";
+    }
+    if (failed > 0) {
+        summary << ", " << failed << " failed";
+    }
+    summary << " in " << seconds << "s (" << (seconds > 0.0 ? converted / seconds : 0.0) << " frames/s)";
+    std::cout << summary.str() << std::endl;
+    return failed == 0;
 }
 
 void printUsage(const char* program_name) {
@@ -75,11 +455,26 @@ void printUsage(const char* program_name) {
     std::cout << "Commands:" << std::endl;
     std::cout << "  view <depth_file>           - Display depth file interactively" << std::endl;
     std::cout << "  convert <depth_file> <out>  - Convert depth file to PNG" << std::endl;
-    std::cout << "  batch <input_dir> <out_dir> - Convert all .depth files to PNG" << std::endl;
+    std::cout << "  batch <input> <out_dir>     - Convert a depth.dsf or all .depth/.dat files of a directory" << std::endl;
+    std::cout << "                                to PNG/JPEG on all cores" << std::endl;
     std::cout << "  info <depth_file>           - Show file information" << std::endl;
+    std::cout << "  bench <depth_file>          - Colormap throughput (frames/s)" << std::endl;
+    std::cout << "  repair <depth.dsf>          - Rebuild the index of a stream that was not closed" << std::endl;
+    std::cout << std::endl;
+    std::cout << "<depth_file> is a .depth/.dat file or a depth.dsf stream (first frame unless --frame)" << std::endl;
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
+    std::cout << "  --frame <n>                 - depth.dsf: recorder frame number to show/convert" << std::endl;
+    std::cout << "  --min-depth <meters>        - Near end of the colour range (default: 0.0)" << std::endl;
     std::cout << "  --max-depth <meters>        - Maximum depth for visualization (default: 10.0)" << std::endl;
+    std::cout << "  --colormap <jet|turbo>      - Colour palette (default: jet)" << std::endl;
+    std::cout << "  --lut-size <n>              - Colour steps across the range (default: 256)" << std::endl;
+    std::cout << "  --threads <n>               - view/convert: row bands, batch: files in parallel (default: 1, batch/bench: all cores)" << std::endl;
+    std::cout << "  --frames <n>                - Frames per bench measurement (default: 100)" << std::endl;
+    std::cout << "  --format <png|jpg>          - batch output format (default: png)" << std::endl;
+    std::cout << "  --jpeg-quality <1-100>      - batch JPEG quality (default: 90)" << std::endl;
+    std::cout << "  --png-compression <0-9>     - batch PNG compression level (default: 3)" << std::endl;
+    std::cout << "  --resume                    - batch: skip frames whose output already exists" << std::endl;
 }
 
 int main(int argc, char** argv) {
@@ -89,14 +484,56 @@ int main(int argc, char** argv) {
     }
     
     std::string command = argv[1];
-    float max_depth = 10.0f;
+    DepthColormap::Config colormap_config;
+    int threads = 0;    // 0 = command default
+    int bench_frames = 100;
+    int64_t frame_number = -1;     // depth.dsf: -1 = first frame
+    std::string batch_format = "png";
+    int jpeg_quality = 90;
+    int png_compression = 3;
+    bool resume = false;
     
     // Parse options
     for (int i = 2; i < argc; i++) {
-        if (std::string(argv[i]) == "--max-depth" && i + 1 < argc) {
-            max_depth = std::stof(argv[++i]);
+        std::string arg = argv[i];
+        if (arg == "--max-depth" && i + 1 < argc) {
+            colormap_config.far_m = std::stof(argv[++i]);
+        } else if (arg == "--min-depth" && i + 1 < argc) {
+            colormap_config.near_m = std::stof(argv[++i]);
+        } else if (arg == "--colormap" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (!depth_colormap::parseColormap(name, colormap_config.type)) {
+                std::cerr << "Unknown colormap: " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--lut-size" && i + 1 < argc) {
+            colormap_config.lut_size = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            bench_frames = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--format" && i + 1 < argc) {
+            batch_format = argv[++i];
+            if (batch_format != "png" && batch_format != "jpg") {
+                std::cerr << "Unknown output format: " << batch_format << std::endl;
+                return 1;
+            }
+        } else if (arg == "--jpeg-quality" && i + 1 < argc) {
+            jpeg_quality = std::min(100, std::max(1, std::stoi(argv[++i])));
+        } else if (arg == "--png-compression" && i + 1 < argc) {
+            png_compression = std::min(9, std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--frame" && i + 1 < argc) {
+            frame_number = std::stoll(argv[++i]);
+        } else if (arg == "--resume") {
+            resume = true;
         }
     }
+    if (colormap_config.far_m <= colormap_config.near_m) {
+        std::cerr << "--max-depth must be greater than --min-depth" << std::endl;
+        return 1;
+    }
+    const DepthColormap colormap(colormap_config);
+    const int color_threads = threads > 0 ? threads : 1;
     
     if (command == "view" && argc >= 3) {
         std::string filepath = argv[2];
@@ -104,14 +541,14 @@ int main(int argc, char** argv) {
         DepthFileHeader header;
         std::vector<float> depth_data;
         
-        if (!readDepthFile(filepath, header, depth_data)) {
+        if (!readDepthFile(filepath, header, depth_data, frame_number)) {
             return 1;
         }
         
         std::cout << "Frame " << header.frame_number << ": " 
                   << header.width << "x" << header.height << std::endl;
         
-        cv::Mat depth_image = depthToColorMap(depth_data, header.width, header.height, max_depth);
+        cv::Mat depth_image = depthToColorMap(depth_data, header.width, header.height, colormap, color_threads);
         
         cv::imshow("Depth Viewer", depth_image);
         std::cout << "Press any key to exit..." << std::endl;
@@ -124,11 +561,11 @@ int main(int argc, char** argv) {
         DepthFileHeader header;
         std::vector<float> depth_data;
         
-        if (!readDepthFile(input_file, header, depth_data)) {
+        if (!readDepthFile(input_file, header, depth_data, frame_number)) {
             return 1;
         }
         
-        cv::Mat depth_image = depthToColorMap(depth_data, header.width, header.height, max_depth);
+        cv::Mat depth_image = depthToColorMap(depth_data, header.width, header.height, colormap, color_threads);
         
         if (cv::imwrite(output_file, depth_image)) {
             std::cout << "Saved: " << output_file << std::endl;
@@ -138,43 +575,69 @@ int main(int argc, char** argv) {
         }
         
     } else if (command == "batch" && argc >= 4) {
-        std::string input_dir = argv[2];
-        std::string output_dir = argv[3];
-        
-        fs::create_directories(output_dir);
-        
-        int count = 0;
-        for (const auto& entry : fs::directory_iterator(input_dir)) {
-            if (entry.path().extension() == ".depth") {
-                DepthFileHeader header;
-                std::vector<float> depth_data;
-                
-                if (readDepthFile(entry.path().string(), header, depth_data)) {
-                    cv::Mat depth_image = depthToColorMap(depth_data, header.width, header.height, max_depth);
-                    
-                    std::string out_filename = "depth_" + 
-                                              std::to_string(header.frame_number) + ".png";
-                    std::string out_path = output_dir + "/" + out_filename;
-                    
-                    if (cv::imwrite(out_path, depth_image)) {
-                        count++;
-                        if (count % 10 == 0) {
-                            std::cout << "Processed " << count << " frames..." << std::endl;
-                        }
-                    }
-                }
-            }
+        BatchOptions options;
+        options.input_dir = argv[2];
+        options.output_dir = argv[3];
+        options.format = batch_format;
+        options.jpeg_quality = jpeg_quality;
+        options.png_compression = png_compression;
+        options.resume = resume;
+        options.threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        
+        if (!runBatch(options, colormap)) {
+            return 1;
         }
         
-        std::cout << "Batch conversion complete: " << count << " frames" << std::endl;
+    } else if (command == "bench" && argc >= 3) {
+        DepthFileHeader header;
+        std::vector<float> depth_data;
+        
+        if (!readDepthFile(argv[2], header, depth_data, frame_number)) {
+            return 1;
+        }
+        
+        int bench_threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        benchmarkColorMap(depth_data, header.width, header.height, colormap, bench_threads, bench_frames);
+        
+    } else if (command == "repair" && argc >= 3) {
+        std::string error;
+        if (!DepthStreamWriter::repair(argv[2], &error)) {
+            std::cerr << "Repair failed: " << error << std::endl;
+            return 1;
+        }
         
     } else if (command == "info" && argc >= 3) {
         std::string filepath = argv[2];
         
+        if (isDepthStream(filepath)) {
+            DepthStreamReader stream;
+            if (!openDepthStream(filepath, stream)) {
+                return 1;
+            }
+            const auto& index = stream.getIndex();
+            std::cout << "=== Depth Stream Information ===" << std::endl;
+            std::cout << "Codec: " << depth_codec::codecName(stream.getCodec()) << std::endl;
+            if (stream.getDepthScale() > 1) {
+                std::cout << "Resolution: 1/" << stream.getDepthScale() << " of camera ("
+                          << depth_downsample::poolingName(stream.getPooling()) << " pooling)" << std::endl;
+            }
+            std::cout << "Frames: " << index.size() << (stream.isRecovered() ? " (index rebuilt)" : "") << std::endl;
+            if (!index.empty()) {
+                double span_s = (index.back().timestamp_ns - index.front().timestamp_ns) / 1e9;
+                std::cout << "Frame Numbers: " << index.front().frame_number << " - " << index.back().frame_number << std::endl;
+                std::cout << "Duration: " << span_s << "s";
+                if (span_s > 0.0 && index.size() > 1) {
+                    std::cout << " (" << (index.size() - 1) / span_s << " FPS)";
+                }
+                std::cout << std::endl;
+            }
+            std::cout << std::endl;
+        }
+        
         DepthFileHeader header;
         std::vector<float> depth_data;
         
-        if (!readDepthFile(filepath, header, depth_data)) {
+        if (!readDepthFile(filepath, header, depth_data, frame_number)) {
             return 1;
         }
         
@@ -197,6 +660,7 @@ int main(int argc, char** argv) {
         
         std::cout << "=== Depth File Information ===" << std::endl;
         std::cout << "Frame Number: " << header.frame_number << std::endl;
+        std::cout << "Codec: " << depth_codec::codecName(header.codec) << std::endl;
         std::cout << "Resolution: " << header.width << "x" << header.height << std::endl;
         std::cout << "Total Pixels: " << depth_data.size() << std::endl;
         std::cout << "Valid Pixels: " << valid_pixels << " (" 
@@ -0,0 +1,200 @@
+// Frame Pipeline Benchmark
+// Runs RawFrameRecorder / ZEDRecorder against a synthetic or replayed frame source
+// (no ZED camera needed) and reports achieved FPS, bytes written and MB/s
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <iomanip>
+#include <memory>
+#include "frame_source.h"
+#include "zed_recorder.h"
+#include "raw_frame_recorder.h"
+
+namespace fs = std::filesystem;
+
+void printUsage(const char* program_name) {
+    std::cout << "Frame Pipeline Benchmark - capture-to-disk throughput without camera\n\n";
+    std::cout << "Usage:\n";
+    std::cout << "  " << program_name << " raw <output_dir> [options]   RawFrameRecorder (JPEG + depth + CSV)\n";
+    std::cout << "  " << program_name << " svo <output_dir> [options]   ZEDRecorder loop (sensors/depth only, no SVO)\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --replay <dir>          Replay a RAW_FRAMES recording instead of synthetic frames\n";
+    std::cout << "  --seconds <n>           Benchmark duration (default: 10)\n";
+    std::cout << "  --fps <n>               Source frame rate (default: 30)\n";
+    std::cout << "  --size <w>x<h>          Synthetic frame size (default: 1280x720)\n";
+    std::cout << "  --pattern <p>           gradient | checkerboard | noise (default: gradient)\n";
+    std::cout << "  --unpaced               Deliver frames as fast as the recorder takes them\n";
+    std::cout << "  --jitter <ms>           +/- frame interval jitter\n";
+    std::cout << "  --corrupt-every <n>     Inject CORRUPTED_FRAME every n-th grab\n";
+    std::cout << "  --no-depth              Disable depth (DepthMode::NONE)\n";
+    std::cout << "  --depth-codec <c>       float32 | mm16 | mm16_zlib (raw only, default: float32)\n";
+    std::cout << "  --seed <n>              RNG seed for reproducible runs (default: 42)\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string command = argv[1];
+    std::string output_dir = argv[2];
+    std::string replay_dir;
+    int seconds = 10;
+    bool with_depth = true;
+    DepthCodec depth_codec = DepthCodec::FLOAT32;
+    EncoderPoolStats encoder_stats;
+
+    SyntheticSourceConfig synth_config;
+    OfflineSourceTiming& timing = synth_config.timing;
+
+    // Parse options
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            replay_dir = argv[++i];
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::stoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            timing.fps = std::stoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            std::string size = argv[++i];
+            size_t x = size.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Invalid size: " << size << std::endl;
+                return 1;
+            }
+            synth_config.width = std::stoi(size.substr(0, x));
+            synth_config.height = std::stoi(size.substr(x + 1));
+        } else if (arg == "--pattern" && i + 1 < argc) {
+            std::string pattern = argv[++i];
+            if (pattern == "checkerboard") {
+                synth_config.pattern = SyntheticPattern::CHECKERBOARD;
+            } else if (pattern == "noise") {
+                synth_config.pattern = SyntheticPattern::NOISE;
+            } else {
+                synth_config.pattern = SyntheticPattern::GRADIENT;
+            }
+        } else if (arg == "--unpaced") {
+            timing.realtime = false;
+        } else if (arg == "--jitter" && i + 1 < argc) {
+            timing.jitter_ms = std::stoi(argv[++i]);
+        } else if (arg == "--corrupt-every" && i + 1 < argc) {
+            timing.corrupt_every_n = std::stoi(argv[++i]);
+        } else if (arg == "--no-depth") {
+            with_depth = false;
+        } else if (arg == "--depth-codec" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (!depth_codec::parseCodec(codec, depth_codec)) {
+                std::cerr << "Invalid depth codec: " << codec << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            timing.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
+    synth_config.with_depth = with_depth;
+
+    std::unique_ptr<FrameSource> source;
+    if (!replay_dir.empty()) {
+        ReplaySourceConfig replay_config;
+        replay_config.base_dir = replay_dir;
+        replay_config.timing = timing;
+        source = std::make_unique<ReplayFrameSource>(replay_config);
+    } else {
+        source = std::make_unique<SyntheticFrameSource>(synth_config);
+    }
+
+    if (!source->isOpened()) {
+        std::cerr << "Frame source could not be opened" << std::endl;
+        return 1;
+    }
+
+    std::string source_name = source->getName();
+    int width = source->getWidth();
+    int height = source->getHeight();
+
+    fs::create_directories(output_dir);
+
+    long frames = 0;
+    size_t bytes = 0;
+    double elapsed_s = 0.0;
+
+    if (command == "raw") {
+        RawFrameRecorder recorder;
+        if (!recorder.initWithSource(std::move(source), RecordingMode::HD720_30FPS,
+                                     with_depth ? DepthMode::NEURAL : DepthMode::NONE)) {
+            return 1;
+        }
+        recorder.setDepthCodec(depth_codec);
+
+        auto start = std::chrono::steady_clock::now();
+        if (!recorder.startRecording(output_dir)) {
+            return 1;
+        }
+        while (recorder.isRecording() &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(seconds)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        recorder.stopRecording();
+        elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        frames = recorder.getFrameCount();
+        bytes = static_cast<size_t>(recorder.getBytesWritten());
+        encoder_stats = recorder.getEncoderStats();
+        recorder.close();
+
+    } else if (command == "svo") {
+        ZEDRecorder recorder;
+        recorder.enableDepthComputation(with_depth);
+        if (!recorder.initWithSource(std::move(source))) {
+            return 1;
+        }
+
+        std::string sensor_path = output_dir + "/sensors.slog";
+        auto start = std::chrono::steady_clock::now();
+        if (!recorder.startRecording(output_dir + "/video.svo", sensor_path)) {
+            return 1;
+        }
+        while (recorder.isRecording() &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(seconds)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        recorder.stopRecording();
+        elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        frames = recorder.getCurrentFrameNumber();
+        std::error_code ec;
+        auto sensor_size = fs::file_size(sensor_path, ec);
+        bytes = ec ? 0 : static_cast<size_t>(sensor_size);
+        recorder.close();
+
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cout << "\n=== Frame Pipeline Benchmark (" << command << ", " << source_name << " "
+              << width << "x" << height << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Duration:      " << elapsed_s << " s" << std::endl;
+    std::cout << "Frames:        " << frames << std::endl;
+    std::cout << "Achieved FPS:  " << (elapsed_s > 0 ? frames / elapsed_s : 0.0)
+              << " (source: " << timing.fps << (timing.realtime ? "" : ", unpaced") << ")" << std::endl;
+    std::cout << "Bytes written: " << mb << " MB" << std::endl;
+    std::cout << "Throughput:    " << (elapsed_s > 0 ? mb / elapsed_s : 0.0) << " MB/s" << std::endl;
+    if (command == "raw" && with_depth) {
+        std::cout << "Depth codec:   " << depth_codec::codecName(depth_codec) << " - "
+                  << encoder_stats.depth_compression_ratio << "x";
+        if (encoder_stats.depth_encode_mb_per_sec > 0.0) {
+            std::cout << ", " << encoder_stats.depth_encode_mb_per_sec << " MB/s encode";
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
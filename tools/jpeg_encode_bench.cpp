@@ -0,0 +1,206 @@
+// JPEG Encode Benchmark
+// Compares the old snapshot/RAW path (cv::cvtColor BGRA->BGR + cv::imencode)
+// with JpegEncoder (direct BGRA input, persistent compressor and buffer).
+// Reports per-frame time and heap allocations per frame.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cerrno>
+#include <iomanip>
+#include <opencv2/opencv.hpp>
+#include "jpeg_encoder.h"
+
+// ----------------------------------------------------------------------------
+// Allocation counting
+// Interposes the glibc malloc family: catches operator new (libstdc++),
+// cv::fastMalloc (posix_memalign) and libjpeg's pool allocator alike.
+// ----------------------------------------------------------------------------
+
+static std::atomic<size_t> g_alloc_count{0};
+static std::atomic<size_t> g_alloc_bytes{0};
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+static inline void countAlloc(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void* malloc(size_t size) {
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countAlloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    countAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    countAlloc(size);
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    countAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    countAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+}
+
+// ----------------------------------------------------------------------------
+
+struct BenchResult {
+    double ms_per_frame = 0.0;
+    double allocs_per_frame = 0.0;
+    double alloc_kb_per_frame = 0.0;
+    size_t jpeg_bytes = 0;
+};
+
+void printUsage(const char* program_name) {
+    std::cout << "JPEG Encode Benchmark - cvtColor+imencode vs direct BGRA encoder\n\n";
+    std::cout << "Usage: " << program_name << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --size <w>x<h>     Frame size (default: 1280x720)\n";
+    std::cout << "  --frames <n>       Frames per run (default: 200)\n";
+    std::cout << "  --quality <q>      JPEG quality (default: 90)\n";
+    std::cout << "  --stride-pad <n>   Extra bytes per row, like sl::Mat padding (default: 64)\n";
+}
+
+// Deterministic BGRA test frame with some texture (gradient + noise)
+void fillFrame(std::vector<uint8_t>& buffer, int width, int height, size_t stride, int frame) {
+    uint32_t state = 12345u + static_cast<uint32_t>(frame);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = buffer.data() + y * stride;
+        for (int x = 0; x < width; x++) {
+            state = state * 1664525u + 1013904223u;
+            uint8_t noise = static_cast<uint8_t>((state >> 24) & 0x0F);
+            row[x * 4 + 0] = static_cast<uint8_t>(x + frame) + noise;
+            row[x * 4 + 1] = static_cast<uint8_t>(y) + noise;
+            row[x * 4 + 2] = static_cast<uint8_t>((x + y) >> 1);
+            row[x * 4 + 3] = 255;
+        }
+    }
+}
+
+template <typename EncodeFn>
+BenchResult runBench(int frames, EncodeFn encode) {
+    // Warm-up (first frame sizes the persistent buffers)
+    encode();
+
+    size_t allocs_before = g_alloc_count.load();
+    size_t bytes_before = g_alloc_bytes.load();
+    auto start = std::chrono::steady_clock::now();
+
+    size_t jpeg_bytes = 0;
+    for (int i = 0; i < frames; i++) {
+        jpeg_bytes = encode();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    BenchResult result;
+    result.ms_per_frame = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+    result.allocs_per_frame = static_cast<double>(g_alloc_count.load() - allocs_before) / frames;
+    result.alloc_kb_per_frame = static_cast<double>(g_alloc_bytes.load() - bytes_before) / 1024.0 / frames;
+    result.jpeg_bytes = jpeg_bytes;
+    return result;
+}
+
+void printResult(const std::string& name, const BenchResult& r) {
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10) << r.ms_per_frame << " ms"
+              << std::setw(10) << r.allocs_per_frame << " allocs"
+              << std::setw(12) << r.alloc_kb_per_frame << " KB"
+              << std::setw(10) << r.jpeg_bytes / 1024 << " KB jpeg" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int width = 1280;
+    int height = 720;
+    int frames = 200;
+    int quality = 90;
+    int stride_pad = 64;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            std::string size = argv[++i];
+            size_t x = size.find('x');
+            if (x == std::string::npos) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            width = std::stoi(size.substr(0, x));
+            height = std::stoi(size.substr(x + 1));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::stoi(argv[++i]);
+        } else if (arg == "--quality" && i + 1 < argc) {
+            quality = std::stoi(argv[++i]);
+        } else if (arg == "--stride-pad" && i + 1 < argc) {
+            stride_pad = std::stoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    size_t stride = static_cast<size_t>(width) * 4 + stride_pad;
+    std::vector<uint8_t> frame(stride * height);
+    fillFrame(frame, width, height, stride, 0);
+
+    std::cout << "Frame: " << width << "x" << height << " BGRA (stride " << stride << "), "
+              << frames << " frames, quality " << quality << "\n" << std::endl;
+
+    // BEFORE: what saveImageJPEG / generateSnapshotJPEG used to do
+    BenchResult before = runBench(frames, [&]() {
+        cv::Mat bgra(height, width, CV_8UC4, frame.data(), stride);
+        cv::Mat bgr;
+        cv::cvtColor(bgra, bgr, cv::COLOR_BGRA2BGR);
+        std::vector<uchar> jpeg_buffer;
+        std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, quality};
+        cv::imencode(".jpg", bgr, jpeg_buffer, params);
+        return jpeg_buffer.size();
+    });
+
+    // AFTER: direct BGRA encode with persistent state
+    JpegEncoder encoder(quality);
+    BenchResult after = runBench(frames, [&]() {
+        encoder.encodeBGRA(frame.data(), width, height, stride);
+        return encoder.size();
+    });
+
+    printResult("cvtColor + imencode", before);
+    printResult("JpegEncoder (BGRX direct)", after);
+
+    if (after.ms_per_frame > 0) {
+        std::cout << "\nSpeedup: " << std::setprecision(2) << before.ms_per_frame / after.ms_per_frame << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+// RAW Container Export
+// Unpacks a RAW_FRAMES frames.dfc container into the legacy directory layout
+// (left/frame_XXXXXX_left.jpg, right/frame_XXXXXX_right.jpg, depth/frame_XXXXXX_depth.dat)
+// so existing post-processing scripts keep working.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+#include "frame_container.h"
+#include "depth_codec.h"
+#include "depth_downsample.h"
+
+namespace fs = std::filesystem;
+
+void printUsage(const char* program_name) {
+    std::cout << "RAW Container Export - frames.dfc to left/ right/ depth/\n\n";
+    std::cout << "Usage: " << program_name << " <frames.dfc> [output_dir] [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --info             Print container summary only\n";
+    std::cout << "  --no-depth         Skip depth maps\n";
+    std::cout << "  --repair           Write the rebuilt index back to a container that was not closed\n";
+    std::cout << "\nDefault output_dir is the directory containing frames.dfc\n";
+}
+
+std::string framePath(const std::string& dir, uint64_t frame_num, const std::string& suffix) {
+    std::ostringstream oss;
+    oss << dir << "/frame_" << std::setw(6) << std::setfill('0') << frame_num << "_" << suffix;
+    return oss.str();
+}
+
+bool writeBytes(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(file);
+}
+
+// Same layout as RawFrameRecorder::saveDepthMap: int width, int height, float32 rows
+// (compressed chunks are decoded, so downstream scripts always see float32)
+bool writeDepth(const std::string& path, const dfc::Chunk& chunk) {
+    DepthImage decoded;
+    const uint8_t* values = chunk.data.data();
+    size_t values_size = chunk.data.size();
+    if (chunk.encoding == dfc::ChunkEncoding::DEPTH_CODEC) {
+        std::string error;
+        if (!decodeDepthBlob(chunk.data.data(), chunk.data.size(), decoded, &error)) {
+            std::cerr << "Depth decode failed: " << error << std::endl;
+            return false;
+        }
+        values = reinterpret_cast<const uint8_t*>(decoded.data.data());
+        values_size = decoded.data.size() * sizeof(float);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    int width = chunk.width;
+    int height = chunk.height;
+    file.write(reinterpret_cast<const char*>(&width), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&height), sizeof(int));
+    file.write(reinterpret_cast<const char*>(values), values_size);
+    return static_cast<bool>(file);
+}
+
+// Same sidecar as RawFrameRecorder's DIRECTORIES mode: the .dat header has no field for the downsampling
+bool writeDepthInfo(const std::string& depth_dir, const dfc::Chunk& chunk) {
+    std::ofstream file(depth_dir + "/depth_info.txt");
+    file << "# frame_*_depth.dat: depth maps stored at 1/depth_scale of the camera resolution per axis\n"
+         << "depth_scale=" << chunk.depth_scale << "\n"
+         << "pooling=" << depth_downsample::poolingName(static_cast<DepthPooling>(chunk.pooling)) << "\n"
+         << "codec=" << depth_codec::codecName(DepthCodec::FLOAT32) << "\n";
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string input_path = argv[1];
+    std::string output_dir;
+    bool info_only = false;
+    bool export_depth = true;
+    bool repair = false;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--info") {
+            info_only = true;
+        } else if (arg == "--no-depth") {
+            export_depth = false;
+        } else if (arg == "--repair") {
+            repair = true;
+        } else if (arg.rfind("--", 0) == 0 || !output_dir.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            output_dir = arg;
+        }
+    }
+
+    if (output_dir.empty()) {
+        output_dir = fs::path(input_path).parent_path().string();
+        if (output_dir.empty()) {
+            output_dir = ".";
+        }
+    }
+
+    if (repair) {
+        std::string error;
+        if (!FrameContainerWriter::repair(input_path, &error)) {
+            std::cerr << "Repair failed: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    FrameContainerReader reader;
+    if (!reader.open(input_path)) {
+        std::cerr << "Failed to open container: " << reader.getLastError() << std::endl;
+        return 1;
+    }
+    if (reader.isRecovered()) {
+        std::cerr << "Warning: " << input_path << " has no index (recording not closed) - rebuilt from "
+                  << reader.getFrameCount() << " frame records; --repair writes it back" << std::endl;
+    }
+
+    const auto& index = reader.getIndex();
+    std::cout << "Container: " << input_path << std::endl;
+    std::cout << "Frames: " << index.size() << std::endl;
+    if (!index.empty()) {
+        double duration_s = (index.back().timestamp_ns - index.front().timestamp_ns) / 1e9;
+        std::cout << "Frame range: " << index.front().frame_number << " - " << index.back().frame_number
+                  << " (" << std::fixed << std::setprecision(1) << duration_s << "s)" << std::endl;
+
+        // Depth size and downsampling of the first frame (constant within a recording)
+        dfc::FrameRecord first;
+        const dfc::Chunk* depth = reader.readFrame(0, first) ? first.find(dfc::ChunkType::DEPTH) : nullptr;
+        if (depth) {
+            std::cout << "Depth: " << depth->width << "x" << depth->height;
+            if (depth->depth_scale > 1) {
+                std::cout << " (1/" << depth->depth_scale << " of camera, "
+                          << depth_downsample::poolingName(static_cast<DepthPooling>(depth->pooling)) << " pooling)";
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (info_only) {
+        return 0;
+    }
+
+    std::string left_dir = output_dir + "/left";
+    std::string right_dir = output_dir + "/right";
+    std::string depth_dir = output_dir + "/depth";
+    fs::create_directories(left_dir);
+    fs::create_directories(right_dir);
+
+    size_t exported = 0;
+    size_t errors = 0;
+    size_t corrupted = 0;
+    bool depth_info_written = false;
+    dfc::FrameRecord record;
+
+    for (size_t i = 0; i < reader.getFrameCount(); i++) {
+        if (!reader.readFrame(i, record)) {
+            std::cerr << "Frame " << i << ": " << reader.getLastError() << std::endl;
+            errors++;
+            continue;
+        }
+        if (record.flags & dfc::FRAME_FLAG_CORRUPTED) {
+            corrupted++;
+        }
+
+        bool ok = true;
+        if (const dfc::Chunk* left = record.find(dfc::ChunkType::LEFT_JPEG)) {
+            ok &= writeBytes(framePath(left_dir, record.frame_number, "left.jpg"), left->data);
+        }
+        if (const dfc::Chunk* right = record.find(dfc::ChunkType::RIGHT_JPEG)) {
+            ok &= writeBytes(framePath(right_dir, record.frame_number, "right.jpg"), right->data);
+        }
+        const dfc::Chunk* depth = record.find(dfc::ChunkType::DEPTH);
+        if (export_depth && depth) {
+            fs::create_directories(depth_dir);
+            if (!depth_info_written) {
+                ok &= writeDepthInfo(depth_dir, *depth);
+                depth_info_written = true;
+            }
+            ok &= writeDepth(framePath(depth_dir, record.frame_number, "depth.dat"), *depth);
+        }
+
+        if (ok) {
+            exported++;
+        } else {
+            std::cerr << "Failed to write frame " << record.frame_number << std::endl;
+            errors++;
+        }
+
+        if ((i + 1) % 500 == 0) {
+            std::cout << "  " << (i + 1) << "/" << reader.getFrameCount() << " frames" << std::endl;
+        }
+    }
+
+    std::cout << "Exported " << exported << " frames to " << output_dir;
+    if (corrupted > 0) {
+        std::cout << " (" << corrupted << " flagged corrupted)";
+    }
+    std::cout << std::endl;
+
+    return errors == 0 ? 0 : 1;
+}
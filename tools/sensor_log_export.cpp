@@ -0,0 +1,104 @@
+// Sensor Log Export
+// Converts a binary sensor log (sensors.slog / sensor_data.slog) into the CSV
+// the recorders used to write directly, so existing analysis scripts keep working.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <iomanip>
+#include <filesystem>
+#include "sensor_log.h"
+
+namespace fs = std::filesystem;
+
+void printUsage(const char* program_name) {
+    std::cout << "Sensor Log Export - .slog to CSV\n\n";
+    std::cout << "Usage: " << program_name << " <sensors.slog> [output.csv] [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --info             Print log summary only\n";
+    std::cout << "\nDefault output is the input path with .csv extension\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string input_path = argv[1];
+    std::string output_path;
+    bool info_only = false;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--info") {
+            info_only = true;
+        } else if (arg.rfind("--", 0) == 0 || !output_path.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            output_path = arg;
+        }
+    }
+
+    if (output_path.empty()) {
+        output_path = fs::path(input_path).replace_extension(".csv").string();
+    }
+
+    SensorLogReader reader;
+    if (!reader.open(input_path)) {
+        std::cerr << "Failed to open sensor log: " << reader.getLastError() << std::endl;
+        return 1;
+    }
+
+    const auto& records = reader.getRecords();
+    sensor_log::Layout layout = reader.getLayout();
+    std::cout << "Sensor log: " << input_path << std::endl;
+    std::cout << "Format version: " << reader.getVersion()
+              << " (" << (layout == sensor_log::Layout::RAW_FRAMES ? "RAW_FRAMES" : "ZED_SVO") << " layout)" << std::endl;
+    std::cout << "Records: " << records.size() << std::endl;
+    if (records.size() > 1) {
+        double duration_s = (records.back().wall_time_ms - records.front().wall_time_ms) / 1000.0;
+        std::cout << "Duration: " << std::fixed << std::setprecision(1) << duration_s << "s ("
+                  << (duration_s > 0.0 ? records.size() / duration_s : 0.0) << " Hz)" << std::endl;
+
+        // Logs written by ImuSampler flag which samples carry a fresh magnetometer/barometer reading
+        size_t mag_updates = 0;
+        size_t baro_updates = 0;
+        for (const auto& record : records) {
+            if (record.flags & sensor_log::FLAG_MAG_NEW) mag_updates++;
+            if (record.flags & sensor_log::FLAG_BARO_NEW) baro_updates++;
+        }
+        if ((mag_updates > 0 || baro_updates > 0) && duration_s > 0.0) {
+            std::cout << "Magnetometer: " << mag_updates / duration_s << " Hz, Barometer: "
+                      << baro_updates / duration_s << " Hz" << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    if (reader.isTruncated()) {
+        std::cout << "Warning: trailing partial record ignored (recording cut short)" << std::endl;
+    }
+    if (info_only) {
+        return 0;
+    }
+
+    std::ofstream csv(output_path);
+    if (!csv) {
+        std::cerr << "Failed to create " << output_path << std::endl;
+        return 1;
+    }
+
+    csv << sensor_log::csvHeader(layout) << "\n";
+    for (const auto& record : records) {
+        csv << sensor_log::csvRow(layout, record) << "\n";
+    }
+    csv.close();
+
+    if (!csv) {
+        std::cerr << "Failed to write " << output_path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Exported " << records.size() << " rows to " << output_path << std::endl;
+    return 0;
+}